@@ -135,7 +135,7 @@ except ImportError:
         # Otherwise try loading by name only.
         ctypes.CDLL(libtiledbsoma_name)
 
-from somacore import AxisColumnNames, AxisQuery, ExperimentAxisQuery
+from somacore import AxisColumnNames, AxisQuery
 from somacore.options import ResultOrder
 
 # TODO: once we no longer support Python 3.7, remove this and pin to pyarrow >= 14.0.1
@@ -164,7 +164,8 @@ from ._general_utilities import (
 )
 from ._indexer import IntIndexer, tiledbsoma_build_index
 from ._measurement import Measurement
-from ._sparse_nd_array import SparseNDArray, SparseNDArrayRead
+from ._query import ExperimentAxisQuery
+from ._sparse_nd_array import SparseNDArray, SparseNDArrayRead, open_shared_batch
 from .options import SOMATileDBContext, TileDBCreateOptions, TileDBWriteOptions
 from .pytiledbsoma import (
     tiledbsoma_stats_disable,
@@ -193,6 +194,7 @@ __all__ = [
     "Measurement",
     "NotCreateableError",
     "open",
+    "open_shared_batch",
     "ResultOrder",
     "show_package_versions",
     "SOMA_JOINID",
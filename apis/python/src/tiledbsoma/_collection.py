@@ -17,6 +17,7 @@ from typing import (
     Iterable,
     Iterator,
     Optional,
+    Sequence,
     Set,
     Tuple,
     Type,
@@ -479,6 +480,32 @@ class CollectionBase(  # type: ignore[misc]  # __eq__ false positive
             self._close_stack.enter_context(entry.soma)
         return cast(CollectionElementType, entry.soma)
 
+    def _open_members(self, paths: Sequence[str] = ()) -> None:
+        """Opens nested members ahead of their first access.
+
+        The members of each level of the collection tree are opened concurrently
+        by the native library, so later ``__getitem__`` calls along ``paths``
+        (e.g. ``"ms/RNA/X/data"``) return the already-open objects. All members
+        are opened if ``paths`` is empty. This is a no-op unless open for read.
+        """
+        if self.mode != "r":
+            return
+        from . import _factory  # Delayed binding to resolve circular import.
+
+        members = self._handle._handle.open_members(list(paths))
+        # Parents sort before their members, so each parent is reified first.
+        for path in sorted(members, key=lambda p: p.count("/")):
+            *parents, key = path.split("/")
+            coll: CollectionBase[Any] = self
+            for parent in parents:
+                coll = cast(CollectionBase[Any], coll[parent])
+            entry = coll._contents.get(key)
+            if entry is None or entry.soma is not None:
+                continue
+            wrapper = _tdb_handles.wrap(members[path], coll.context)
+            entry.soma = _factory.reify_handle(wrapper)
+            coll._close_stack.enter_context(entry.soma)
+
     def set(
         self,
         key: str,
@@ -320,6 +320,136 @@ class DataFrame(SOMAArray, somacore.DataFrame):
         """Returns the number of rows in the dataframe. Same as ``df.count``."""
         return self.count
 
+    def create_category_index(self, uri: str, column_names: Sequence[str]) -> None:
+        """Creates a bitmap index of the rows holding each category of some
+        enumerated columns, stored as a new array at ``uri``.
+
+        The dataframe must be open for writing. Rows written from then on are
+        added to the index, and category selections of the native axis query
+        on indexed columns resolve from it without reading the dataframe.
+
+        Args:
+            uri: The URI of the new index array.
+            column_names: The enumerated columns to index. Their codes must
+                be 8, 16 or 32 bit integers.
+
+        Lifecycle:
+            Experimental.
+        """
+        handle: clib.SOMADataFrame = self._handle._handle
+        handle.create_category_index(uri, list(column_names))
+
+    @property
+    def category_index_uri(self) -> Optional[str]:
+        """The URI of the category index, or None if there is none.
+
+        Lifecycle:
+            Experimental.
+        """
+        handle: clib.SOMADataFrame = self._handle._handle
+        return cast(Optional[str], handle.category_index_uri())
+
+    def create_key_filter_index(
+        self, uri: str, column_names: Sequence[str], *, fpp: float = 0.01
+    ) -> None:
+        """Creates a Bloom filter index of the keys of some string index
+        columns, stored as a new array at ``uri``.
+
+        The dataframe must be open for writing. Each write from then on adds
+        a filter of its keys, and reads selecting points of an indexed column
+        skip the keys no filter may contain, and the fragments whose filters
+        no key passes. Consolidating the fragments of the dataframe replaces
+        their filters by one.
+
+        Args:
+            uri: The URI of the new index array.
+            column_names: The string index columns to index.
+            fpp: The false positive rate of the filters.
+
+        Lifecycle:
+            Experimental.
+        """
+        handle: clib.SOMADataFrame = self._handle._handle
+        handle.create_key_filter_index(uri, list(column_names), fpp)
+
+    @property
+    def key_filter_index_uri(self) -> Optional[str]:
+        """The URI of the key filter index, or None if there is none.
+
+        Lifecycle:
+            Experimental.
+        """
+        handle: clib.SOMADataFrame = self._handle._handle
+        return cast(Optional[str], handle.key_filter_index_uri())
+
+    def sample_joinids(
+        self, n: int, *, seed: int = 0, stratify_by: Optional[str] = None
+    ) -> np.ndarray:
+        """Draws a random sample of distinct soma_joinids, uniform over the
+        rows or stratified by the values of a column.
+
+        A stratified sample gives each value of ``stratify_by`` a share of
+        ``n`` proportional to its number of rows.
+
+        Args:
+            n: The sample size. All joinids are returned if there are at most
+                ``n`` rows.
+            seed: The random seed.
+            stratify_by: The column to stratify the sample by, if any.
+
+        Returns:
+            The sampled soma_joinids, in random order.
+
+        Raises:
+            ValueError:
+                If the object is not open for reading.
+
+        Lifecycle:
+            Experimental.
+        """
+        self._check_open_read()
+        handle: clib.SOMADataFrame = self._handle._handle
+        return cast(np.ndarray, handle.sample_joinids(n, seed, stratify_by))
+
+    def read_sample(
+        self,
+        joinids: Sequence[int],
+        *,
+        column_names: Optional[Sequence[str]] = None,
+    ) -> pa.Table:
+        """Reads the rows of some distinct soma_joinids, such as a sample
+        drawn by :meth:`sample_joinids`, in the order given.
+
+        The joinids are read as ranges of consecutive joinids, and the rows
+        of joinids not asked for are dropped as they are read.
+
+        Args:
+            joinids: The distinct soma_joinids to read. Those absent from the
+                dataframe are skipped.
+            column_names: The columns to read, or all columns if None.
+                ``soma_joinid`` is always read.
+
+        Raises:
+            ValueError:
+                If the object is not open for reading.
+            SOMAError:
+                If ``soma_joinid`` is not an index column.
+
+        Lifecycle:
+            Experimental.
+        """
+        self._check_open_read()
+        handle: clib.SOMADataFrame = self._handle._handle
+        names = list(column_names or ())
+        if names and SOMA_JOINID not in names:
+            names.append(SOMA_JOINID)
+        joinids = np.asarray(joinids, dtype=np.int64).tolist()
+        tables, permutation = handle.read_sample(joinids, names)
+        schema = self.schema
+        if names:
+            schema = pa.schema([schema.field(name) for name in names])
+        return _util.sampled_rows_to_table(tables, permutation, schema)
+
     def read(
         self,
         coords: options.SparseDFCoords = (),
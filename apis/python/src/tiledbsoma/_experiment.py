@@ -16,6 +16,7 @@ from ._collection import Collection, CollectionBase
 from ._dataframe import DataFrame
 from ._indexer import IntIndexer
 from ._measurement import Measurement
+from ._query import ExperimentAxisQuery
 from ._soma_object import AnySOMAObject
 from ._tdb_handles import Wrapper
 
@@ -91,7 +92,7 @@ class Experiment(  # type: ignore[misc]  # __eq__ false positive
         """
         # mypy doesn't quite understand descriptors so it issues a spurious
         # error here.
-        return query.ExperimentAxisQuery(  # type: ignore
+        return ExperimentAxisQuery(  # type: ignore
             self,
             measurement_name,
             obs_query=obs_query or query.AxisQuery(),
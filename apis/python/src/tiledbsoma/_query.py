@@ -0,0 +1,556 @@
+# Copyright (c) 2024 TileDB, Inc.
+#
+# Licensed under the MIT License.
+
+"""Implementation of experiment axis queries on the native query engine.
+"""
+from __future__ import annotations
+
+import ast
+from typing import (
+    Any,
+    Dict,
+    Iterator,
+    List,
+    Optional,
+    Sequence,
+    Tuple,
+    TypeVar,
+    Union,
+    cast,
+)
+
+import numpy as np
+import pyarrow as pa
+import scipy.sparse as sp
+import somacore
+from somacore import options, query
+from typing_extensions import Literal
+
+from . import pytiledbsoma as clib
+from ._constants import SOMA_JOINID
+from ._dataframe import DataFrame
+from ._exception import SOMAError
+from ._query_condition import QueryCondition, QueryConditionTree
+from ._sparse_nd_array import SparseNDArray
+
+_Exp = TypeVar("_Exp", bound=somacore.Experiment)  # type: ignore[type-arg]
+
+_Minibatch = Tuple[np.ndarray, Union[np.ndarray, sp.csr_matrix]]
+
+
+def _native_axis_query(
+    df: DataFrame, axis_query: query.AxisQuery, prefix: str
+) -> Optional[Dict[str, Any]]:
+    """Converts an axis query to keyword arguments of the native query, or
+    returns None if the native query cannot express it."""
+    if tuple(df.index_column_names) != (SOMA_JOINID,):
+        return None
+    if len(axis_query.coords) > 1:
+        return None
+
+    kwargs: Dict[str, Any] = {}
+    coords = axis_query.coords[0] if axis_query.coords else None
+    if coords is None:
+        pass
+    elif isinstance(coords, (int, np.integer)):
+        kwargs[f"{prefix}_coords"] = [int(coords)]
+    elif isinstance(coords, slice):
+        if coords.step is not None:
+            return None
+        if coords.start is not None or coords.stop is not None:
+            start = 0 if coords.start is None else int(coords.start)
+            if coords.stop is None:
+                # Bound an open slice by the written joinids, rather than by
+                # the largest representable one
+                domain = df.non_empty_domain()
+                stop = max(start, int(domain[0][1])) if domain else start
+            else:
+                stop = int(coords.stop)
+            kwargs[f"{prefix}_ranges"] = [(start, stop)]
+    else:
+        if isinstance(coords, (pa.Array, pa.ChunkedArray)):
+            coords = coords.to_numpy()
+        try:
+            values = np.asarray(coords)
+        except (TypeError, ValueError):
+            return None
+        if values.ndim != 1 or (values.size and values.dtype.kind not in "iu"):
+            return None
+        kwargs[f"{prefix}_coords"] = values.astype(np.int64).tolist()
+
+    if axis_query.value_filter is not None:
+        categories, qc = _split_value_filter(df, axis_query.value_filter)
+        if categories:
+            kwargs[f"{prefix}_categories"] = categories
+        if qc is not None:
+            kwargs[f"{prefix}_query_condition"] = qc
+    return kwargs
+
+
+def _split_value_filter(
+    df: DataFrame, value_filter: str
+) -> Tuple[Dict[str, List[str]], Optional[clib.PyQueryCondition]]:
+    """Splits the ``==`` and ``in`` terms on enumerated columns out of the
+    top-level conjunction of a value filter when the dataframe has a category
+    index, so the native query resolves them from the index. Returns the
+    labels of each such column and the compiled condition of the other terms,
+    if any."""
+    qc = QueryCondition(value_filter)
+    terms = _conjuncts(qc.tree.body) if df.category_index_uri else []
+    categories: Dict[str, List[str]] = {}
+    rest: List[ast.expr] = []
+    for term in terms:
+        match = _category_term(df.schema, term)
+        if match is None:
+            rest.append(term)
+            continue
+        column, labels = match
+        if column in categories:
+            labels = [label for label in categories[column] if label in labels]
+        categories[column] = labels
+
+    if not categories:
+        qc.init_query_condition(df.schema, [])
+        return categories, qc.c_obj
+    if not rest:
+        return categories, None
+    body = rest[0] if len(rest) == 1 else ast.BoolOp(op=ast.And(), values=rest)
+    try:
+        c_obj = QueryConditionTree(df.schema, []).visit(body)
+    except Exception as pex:
+        raise SOMAError(pex)
+    return categories, c_obj
+
+
+def _conjuncts(node: ast.expr) -> List[ast.expr]:
+    """Returns the terms of a conjunction, or the node itself."""
+    if isinstance(node, ast.BoolOp) and isinstance(node.op, ast.And):
+        return [term for value in node.values for term in _conjuncts(value)]
+    if isinstance(node, ast.BinOp) and isinstance(node.op, ast.BitAnd):
+        return _conjuncts(node.left) + _conjuncts(node.right)
+    return [node]
+
+
+def _category_term(
+    schema: pa.Schema, node: ast.expr
+) -> Optional[Tuple[str, List[str]]]:
+    """Returns the column and labels of a ``column == 'label'`` or
+    ``column in ['label', ...]`` term on an enumerated string column, or None
+    for any other term."""
+    if not isinstance(node, ast.Compare) or len(node.ops) != 1:
+        return None
+    lhs, rhs = node.left, node.comparators[0]
+    if isinstance(node.ops[0], ast.Eq):
+        if _column_name(lhs) is None:
+            lhs, rhs = rhs, lhs
+        labels = [rhs]
+    elif isinstance(node.ops[0], ast.In) and isinstance(rhs, ast.List):
+        labels = rhs.elts
+    else:
+        return None
+
+    column = _column_name(lhs)
+    if column is None or column not in schema.names or not labels:
+        return None
+    if not all(
+        isinstance(label, ast.Constant) and isinstance(label.value, str)
+        for label in labels
+    ):
+        return None
+    dt = schema.field(column).type
+    if not pa.types.is_dictionary(dt) or not (
+        pa.types.is_string(dt.value_type) or pa.types.is_large_string(dt.value_type)
+    ):
+        return None
+    return column, [cast(ast.Constant, label).value for label in labels]
+
+
+def _column_name(node: ast.expr) -> Optional[str]:
+    """Returns the column named by a ``column`` or ``attr('column')`` node."""
+    if isinstance(node, ast.Name):
+        return node.id
+    if (
+        isinstance(node, ast.Call)
+        and isinstance(node.func, ast.Name)
+        and node.func.id == "attr"
+        and len(node.args) == 1
+        and isinstance(node.args[0], ast.Constant)
+        and isinstance(node.args[0].value, str)
+    ):
+        return node.args[0].value
+    return None
+
+
+class _TableListReadIter(somacore.ReadIter[pa.Table]):
+    """Iterator over tables already read by the native query."""
+
+    def __init__(self, tables: List[pa.Table]):
+        self._tables = iter(tables)
+
+    def __next__(self) -> pa.Table:
+        return next(self._tables)
+
+    def concat(self) -> pa.Table:
+        return pa.concat_tables(self)
+
+
+class ShuffledXLoader:
+    """Streams shuffled minibatches of the selected obs rows of an X layer.
+
+    Iterating the loader yields ``(obs_joinids, X)`` pairs for the rest of the
+    current epoch, where ``X`` has one row per joinid and its columns are
+    indexed by position in the query ``var_joinids()``. Call ``set_epoch`` to
+    start another epoch, which is shuffled differently.
+
+    Lifecycle:
+        Experimental.
+    """
+
+    def __init__(self, handle: clib.ShuffledXLoader, n_vars: int, dense: bool):
+        self._handle = handle
+        self._n_vars = n_vars
+        self._dense = dense
+
+    @property
+    def epoch(self) -> int:
+        """The current epoch."""
+        return int(self._handle.epoch)
+
+    @property
+    def num_rows(self) -> int:
+        """The number of obs rows this shard emits per epoch."""
+        return int(self._handle.num_rows)
+
+    def set_epoch(self, epoch: int) -> None:
+        """Restarts the loader at the beginning of ``epoch``."""
+        self._handle.set_epoch(epoch)
+
+    def __iter__(self) -> Iterator[_Minibatch]:
+        while True:
+            batch = self._handle.next(dense=self._dense)
+            if batch is None:
+                return
+            if self._dense:
+                yield batch
+                continue
+            obs_joinids, data, indices, indptr = batch
+            X = sp.csr_matrix(
+                (data, indices, indptr), shape=(len(obs_joinids), self._n_vars)
+            )
+            yield obs_joinids, X
+
+
+class ExperimentAxisQuery(query.ExperimentAxisQuery[_Exp]):
+    """Axis query whose joinids are resolved by the native query engine.
+
+    When both axis queries only select on ``soma_joinid`` coordinates and value
+    filters, libtiledbsoma evaluates them, reading ``obs`` and ``var``
+    concurrently, and ``obs()``, ``var()`` and ``X()`` read only the resolved
+    joinids. Other queries, such as those on dataframes indexed by other
+    columns, are resolved as in ``somacore``.
+
+    Lifecycle:
+        Experimental.
+    """
+
+    def __init__(
+        self,
+        experiment: _Exp,
+        measurement_name: str,
+        *,
+        obs_query: query.AxisQuery = query.AxisQuery(),
+        var_query: query.AxisQuery = query.AxisQuery(),
+        **kwargs: Any,
+    ):
+        super().__init__(
+            experiment,
+            measurement_name,
+            obs_query=obs_query,
+            var_query=var_query,
+            **kwargs,
+        )
+        self._native_obs_query = obs_query
+        self._native_var_query = var_query
+        self._native_: Optional[clib.SOMAExperimentAxisQuery] = None
+        self._native_resolved = False
+        self._native_obs_joinids: Optional[pa.Int64Array] = None
+        self._native_var_joinids: Optional[pa.Int64Array] = None
+        self._engine_: Optional[clib.SOMAExperimentAxisQuery] = None
+
+    def _native(self) -> Optional[clib.SOMAExperimentAxisQuery]:
+        """Returns the native query, or None if it does not apply."""
+        if self._native_resolved:
+            return self._native_
+        self._native_resolved = True
+
+        experiment: Any = self.experiment
+        if getattr(experiment, "mode", None) != "r":
+            return None
+        handle = experiment._handle._handle
+        if not isinstance(handle, clib.SOMAExperiment):
+            return None
+        ms = experiment.ms[self.measurement_name]
+        obs_kwargs = _native_axis_query(experiment.obs, self._native_obs_query, "obs")
+        var_kwargs = _native_axis_query(ms.var, self._native_var_query, "var")
+        if obs_kwargs is None or var_kwargs is None:
+            return None
+        self._native_ = clib.SOMAExperimentAxisQuery(
+            handle, self.measurement_name, **obs_kwargs, **var_kwargs
+        )
+        return self._native_
+
+    def _engine(self) -> clib.SOMAExperimentAxisQuery:
+        """Returns a native query over the selected joinids, for the
+        computations only the native engine implements."""
+        native = self._native()
+        if native is not None:
+            return native
+        if self._engine_ is None:
+            experiment: Any = self.experiment
+            handle = experiment._handle._handle
+            if experiment.mode != "r" or not isinstance(handle, clib.SOMAExperiment):
+                raise ValueError("native query requires an experiment opened for read")
+            # Selections the native query cannot express are resolved
+            # by somacore and passed down as explicit joinids
+            self._engine_ = clib.SOMAExperimentAxisQuery(
+                handle,
+                self.measurement_name,
+                obs_coords=self.obs_joinids().to_numpy().tolist(),
+                var_coords=self.var_joinids().to_numpy().tolist(),
+            )
+        return self._engine_
+
+    def obs_joinids(self) -> pa.Int64Array:
+        native = self._native()
+        if native is None:
+            return super().obs_joinids()
+        if self._native_obs_joinids is None:
+            self._native_obs_joinids = pa.array(native.obs_joinids(), pa.int64())
+        return self._native_obs_joinids
+
+    def var_joinids(self) -> pa.Int64Array:
+        native = self._native()
+        if native is None:
+            return super().var_joinids()
+        if self._native_var_joinids is None:
+            self._native_var_joinids = pa.array(native.var_joinids(), pa.int64())
+        return self._native_var_joinids
+
+    def obs(
+        self,
+        *,
+        column_names: Optional[Sequence[str]] = None,
+        batch_size: options.BatchSize = options.BatchSize(),
+        partitions: Optional[options.ReadPartitions] = None,
+        result_order: options.ResultOrderStr = options.ResultOrder.AUTO,
+        platform_config: Optional[options.PlatformConfig] = None,
+    ) -> somacore.ReadIter[pa.Table]:
+        native = self._native()
+        if native is not None and partitions is None and platform_config is None:
+            tables = self._read_axis(native.obs, column_names, result_order)
+            if tables is not None:
+                return tables
+        return super().obs(
+            column_names=column_names,
+            batch_size=batch_size,
+            partitions=partitions,
+            result_order=result_order,
+            platform_config=platform_config,
+        )
+
+    def var(
+        self,
+        *,
+        column_names: Optional[Sequence[str]] = None,
+        batch_size: options.BatchSize = options.BatchSize(),
+        partitions: Optional[options.ReadPartitions] = None,
+        result_order: options.ResultOrderStr = options.ResultOrder.AUTO,
+        platform_config: Optional[options.PlatformConfig] = None,
+    ) -> somacore.ReadIter[pa.Table]:
+        native = self._native()
+        if native is not None and partitions is None and platform_config is None:
+            tables = self._read_axis(native.var, column_names, result_order)
+            if tables is not None:
+                return tables
+        return super().var(
+            column_names=column_names,
+            batch_size=batch_size,
+            partitions=partitions,
+            result_order=result_order,
+            platform_config=platform_config,
+        )
+
+    @staticmethod
+    def _read_axis(
+        read: Any,
+        column_names: Optional[Sequence[str]],
+        result_order: options.ResultOrderStr,
+    ) -> Optional[_TableListReadIter]:
+        """Reads the selected rows of an axis dataframe natively, or returns
+        None to leave the read to ``somacore``."""
+        if options.ResultOrder(result_order) is not options.ResultOrder.AUTO:
+            return None
+        if column_names is not None and not column_names:
+            return None
+        tables = read(list(column_names or ()))
+        if not tables:
+            # Let the dataframe reader produce the empty, typed table
+            return None
+        return _TableListReadIter(tables)
+
+    def X(
+        self,
+        layer_name: str,
+        *,
+        batch_size: options.BatchSize = options.BatchSize(),
+        partitions: Optional[options.ReadPartitions] = None,
+        result_order: options.ResultOrderStr = options.ResultOrder.AUTO,
+        platform_config: Optional[options.PlatformConfig] = None,
+    ) -> somacore.SparseRead:
+        if self._native() is None:
+            return super().X(
+                layer_name,
+                batch_size=batch_size,
+                partitions=partitions,
+                result_order=result_order,
+                platform_config=platform_config,
+            )
+        ms: Any = self.experiment.ms[self.measurement_name]
+        try:
+            x_layer = ms.X[layer_name]
+        except KeyError as ke:
+            raise KeyError(f"{layer_name} is not present in X") from ke
+        if not isinstance(x_layer, SparseNDArray):
+            raise NotImplementedError("Dense array unsupported")
+        return x_layer.read(
+            (self.obs_joinids(), self.var_joinids()),
+            batch_size=batch_size,
+            partitions=partitions,
+            result_order=result_order,
+            platform_config=platform_config,
+        )
+
+    def X_moments(self, layer_name: str, *, ddof: int = 1) -> Dict[str, np.ndarray]:
+        """Computes the per-obs and per-var nnz, mean and variance of an X
+        layer in one streaming pass, without materializing it.
+
+        Cells that are not stored count as zeros. Results are indexed by
+        position in ``obs_joinids()`` and ``var_joinids()``.
+
+        Args:
+            layer_name: The X layer name.
+            ddof: Delta degrees of freedom of the variance.
+
+        Returns:
+            A dict with ``obs_nnz``, ``obs_mean``, ``obs_variance``,
+            ``var_nnz``, ``var_mean`` and ``var_variance`` arrays.
+
+        Lifecycle:
+            Experimental.
+        """
+        moments = self._engine().X_moments(layer_name, ddof=ddof)
+        return cast(Dict[str, np.ndarray], moments)
+
+    def X_matmul(self, layer_name: str, rhs: np.ndarray) -> np.ndarray:
+        """Multiplies an X layer by a dense matrix in one streaming pass,
+        without materializing X.
+
+        Args:
+            layer_name: The X layer name.
+            rhs: A dense matrix of shape ``(n_vars, k)``, with rows indexed by
+                position in ``var_joinids()``.
+
+        Returns:
+            The ``(n_obs, k)`` product, with rows indexed by position in
+            ``obs_joinids()``.
+
+        Lifecycle:
+            Experimental.
+        """
+        return cast(np.ndarray, self._engine().X_matmul(layer_name, rhs))
+
+    def X_loader(
+        self,
+        layer_name: str,
+        *,
+        batch_size: int = 1024,
+        shuffle: bool = True,
+        seed: int = 0,
+        chunk_size: int = 64,
+        buffer_size: int = 1 << 16,
+        shard: int = 0,
+        num_shards: int = 1,
+        drop_last: bool = False,
+        dense: bool = False,
+    ) -> ShuffledXLoader:
+        """Creates a loader of shuffled minibatches of the selected obs rows
+        of an X layer, e.g. for model training.
+
+        Rows are read in chunks of consecutive joinids, and ``buffer_size``
+        rows are shuffled together in memory while the next buffer is read.
+
+        Args:
+            layer_name: The X layer name.
+            batch_size: Number of obs rows per minibatch.
+            shuffle: If false, rows are emitted in ``soma_joinid`` order.
+            seed: Seed of the shuffle, which all shards must share.
+            chunk_size: Number of consecutive obs joinids read together.
+            buffer_size: Number of obs rows held in memory.
+            shard: Index of the shard this loader emits.
+            num_shards: Number of disjoint shards, e.g. distributed ranks.
+            drop_last: Drop the last minibatch of an epoch if it is short.
+            dense: Emit dense ``float32`` arrays instead of CSR matrices.
+
+        Lifecycle:
+            Experimental.
+        """
+        engine = self._engine()
+        handle = engine.X_loader(
+            layer_name,
+            seed=seed,
+            batch_size=batch_size,
+            chunk_size=chunk_size,
+            buffer_size=buffer_size,
+            shuffle=shuffle,
+            shard=shard,
+            num_shards=num_shards,
+            drop_last=drop_last,
+        )
+        return ShuffledXLoader(handle, engine.n_vars, dense)
+
+    def obsm_knn(
+        self,
+        layer_name: str,
+        queries: np.ndarray,
+        k: int,
+        *,
+        metric: Literal["l2", "cosine"] = "l2",
+    ) -> Tuple[np.ndarray, np.ndarray]:
+        """Finds the exact ``k`` nearest selected obs rows of an obsm
+        embedding to each query vector, streaming the embedding in blocks.
+
+        Args:
+            layer_name: The obsm layer name, e.g. ``"X_pca"``.
+            queries: Query vectors of shape ``(n_queries, dim)``, where
+                ``dim`` is the number of columns of the embedding.
+            k: Number of neighbors per query.
+            metric: ``"l2"`` for Euclidean distance, or ``"cosine"`` for one
+                minus the cosine similarity.
+
+        Returns:
+            The ``(n_queries, k)`` obs joinids and distances of the neighbors,
+            nearest first. Queries with fewer than ``k`` candidates are
+            padded with joinid -1 and an infinite distance.
+
+        Lifecycle:
+            Experimental.
+        """
+        try:
+            knn_metric = clib.KnnMetric.__members__[metric]
+        except KeyError:
+            raise ValueError(f"unknown metric {metric!r}") from None
+        joinids, distances = self._engine().obsm_knn(
+            layer_name, queries, k, metric=knn_metric
+        )
+        return joinids, distances
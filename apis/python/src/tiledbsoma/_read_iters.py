@@ -12,6 +12,7 @@ from concurrent import futures
 from concurrent.futures import ThreadPoolExecutor
 from typing import (
     TYPE_CHECKING,
+    Any,
     Dict,
     Iterator,
     List,
@@ -225,8 +226,14 @@ class BlockwiseReadIterBase(somacore.ReadIter[_RT], metaclass=abc.ABCMeta):
         """Private"""
         return EagerIterator(x, pool=_pool) if self.eager else x
 
-    def _table_reader(self) -> Iterator[BlockwiseTableReadIterResult]:
-        """Private. Blockwise table reader. Helper function for sub-class use"""
+    def _table_reader(
+        self, reindex: bool = False
+    ) -> Iterator[BlockwiseTableReadIterResult]:
+        """Private. Blockwise table reader. Helper function for sub-class use.
+
+        With ``reindex``, the coordinates of the axes to reindex are replaced
+        by their positions in the step's joinids on the native read thread.
+        """
         kwargs: Dict[str, object] = {"result_order": self.sr.result_order}
         for coord_chunk in _coords_strider(
             self.coords[self.major_axis],
@@ -240,30 +247,25 @@ class BlockwiseReadIterBase(somacore.ReadIter[_RT], metaclass=abc.ABCMeta):
 
             joinids = list(self.joinids)
             joinids[self.major_axis] = pa.array(coord_chunk)
-            yield pa.concat_tables(_arrow_table_reader(self.sr)), tuple(joinids)
+
+            reindexers: Dict[str, clib.IntIndexer] = {}
+            if reindex:
+                for d in self.axes_to_reindex:
+                    if d == self.major_axis:
+                        indexer = IntIndexer(coord_chunk, context=self.context)
+                    else:
+                        indexer = self.minor_axes_indexer[d]
+                    reindexers[f"soma_dim_{d}"] = indexer._reindexer
+
+            tbl = pa.concat_tables(_arrow_table_reader(self.sr, reindexers))
+            yield tbl, tuple(joinids)
 
     def _reindexed_table_reader(
         self,
         _pool: Optional[ThreadPoolExecutor] = None,
     ) -> Iterator[BlockwiseTableReadIterResult]:
         """Private. Blockwise table reader w/ reindexing. Helper function for sub-class use"""
-        for tbl, coords in self._maybe_eager_iterator(self._table_reader(), _pool):
-            pytbl = {}
-            for d in range(self.ndim):
-                col = tbl.column(f"soma_dim_{d}")
-                if d in self.axes_to_reindex:
-                    if d == self.major_axis:
-                        assert self.context is not None
-                        col = IntIndexer(
-                            coords[self.major_axis], context=self.context
-                        ).get_indexer(
-                            col.to_numpy(),
-                        )
-                    else:
-                        col = self.minor_axes_indexer[d].get_indexer(col.to_numpy())
-                pytbl[f"soma_dim_{d}"] = col
-            pytbl["soma_data"] = tbl.column("soma_data")
-            yield pa.Table.from_pydict(pytbl), coords
+        yield from self._maybe_eager_iterator(self._table_reader(reindex=True), _pool)
 
 
 class BlockwiseTableReadIter(BlockwiseReadIterBase[BlockwiseTableReadIterResult]):
@@ -401,6 +403,43 @@ class BlockwiseScipyReadIter(BlockwiseReadIterBase[BlockwiseScipyReadIterResult]
         """Private. Compressed sparse variants"""
         assert self.compress
         assert self.major_axis not in self.reindex_disable_on_axis
+        if not _is_native_compressible(self.array.schema.field("soma_data").type):
+            yield from self._scipy_cs_reader(_pool)
+            return
+
+        assert self.context is not None
+        cls = sparse.csr_matrix if self.major_axis == 0 else sparse.csc_matrix
+        fmt = (
+            clib.CompressedFormat.csr
+            if self.major_axis == 0
+            else clib.CompressedFormat.csc
+        )
+        for coo_tbl, indices in self._maybe_eager_iterator(
+            self._reindexed_table_reader(_pool), _pool
+        ):
+            np_indices = (indices[0].to_numpy(), indices[1].to_numpy())
+            shape = self._mk_shape(
+                np_indices[self.major_axis], np_indices[self.minor_axis]
+            )
+            # Counting sort on the major axis in libtiledbsoma. The returned
+            # arrays share the native buffers and are in canonical order, so
+            # scipy does not need to sort them.
+            data, minor, indptr = clib.compress_coo(
+                self.context.native_context,
+                fmt,
+                shape,
+                _chunks_to_numpy(coo_tbl.column(0)),
+                _chunks_to_numpy(coo_tbl.column(1)),
+                _chunks_to_numpy(coo_tbl.column(2)),
+            )
+            sp = cls((data, minor, indptr), shape=shape, copy=False)
+            sp.has_sorted_indices = True
+            yield sp, np_indices
+
+    def _scipy_cs_reader(
+        self, _pool: Optional[ThreadPoolExecutor] = None
+    ) -> Iterator[Tuple[Union[sparse.csr_matrix, sparse.csc_matrix], IndicesType],]:
+        """Private. Compressed sparse variants, assembled by scipy"""
         for ((i, j), d), indices in self._maybe_eager_iterator(
             self._sorted_tbl_reader(_pool), _pool
         ):
@@ -457,12 +496,27 @@ class SparseCOOTensorReadIter(SparseTensorReadIterBase[pa.SparseCOOTensor]):
         return pa.SparseCOOTensor.from_numpy(coo_data, coo_coords, shape=self.shape)
 
 
-def _arrow_table_reader(sr: clib.SOMAArray) -> Iterator[pa.Table]:
-    """Private. Simple Table iterator on any Array"""
-    tbl = sr.read_next()
-    while tbl is not None:
-        yield tbl
-        tbl = sr.read_next()
+def _arrow_table_reader(
+    sr: clib.SOMAArray, reindexers: Optional[Dict[str, clib.IntIndexer]] = None
+) -> Iterator[pa.Table]:
+    """Private. Simple Table iterator on any Array.
+
+    Batches are read, reindexed and converted ahead of the consumer on a
+    native thread, which holds ``sr`` until the iterator is exhausted.
+    """
+    yield from clib.ReadPrefetcher(sr, reindexers=reindexers or {})
+
+
+def _is_native_compressible(type: pa.DataType) -> bool:
+    """Private. True if ``clib.compress_coo`` supports the value type"""
+    return pa.types.is_integer(type) or type in (pa.float32(), pa.float64())
+
+
+def _chunks_to_numpy(col: pa.ChunkedArray) -> List[npt.NDArray[Any]]:
+    """Private. Zero-copy numpy views of the chunks of a column"""
+    if col.num_chunks == 0:
+        return [np.empty(0, dtype=col.type.to_pandas_dtype())]
+    return [chunk.to_numpy() for chunk in col.chunks]
 
 
 def _coords_strider(
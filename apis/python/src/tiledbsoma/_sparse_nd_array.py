@@ -11,7 +11,10 @@ from __future__ import annotations
 import itertools
 import warnings
 from typing import (
+    Any,
     Dict,
+    Iterator,
+    NamedTuple,
     Optional,
     Sequence,
     Tuple,
@@ -22,6 +25,7 @@ from typing import (
 import numpy as np
 import pyarrow as pa
 import pyarrow.compute as pacomp
+import scipy.sparse as sp
 import somacore
 from somacore import options
 from somacore.options import PlatformConfig
@@ -52,6 +56,33 @@ from .options._tiledb_create_options import TileDBCreateOptions, TileDBWriteOpti
 _UNBATCHED = options.BatchSize()
 
 
+class Neighborhood(NamedTuple):
+    """Nodes reached in a graph stored as a 2D :class:`SparseNDArray`.
+
+    Lifecycle:
+        Experimental.
+    """
+
+    joinids: np.ndarray
+    """The node joinids, ascending."""
+    hops: np.ndarray
+    """The hop at which each node was reached, 0 for the seeds."""
+    adjacency: Optional[sp.csr_matrix]
+    """The ``(n, n)`` adjacency of the induced subgraph, indexed by position in
+    ``joinids``, or None if it was not requested."""
+
+
+def _to_neighborhood(result: Dict[str, Any], subgraph: bool) -> Neighborhood:
+    joinids = result["joinids"]
+    adjacency = None
+    if subgraph:
+        adjacency = sp.csr_matrix(
+            (result["data"], result["indices"], result["indptr"]),
+            shape=(len(joinids), len(joinids)),
+        )
+    return Neighborhood(joinids, result["hops"], adjacency)
+
+
 class SparseNDArray(NDArray, somacore.SparseNDArray):
     """:class:`SparseNDArray` is a sparse, N-dimensional array, with offset
     (zero-based) integer indexing on each dimension.
@@ -236,6 +267,88 @@ class SparseNDArray(NDArray, somacore.SparseNDArray):
 
         return SparseNDArrayRead(sr, self, coords)
 
+    def k_hop(
+        self, seeds: Sequence[int], hops: int, *, subgraph: bool = True
+    ) -> Neighborhood:
+        """Expands the neighborhood of some nodes of a graph stored as a 2D
+        array, with an edge from ``soma_dim_0`` to ``soma_dim_1`` for each
+        stored cell, e.g. an ``obsp`` layer.
+
+        Each hop reads the rows of its whole frontier with a single query.
+
+        Args:
+            seeds: The joinids of the nodes to start from.
+            hops: The maximum number of edges from the seeds.
+            subgraph: If true, also extract the subgraph induced by the nodes
+                reached.
+
+        Raises:
+            ValueError:
+                If the object is not open for reading.
+
+        Lifecycle:
+            Experimental.
+        """
+        self._check_open_read()
+        handle: clib.SOMASparseNDArray = self._handle._handle
+        seeds = np.asarray(seeds, dtype=np.int64).tolist()
+        return _to_neighborhood(handle.k_hop(seeds, hops, subgraph), subgraph)
+
+    def induced_subgraph(self, nodes: Sequence[int]) -> Neighborhood:
+        """Extracts the subgraph induced by some nodes of a graph stored as a
+        2D array, as in :meth:`k_hop` with zero hops.
+
+        Lifecycle:
+            Experimental.
+        """
+        self._check_open_read()
+        handle: clib.SOMASparseNDArray = self._handle._handle
+        nodes = np.asarray(nodes, dtype=np.int64).tolist()
+        return _to_neighborhood(handle.induced_subgraph(nodes), True)
+
+    def sample_joinids(self, n: int, *, seed: int = 0) -> np.ndarray:
+        """Draws a uniform random sample of distinct ``soma_dim_0``
+        coordinates, out of those spanned by the stored cells.
+
+        Args:
+            n: The sample size.
+            seed: The random seed.
+
+        Returns:
+            The sampled coordinates, in random order.
+
+        Raises:
+            ValueError:
+                If the object is not open for reading.
+
+        Lifecycle:
+            Experimental.
+        """
+        self._check_open_read()
+        handle: clib.SOMASparseNDArray = self._handle._handle
+        return cast(np.ndarray, handle.sample_joinids(n, seed))
+
+    def read_sample(self, joinids: Sequence[int]) -> pa.Table:
+        """Reads the cells of some distinct ``soma_dim_0`` coordinates, e.g.
+        the ``X`` rows of an ``obs`` sample, grouped by coordinate in the order
+        given.
+
+        The coordinates are read as ranges of consecutive coordinates, and the
+        cells of coordinates not asked for are dropped as they are read.
+
+        Raises:
+            ValueError:
+                If the object is not open for reading.
+
+        Lifecycle:
+            Experimental.
+        """
+        self._check_open_read()
+        handle: clib.SOMASparseNDArray = self._handle._handle
+        joinids = np.asarray(joinids, dtype=np.int64).tolist()
+        tables, permutation = handle.read_sample(joinids)
+        return _util.sampled_rows_to_table(tables, permutation, self.schema)
+
     def write(
         self,
         values: Union[
@@ -499,6 +612,23 @@ class SparseNDArray(NDArray, somacore.SparseNDArray):
         self.metadata.update(bounding_box)
 
 
+def open_shared_batch(name: str, *, unlink: bool = True) -> pa.RecordBatch:
+    """Maps a batch written by :meth:`SparseNDArrayRead.shared_batches`.
+
+    The batch buffers point into the shared memory segment, which is unmapped
+    once the batch and all its columns are garbage collected.
+
+    Args:
+        name: The segment name.
+        unlink: Remove the segment name once it is mapped, so that its memory
+            is freed with the last mapping.
+
+    Lifecycle:
+        Experimental.
+    """
+    return clib.open_shared_batch(name, unlink=unlink)
+
+
 class _SparseNDArrayReadBase(somacore.SparseRead):
     """Base class for sparse reads"""
 
@@ -563,6 +693,26 @@ class SparseNDArrayRead(_SparseNDArrayReadBase):
         self.array._set_reader_coords(self.sr, self.coords)
         return TableReadIter(self.sr)
 
+    def shared_batches(self, name_prefix: str) -> Iterator[str]:
+        """
+        Writes each batch of the read to a new POSIX shared memory segment,
+        named ``f"{name_prefix}-{i}"``, and yields the segment names. Worker
+        processes map the batches with :func:`open_shared_batch` without
+        copying them, so a batch is decoded once however many workers use it.
+
+        Each segment outlives this process until it is opened with
+        ``unlink=True``, so every yielded name must be opened once.
+
+        Lifecycle:
+            Experimental.
+        """
+        self.array._set_reader_coords(self.sr, self.coords)
+        for i in itertools.count():
+            name = f"{name_prefix}-{i}"
+            if self.sr.read_next_shared(name) is None:
+                return
+            yield name
+
     def blockwise(
         self,
         axis: Union[int, Sequence[int]],
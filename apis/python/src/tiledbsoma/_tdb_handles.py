@@ -74,6 +74,13 @@ def open(
     if not soma_object:
         raise DoesNotExistError(f"{uri!r} does not exist")
 
+    return wrap(soma_object, context)
+
+
+def wrap(
+    soma_object: clib.SOMAObject, context: SOMATileDBContext
+) -> "Wrapper[RawHandle]":
+    """Wrap an already opened object in the handle class for its type."""
     _type_to_class = {
         "somadataframe": DataFrameWrapper,
         "somadensendarray": DenseNDArrayWrapper,
@@ -88,7 +95,9 @@ def open(
             soma_object, context
         )
     except KeyError:
-        raise SOMAError(f"{uri!r} has unknown storage type {soma_object.type!r}")
+        raise SOMAError(
+            f"{soma_object.uri!r} has unknown storage type {soma_object.type!r}"
+        )
 
 
 @attrs.define(eq=False, hash=False, slots=False)
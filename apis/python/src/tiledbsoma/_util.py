@@ -288,6 +288,16 @@ def to_clib_result_order(result_order: options.ResultOrderStr) -> clib.ResultOrd
         raise ValueError(f"Invalid result_order: {result_order}") from ke
 
 
+def sampled_rows_to_table(
+    tables: List[pa.Table], permutation: Any, schema: pa.Schema
+) -> pa.Table:
+    """Concatenates the tables of a sample read by ``read_sample`` in sample
+    order, or returns an empty table of ``schema`` if none were read."""
+    if not tables:
+        return schema.empty_table()
+    return pa.concat_tables(tables).take(permutation)
+
+
 def pa_types_is_string_or_bytes(dtype: pa.DataType) -> bool:
     return bool(
         pa.types.is_large_string(dtype)
@@ -151,31 +151,59 @@ bool is_tdb_str(tiledb_datatype_t type) {
     }
 }
 
+namespace {
+
+/**
+ * @brief Return a pyarrow callable, looked up on first use.
+ *
+ * The objects are never released, as the interpreter may already be
+ * finalized when static destructors run. The GIL serializes the lookup.
+ */
+const py::object& pa_record_batch_import() {
+    static py::object* import = nullptr;
+    if (import == nullptr) {
+        import = new py::object(py::module::import("pyarrow")
+                                    .attr("RecordBatch")
+                                    .attr("_import_from_c"));
+    }
+    return *import;
+}
+
+const py::object& pa_table_from_batches() {
+    static py::object* from_batches = nullptr;
+    if (from_batches == nullptr) {
+        from_batches = new py::object(
+            py::module::import("pyarrow").attr("Table").attr("from_batches"));
+    }
+    return *from_batches;
+}
+
+}  // namespace
+
+py::object arrow_to_table(
+    std::unique_ptr<ArrowArray> array, std::unique_ptr<ArrowSchema> schema) {
+    auto batch = pa_record_batch_import()(
+        py::capsule(array.get()), py::capsule(schema.get()));
+    return pa_table_from_batches()(py::make_tuple(batch));
+}
+
 /**
  * @brief Convert ArrayBuffers to Arrow table.
  *
+ * The batch is converted to a single Arrow struct array with the GIL
+ * released, then imported as one record batch.
+ *
  * @param cbs ArrayBuffers
  * @return py::object
  */
 py::object _buffer_to_table(std::shared_ptr<ArrayBuffers> buffers) {
-    auto pa = py::module::import("pyarrow");
-    auto pa_table_from_arrays = pa.attr("Table").attr("from_arrays");
-    auto pa_array_import = pa.attr("Array").attr("_import_from_c");
-    auto pa_schema_import = pa.attr("Schema").attr("_import_from_c");
-
-    py::list array_list;
-    py::list names;
-
-    for (auto& name : buffers->names()) {
-        auto column = buffers->at(name);
-        auto [pa_array, pa_schema] = ArrowAdapter::to_arrow(column);
-        auto array = pa_array_import(
-            py::capsule(pa_array.get()), py::capsule(pa_schema.get()));
-        array_list.append(array);
-        names.append(name);
+    std::unique_ptr<ArrowArray> pa_array;
+    std::unique_ptr<ArrowSchema> pa_schema;
+    {
+        py::gil_scoped_release release;
+        std::tie(pa_array, pa_schema) = ArrowAdapter::to_arrow(buffers);
     }
-
-    return pa_table_from_arrays(array_list, names);
+    return arrow_to_table(std::move(pa_array), std::move(pa_schema));
 }
 
 std::optional<py::object> to_table(
@@ -189,6 +217,19 @@ std::optional<py::object> to_table(
     return std::nullopt;
 }
 
+py::tuple to_sampled_tables(const SampledRows& rows) {
+    py::list tables;
+    for (auto& batch : rows.batches) {
+        tables.append(_buffer_to_table(batch));
+    }
+    auto permutation = py::array_t<int64_t>(rows.permutation.size());
+    std::copy(
+        rows.permutation.begin(),
+        rows.permutation.end(),
+        permutation.mutable_data());
+    return py::make_tuple(tables, permutation);
+}
+
 py::dict meta(std::map<std::string, MetadataValue> metadata_mapping) {
     py::dict results;
 
@@ -38,9 +38,22 @@ tiledb_datatype_t np_to_tdb_dtype(py::dtype type);
 
 bool is_tdb_str(tiledb_datatype_t type);
 
+/**
+ * @brief Import an Arrow struct array, such as one built by
+ * ArrowAdapter::to_arrow, as an Arrow table.
+ */
+py::object arrow_to_table(
+    std::unique_ptr<ArrowArray> array, std::unique_ptr<ArrowSchema> schema);
+
 std::optional<py::object> to_table(
     std::optional<std::shared_ptr<ArrayBuffers>> buffers);
 
+/**
+ * @brief Convert the rows of a sample to a tuple of the list of Arrow
+ * tables read and the numpy permutation of their concatenated rows.
+ */
+py::tuple to_sampled_tables(const SampledRows& rows);
+
 py::dict meta(std::map<std::string, MetadataValue> metadata_mapping);
 void set_metadata(
     SOMAObject& soma_object, const std::string& key, py::array value);
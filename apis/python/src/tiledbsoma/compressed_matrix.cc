@@ -0,0 +1,189 @@
+/**
+ * @file   compressed_matrix.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ * This file defines the CompressedMatrix bindings.
+ */
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/pytypes.h>
+#include <pybind11/stl.h>
+
+#include <tiledbsoma/tiledbsoma>
+
+#include "common.h"
+
+namespace libtiledbsomacpp {
+
+namespace py = pybind11;
+using namespace py::literals;
+using namespace tiledbsoma;
+
+namespace {
+
+using Coords = py::array_t<int64_t, py::array::c_style | py::array::forcecast>;
+
+/**
+ * @brief Assemble COO chunks into a CSR or CSC matrix and return its
+ * (data, indices, indptr) as numpy arrays sharing the matrix buffers.
+ */
+template <typename T>
+py::tuple compress_coo_as(
+    std::shared_ptr<SOMAContext> ctx,
+    CompressedFormat format,
+    std::pair<int64_t, int64_t> shape,
+    const std::vector<Coords>& rows,
+    const std::vector<Coords>& cols,
+    const std::vector<py::array>& data) {
+    using Values = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+    auto matrix = std::make_shared<CompressedMatrix<T>>(
+        format, shape.first, shape.second, ctx);
+
+    // Keep the (possibly converted) value arrays alive until compressed
+    std::vector<Values> values;
+    for (size_t i = 0; i < data.size(); ++i) {
+        values.push_back(Values::ensure(data[i]));
+        if (rows[i].size() != values[i].size() ||
+            cols[i].size() != values[i].size()) {
+            throw py::value_error(
+                "compress_coo: row, col and data chunks must have the same "
+                "length");
+        }
+        matrix->append(
+            rows[i].data(), cols[i].data(), values[i].data(), values[i].size());
+    }
+
+    {
+        py::gil_scoped_release release;
+        matrix->compress();
+    }
+
+    // The three arrays share one capsule owning the matrix, so no buffer is
+    // copied and the matrix is freed with the last of them
+    py::capsule owner(
+        new std::shared_ptr<CompressedMatrix<T>>(matrix), [](void* p) {
+            delete reinterpret_cast<std::shared_ptr<CompressedMatrix<T>>*>(p);
+        });
+    return py::make_tuple(
+        py::array_t<T>(matrix->data().size(), matrix->data().data(), owner),
+        py::array_t<int64_t>(
+            matrix->indices().size(), matrix->indices().data(), owner),
+        py::array_t<int64_t>(
+            matrix->indptr().size(), matrix->indptr().data(), owner));
+}
+
+}  // namespace
+
+void load_compressed_matrix(py::module& m) {
+    py::enum_<CompressedFormat>(m, "CompressedFormat")
+        .value("csr", CompressedFormat::csr)
+        .value("csc", CompressedFormat::csc);
+
+    // Native COO to CSR/CSC assembly. The row, col and data arguments are
+    // lists of chunks (e.g. the chunks of a reindexed X table).
+    m.def(
+        "compress_coo",
+        [](std::shared_ptr<SOMAContext> ctx,
+           CompressedFormat format,
+           std::pair<int64_t, int64_t> shape,
+           std::vector<Coords> rows,
+           std::vector<Coords> cols,
+           std::vector<py::array> data) -> py::tuple {
+            if (rows.size() != data.size() || cols.size() != data.size()) {
+                throw py::value_error(
+                    "compress_coo: row, col and data must have the same "
+                    "number of chunks");
+            }
+            if (data.empty()) {
+                throw py::value_error(
+                    "compress_coo: at least one data chunk is required");
+            }
+
+            // Dispatch on kind and size rather than dtype identity, so
+            // equal dtypes built another way (from a string, with a
+            // non-native byte order, long vs. long long) are accepted; the
+            // chunks are converted to native order by `compress_coo_as`
+            auto dtype = data[0].dtype();
+            switch (dtype.kind()) {
+                case 'f':
+                    switch (dtype.itemsize()) {
+                        case 4:
+                            return compress_coo_as<float>(
+                                ctx, format, shape, rows, cols, data);
+                        case 8:
+                            return compress_coo_as<double>(
+                                ctx, format, shape, rows, cols, data);
+                    }
+                    break;
+                case 'i':
+                    switch (dtype.itemsize()) {
+                        case 1:
+                            return compress_coo_as<int8_t>(
+                                ctx, format, shape, rows, cols, data);
+                        case 2:
+                            return compress_coo_as<int16_t>(
+                                ctx, format, shape, rows, cols, data);
+                        case 4:
+                            return compress_coo_as<int32_t>(
+                                ctx, format, shape, rows, cols, data);
+                        case 8:
+                            return compress_coo_as<int64_t>(
+                                ctx, format, shape, rows, cols, data);
+                    }
+                    break;
+                case 'u':
+                    switch (dtype.itemsize()) {
+                        case 1:
+                            return compress_coo_as<uint8_t>(
+                                ctx, format, shape, rows, cols, data);
+                        case 2:
+                            return compress_coo_as<uint16_t>(
+                                ctx, format, shape, rows, cols, data);
+                        case 4:
+                            return compress_coo_as<uint32_t>(
+                                ctx, format, shape, rows, cols, data);
+                        case 8:
+                            return compress_coo_as<uint64_t>(
+                                ctx, format, shape, rows, cols, data);
+                    }
+                    break;
+            }
+            throw py::type_error(
+                "compress_coo: unsupported data type " +
+                py::str(dtype).cast<std::string>());
+        },
+        "ctx"_a,
+        "format"_a,
+        "shape"_a,
+        "rows"_a,
+        "cols"_a,
+        "data"_a);
+}
+
+}  // namespace libtiledbsomacpp
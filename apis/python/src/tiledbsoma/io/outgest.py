@@ -190,6 +190,16 @@ def to_anndata(
         raise ValueError(
             f"requested measurement name {measurement_name} not found in input: {experiment.ms.keys()}"
         )
+    # Open everything read below in a few concurrent rounds rather than one
+    # member at a time
+    ms_path = f"ms/{measurement_name}"
+    X_layers = [X_layer_name] if X_layer_name is not None else []
+    X_layers.extend(extra_X_layer_names or [])
+    experiment._open_members(
+        ["obs"]
+        + [f"{ms_path}/{key}" for key in ("var", "obsm", "varm", "obsp", "varp")]
+        + [f"{ms_path}/X/{layer}" for layer in X_layers]
+    )
     measurement = experiment.ms[measurement_name]
 
     # How to choose index name for AnnData obs and var dataframes:
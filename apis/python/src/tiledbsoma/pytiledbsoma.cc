@@ -24,8 +24,10 @@ void load_soma_dense_ndarray(py::module&);
 void load_soma_sparse_ndarray(py::module&);
 void load_soma_group(py::module&);
 void load_soma_collection(py::module&);
+void load_soma_experiment_axis_query(py::module&);
 void load_query_condition(py::module&);
 void load_reindexer(py::module&);
+void load_compressed_matrix(py::module&);
 
 PYBIND11_MODULE(pytiledbsoma, m) {
     py::register_exception<TileDBSOMAError>(m, "SOMAError");
@@ -132,8 +134,10 @@ PYBIND11_MODULE(pytiledbsoma, m) {
     load_soma_sparse_ndarray(m);
     load_soma_group(m);
     load_soma_collection(m);
+    load_soma_experiment_axis_query(m);
     load_query_condition(m);
     load_reindexer(m);
+    load_compressed_matrix(m);
 }
 
 };  // namespace libtiledbsomacpp
@@ -137,7 +137,7 @@ py::array_t<int64_t> get_indexer_py_arrow(
 void load_reindexer(py::module& m) {
     // Efficient C++ re-indexing (aka hashing unique key values to an index
     // between 0 and number of keys - 1) based on khash
-    py::class_<IntIndexer>(m, "IntIndexer")
+    py::class_<IntIndexer, std::shared_ptr<IntIndexer>>(m, "IntIndexer")
         .def(py::init<>())
         .def(py::init<std::shared_ptr<SOMAContext>>())
         .def(
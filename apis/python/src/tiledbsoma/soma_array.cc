@@ -59,6 +59,40 @@ void write(SOMAArray& array, py::handle py_batch, bool sort_coords = true) {
     arrow_array.release(&arrow_array);
 }
 
+template <typename T>
+py::array read_dense_rows_as(SOMAArray& array, std::vector<int64_t> joinids) {
+    std::unique_ptr<std::vector<T>> matrix;
+    {
+        py::gil_scoped_release release;
+        matrix = std::make_unique<std::vector<T>>(
+            DenseRowReader::read<T>(array, joinids));
+    }
+
+    // The numpy array takes ownership of the matrix, without copying it
+    auto n_rows = static_cast<py::ssize_t>(joinids.size());
+    auto n_cols = static_cast<py::ssize_t>(array.shape()[1]);
+    auto data = matrix->data();
+    py::capsule owner(matrix.release(), [](void* p) {
+        delete reinterpret_cast<std::vector<T>*>(p);
+    });
+    return py::array_t<T>({n_rows, n_cols}, data, owner);
+}
+
+py::dict neighborhood_to_dict(Neighborhood neighborhood) {
+    py::dict result;
+    result["joinids"] = py::array_t<int64_t>(
+        neighborhood.joinids.size(), neighborhood.joinids.data());
+    result["hops"] = py::array_t<uint32_t>(
+        neighborhood.hops.size(), neighborhood.hops.data());
+    result["indptr"] = py::array_t<int64_t>(
+        neighborhood.indptr.size(), neighborhood.indptr.data());
+    result["indices"] = py::array_t<int64_t>(
+        neighborhood.indices.size(), neighborhood.indices.data());
+    result["data"] = py::array_t<double>(
+        neighborhood.data.size(), neighborhood.data.data());
+    return result;
+}
+
 void write_coords(
     SOMAArray& array,
     std::vector<py::array> coords,
@@ -132,6 +166,8 @@ void load_soma_array(py::module& m) {
                py::object py_query_condition,
                py::object py_schema) {
                 auto column_names = array.column_names();
+                std::vector<std::string> filter_columns;
+                std::string condition_key;
                 // Handle query condition based on
                 // TileDB-Py::PyQuery::set_attr_cond()
                 QueryCondition* qc = nullptr;
@@ -139,16 +175,22 @@ void load_soma_array(py::module& m) {
                     py::object init_pyqc = py_query_condition.attr(
                         "init_query_condition");
                     try {
-                        // Column names will be updated with columns present
-                        // in the query condition
-                        auto new_column_names =
-                            init_pyqc(py_schema, column_names)
+                        // Collect the columns present in the query condition
+                        filter_columns =
+                            init_pyqc(py_schema, py::list())
                                 .cast<std::vector<std::string>>();
                         // Update the column_names list if it was not empty,
                         // otherwise continue selecting all columns with an
                         // empty column_names list
                         if (!column_names.empty()) {
-                            column_names = new_column_names;
+                            for (const auto& name : filter_columns) {
+                                if (std::find(
+                                        column_names.begin(),
+                                        column_names.end(),
+                                        name) == column_names.end()) {
+                                    column_names.push_back(name);
+                                }
+                            }
                         }
                     } catch (const std::exception& e) {
                         TPY_ERROR_LOC(e.what());
@@ -157,6 +199,10 @@ void load_soma_array(py::module& m) {
                              .cast<PyQueryCondition>()
                              .ptr()
                              .get();
+                    // Identify the condition by its expression for the
+                    // result cache
+                    condition_key = py_query_condition.attr("expression")
+                                        .cast<std::string>();
                 }
                 array.reset(column_names);
 
@@ -165,7 +211,8 @@ void load_soma_array(py::module& m) {
                 py::gil_scoped_release release;
                 // Set query condition if present
                 if (qc) {
-                    array.set_condition(*qc);
+                    array.set_condition(*qc, filter_columns);
+                    array.set_condition_key(condition_key);
                 }
             },
             "py_query_condition"_a,
@@ -518,6 +565,81 @@ void load_soma_array(py::module& m) {
                 return std::nullopt;
             })
 
+        .def(
+            "read_next_shared",
+            [](SOMAArray& array,
+               const std::string& name) -> std::optional<size_t> {
+                // Release python GIL before reading data
+                py::gil_scoped_release release;
+
+                // Write the next batch to a shared memory segment for
+                // open_shared_batch in worker processes, and return the
+                // segment size, or nullopt if the query is complete
+                auto buffers = array.read_next();
+                if (!buffers.has_value()) {
+                    return std::nullopt;
+                }
+                return SharedBatch::write(name, *buffers);
+            },
+            "name"_a)
+
+        .def(
+            "read_dense_rows",
+            [](SOMAArray& array,
+               std::vector<int64_t> joinids,
+               py::object dtype_like) -> py::array {
+                // Read the rows of a 2D array as a dense (len(joinids),
+                // shape[1]) matrix, in the order of the joinids
+                auto dtype = py::dtype::from_args(dtype_like);
+                if (dtype.equal(py::dtype::of<float>())) {
+                    return read_dense_rows_as<float>(array, joinids);
+                }
+                if (dtype.equal(py::dtype::of<double>())) {
+                    return read_dense_rows_as<double>(array, joinids);
+                }
+                throw py::type_error(
+                    "read_dense_rows: dtype must be float32 or float64");
+            },
+            "joinids"_a,
+            "dtype"_a = "float32")
+
+        .def(
+            "k_hop",
+            [](SOMAArray& array,
+               std::vector<int64_t> seeds,
+               uint32_t hops,
+               bool subgraph) {
+                // Expand the neighborhood of the seeds in a graph array,
+                // returning its nodes, their hop and the CSR adjacency of
+                // the induced subgraph
+                Neighborhood neighborhood;
+                {
+                    py::gil_scoped_release release;
+                    neighborhood = GraphTraversal::k_hop(
+                        array,
+                        JoinidBitmap::from_joinids(seeds),
+                        hops,
+                        subgraph);
+                }
+                return neighborhood_to_dict(std::move(neighborhood));
+            },
+            "seeds"_a,
+            "hops"_a,
+            "subgraph"_a = true)
+
+        .def(
+            "induced_subgraph",
+            [](SOMAArray& array, std::vector<int64_t> nodes) {
+                Neighborhood neighborhood;
+                {
+                    py::gil_scoped_release release;
+                    neighborhood = GraphTraversal::induced_subgraph(
+                        array, JoinidBitmap::from_joinids(nodes));
+                }
+                return neighborhood_to_dict(std::move(neighborhood));
+            },
+            "nodes"_a)
+
         .def("write", write)
 
         .def("write_coords", write_coords)
@@ -655,5 +777,50 @@ void load_soma_array(py::module& m) {
         .def("has_metadata", &SOMAArray::has_metadata)
 
         .def("metadata_num", &SOMAArray::metadata_num);
+
+    // Reads, reindexes and converts the batches of a SOMAArray query on a
+    // background thread. The GIL is only held to import finished batches.
+    py::class_<ReadPrefetcher>(m, "ReadPrefetcher")
+        .def(
+            py::init<
+                SOMAArray&,
+                size_t,
+                std::map<std::string, std::shared_ptr<IntIndexer>>>(),
+            "array"_a,
+            "queue_depth"_a = 2,
+            "reindexers"_a =
+                std::map<std::string, std::shared_ptr<IntIndexer>>(),
+            py::keep_alive<1, 2>())
+
+        .def("__iter__", [](py::object self) { return self; })
+
+        .def("__next__", [](ReadPrefetcher& prefetcher) -> py::object {
+            std::optional<ReadPrefetcher::ArrowBatch> batch;
+            {
+                py::gil_scoped_release release;
+                batch = prefetcher.next();
+            }
+            if (!batch) {
+                throw py::stop_iteration();
+            }
+            return arrow_to_table(
+                std::move(batch->first), std::move(batch->second));
+        });
+
+    m.def(
+        "open_shared_batch",
+        [](const std::string& name, bool unlink) -> py::object {
+            // Map a segment written by SOMAArray.read_next_shared as a
+            // record batch. The segment is unmapped when the batch and all
+            // its columns are garbage collected.
+            auto [array, schema] = SharedBatch::open(name, unlink);
+            auto pa = py::module::import("pyarrow");
+            auto pa_batch_import = pa.attr("RecordBatch").attr(
+                "_import_from_c");
+            return pa_batch_import(
+                py::capsule(array.get()), py::capsule(schema.get()));
+        },
+        "name"_a,
+        "unlink"_a = true);
 }
 }  // namespace libtiledbsomacpp
@@ -67,7 +67,28 @@ void load_soma_collection(py::module& m) {
                 return py::make_iterator(collection.begin(), collection.end());
             },
             py::keep_alive<0, 1>())
-        .def("get", &SOMACollection::get);
+        .def("get", &SOMACollection::get)
+        .def(
+            "open_members",
+            [](py::object self, std::vector<std::string> paths) {
+                auto& collection = self.cast<SOMACollection&>();
+                std::map<std::string, std::shared_ptr<SOMAObject>> members;
+                {
+                    py::gil_scoped_release release;
+                    members = collection.open_members(paths);
+                }
+                // The members are owned by their parent collections, so the
+                // returned handles keep this collection alive
+                py::dict result;
+                for (const auto& [path, member] : members) {
+                    result[py::str(path)] = py::cast(
+                        member.get(),
+                        py::return_value_policy::reference_internal,
+                        self);
+                }
+                return result;
+            },
+            "paths"_a = std::vector<std::string>());
 
     py::class_<SOMAExperiment, SOMACollection, SOMAGroup, SOMAObject>(
         m, "SOMAExperiment");
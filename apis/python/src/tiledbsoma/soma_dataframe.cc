@@ -136,6 +136,66 @@ void load_soma_dataframe(py::module& m) {
         .def_static("exists", &SOMADataFrame::exists)
         .def_property_readonly(
             "index_column_names", &SOMADataFrame::index_column_names)
-        .def_property_readonly("count", &SOMADataFrame::count);
+        .def_property_readonly("count", &SOMADataFrame::count)
+
+        .def(
+            "create_category_index",
+            [](SOMADataFrame& df,
+               std::string_view index_uri,
+               std::vector<std::string> column_names) {
+                py::gil_scoped_release release;
+                df.create_category_index(index_uri, column_names);
+            },
+            "index_uri"_a,
+            "column_names"_a)
+
+        .def("category_index_uri", &SOMADataFrame::category_index_uri)
+
+        .def(
+            "create_key_filter_index",
+            [](SOMADataFrame& df,
+               std::string_view index_uri,
+               std::vector<std::string> column_names,
+               double fpp) {
+                py::gil_scoped_release release;
+                df.create_key_filter_index(index_uri, column_names, fpp);
+            },
+            "index_uri"_a,
+            "column_names"_a,
+            "fpp"_a = KeyFilterIndex::DEFAULT_FPP)
+
+        .def("key_filter_index_uri", &SOMADataFrame::key_filter_index_uri)
+
+        .def(
+            "sample_joinids",
+            [](SOMADataFrame& df,
+               size_t n,
+               uint64_t seed,
+               std::optional<std::string> stratify_by) {
+                std::vector<int64_t> joinids;
+                {
+                    py::gil_scoped_release release;
+                    joinids = df.sample_joinids(n, seed, stratify_by);
+                }
+                return py::array_t<int64_t>(joinids.size(), joinids.data());
+            },
+            "n"_a,
+            "seed"_a = 0,
+            "stratify_by"_a = py::none())
+
+        .def(
+            "read_sample",
+            [](SOMADataFrame& df,
+               std::vector<int64_t> joinids,
+               std::vector<std::string> column_names) {
+                SampledRows rows;
+                {
+                    py::gil_scoped_release release;
+                    rows = df.read_sample(joinids, column_names);
+                }
+                return to_sampled_tables(rows);
+            },
+            "joinids"_a,
+            "column_names"_a = std::vector<std::string>{});
 }
 }  // namespace libtiledbsomacpp
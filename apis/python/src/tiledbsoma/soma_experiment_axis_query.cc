@@ -0,0 +1,421 @@
+/**
+ * @file   soma_experiment_axis_query.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ * This file defines the SOMAExperimentAxisQuery bindings.
+ */
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/pytypes.h>
+#include <pybind11/stl.h>
+#include <pybind11/stl_bind.h>
+
+#include <tiledbsoma/tiledbsoma>
+
+#include "common.h"
+
+namespace libtiledbsomacpp {
+
+namespace py = pybind11;
+using namespace py::literals;
+using namespace tiledbsoma;
+
+namespace {
+
+using Batches = std::vector<std::shared_ptr<ArrayBuffers>>;
+
+SOMAAxisQuery make_axis_query(
+    std::optional<std::vector<int64_t>> coords,
+    std::optional<std::vector<std::pair<int64_t, int64_t>>> ranges,
+    py::object query_condition,
+    std::optional<std::map<std::string, std::vector<std::string>>>
+        categories) {
+    SOMAAxisQuery axis_query;
+    if (coords) {
+        axis_query.set_coords(*coords);
+    }
+    if (ranges) {
+        axis_query.set_ranges(*ranges);
+    }
+    // The caller is expected to have run `init_query_condition` on the
+    // Python QueryCondition, so only the compiled C++ object is used here
+    if (!query_condition.is_none()) {
+        axis_query.set_condition(
+            *query_condition.cast<PyQueryCondition>().ptr());
+    }
+    if (categories) {
+        axis_query.set_categories(*categories);
+    }
+    return axis_query;
+}
+
+py::list to_tables(const Batches& batches) {
+    py::list tables;
+    for (auto& batch : batches) {
+        tables.append(*to_table(batch));
+    }
+    return tables;
+}
+
+template <typename T>
+py::array_t<T> to_numpy(const std::vector<T>& values) {
+    auto result = py::array_t<T>(values.size());
+    std::copy(values.begin(), values.end(), result.mutable_data());
+    return result;
+}
+
+}  // namespace
+
+void load_soma_experiment_axis_query(py::module& m) {
+    py::enum_<KnnMetric>(m, "KnnMetric")
+        .value("l2", KnnMetric::l2)
+        .value("cosine", KnnMetric::cosine);
+
+    py::class_<ShuffledXLoader>(m, "ShuffledXLoader")
+        .def(
+            "set_epoch",
+            &ShuffledXLoader::set_epoch,
+            "epoch"_a,
+            py::call_guard<py::gil_scoped_release>())
+
+        .def_property_readonly("epoch", &ShuffledXLoader::epoch)
+
+        .def_property_readonly("num_rows", &ShuffledXLoader::num_rows)
+
+        .def(
+            "next",
+            [](ShuffledXLoader& loader, bool dense) -> py::object {
+                std::optional<XMinibatch> batch;
+                {
+                    py::gil_scoped_release release;
+                    batch = loader.next();
+                }
+                if (!batch) {
+                    return py::none();
+                }
+                auto obs_joinids = to_numpy(batch->obs_joinids);
+                if (dense) {
+                    auto values = batch->to_dense();
+                    auto result = py::array_t<float>(
+                        {static_cast<int64_t>(batch->n_rows()),
+                         batch->n_cols});
+                    std::copy(
+                        values.begin(), values.end(), result.mutable_data());
+                    return py::make_tuple(obs_joinids, result);
+                }
+                return py::make_tuple(
+                    obs_joinids,
+                    to_numpy(batch->data),
+                    to_numpy(batch->indices),
+                    to_numpy(batch->indptr));
+            },
+            py::kw_only(),
+            "dense"_a = false);
+
+    py::class_<SOMAExperimentAxisQuery>(m, "SOMAExperimentAxisQuery")
+        .def(
+            py::init([](SOMAExperiment& experiment,
+                        std::string measurement_name,
+                        std::optional<std::vector<int64_t>> obs_coords,
+                        std::optional<std::vector<std::pair<int64_t, int64_t>>>
+                            obs_ranges,
+                        py::object obs_query_condition,
+                        std::optional<
+                            std::map<std::string, std::vector<std::string>>>
+                            obs_categories,
+                        std::optional<std::vector<int64_t>> var_coords,
+                        std::optional<std::vector<std::pair<int64_t, int64_t>>>
+                            var_ranges,
+                        py::object var_query_condition,
+                        std::optional<
+                            std::map<std::string, std::vector<std::string>>>
+                            var_categories) {
+                // The query shares ownership of the experiment, so reopen it
+                // rather than borrowing the Python-owned handle
+                std::shared_ptr<SOMAExperiment> exp = SOMAExperiment::open(
+                    experiment.uri(),
+                    OpenMode::read,
+                    experiment.ctx(),
+                    experiment.timestamp());
+                return std::make_unique<SOMAExperimentAxisQuery>(
+                    exp,
+                    measurement_name,
+                    make_axis_query(
+                        obs_coords,
+                        obs_ranges,
+                        obs_query_condition,
+                        obs_categories),
+                    make_axis_query(
+                        var_coords,
+                        var_ranges,
+                        var_query_condition,
+                        var_categories));
+            }),
+            "experiment"_a,
+            "measurement_name"_a,
+            py::kw_only(),
+            "obs_coords"_a = py::none(),
+            "obs_ranges"_a = py::none(),
+            "obs_query_condition"_a = py::none(),
+            "obs_categories"_a = py::none(),
+            "var_coords"_a = py::none(),
+            "var_ranges"_a = py::none(),
+            "var_query_condition"_a = py::none(),
+            "var_categories"_a = py::none())
+
+        .def(
+            "obs_joinids",
+            [](SOMAExperimentAxisQuery& query) {
+                const std::vector<int64_t>* joinids;
+                {
+                    py::gil_scoped_release release;
+                    joinids = &query.obs_joinids();
+                }
+                return to_numpy(*joinids);
+            })
+
+        .def(
+            "var_joinids",
+            [](SOMAExperimentAxisQuery& query) {
+                const std::vector<int64_t>* joinids;
+                {
+                    py::gil_scoped_release release;
+                    joinids = &query.var_joinids();
+                }
+                return to_numpy(*joinids);
+            })
+
+        .def_property_readonly(
+            "n_obs",
+            &SOMAExperimentAxisQuery::n_obs,
+            py::call_guard<py::gil_scoped_release>())
+
+        .def_property_readonly(
+            "n_vars",
+            &SOMAExperimentAxisQuery::n_vars,
+            py::call_guard<py::gil_scoped_release>())
+
+        .def(
+            "obs",
+            [](SOMAExperimentAxisQuery& query,
+               std::vector<std::string> column_names) {
+                Batches batches;
+                {
+                    py::gil_scoped_release release;
+                    batches = query.obs(column_names);
+                }
+                return to_tables(batches);
+            },
+            "column_names"_a = std::vector<std::string>{})
+
+        .def(
+            "var",
+            [](SOMAExperimentAxisQuery& query,
+               std::vector<std::string> column_names) {
+                Batches batches;
+                {
+                    py::gil_scoped_release release;
+                    batches = query.var(column_names);
+                }
+                return to_tables(batches);
+            },
+            "column_names"_a = std::vector<std::string>{})
+
+        .def(
+            "read_X",
+            [](SOMAExperimentAxisQuery& query,
+               const std::string& layer,
+               bool reindex,
+               ResultOrder result_order) {
+                Batches batches;
+                {
+                    py::gil_scoped_release release;
+                    batches = query.read_X(layer, reindex, result_order);
+                }
+                return to_tables(batches);
+            },
+            "layer"_a,
+            py::kw_only(),
+            "reindex"_a = false,
+            "result_order"_a = ResultOrder::automatic)
+
+        .def(
+            "X_moments",
+            [](SOMAExperimentAxisQuery& query,
+               const std::string& layer,
+               int64_t ddof) {
+                std::optional<SparseMoments> moments;
+                {
+                    py::gil_scoped_release release;
+                    moments.emplace(query.X_moments(layer, ddof));
+                }
+                py::dict result;
+                result["obs_nnz"] = to_numpy(moments->row_nnz());
+                result["obs_mean"] = to_numpy(moments->row_mean());
+                result["obs_variance"] = to_numpy(moments->row_variance());
+                result["var_nnz"] = to_numpy(moments->col_nnz());
+                result["var_mean"] = to_numpy(moments->col_mean());
+                result["var_variance"] = to_numpy(moments->col_variance());
+                return result;
+            },
+            "layer"_a,
+            py::kw_only(),
+            "ddof"_a = 1)
+
+        .def(
+            "X_matmul",
+            [](SOMAExperimentAxisQuery& query,
+               const std::string& layer,
+               py::array_t<double, py::array::c_style | py::array::forcecast>
+                   rhs) {
+                if (rhs.ndim() != 2) {
+                    throw py::value_error("rhs must be a 2D array");
+                }
+                int64_t k = rhs.shape(1);
+                size_t n_vars;
+                {
+                    py::gil_scoped_release release;
+                    n_vars = query.n_vars();
+                }
+                if (rhs.shape(0) != static_cast<int64_t>(n_vars)) {
+                    throw py::value_error(
+                        "rhs must have one row per selected var (" +
+                        std::to_string(n_vars) + ")");
+                }
+                std::vector<double> product;
+                {
+                    py::gil_scoped_release release;
+                    product = query.X_matmul(layer, rhs.data(), k);
+                }
+                auto result = py::array_t<double>(
+                    {static_cast<int64_t>(query.n_obs()), k});
+                std::copy(
+                    product.begin(), product.end(), result.mutable_data());
+                return result;
+            },
+            "layer"_a,
+            "rhs"_a)
+
+        .def(
+            "X_loader",
+            [](SOMAExperimentAxisQuery& query,
+               const std::string& layer,
+               uint64_t seed,
+               size_t batch_size,
+               size_t chunk_size,
+               size_t buffer_size,
+               bool shuffle,
+               uint32_t shard,
+               uint32_t num_shards,
+               bool drop_last) {
+                ShuffledXLoaderOptions options;
+                options.seed = seed;
+                options.batch_size = batch_size;
+                options.chunk_size = chunk_size;
+                options.buffer_size = buffer_size;
+                options.shuffle = shuffle;
+                options.shard = shard;
+                options.num_shards = num_shards;
+                options.drop_last = drop_last;
+                py::gil_scoped_release release;
+                return query.X_loader(layer, options);
+            },
+            "layer"_a,
+            py::kw_only(),
+            "seed"_a = 0,
+            "batch_size"_a = 1024,
+            "chunk_size"_a = 64,
+            "buffer_size"_a = 1 << 16,
+            "shuffle"_a = true,
+            "shard"_a = 0,
+            "num_shards"_a = 1,
+            "drop_last"_a = false)
+
+        .def(
+            "obsm_knn",
+            [](SOMAExperimentAxisQuery& query,
+               const std::string& name,
+               py::array_t<float, py::array::c_style | py::array::forcecast>
+                   queries,
+               int64_t k,
+               KnnMetric metric) {
+                if (queries.ndim() != 2) {
+                    throw py::value_error("queries must be a 2D array");
+                }
+                if (k < 0) {
+                    throw py::value_error("k must be non-negative");
+                }
+                int64_t n_queries = queries.shape(0);
+                int64_t dim = queries.shape(1);
+                KnnResult result;
+                {
+                    py::gil_scoped_release release;
+                    result = query.obsm_knn(
+                        name, queries.data(), n_queries, dim, k, metric);
+                }
+                auto joinids = py::array_t<int64_t>({n_queries, k});
+                auto distances = py::array_t<float>({n_queries, k});
+                std::copy(
+                    result.joinids.begin(),
+                    result.joinids.end(),
+                    joinids.mutable_data());
+                std::copy(
+                    result.distances.begin(),
+                    result.distances.end(),
+                    distances.mutable_data());
+                return py::make_tuple(joinids, distances);
+            },
+            "name"_a,
+            "queries"_a,
+            "k"_a,
+            "metric"_a = KnnMetric::l2)
+
+        .def(
+            "read_X_layers",
+            [](SOMAExperimentAxisQuery& query,
+               std::vector<std::string> layers,
+               bool reindex,
+               ResultOrder result_order) {
+                std::map<std::string, Batches> results;
+                {
+                    py::gil_scoped_release release;
+                    results = query.read_X_layers(
+                        layers, reindex, result_order);
+                }
+                py::dict tables;
+                for (auto& [layer, batches] : results) {
+                    tables[py::str(layer)] = to_tables(batches);
+                }
+                return tables;
+            },
+            "layers"_a,
+            py::kw_only(),
+            "reindex"_a = false,
+            "result_order"_a = ResultOrder::automatic);
+}
+}  // namespace libtiledbsomacpp
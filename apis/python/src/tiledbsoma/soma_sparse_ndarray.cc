@@ -110,6 +110,42 @@ void load_soma_sparse_ndarray(py::module& m) {
             "result_order"_a = ResultOrder::automatic,
             "timestamp"_a = py::none())
 
-        .def_static("exists", &SOMASparseNDArray::exists);
+        .def_static("exists", &SOMASparseNDArray::exists)
+
+        .def(
+            "create_colmajor_layout",
+            [](SOMASparseNDArray& array, std::string_view layout_uri) {
+                py::gil_scoped_release release;
+                array.create_colmajor_layout(layout_uri);
+            },
+            "layout_uri"_a)
+
+        .def(
+            "colmajor_layout_uri", &SOMASparseNDArray::colmajor_layout_uri)
+
+        .def(
+            "sample_joinids",
+            [](SOMASparseNDArray& array, size_t n, uint64_t seed) {
+                std::vector<int64_t> joinids;
+                {
+                    py::gil_scoped_release release;
+                    joinids = array.sample_joinids(n, seed);
+                }
+                return py::array_t<int64_t>(joinids.size(), joinids.data());
+            },
+            "n"_a,
+            "seed"_a = 0)
+
+        .def(
+            "read_sample",
+            [](SOMASparseNDArray& array, std::vector<int64_t> joinids) {
+                SampledRows rows;
+                {
+                    py::gil_scoped_release release;
+                    rows = array.read_sample(joinids);
+                }
+                return to_sampled_tables(rows);
+            },
+            "joinids"_a);
 }
 }  // namespace libtiledbsomacpp
@@ -376,6 +376,44 @@ def test_cascading_close(tmp_path: pathlib.Path):
     assert all(elem.closed for elem in all_elements)
 
 
+def test_open_members(tmp_path: pathlib.Path):
+    uri = tmp_path.as_uri()
+    with soma.Collection.create(uri) as outer:
+        dog = outer.add_new_collection("dog")
+        dog.add_new_sparse_ndarray("kabosu", type=pa.uint8(), shape=(10,))
+        dog.add_new_dense_ndarray("hachiko", type=pa.float64(), shape=(1, 2))
+        outer.add_new_collection("cat")
+        with create_and_populate_dataframe(os.path.join(uri, "louis")) as louis:
+            outer["louis"] = louis
+
+    with soma.Collection.open(uri) as reopened:
+        reopened._open_members(["dog/kabosu", "louis"])
+        contents = reopened._contents
+        assert contents["cat"].soma is None
+        dog = contents["dog"].soma
+        assert isinstance(dog, soma.Collection)
+        assert isinstance(dog._contents["kabosu"].soma, soma.SparseNDArray)
+        assert dog._contents["hachiko"].soma is None
+        louis = contents["louis"].soma
+        assert isinstance(louis, soma.DataFrame)
+        assert reopened["louis"] is louis
+        assert len(louis.read().concat()) == 5
+
+        # Opening everything keeps the members that are already open
+        reopened._open_members()
+        assert reopened["dog"] is dog
+        assert isinstance(reopened["cat"], soma.Collection)
+        assert isinstance(dog["hachiko"], soma.DenseNDArray)
+        all_elements = [dog, dog["kabosu"], dog["hachiko"], reopened["cat"], louis]
+        assert not any(elem.closed for elem in all_elements)
+    assert all(elem.closed for elem in all_elements)
+
+    # Write handles open their members on access only
+    with soma.Collection.open(uri, "w") as writer:
+        writer._open_members()
+        assert all(entry.soma is None for entry in writer._contents.values())
+
+
 # Helper tests
 
 
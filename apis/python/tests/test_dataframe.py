@@ -775,6 +775,73 @@ def test_read_indexing(tmp_path, io):
             assert table["A"].to_list() == io["A"]
 
 
+@pytest.mark.parametrize("value_filter", ["A > 95", "A > 1000", "B < 3 and A > 5"])
+def test_read_late_materialization(tmp_path, value_filter):
+    uri = tmp_path.as_posix()
+    schema = pa.schema(
+        [
+            ("soma_joinid", pa.int64()),
+            ("A", pa.int64()),
+            ("B", pa.float64()),
+            ("C", pa.large_string()),
+        ]
+    )
+    n = 100
+    with soma.DataFrame.create(uri, schema=schema) as sdf:
+        data = {
+            "soma_joinid": list(range(n)),
+            "A": list(range(n)),
+            "B": [float(i % 7) for i in range(n)],
+            "C": [f"row{i}" for i in range(n)],
+        }
+        sdf.write(pa.Table.from_pydict(data))
+
+    with soma.DataFrame.open(uri) as sdf:
+        expected = sdf.read(value_filter=value_filter).concat().to_pandas()
+
+    context = soma.SOMATileDBContext(
+        tiledb_config={"soma.read.late_materialization": "true"}
+    )
+    with soma.DataFrame.open(uri, context=context) as sdf:
+        for column_names in (None, ["C"], ["soma_joinid", "B", "C"]):
+            actual = (
+                sdf.read(value_filter=value_filter, column_names=column_names)
+                .concat()
+                .to_pandas()
+                .sort_values("C", ignore_index=True)
+            )
+            want = expected if column_names is None else expected[column_names]
+            want = want.sort_values("C", ignore_index=True)
+            assert actual[want.columns].equals(want)
+
+
+def test_read_result_cache(tmp_path):
+    uri = tmp_path.as_posix()
+    schema = pa.schema([("soma_joinid", pa.int64()), ("A", pa.int64())])
+    context = soma.SOMATileDBContext(
+        tiledb_config={"soma.read.result_cache_bytes": str(1 << 20)}
+    )
+
+    def write(offset):
+        data = {"soma_joinid": list(range(10)), "A": [offset + i for i in range(10)]}
+        with soma.DataFrame.open(uri, "w", context=context) as sdf:
+            sdf.write(pa.Table.from_pydict(data))
+
+    def read():
+        with soma.DataFrame.open(uri, context=context) as sdf:
+            table = sdf.read(coords=[[2, 3, 4]], value_filter="A > 2").concat()
+            return table["A"].to_pylist()
+
+    soma.DataFrame.create(uri, schema=schema, context=context).close()
+    write(0)
+    assert read() == [3, 4]
+    assert read() == [3, 4]
+
+    # Writes through the same context invalidate the cached reads
+    write(1)
+    assert read() == [3, 4, 5]
+
+
 def test_write_categorical_types(tmp_path):
     """
     Verify that write path accepts categoricals
@@ -1486,3 +1553,173 @@ def test_nullable(tmp_path):
     with soma.DataFrame.open(uri, "r") as sdf:
         df = sdf.read().concat().to_pandas()
         assert df.compare(data.to_pandas()).empty
+
+
+def test_category_index(tmp_path):
+    uri = (tmp_path / "exp").as_posix()
+    labels = pa.array(["B cell", "T cell", "NK cell"], pa.large_string())
+
+    def rows(begin, end):
+        codes = pa.array([i % 3 for i in range(begin, end)], pa.int32())
+        return pa.Table.from_pydict(
+            {
+                "soma_joinid": pa.array(range(begin, end), pa.int64()),
+                "cell_type": pa.DictionaryArray.from_arrays(codes, labels),
+                "score": pa.array(range(begin, end), pa.int32()),
+            }
+        )
+
+    schema = rows(0, 1).schema
+    with soma.Experiment.create(uri) as exp:
+        obs = exp.add_new_dataframe("obs", schema=schema)
+        obs.write(rows(0, 100))
+        assert obs.category_index_uri is None
+        with pytest.raises(soma.SOMAError):
+            obs.create_category_index(f"{uri}-index", ["score"])
+        obs.create_category_index(f"{uri}-index", ["cell_type"])
+        assert obs.category_index_uri == f"{uri}-index"
+        rna = exp.add_new_collection("ms").add_new_collection("RNA", soma.Measurement)
+        rna.add_new_dataframe("var", schema=pa.schema([("label", pa.large_string())]))
+
+    # The index must be created in write mode, and only once
+    with soma.DataFrame.open(f"{uri}/obs") as obs:
+        assert obs.category_index_uri == f"{uri}-index"
+        with pytest.raises(soma.SOMAError):
+            obs.create_category_index(f"{uri}-index2", ["cell_type"])
+
+    # Rows written later are added to the index
+    with soma.DataFrame.open(f"{uri}/obs", "w") as obs:
+        with pytest.raises(soma.SOMAError):
+            obs.create_category_index(f"{uri}-index2", ["cell_type"])
+        obs.write(rows(100, 250))
+
+    def expected(end, codes):
+        return [i for i in range(end) if i % 3 in codes]
+
+    with soma.Experiment.open(uri) as exp:
+        handle = exp._handle._handle
+        query = soma.pytiledbsoma.SOMAExperimentAxisQuery(
+            handle, "RNA", obs_categories={"cell_type": ["T cell"]}
+        )
+        assert query.obs_joinids().tolist() == expected(250, [1])
+
+        query = soma.pytiledbsoma.SOMAExperimentAxisQuery(
+            handle,
+            "RNA",
+            obs_ranges=[(0, 99)],
+            obs_categories={"cell_type": ["NK cell", "B cell", "unknown"]},
+        )
+        assert query.obs_joinids().tolist() == expected(100, [0, 2])
+
+        query = soma.pytiledbsoma.SOMAExperimentAxisQuery(
+            handle, "RNA", obs_categories={"cell_type": ["unknown"]}
+        )
+        assert query.n_obs == 0
+
+        # Indexed terms of a value filter resolve from the index, and the
+        # other terms remain a condition
+        value_filter = "cell_type in ['T cell', 'NK cell'] and score < 200"
+        kwargs = soma._query._native_axis_query(
+            exp.obs, soma.AxisQuery(value_filter=value_filter), "obs"
+        )
+        assert kwargs["obs_categories"] == {"cell_type": ["T cell", "NK cell"]}
+        assert "obs_query_condition" in kwargs
+        with exp.axis_query(
+            "RNA", obs_query=soma.AxisQuery(value_filter=value_filter)
+        ) as axis_query:
+            assert axis_query.obs_joinids().to_pylist() == expected(200, [1, 2])
+
+        value_filter = "cell_type == 'B cell' and attr('cell_type') == 'B cell'"
+        kwargs = soma._query._native_axis_query(
+            exp.obs, soma.AxisQuery(value_filter=value_filter), "obs"
+        )
+        assert kwargs == {"obs_categories": {"cell_type": ["B cell"]}}
+        with exp.axis_query(
+            "RNA", obs_query=soma.AxisQuery(value_filter=value_filter)
+        ) as axis_query:
+            assert axis_query.obs_joinids().to_pylist() == expected(250, [0])
+
+
+def test_key_filter_index(tmp_path):
+    uri = tmp_path.as_posix()
+    index_uri = f"{uri}-index"
+
+    def rows(begin, end):
+        return pa.Table.from_pydict(
+            {
+                "soma_joinid": pa.array(range(begin, end), pa.int64()),
+                "obs_id": pa.array(
+                    [f"cell-{i}" for i in range(begin, end)], pa.large_string()
+                ),
+                "n": pa.array(range(begin, end), pa.int64()),
+            }
+        )
+
+    schema = pa.schema([("obs_id", pa.large_string()), ("n", pa.int64())])
+    with soma.DataFrame.create(
+        uri, schema=schema, index_column_names=["obs_id"]
+    ) as sdf:
+        sdf.write(rows(0, 100))
+        assert sdf.key_filter_index_uri is None
+        with pytest.raises(soma.SOMAError):
+            sdf.create_key_filter_index(index_uri, ["n"])
+        with pytest.raises(soma.SOMAError):
+            sdf.create_key_filter_index(index_uri, ["obs_id"], fpp=0)
+        sdf.create_key_filter_index(index_uri, ["obs_id"], fpp=0.001)
+        assert sdf.key_filter_index_uri == index_uri
+
+    # Point lookups return the present keys only
+    keys = [f"cell-{10 * i}" for i in range(10)] + [f"absent-{i}" for i in range(100)]
+    with soma.DataFrame.open(uri) as sdf:
+        assert sdf.key_filter_index_uri == index_uri
+        with pytest.raises(soma.SOMAError):
+            sdf.create_key_filter_index(f"{index_uri}2", ["obs_id"])
+        tbl = sdf.read(coords=[keys]).concat()
+        assert sorted(tbl["n"].to_pylist()) == list(range(0, 100, 10))
+        assert len(sdf.read(coords=[keys[10:]]).concat()) == 0
+
+    # Each write adds a filter of its keys
+    with soma.DataFrame.open(uri, "w") as sdf:
+        sdf.write(rows(100, 150))
+    with soma.DataFrame.open(uri) as sdf:
+        tbl = sdf.read(coords=[["cell-120", "cell-99", "absent-0"]]).concat()
+        assert sorted(tbl["n"].to_pylist()) == [99, 120]
+
+
+def test_sample_joinids(tmp_path):
+    uri = tmp_path.as_posix()
+    joinids = [*range(0, 40), *range(100, 160)]
+    table = pa.Table.from_pydict(
+        {
+            "soma_joinid": pa.array(joinids, pa.int64()),
+            "group": pa.array(
+                ["a" if j < 100 else "b" for j in joinids], pa.large_string()
+            ),
+            "n": pa.array([j * 2 for j in joinids], pa.int64()),
+        }
+    )
+    with soma.DataFrame.create(uri, schema=table.schema) as sdf:
+        sdf.write(table)
+
+    with soma.DataFrame.open(uri) as sdf:
+        sample = sdf.sample_joinids(30, seed=7)
+        assert len(set(sample.tolist())) == 30
+        assert set(sample.tolist()) <= set(joinids)
+        assert sdf.sample_joinids(30, seed=7).tolist() == sample.tolist()
+
+        sample = sdf.sample_joinids(10, seed=7, stratify_by="group")
+        assert sorted(j < 100 for j in sample) == [False] * 6 + [True] * 4
+
+        # Rows come back in the order asked for, skipping absent joinids
+        tbl = sdf.read_sample([150, 3, 70, 101, 4], column_names=["n"])
+        assert tbl.column_names == ["n", "soma_joinid"]
+        assert tbl["soma_joinid"].to_pylist() == [150, 3, 101, 4]
+        assert tbl["n"].to_pylist() == [300, 6, 202, 8]
+
+        tbl = sdf.read_sample([70, 80])
+        assert tbl.num_rows == 0
+        assert tbl.schema == sdf.schema
+
+    with soma.DataFrame.open(uri, "w") as sdf:
+        with pytest.raises(ValueError):
+            sdf.sample_joinids(5)
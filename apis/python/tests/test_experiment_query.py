@@ -865,6 +865,244 @@ def test_experiment_query_mp_disjoint_arrow_coords(soma_experiment):
             assert query.obs_joinids() == ids
 
 
+@pytest.mark.parametrize("n_obs,n_vars", [(1001, 99)])
+def test_experiment_query_native(soma_experiment):
+    """
+    Verify that joinid-based queries are resolved by the native engine and
+    match the selection.
+    """
+    obs_ids = [i for i in range(3, 73) if i not in (5, 15, 25)]
+    var_ids = [1, 5, 7, 80]
+    with soma_experiment.axis_query(
+        "RNA",
+        obs_query=soma.AxisQuery(
+            coords=(slice(3, 72),), value_filter="label not in ['5', '15', '25']"
+        ),
+        var_query=soma.AxisQuery(coords=(np.array(var_ids),)),
+    ) as query:
+        assert query._native() is not None
+        assert query.obs_joinids().to_pylist() == obs_ids
+        assert query.var_joinids().to_pylist() == var_ids
+        assert query.n_obs == len(obs_ids)
+        assert query.n_vars == len(var_ids)
+
+        X = query.X("raw").tables().concat()
+        assert set(X["soma_dim_0"].to_pylist()) <= set(obs_ids)
+        assert set(X["soma_dim_1"].to_pylist()) <= set(var_ids)
+        full = soma_experiment.ms["RNA"].X["raw"].read().tables().concat().to_pandas()
+        expected = full[full.soma_dim_0.isin(obs_ids) & full.soma_dim_1.isin(var_ids)]
+        assert len(X) == len(expected)
+
+        adata = query.to_anndata("raw")
+        assert adata.n_obs == len(obs_ids)
+        assert adata.n_vars == len(var_ids)
+
+        obs = query.obs(column_names=["soma_joinid", "label"]).concat()
+        assert obs["soma_joinid"].to_pylist() == obs_ids
+        assert obs["label"].to_pylist() == [str(i) for i in obs_ids]
+        var = query.var().concat()
+        assert var["soma_joinid"].to_pylist() == var_ids
+
+    # An open-ended slice is bounded by the written joinids
+    all_obs = soma_experiment.obs.read(column_names=["soma_joinid"]).concat()
+    with soma_experiment.axis_query(
+        "RNA", obs_query=soma.AxisQuery(coords=(slice(60, None),))
+    ) as query:
+        assert query._native() is not None
+        expected_obs = [i for i in all_obs["soma_joinid"].to_pylist() if i >= 60]
+        assert query.obs_joinids().to_pylist() == expected_obs
+        assert query.obs().concat()["soma_joinid"].to_pylist() == expected_obs
+    with soma_experiment.axis_query(
+        "RNA", obs_query=soma.AxisQuery(coords=(slice(10**9, None),))
+    ) as query:
+        assert query._native() is not None
+        assert query.n_obs == 0
+        assert len(query.obs().concat()) == 0
+
+    # Selections the native engine cannot express are left to somacore
+    with soma_experiment.axis_query(
+        "RNA", obs_query=soma.AxisQuery(coords=(slice(0, 10, 2),))
+    ) as query:
+        assert query._native() is None
+
+
+def _dense_X(query, layer_name: str) -> np.ndarray:
+    """Reads the selected cells of an X layer as a dense matrix indexed by
+    position in the query joinids."""
+    X = query.X(layer_name).tables().concat()
+    indexer = getattr(query, "indexer", query._indexer)
+    rows = indexer.by_obs(X["soma_dim_0"])
+    cols = indexer.by_var(X["soma_dim_1"])
+    dense = np.zeros((query.n_obs, query.n_vars))
+    dense[rows, cols] = X["soma_data"].to_numpy()
+    return dense
+
+
+@pytest.mark.parametrize("n_obs,n_vars", [(1001, 99)])
+@pytest.mark.parametrize(
+    "obs_coords", [slice(3, 500), slice(0, 1000, 3)], ids=["native", "fallback"]
+)
+def test_experiment_query_X_moments(soma_experiment, obs_coords):
+    with soma_experiment.axis_query(
+        "RNA",
+        obs_query=soma.AxisQuery(coords=(obs_coords,)),
+        var_query=soma.AxisQuery(value_filter="soma_joinid > 10"),
+    ) as query:
+        dense = _dense_X(query, "raw")
+        moments = query.X_moments("raw")
+        assert set(moments) == {
+            "obs_nnz",
+            "obs_mean",
+            "obs_variance",
+            "var_nnz",
+            "var_mean",
+            "var_variance",
+        }
+        assert np.array_equal(moments["obs_nnz"], np.count_nonzero(dense, axis=1))
+        assert np.array_equal(moments["var_nnz"], np.count_nonzero(dense, axis=0))
+        assert np.allclose(moments["obs_mean"], dense.mean(axis=1))
+        assert np.allclose(moments["var_mean"], dense.mean(axis=0))
+        assert np.allclose(moments["obs_variance"], dense.var(axis=1, ddof=1))
+        assert np.allclose(moments["var_variance"], dense.var(axis=0, ddof=1))
+
+        population = query.X_moments("raw", ddof=0)
+        assert np.allclose(population["var_variance"], dense.var(axis=0))
+
+        with pytest.raises(Exception):
+            query.X_moments("no-such-layer")
+
+
+@pytest.mark.parametrize("n_obs,n_vars", [(1001, 99)])
+@pytest.mark.parametrize(
+    "obs_coords", [slice(3, 500), slice(0, 1000, 3)], ids=["native", "fallback"]
+)
+def test_experiment_query_X_matmul(soma_experiment, obs_coords):
+    with soma_experiment.axis_query(
+        "RNA",
+        obs_query=soma.AxisQuery(coords=(obs_coords,)),
+        var_query=soma.AxisQuery(coords=(np.arange(0, 99, 2),)),
+    ) as query:
+        dense = _dense_X(query, "raw")
+        rhs = np.random.default_rng(0).standard_normal((query.n_vars, 7))
+        product = query.X_matmul("raw", rhs)
+        assert product.shape == (query.n_obs, 7)
+        assert np.allclose(product, dense @ rhs)
+
+        # Integer input is converted
+        ones = np.ones((query.n_vars, 1), dtype=np.int32)
+        assert np.allclose(query.X_matmul("raw", ones)[:, 0], dense.sum(axis=1))
+
+        with pytest.raises(ValueError):
+            query.X_matmul("raw", np.ones(query.n_vars))
+        with pytest.raises(ValueError):
+            query.X_matmul("raw", np.ones((query.n_vars + 1, 2)))
+
+
+@pytest.mark.parametrize("n_obs,n_vars", [(1001, 99)])
+def test_experiment_query_X_loader(soma_experiment):
+    with soma_experiment.axis_query(
+        "RNA",
+        obs_query=soma.AxisQuery(coords=(slice(100, 899),)),
+        var_query=soma.AxisQuery(coords=(np.arange(0, 99, 3),)),
+    ) as query:
+        dense = _dense_X(query, "raw")
+        obs_joinids = query.obs_joinids().to_numpy()
+
+        loader = query.X_loader("raw", batch_size=64, chunk_size=16, seed=1)
+        assert loader.num_rows == query.n_obs
+        assert loader.epoch == 0
+        batches = list(loader)
+        assert all(X.shape == (len(ids), query.n_vars) for ids, X in batches)
+        assert all(len(ids) == 64 for ids, _ in batches[:-1])
+        joinids = np.concatenate([ids for ids, _ in batches])
+        assert np.array_equal(np.sort(joinids), obs_joinids)
+        assert not np.array_equal(joinids, obs_joinids)
+        rows = sparse.vstack([X for _, X in batches]).toarray()
+        assert np.allclose(rows, dense[np.searchsorted(obs_joinids, joinids)])
+
+        # The epoch is exhausted until the loader is restarted
+        assert list(loader) == []
+        loader.set_epoch(1)
+        assert loader.epoch == 1
+        epoch1 = np.concatenate([ids for ids, _ in loader])
+        assert np.array_equal(np.sort(epoch1), obs_joinids)
+        assert not np.array_equal(epoch1, joinids)
+
+        # Unshuffled dense minibatches, split into disjoint shards
+        shards = [
+            list(
+                query.X_loader(
+                    "raw",
+                    batch_size=50,
+                    shuffle=False,
+                    shard=shard,
+                    num_shards=2,
+                    drop_last=True,
+                    dense=True,
+                )
+            )
+            for shard in range(2)
+        ]
+        for batches in shards:
+            assert all(X.shape == (50, query.n_vars) for _, X in batches)
+            for ids, X in batches:
+                assert isinstance(X, np.ndarray)
+                assert np.array_equal(ids, np.sort(ids))
+                assert np.allclose(X, dense[np.searchsorted(obs_joinids, ids)])
+        ids0, ids1 = (np.concatenate([ids for ids, _ in batches]) for batches in shards)
+        assert not set(ids0) & set(ids1)
+
+
+@pytest.mark.parametrize(
+    "n_obs,n_vars,obsm_layer_names", [(1001, 99, ["foo"])], ids=["1001-99-foo"]
+)
+@pytest.mark.parametrize("metric", ["l2", "cosine"])
+def test_experiment_query_obsm_knn(soma_experiment, metric):
+    obsm = soma_experiment.ms["RNA"].obsm["foo"]
+    embedding = obsm.read().coos().concat().to_scipy().toarray()
+    queries = np.random.default_rng(0).random((5, N_FEATURES), dtype=np.float32)
+
+    def distance(queries, rows):
+        if metric == "l2":
+            return np.linalg.norm(queries[:, None, :] - rows[None, :, :], axis=2)
+        # The zero vector has zero similarity to every vector
+        norms = np.linalg.norm(queries, axis=1)[:, None] * np.linalg.norm(rows, axis=1)
+        similarity = queries @ rows.T
+        cosine = np.zeros_like(similarity)
+        np.divide(similarity, norms, out=cosine, where=norms > 0)
+        return 1 - cosine
+
+    with soma_experiment.axis_query(
+        "RNA", obs_query=soma.AxisQuery(coords=(slice(200, 699),))
+    ) as query:
+        candidates = query.obs_joinids().to_numpy()
+        joinids, distances = query.obsm_knn("foo", queries, 10, metric=metric)
+        assert joinids.shape == distances.shape == (5, 10)
+        assert np.isin(joinids, candidates).all()
+        assert (np.diff(distances, axis=1) >= 0).all()
+
+        expected = np.sort(distance(queries, embedding[candidates]), axis=1)
+        assert np.allclose(distances, expected[:, :10], rtol=1e-4, atol=1e-5)
+        for q in range(5):
+            found = distance(queries[q : q + 1], embedding[joinids[q]])[0]
+            assert np.allclose(distances[q], found, rtol=1e-4, atol=1e-5)
+
+        # Too few candidates are padded
+        with soma_experiment.axis_query(
+            "RNA", obs_query=soma.AxisQuery(coords=([3, 7],))
+        ) as small:
+            joinids, distances = small.obsm_knn("foo", queries, 4, metric=metric)
+            assert (joinids[:, 2:] == -1).all()
+            assert np.isinf(distances[:, 2:]).all()
+
+        with pytest.raises(ValueError):
+            query.obsm_knn("foo", queries, 10, metric="manhattan")
+        with pytest.raises(ValueError):
+            query.obsm_knn("foo", queries[0], 10)
+        with pytest.raises(Exception):
+            query.obsm_knn("foo", queries[:, :3], 10)
+
+
 """
 Fixture support & utility functions below.
 """
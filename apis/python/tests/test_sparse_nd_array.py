@@ -1,7 +1,9 @@
 from __future__ import annotations
 
 import itertools
+import multiprocessing
 import operator
+import os
 import pathlib
 import sys
 from concurrent import futures
@@ -1631,6 +1633,221 @@ def test_blockwise_scipy_iter_result_order(a_random_sparse_nd_array: str) -> Non
                         assert isinstance(sp, sparse.coo_matrix)
 
 
+def test_native_read_prefetcher(tmp_path: pathlib.Path) -> None:
+    """
+    The native read iterator yields every cell across batches, reindexing
+    coordinates on its read thread.
+    """
+    uri = tmp_path.as_posix()
+    context = SOMATileDBContext()
+    d0, d1 = np.meshgrid(np.arange(20), np.arange(10), indexing="ij")
+    with soma.SparseNDArray.create(
+        uri, type=pa.float64(), shape=(20, 10), context=context
+    ) as A:
+        A.write(
+            pa.Table.from_pydict(
+                {
+                    "soma_dim_0": d0.ravel(),
+                    "soma_dim_1": d1.ravel(),
+                    "soma_data": (d0 * 10 + d1).ravel().astype(np.float64),
+                }
+            )
+        )
+
+    # A small read buffer splits the read into several batches
+    sr = soma.pytiledbsoma.SOMAArray(
+        uri, platform_config={"soma.init_buffer_bytes": "256"}
+    )
+    indexer = soma.IntIndexer(np.arange(9, -1, -1), context=context)
+    tables = list(
+        soma.pytiledbsoma.ReadPrefetcher(
+            sr, queue_depth=1, reindexers={"soma_dim_1": indexer._reindexer}
+        )
+    )
+    assert len(tables) > 1
+
+    tbl = pa.concat_tables(tables)
+    assert len(tbl) == 200
+    i = tbl["soma_dim_0"].to_numpy()
+    j = tbl["soma_dim_1"].to_numpy()
+    assert np.array_equal(tbl["soma_data"].to_numpy(), i * 10 + (9 - j))
+
+
+def test_k_hop(tmp_path: pathlib.Path) -> None:
+    """
+    k-hop expansion follows edges from soma_dim_0 to soma_dim_1 and extracts
+    the induced subgraph.
+    """
+    uri = tmp_path.as_posix()
+    # A chain 0 -> 1 -> ... -> 9, with a shortcut 0 -> 5 and a back edge 3 -> 0
+    rows = np.array([*range(9), 0, 3])
+    cols = np.array([*range(1, 10), 5, 0])
+    data = np.arange(1, len(rows) + 1, dtype=np.float32)
+    with soma.SparseNDArray.create(uri, type=pa.float32(), shape=(20, 20)) as A:
+        A.write(
+            pa.Table.from_pydict(
+                {"soma_dim_0": rows, "soma_dim_1": cols, "soma_data": data}
+            )
+        )
+    graph = sparse.csr_matrix((data, (rows, cols)), shape=(20, 20)).toarray()
+
+    with soma.SparseNDArray.open(uri) as A:
+        nbhd = A.k_hop([0], 2)
+        assert nbhd.joinids.tolist() == [0, 1, 2, 5, 6]
+        assert nbhd.hops.tolist() == [0, 1, 2, 1, 2]
+        assert isinstance(nbhd.adjacency, sparse.csr_matrix)
+        assert np.array_equal(
+            nbhd.adjacency.toarray(), graph[np.ix_(nbhd.joinids, nbhd.joinids)]
+        )
+
+        nbhd = A.k_hop(np.array([3, 8]), 1, subgraph=False)
+        assert nbhd.joinids.tolist() == [0, 3, 4, 8, 9]
+        assert nbhd.hops.tolist() == [1, 0, 1, 0, 1]
+        assert nbhd.adjacency is None
+
+        # Zero hops keep the seeds only
+        assert A.k_hop([4], 0).joinids.tolist() == [4]
+
+        nodes = [0, 3, 4, 5, 9]
+        sub = A.induced_subgraph(nodes)
+        assert sub.joinids.tolist() == nodes
+        assert not sub.hops.any()
+        assert np.array_equal(sub.adjacency.toarray(), graph[np.ix_(nodes, nodes)])
+
+    with soma.SparseNDArray.open(uri, "w") as A:
+        with pytest.raises(ValueError):
+            A.k_hop([0], 1)
+
+
+def _read_shared_batch(name: str) -> Dict[str, List[Any]]:
+    return soma.open_shared_batch(name).to_pydict()
+
+
+@pytest.mark.skipif(sys.platform == "win32", reason="POSIX shared memory")
+def test_shared_batches(tmp_path: pathlib.Path) -> None:
+    """
+    Read batches handed to worker processes through shared memory hold the
+    cells of the read.
+    """
+    uri = tmp_path.as_posix()
+    d0, d1 = np.meshgrid(np.arange(20), np.arange(10), indexing="ij")
+    with soma.SparseNDArray.create(uri, type=pa.float64(), shape=(20, 10)) as A:
+        A.write(
+            pa.Table.from_pydict(
+                {
+                    "soma_dim_0": d0.ravel(),
+                    "soma_dim_1": d1.ravel(),
+                    "soma_data": (d0 * 10 + d1).ravel().astype(np.float64),
+                }
+            )
+        )
+
+    prefix = f"/soma-test-shared-batches-{os.getpid()}"
+    with soma.SparseNDArray.open(uri) as A:
+        read = A.read(
+            (slice(5, 14),), platform_config={"soma.init_buffer_bytes": "256"}
+        )
+        names = list(read.shared_batches(prefix))
+    # A small read buffer splits the read into several batches
+    assert len(names) > 1
+    assert names == [f"{prefix}-{i}" for i in range(len(names))]
+
+    with futures.ProcessPoolExecutor(
+        max_workers=2, mp_context=multiprocessing.get_context("spawn")
+    ) as pool:
+        batches = list(pool.map(_read_shared_batch, names))
+    tbl = pa.concat_tables(pa.Table.from_pydict(batch) for batch in batches)
+    assert len(tbl) == 100
+    i = tbl["soma_dim_0"].to_numpy()
+    j = tbl["soma_dim_1"].to_numpy()
+    assert ((i >= 5) & (i <= 14)).all()
+    assert np.array_equal(tbl["soma_data"].to_numpy(), i * 10 + j)
+
+    # The workers unlinked the segments
+    with pytest.raises(soma.SOMAError):
+        soma.open_shared_batch(names[0])
+
+    # A segment may be mapped without unlinking it
+    with soma.SparseNDArray.open(uri) as A:
+        (name,) = A.read((0,)).shared_batches(prefix)
+    batch = soma.open_shared_batch(name, unlink=False)
+    assert batch["soma_data"].to_pylist() == list(range(10))
+    del batch
+    assert soma.open_shared_batch(name)["soma_dim_1"].to_pylist() == list(range(10))
+
+
+@pytest.mark.parametrize("fmt", ["csr", "csc"])
+@pytest.mark.parametrize("dtype", [np.float32, np.float64, np.int32, np.uint16])
+@pytest.mark.parametrize("presorted", [True, False])
+def test_native_compress_coo(fmt: str, dtype: Any, presorted: bool) -> None:
+    """
+    Native COO to CSR/CSC assembly matches scipy, with or without sorted input
+    and across chunk boundaries.
+    """
+    context = soma.SOMATileDBContext()
+    rng = np.random.default_rng(0)
+    shape = (97, 53)
+    coo = sparse.random(*shape, density=0.2, format="coo", random_state=rng)
+    coo.data = (coo.data * 100).astype(dtype)
+    cls = sparse.csr_matrix if fmt == "csr" else sparse.csc_matrix
+    expected = cls(coo)
+    expected.sort_indices()
+
+    order = (
+        np.lexsort((coo.col, coo.row) if fmt == "csr" else (coo.row, coo.col))
+        if presorted
+        else rng.permutation(coo.nnz)
+    )
+    split = [0, 11, coo.nnz // 2, coo.nnz]
+    chunks = [order[b:e] for b, e in zip(split[:-1], split[1:])]
+
+    data, indices, indptr = soma.pytiledbsoma.compress_coo(
+        context.native_context,
+        getattr(soma.pytiledbsoma.CompressedFormat, fmt),
+        shape,
+        [coo.row[c].astype(np.int64) for c in chunks],
+        [coo.col[c].astype(np.int64) for c in chunks],
+        [coo.data[c] for c in chunks],
+    )
+    assert data.dtype == dtype
+    assert np.array_equal(indptr, expected.indptr)
+    assert np.array_equal(indices, expected.indices)
+    assert np.array_equal(data, expected.data)
+
+    with pytest.raises(soma.SOMAError):
+        soma.pytiledbsoma.compress_coo(
+            context.native_context,
+            soma.pytiledbsoma.CompressedFormat.csr,
+            (1, 1),
+            [np.array([3], dtype=np.int64)],
+            [np.array([0], dtype=np.int64)],
+            [np.array([1.0])],
+        )
+
+
+
+@pytest.mark.parametrize("dtype", [">f4", "float64", np.dtype("q"), np.dtype(">u2")])
+def test_native_compress_coo_equal_dtypes(dtype: Any) -> None:
+    """
+    Value dtypes equal to a supported type, but built from a string, with a
+    non-native byte order or as a platform alias, are accepted.
+    """
+    context = soma.SOMATileDBContext()
+    values = np.array([3, 1, 2], dtype=dtype)
+    data, indices, indptr = soma.pytiledbsoma.compress_coo(
+        context.native_context,
+        soma.pytiledbsoma.CompressedFormat.csr,
+        (2, 3),
+        [np.array([1, 0, 1], dtype=np.int64)],
+        [np.array([2, 1, 0], dtype=np.int64)],
+        [values],
+    )
+    assert data.dtype == np.dtype(dtype).newbyteorder("=")
+    assert data.dtype.isnative
+    assert np.array_equal(data, [1, 2, 3])
+    assert np.array_equal(indices, [1, 0, 2])
+    assert np.array_equal(indptr, [0, 1, 3])
+
 @pytest.mark.parametrize("density,shape", [(0.001, (9799, 1530))])
 @pytest.mark.parametrize(
     "coords,expected_indices",
@@ -1832,3 +2049,29 @@ def test_global_writes(tmp_path):
             )
         assert "The write parameter now takes in TileDBWriteOptions instead "
         "of TileDBCreateOptions" == warning[0].message
+
+
+def test_read_sample(tmp_path):
+    uri = tmp_path.as_posix()
+    coo = sparse.random(200, 10, density=0.3, format="coo", random_state=1)
+    with soma.SparseNDArray.create(uri, type=pa.float64(), shape=(500, 10)) as A:
+        A.write(coo)
+
+    with soma.SparseNDArray.open(uri) as A:
+        rows = sorted(set(coo.row.tolist()))
+        sample = A.sample_joinids(50, seed=3)
+        assert len(set(sample.tolist())) == 50
+        assert rows[0] <= sample.min() and sample.max() <= rows[-1]
+
+        # Cells are grouped by row in the order asked for
+        joinids = [120, 7, 450, 8, 63]
+        tbl = A.read_sample(joinids)
+        dense = coo.toarray()
+        expected = [j for j in joinids if j < 200 for _ in dense[j].nonzero()[0]]
+        assert tbl["soma_dim_0"].to_pylist() == expected
+        for j in joinids[:2]:
+            cells = tbl.filter(tbl["soma_dim_0"].to_numpy() == j)
+            cols = cells["soma_dim_1"].to_numpy()
+            assert np.array_equal(cells["soma_data"].to_numpy(), dense[j, cols])
+
+        assert A.read_sample([400, 499]).num_rows == 0
@@ -29,8 +29,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // writeArrayFromArrow
-void writeArrayFromArrow(const std::string& uri, naxpArray naap, naxpSchema nasp, const std::string arraytype, Rcpp::Nullable<Rcpp::CharacterVector> config);
-RcppExport SEXP _tiledbsoma_writeArrayFromArrow(SEXP uriSEXP, SEXP naapSEXP, SEXP naspSEXP, SEXP arraytypeSEXP, SEXP configSEXP) {
+void writeArrayFromArrow(const std::string& uri, naxpArray naap, naxpSchema nasp, const std::string arraytype, Rcpp::Nullable<Rcpp::CharacterVector> config, Rcpp::Nullable<Rcpp::Datetime> timestamp_end);
+RcppExport SEXP _tiledbsoma_writeArrayFromArrow(SEXP uriSEXP, SEXP naapSEXP, SEXP naspSEXP, SEXP arraytypeSEXP, SEXP configSEXP, SEXP timestamp_endSEXP) {
 BEGIN_RCPP
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< const std::string& >::type uri(uriSEXP);
@@ -38,41 +38,72 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< naxpSchema >::type nasp(naspSEXP);
     Rcpp::traits::input_parameter< const std::string >::type arraytype(arraytypeSEXP);
     Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::CharacterVector> >::type config(configSEXP);
-    writeArrayFromArrow(uri, naap, nasp, arraytype, config);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::Datetime> >::type timestamp_end(timestamp_endSEXP);
+    writeArrayFromArrow(uri, naap, nasp, arraytype, config, timestamp_end);
     return R_NilValue;
 END_RCPP
 }
+// soma_context_create
+Rcpp::XPtr<somactx_wrap_t> soma_context_create(Rcpp::CharacterVector config);
+RcppExport SEXP _tiledbsoma_soma_context_create(SEXP configSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::CharacterVector >::type config(configSEXP);
+    rcpp_result_gen = Rcpp::wrap(soma_context_create(config));
+    return rcpp_result_gen;
+END_RCPP
+}
+// axis_query_joinids
+Rcpp::List axis_query_joinids(const std::string& uri, const std::string& measurement_name, Rcpp::XPtr<somactx_wrap_t> somactx, Rcpp::Nullable<Rcpp::NumericVector> obs_coords, Rcpp::Nullable<Rcpp::XPtr<tiledb::QueryCondition>> obs_qc, Rcpp::Nullable<Rcpp::NumericVector> var_coords, Rcpp::Nullable<Rcpp::XPtr<tiledb::QueryCondition>> var_qc, Rcpp::Nullable<Rcpp::Datetime> timestamp_end);
+RcppExport SEXP _tiledbsoma_axis_query_joinids(SEXP uriSEXP, SEXP measurement_nameSEXP, SEXP somactxSEXP, SEXP obs_coordsSEXP, SEXP obs_qcSEXP, SEXP var_coordsSEXP, SEXP var_qcSEXP, SEXP timestamp_endSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type uri(uriSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type measurement_name(measurement_nameSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<somactx_wrap_t> >::type somactx(somactxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type obs_coords(obs_coordsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::XPtr<tiledb::QueryCondition>> >::type obs_qc(obs_qcSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type var_coords(var_coordsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::XPtr<tiledb::QueryCondition>> >::type var_qc(var_qcSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::Datetime> >::type timestamp_end(timestamp_endSEXP);
+    rcpp_result_gen = Rcpp::wrap(axis_query_joinids(uri, measurement_name, somactx, obs_coords, obs_qc, var_coords, var_qc, timestamp_end));
+    return rcpp_result_gen;
+END_RCPP
+}
 // reindex_create
-Rcpp::XPtr<tdbs::IntIndexer> reindex_create();
-RcppExport SEXP _tiledbsoma_reindex_create() {
+Rcpp::XPtr<tdbs::IntIndexer> reindex_create(SEXP somactx);
+RcppExport SEXP _tiledbsoma_reindex_create(SEXP somactxSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    rcpp_result_gen = Rcpp::wrap(reindex_create());
+    Rcpp::traits::input_parameter< SEXP >::type somactx(somactxSEXP);
+    rcpp_result_gen = Rcpp::wrap(reindex_create(somactx));
     return rcpp_result_gen;
 END_RCPP
 }
 // reindex_map
-Rcpp::XPtr<tdbs::IntIndexer> reindex_map(Rcpp::XPtr<tdbs::IntIndexer> idx, const Rcpp::NumericVector nvec);
-RcppExport SEXP _tiledbsoma_reindex_map(SEXP idxSEXP, SEXP nvecSEXP) {
+Rcpp::XPtr<tdbs::IntIndexer> reindex_map(Rcpp::XPtr<tdbs::IntIndexer> idx, SEXP keys);
+RcppExport SEXP _tiledbsoma_reindex_map(SEXP idxSEXP, SEXP keysSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::XPtr<tdbs::IntIndexer> >::type idx(idxSEXP);
-    Rcpp::traits::input_parameter< const Rcpp::NumericVector >::type nvec(nvecSEXP);
-    rcpp_result_gen = Rcpp::wrap(reindex_map(idx, nvec));
+    Rcpp::traits::input_parameter< SEXP >::type keys(keysSEXP);
+    rcpp_result_gen = Rcpp::wrap(reindex_map(idx, keys));
     return rcpp_result_gen;
 END_RCPP
 }
 // reindex_lookup
-Rcpp::NumericVector reindex_lookup(Rcpp::XPtr<tdbs::IntIndexer> idx, const Rcpp::NumericVector kvec);
-RcppExport SEXP _tiledbsoma_reindex_lookup(SEXP idxSEXP, SEXP kvecSEXP) {
+Rcpp::NumericVector reindex_lookup(Rcpp::XPtr<tdbs::IntIndexer> idx, SEXP keys);
+RcppExport SEXP _tiledbsoma_reindex_lookup(SEXP idxSEXP, SEXP keysSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::XPtr<tdbs::IntIndexer> >::type idx(idxSEXP);
-    Rcpp::traits::input_parameter< const Rcpp::NumericVector >::type kvec(kvecSEXP);
-    rcpp_result_gen = Rcpp::wrap(reindex_lookup(idx, kvec));
+    Rcpp::traits::input_parameter< SEXP >::type keys(keysSEXP);
+    rcpp_result_gen = Rcpp::wrap(reindex_lookup(idx, keys));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -215,6 +246,18 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// sr_stream
+SEXP sr_stream(Rcpp::XPtr<tdbs::SOMAArray> sr, int queue_depth);
+RcppExport SEXP _tiledbsoma_sr_stream(SEXP srSEXP, SEXP queue_depthSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<tdbs::SOMAArray> >::type sr(srSEXP);
+    Rcpp::traits::input_parameter< int >::type queue_depth(queue_depthSEXP);
+    rcpp_result_gen = Rcpp::wrap(sr_stream(sr, queue_depth));
+    return rcpp_result_gen;
+END_RCPP
+}
 // sr_reset
 void sr_reset(Rcpp::XPtr<tdbs::SOMAArray> sr);
 RcppExport SEXP _tiledbsoma_sr_reset(SEXP srSEXP) {
@@ -306,11 +349,61 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// sample_joinids
+Rcpp::NumericVector sample_joinids(const std::string& uri, const std::string& soma_type, Rcpp::XPtr<somactx_wrap_t> somactx, double n, double seed, Rcpp::Nullable<Rcpp::CharacterVector> stratify_by, Rcpp::Nullable<Rcpp::Datetime> timestamp_end);
+RcppExport SEXP _tiledbsoma_sample_joinids(SEXP uriSEXP, SEXP soma_typeSEXP, SEXP somactxSEXP, SEXP nSEXP, SEXP seedSEXP, SEXP stratify_bySEXP, SEXP timestamp_endSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type uri(uriSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type soma_type(soma_typeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<somactx_wrap_t> >::type somactx(somactxSEXP);
+    Rcpp::traits::input_parameter< double >::type n(nSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::CharacterVector> >::type stratify_by(stratify_bySEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::Datetime> >::type timestamp_end(timestamp_endSEXP);
+    rcpp_result_gen = Rcpp::wrap(sample_joinids(uri, soma_type, somactx, n, seed, stratify_by, timestamp_end));
+    return rcpp_result_gen;
+END_RCPP
+}
+// read_sample
+Rcpp::List read_sample(const std::string& uri, const std::string& soma_type, Rcpp::XPtr<somactx_wrap_t> somactx, Rcpp::NumericVector joinids, Rcpp::Nullable<Rcpp::CharacterVector> colnames, Rcpp::Nullable<Rcpp::Datetime> timestamp_end);
+RcppExport SEXP _tiledbsoma_read_sample(SEXP uriSEXP, SEXP soma_typeSEXP, SEXP somactxSEXP, SEXP joinidsSEXP, SEXP colnamesSEXP, SEXP timestamp_endSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type uri(uriSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type soma_type(soma_typeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<somactx_wrap_t> >::type somactx(somactxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type joinids(joinidsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::CharacterVector> >::type colnames(colnamesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::Datetime> >::type timestamp_end(timestamp_endSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_sample(uri, soma_type, somactx, joinids, colnames, timestamp_end));
+    return rcpp_result_gen;
+END_RCPP
+}
+// sr_sparse_matrix
+Rcpp::List sr_sparse_matrix(Rcpp::XPtr<tdbs::SOMAArray> sr, Rcpp::NumericVector shape, const std::string& repr, Rcpp::Nullable<Rcpp::NumericVector> row_joinids, Rcpp::Nullable<Rcpp::NumericVector> col_joinids);
+RcppExport SEXP _tiledbsoma_sr_sparse_matrix(SEXP srSEXP, SEXP shapeSEXP, SEXP reprSEXP, SEXP row_joinidsSEXP, SEXP col_joinidsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<tdbs::SOMAArray> >::type sr(srSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type shape(shapeSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type repr(reprSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type row_joinids(row_joinidsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type col_joinids(col_joinidsSEXP);
+    rcpp_result_gen = Rcpp::wrap(sr_sparse_matrix(sr, shape, repr, row_joinids, col_joinids));
+    return rcpp_result_gen;
+END_RCPP
+}
 
 static const R_CallMethodDef CallEntries[] = {
     {"_tiledbsoma_createSchemaFromArrow", (DL_FUNC) &_tiledbsoma_createSchemaFromArrow, 8},
-    {"_tiledbsoma_writeArrayFromArrow", (DL_FUNC) &_tiledbsoma_writeArrayFromArrow, 5},
-    {"_tiledbsoma_reindex_create", (DL_FUNC) &_tiledbsoma_reindex_create, 0},
+    {"_tiledbsoma_writeArrayFromArrow", (DL_FUNC) &_tiledbsoma_writeArrayFromArrow, 6},
+    {"_tiledbsoma_soma_context_create", (DL_FUNC) &_tiledbsoma_soma_context_create, 1},
+    {"_tiledbsoma_axis_query_joinids", (DL_FUNC) &_tiledbsoma_axis_query_joinids, 8},
+    {"_tiledbsoma_reindex_create", (DL_FUNC) &_tiledbsoma_reindex_create, 1},
     {"_tiledbsoma_reindex_map", (DL_FUNC) &_tiledbsoma_reindex_map, 2},
     {"_tiledbsoma_reindex_lookup", (DL_FUNC) &_tiledbsoma_reindex_lookup, 2},
     {"_tiledbsoma_soma_array_reader", (DL_FUNC) &_tiledbsoma_soma_array_reader, 9},
@@ -324,6 +417,7 @@ static const R_CallMethodDef CallEntries[] = {
     {"_tiledbsoma_sr_complete", (DL_FUNC) &_tiledbsoma_sr_complete, 1},
     {"_tiledbsoma_create_empty_arrow_table", (DL_FUNC) &_tiledbsoma_create_empty_arrow_table, 0},
     {"_tiledbsoma_sr_next", (DL_FUNC) &_tiledbsoma_sr_next, 1},
+    {"_tiledbsoma_sr_stream", (DL_FUNC) &_tiledbsoma_sr_stream, 2},
     {"_tiledbsoma_sr_reset", (DL_FUNC) &_tiledbsoma_sr_reset, 1},
     {"_tiledbsoma_sr_set_dim_points", (DL_FUNC) &_tiledbsoma_sr_set_dim_points, 3},
     {"_tiledbsoma_tiledbsoma_stats_enable", (DL_FUNC) &_tiledbsoma_tiledbsoma_stats_enable, 0},
@@ -333,6 +427,9 @@ static const R_CallMethodDef CallEntries[] = {
     {"_tiledbsoma_libtiledbsoma_version", (DL_FUNC) &_tiledbsoma_libtiledbsoma_version, 1},
     {"_tiledbsoma_tiledb_embedded_version", (DL_FUNC) &_tiledbsoma_tiledb_embedded_version, 0},
     {"_tiledbsoma_tiledb_datatype_max_value", (DL_FUNC) &_tiledbsoma_tiledb_datatype_max_value, 1},
+    {"_tiledbsoma_sample_joinids", (DL_FUNC) &_tiledbsoma_sample_joinids, 7},
+    {"_tiledbsoma_read_sample", (DL_FUNC) &_tiledbsoma_read_sample, 6},
+    {"_tiledbsoma_sr_sparse_matrix", (DL_FUNC) &_tiledbsoma_sr_sparse_matrix, 5},
     {NULL, NULL, 0}
 };
 
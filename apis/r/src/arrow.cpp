@@ -110,7 +110,8 @@ void createSchemaFromArrow(const std::string& uri,
 // [[Rcpp::export]]
 void writeArrayFromArrow(const std::string& uri, naxpArray naap, naxpSchema nasp,
                          const std::string arraytype = "",
-                         Rcpp::Nullable<Rcpp::CharacterVector> config = R_NilValue) {
+                         Rcpp::Nullable<Rcpp::CharacterVector> config = R_NilValue,
+                         Rcpp::Nullable<Rcpp::Datetime> timestamp_end = R_NilValue) {
 
     //struct ArrowArray* ap = (struct ArrowArray*) R_ExternalPtrAddr(naap);
     //struct ArrowSchema* sp = (struct ArrowSchema*) R_ExternalPtrAddr(nasp);
@@ -146,12 +147,23 @@ void writeArrayFromArrow(const std::string& uri, naxpArray naap, naxpSchema nasp
         somactx = std::make_shared<tdbs::SOMAContext>();
     }
 
+    std::optional<tdbs::TimestampRange> timestamp = std::nullopt;
+    if (!timestamp_end.isNull()) {
+        uint64_t ts_end = Rcpp::as<Rcpp::Datetime>(timestamp_end).getFractionalTimestamp() * 1e3; // in msec
+        timestamp = tdbs::TimestampRange(0, ts_end);
+    }
+
     std::shared_ptr<tdbs::SOMAArray> arrup;
     if (arraytype == "SOMADataFrame") {
         arrup = tdbs::SOMADataFrame::open(OpenMode::write, uri, somactx);
     } else if (arraytype == "SOMADenseNDArray") {
         arrup = tdbs::SOMADenseNDArray::open(OpenMode::write, uri, somactx,
                                              "unnamed", {}, "auto", ResultOrder::colmajor);
+    } else if (arraytype == "SOMASparseNDArray") {
+        // Sparse writes go through SOMAArray so that they also reach the
+        // column-major layout of the array, if any
+        arrup = tdbs::SOMASparseNDArray::open(uri, OpenMode::write, somactx,
+                                              {}, ResultOrder::automatic, timestamp);
     }
 
     arrup.get()->set_array_data(std::move(schema), std::move(array));
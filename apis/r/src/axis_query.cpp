@@ -0,0 +1,99 @@
+// we currently get deprecation warnings by default which are noisy
+#ifndef TILEDB_NO_API_DEPRECATION_WARNINGS
+#define TILEDB_NO_API_DEPRECATION_WARNINGS
+#endif
+
+#include <Rcpp.h>                       // for R interface to C++
+#include <RcppInt64>                    // for fromInteger64 and toInteger64
+
+#include <tiledb/tiledb>
+#include <tiledbsoma/tiledbsoma>
+
+#include "rutilities.h"         // local declarations
+#include "xptr-utils.h"         // xptr taggging utilitie
+
+namespace tdbs = tiledbsoma;
+
+namespace {
+tdbs::SOMAAxisQuery make_axis_query(Rcpp::Nullable<Rcpp::NumericVector> coords,
+                                    Rcpp::Nullable<Rcpp::XPtr<tiledb::QueryCondition>> qc) {
+    tdbs::SOMAAxisQuery axis_query;
+    if (!coords.isNull()) {
+        Rcpp::NumericVector payload(coords);
+        axis_query.set_coords(Rcpp::fromInteger64(payload, false));
+    }
+    if (!qc.isNull()) {
+        Rcpp::XPtr<tiledb::QueryCondition> qcxp(qc);
+        axis_query.set_condition(*qcxp);
+    }
+    return axis_query;
+}
+}  // namespace
+
+//' Create a libtiledbsoma context
+//'
+//' The context owns the thread pool of the libtiledbsoma query engine, so
+//' holding on to it lets successive axis queries share one pool.
+//'
+//' @param config Named chracter vector with \sQuote{key} and \sQuote{value} pairs
+//' used as TileDB config parameters.
+//'
+//' @return An external pointer to the context
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::XPtr<somactx_wrap_t> soma_context_create(Rcpp::CharacterVector config) {
+    std::map<std::string, std::string> platform_config = config_vector_to_map(Rcpp::wrap(config));
+    auto somactx = std::make_shared<tdbs::SOMAContext>(platform_config);
+    return make_xptr<somactx_wrap_t>(new SOMAContextWrapper(somactx));
+}
+
+//' Resolve the joinids of an experiment axis query
+//'
+//' Evaluates the `obs` and `var` selections of an axis query on a measurement
+//' of a SOMAExperiment in libtiledbsoma, resolving both axes concurrently.
+//'
+//' @param uri Character value with URI path to a SOMAExperiment
+//' @param measurement_name Character value with the name of the measurement
+//' @param somactx External pointer to a context from `soma_context_create()`
+//' @param obs_coords,var_coords Optional integer64 vector of `soma_joinid` values
+//' @param obs_qc,var_qc Optional external Pointer object to TileDB Query Condition
+//' @param timestamp_end Optional POSIXct (i.e. Datetime) type for end of interval for which
+//' data is considered.
+//'
+//' @return A list with integer64 vectors `obs` and `var` of sorted `soma_joinid` values
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List axis_query_joinids(const std::string& uri,
+                              const std::string& measurement_name,
+                              Rcpp::XPtr<somactx_wrap_t> somactx,
+                              Rcpp::Nullable<Rcpp::NumericVector> obs_coords = R_NilValue,
+                              Rcpp::Nullable<Rcpp::XPtr<tiledb::QueryCondition>> obs_qc = R_NilValue,
+                              Rcpp::Nullable<Rcpp::NumericVector> var_coords = R_NilValue,
+                              Rcpp::Nullable<Rcpp::XPtr<tiledb::QueryCondition>> var_qc = R_NilValue,
+                              Rcpp::Nullable<Rcpp::Datetime> timestamp_end = R_NilValue) {
+
+    spdl::debug("[axis_query_joinids] Resolving joinids of {} measurement {}", uri, measurement_name);
+
+    check_xptr_tag<somactx_wrap_t>(somactx);
+
+    std::optional<tdbs::TimestampRange> timestamp = std::nullopt;
+    if (!timestamp_end.isNull()) {
+        uint64_t ts_end = Rcpp::as<Rcpp::Datetime>(timestamp_end).getFractionalTimestamp() * 1e3; // in msec
+        timestamp = tdbs::TimestampRange(0, ts_end);
+    }
+
+    std::shared_ptr<tdbs::SOMAExperiment> experiment =
+        tdbs::SOMAExperiment::open(uri, OpenMode::read, somactx->ctxptr, timestamp);
+    tdbs::SOMAExperimentAxisQuery query(experiment,
+                                        measurement_name,
+                                        make_axis_query(obs_coords, obs_qc),
+                                        make_axis_query(var_coords, var_qc));
+
+    Rcpp::NumericVector obs = Rcpp::toInteger64(query.obs_joinids());
+    Rcpp::NumericVector var = Rcpp::toInteger64(query.var_joinids());
+    experiment->close();
+
+    spdl::debug("[axis_query_joinids] Resolved {} obs and {} var joinids", obs.length(), var.length());
+    return Rcpp::List::create(Rcpp::Named("obs") = obs,
+                              Rcpp::Named("var") = var);
+}
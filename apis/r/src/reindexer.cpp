@@ -1,4 +1,6 @@
 #include <Rcpp/Lightest>        // for R interface to C++
+#include <nanoarrow/r.h>        // for C interface to Arrow (via R package nanoarrow)
+#include <nanoarrow/nanoarrow.h>
 #include <RcppInt64>            // for fromInteger64
 
 #include <tiledbsoma/tiledbsoma>
@@ -9,31 +11,86 @@
 
 namespace tdbs = tiledbsoma;
 
+#include "rutilities.h"         // local declarations
 #include "xptr-utils.h"         // xptr taggging utilitie
 
+namespace {
+
+// View a vector of keys as int64 values. `integer64` vectors and int64 Arrow
+// arrays are used in place; integer and double vectors are copied to `storage`.
+std::pair<const int64_t*, size_t> int64_keys(SEXP keys, std::vector<int64_t>& storage) {
+    if (Rf_inherits(keys, "nanoarrow_array")) {
+        struct ArrowArray* arr = nanoarrow_array_from_xptr(keys);
+        struct ArrowSchema* sch = nanoarrow_schema_from_xptr(R_ExternalPtrTag(keys));
+        if (std::string(sch->format) != "l") {
+            Rcpp::stop("Arrow keys must be of type int64, not '%s'", sch->format);
+        }
+        if (arr->null_count != 0) {
+            Rcpp::stop("Arrow keys must not contain nulls");
+        }
+        if (arr->length == 0) {
+            return {nullptr, 0};
+        }
+        const int64_t* data = static_cast<const int64_t*>(arr->buffers[1]);
+        return {data + arr->offset, static_cast<size_t>(arr->length)};
+    }
+    if (Rf_inherits(keys, "integer64")) {
+        return {reinterpret_cast<const int64_t*>(REAL(keys)), static_cast<size_t>(Rf_xlength(keys))};
+    }
+    switch (TYPEOF(keys)) {
+    case INTSXP: {
+        const int* data = INTEGER(keys);
+        storage.assign(data, data + Rf_xlength(keys));
+        break;
+    }
+    case REALSXP: {
+        const double* data = REAL(keys);
+        storage.assign(data, data + Rf_xlength(keys));
+        break;
+    }
+    default:
+        Rcpp::stop("Keys must be an integer, double, integer64 or int64 Arrow array");
+    }
+    return {storage.data(), storage.size()};
+}
+
+}  // namespace
 
 // [[Rcpp::export]]
-Rcpp::XPtr<tdbs::IntIndexer> reindex_create() {
-    auto p = new tdbs::IntIndexer();
+Rcpp::XPtr<tdbs::IntIndexer> reindex_create(SEXP somactx = R_NilValue) {
+    // The context thread pool parallelizes both mapping and lookups, so an
+    // existing context from `soma_context_create()` is reused when given
+    std::shared_ptr<tdbs::SOMAContext> ctx;
+    if (Rf_isNull(somactx)) {
+        ctx = std::make_shared<tdbs::SOMAContext>();
+    } else {
+        Rcpp::XPtr<somactx_wrap_t> ctxxp(somactx);
+        check_xptr_tag<somactx_wrap_t>(ctxxp);
+        ctx = ctxxp->ctxptr;
+    }
+    auto p = new tdbs::IntIndexer(ctx);
     return make_xptr<tdbs::IntIndexer>(p);
 }
 
 // [[Rcpp::export]]
-Rcpp::XPtr<tdbs::IntIndexer> reindex_map(Rcpp::XPtr<tdbs::IntIndexer> idx,
-                                         const Rcpp::NumericVector nvec) {
+Rcpp::XPtr<tdbs::IntIndexer> reindex_map(Rcpp::XPtr<tdbs::IntIndexer> idx, SEXP keys) {
     check_xptr_tag<tdbs::IntIndexer>(idx);
-    const std::vector<int64_t> vec = Rcpp::fromInteger64(nvec);
-    idx->map_locations(vec);
+    std::vector<int64_t> storage;
+    auto [data, size] = int64_keys(keys, storage);
+    idx->map_locations(data, size);
     return idx;
 }
 
 // [[Rcpp::export]]
-Rcpp::NumericVector reindex_lookup(Rcpp::XPtr<tdbs::IntIndexer> idx,
-                                   const Rcpp::NumericVector kvec) {
+Rcpp::NumericVector reindex_lookup(Rcpp::XPtr<tdbs::IntIndexer> idx, SEXP keys) {
     check_xptr_tag<tdbs::IntIndexer>(idx);
-    const std::vector<int64_t> keys = Rcpp::fromInteger64(kvec);
-    int sz = keys.size();
-    std::vector<int64_t> res(sz);
-    idx->lookup(keys, res);
-    return Rcpp::toInteger64(res);
+    std::vector<int64_t> storage;
+    auto [data, size] = int64_keys(keys, storage);
+    // Results are written straight into the payload of an integer64 vector
+    Rcpp::NumericVector res(size);
+    if (size > 0) {
+        idx->lookup(data, reinterpret_cast<int64_t*>(REAL(res)), size);
+    }
+    res.attr("class") = "integer64";
+    return res;
 }
@@ -248,6 +248,110 @@ SEXP sr_next(Rcpp::XPtr<tdbs::SOMAArray> sr) {
    return arrayxp;
 }
 
+namespace {
+
+// State of an ArrowArrayStream over the batches of a ReadPrefetcher. The
+// first batch is read when the stream is created, so that its schema can be
+// reported before any batch is consumed.
+struct PrefetchStream {
+    std::unique_ptr<tdbs::ReadPrefetcher> prefetcher;
+    std::optional<tdbs::ReadPrefetcher::ArrowBatch> pending;
+    struct ArrowSchema schema = {};
+    std::string error;
+};
+
+int prefetch_stream_get_schema(struct ArrowArrayStream* stream, struct ArrowSchema* out) {
+    auto state = static_cast<PrefetchStream*>(stream->private_data);
+    return ArrowSchemaDeepCopy(&state->schema, out);
+}
+
+int prefetch_stream_get_next(struct ArrowArrayStream* stream, struct ArrowArray* out) {
+    auto state = static_cast<PrefetchStream*>(stream->private_data);
+    try {
+        auto batch = std::move(state->pending);
+        state->pending.reset();
+        if (!batch) {
+            batch = state->prefetcher->next();
+        }
+        if (!batch) {
+            out->release = nullptr;     // end of stream
+            return NANOARROW_OK;
+        }
+        ArrowArrayMove(batch->first.get(), out);
+        batch->second->release(batch->second.get());
+        return NANOARROW_OK;
+    } catch (const std::exception& e) {
+        state->error = e.what();
+        return EIO;
+    }
+}
+
+const char* prefetch_stream_get_last_error(struct ArrowArrayStream* stream) {
+    auto state = static_cast<PrefetchStream*>(stream->private_data);
+    return state->error.empty() ? nullptr : state->error.c_str();
+}
+
+void prefetch_stream_release(struct ArrowArrayStream* stream) {
+    auto state = static_cast<PrefetchStream*>(stream->private_data);
+    if (state->pending) {
+        state->pending->first->release(state->pending->first.get());
+        state->pending->second->release(state->pending->second.get());
+    }
+    if (state->schema.release != nullptr) {
+        state->schema.release(&state->schema);
+    }
+    delete state;                 // joins the prefetch thread
+    stream->release = nullptr;
+}
+
+}  // namespace
+
+//' Stream the batches of a SOMAArray read
+//'
+//' Returns a nanoarrow array stream whose batches are read and assembled into
+//' Arrow struct arrays on a background thread, up to `queue_depth` batches ahead
+//' of the consumer. The stream can be consumed with `$get_next()` or handed to
+//' `arrow::as_record_batch_reader()`. The SOMAArray must not be used otherwise
+//' until the stream is exhausted or released.
+//'
+//' @param sr An external pointer to a TileDB SOMAArray object
+//' @param queue_depth Maximum number of batches read ahead
+//'
+//' @return A \code{nanoarrow_array_stream}
+//' @noRd
+// [[Rcpp::export]]
+SEXP sr_stream(Rcpp::XPtr<tdbs::SOMAArray> sr, int queue_depth = 2) {
+    check_xptr_tag<tdbs::SOMAArray>(sr);
+    if (queue_depth < 1) {
+        Rcpp::stop("'queue_depth' must be positive");
+    }
+
+    auto state = std::make_unique<PrefetchStream>();
+    state->prefetcher = std::make_unique<tdbs::ReadPrefetcher>(*sr, queue_depth);
+    state->pending = state->prefetcher->next();
+    if (state->pending) {
+        exitIfError(ArrowSchemaDeepCopy(state->pending->second.get(), &state->schema),
+                    "Bad schema copy");
+    } else {
+        exitIfError(ArrowSchemaInitFromType(&state->schema, NANOARROW_TYPE_STRUCT), "Bad schema init");
+        exitIfError(ArrowSchemaAllocateChildren(&state->schema, 0), "Bad schema children alloc");
+    }
+
+    auto streamxp = nanoarrow_array_stream_owning_xptr();
+    auto stream = nanoarrow_output_array_stream_from_xptr(streamxp);
+    stream->get_schema = &prefetch_stream_get_schema;
+    stream->get_next = &prefetch_stream_get_next;
+    stream->get_last_error = &prefetch_stream_get_last_error;
+    stream->release = &prefetch_stream_release;
+    stream->private_data = state.release();
+
+    // Keep the SOMAArray alive for as long as the stream object
+    R_SetExternalPtrProtected(streamxp, sr);
+
+    spdl::debug("[sr_stream] Streaming with queue depth {}", queue_depth);
+    return streamxp;
+}
+
 // [[Rcpp::export]]
 void sr_reset(Rcpp::XPtr<tdbs::SOMAArray> sr) {
     check_xptr_tag<tdbs::SOMAArray>(sr);
@@ -0,0 +1,169 @@
+// we currently get deprecation warnings by default which are noisy
+#ifndef TILEDB_NO_API_DEPRECATION_WARNINGS
+#define TILEDB_NO_API_DEPRECATION_WARNINGS
+#endif
+
+#include <Rcpp.h>                       // for R interface to C++
+#include <nanoarrow/r.h>                // for C interface to Arrow (via R package nanoarrow)
+#include <nanoarrow/nanoarrow.h>
+#include <RcppInt64>                    // for fromInteger64 and toInteger64
+
+#include <tiledb/tiledb>
+#include <tiledbsoma/tiledbsoma>
+
+#include "rutilities.h"         // local declarations
+#include "xptr-utils.h"         // xptr taggging utilitie
+
+namespace tdbs = tiledbsoma;
+
+namespace {
+std::optional<tdbs::TimestampRange> timestamp_range(Rcpp::Nullable<Rcpp::Datetime> timestamp_end) {
+    if (timestamp_end.isNull()) {
+        return std::nullopt;
+    }
+    uint64_t ts_end = Rcpp::as<Rcpp::Datetime>(timestamp_end).getFractionalTimestamp() * 1e3; // in msec
+    return tdbs::TimestampRange(0, ts_end);
+}
+
+void check_soma_type(const std::string& soma_type) {
+    if (soma_type != "SOMADataFrame" && soma_type != "SOMASparseNDArray") {
+        Rcpp::stop("Cannot sample the rows of a '%s'", soma_type);
+    }
+}
+
+// Export a batch as an Arrow array with its schema embedded, as in sr_next
+SEXP batch_to_arrow(const std::shared_ptr<tdbs::ArrayBuffers>& batch) {
+    const std::vector<std::string> names = batch->names();
+    auto ncol = names.size();
+    auto schemaxp = nanoarrow_schema_owning_xptr();
+    auto sch = nanoarrow_output_schema_from_xptr(schemaxp);
+    exitIfError(ArrowSchemaInitFromType(sch, NANOARROW_TYPE_STRUCT), "Bad schema init");
+    exitIfError(ArrowSchemaSetName(sch, ""), "Bad schema name");
+    exitIfError(ArrowSchemaAllocateChildren(sch, ncol), "Bad schema children alloc");
+
+    auto arrayxp = nanoarrow_array_owning_xptr();
+    auto arr = nanoarrow_output_array_from_xptr(arrayxp);
+    exitIfError(ArrowArrayInitFromType(arr, NANOARROW_TYPE_STRUCT), "Bad array init");
+    exitIfError(ArrowArrayAllocateChildren(arr, ncol), "Bad array children alloc");
+    arr->length = batch->num_rows();
+
+    for (size_t i=0; i<ncol; i++) {
+        auto pp = tdbs::ArrowAdapter::to_arrow(batch->at(names[i]));
+        ArrowArrayMove(pp.first.get(),   arr->children[i]);
+        ArrowSchemaMove(pp.second.get(), sch->children[i]);
+    }
+
+    array_xptr_set_schema(arrayxp, schemaxp);
+    return arrayxp;
+}
+}  // namespace
+
+//' Sample the joinids of a SOMA array
+//'
+//' Draws a random sample of distinct `soma_joinid` values of a SOMADataFrame,
+//' uniform or stratified by the values of a column, or of `soma_dim_0`
+//' coordinates of a SOMASparseNDArray.
+//'
+//' @param uri Character value with URI path to the array
+//' @param soma_type Either \sQuote{SOMADataFrame} or \sQuote{SOMASparseNDArray}
+//' @param somactx External pointer to a context from `soma_context_create()`
+//' @param n Sample size
+//' @param seed Random seed
+//' @param stratify_by Optional name of a SOMADataFrame column to stratify by
+//' @param timestamp_end Optional POSIXct (i.e. Datetime) type for end of interval for which
+//' data is considered.
+//'
+//' @return An integer64 vector with the sample, in random order
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::NumericVector sample_joinids(const std::string& uri,
+                                   const std::string& soma_type,
+                                   Rcpp::XPtr<somactx_wrap_t> somactx,
+                                   double n,
+                                   double seed,
+                                   Rcpp::Nullable<Rcpp::CharacterVector> stratify_by = R_NilValue,
+                                   Rcpp::Nullable<Rcpp::Datetime> timestamp_end = R_NilValue) {
+    check_xptr_tag<somactx_wrap_t>(somactx);
+    check_soma_type(soma_type);
+    auto timestamp = timestamp_range(timestamp_end);
+
+    std::vector<int64_t> joinids;
+    if (soma_type == "SOMADataFrame") {
+        std::optional<std::string> column = std::nullopt;
+        if (!stratify_by.isNull()) {
+            column = Rcpp::as<std::string>(stratify_by);
+        }
+        auto df = tdbs::SOMADataFrame::open(uri, OpenMode::read, somactx->ctxptr, {},
+                                            ResultOrder::automatic, timestamp);
+        joinids = df->sample_joinids(n, seed, column);
+        df->close();
+    } else {
+        if (!stratify_by.isNull()) {
+            Rcpp::stop("Only the rows of a SOMADataFrame can be stratified");
+        }
+        auto array = tdbs::SOMASparseNDArray::open(uri, OpenMode::read, somactx->ctxptr, {},
+                                                   ResultOrder::automatic, timestamp);
+        joinids = array->sample_joinids(n, seed);
+        array->close();
+    }
+    spdl::debug("[sample_joinids] Sampled {} joinids of {}", joinids.size(), uri);
+    return Rcpp::toInteger64(joinids);
+}
+
+//' Read the rows of sampled joinids of a SOMA array
+//'
+//' Reads the rows of some distinct `soma_joinid` values of a SOMADataFrame, or
+//' the cells of some distinct `soma_dim_0` coordinates of a SOMASparseNDArray.
+//' The joinids are read as ranges of consecutive joinids, and the rows of
+//' joinids not asked for are dropped as they are read.
+//'
+//' @param uri Character value with URI path to the array
+//' @param soma_type Either \sQuote{SOMADataFrame} or \sQuote{SOMASparseNDArray}
+//' @param somactx External pointer to a context from `soma_context_create()`
+//' @param joinids integer64 vector of distinct joinids, in sample order
+//' @param colnames Optional vector of character value with the name of the columns to retrieve
+//' @param timestamp_end Optional POSIXct (i.e. Datetime) type for end of interval for which
+//' data is considered.
+//'
+//' @return A list with the Arrow arrays of the `batches` read, and the 0-based
+//' `permutation` of their concatenated rows grouping them in sample order
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List read_sample(const std::string& uri,
+                       const std::string& soma_type,
+                       Rcpp::XPtr<somactx_wrap_t> somactx,
+                       Rcpp::NumericVector joinids,
+                       Rcpp::Nullable<Rcpp::CharacterVector> colnames = R_NilValue,
+                       Rcpp::Nullable<Rcpp::Datetime> timestamp_end = R_NilValue) {
+    check_xptr_tag<somactx_wrap_t>(somactx);
+    check_soma_type(soma_type);
+    auto timestamp = timestamp_range(timestamp_end);
+    auto sample = Rcpp::fromInteger64(joinids, false);
+
+    tdbs::SampledRows rows;
+    if (soma_type == "SOMADataFrame") {
+        std::vector<std::string> column_names;
+        if (!colnames.isNull()) {
+            column_names = Rcpp::as<std::vector<std::string>>(colnames);
+        }
+        auto df = tdbs::SOMADataFrame::open(uri, OpenMode::read, somactx->ctxptr, {},
+                                            ResultOrder::automatic, timestamp);
+        rows = df->read_sample(sample, column_names);
+        df->close();
+    } else {
+        auto array = tdbs::SOMASparseNDArray::open(uri, OpenMode::read, somactx->ctxptr, {},
+                                                   ResultOrder::automatic, timestamp);
+        rows = array->read_sample(sample);
+        array->close();
+    }
+    spdl::debug("[read_sample] Read {} batches of {} rows of {}",
+                rows.batches.size(), rows.permutation.size(), uri);
+
+    Rcpp::List batches(rows.batches.size());
+    for (size_t i = 0; i < rows.batches.size(); i++) {
+        batches[i] = batch_to_arrow(rows.batches[i]);
+    }
+    Rcpp::IntegerVector permutation(rows.permutation.begin(), rows.permutation.end());
+    return Rcpp::List::create(Rcpp::Named("batches") = batches,
+                              Rcpp::Named("permutation") = permutation);
+}
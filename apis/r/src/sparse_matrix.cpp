@@ -0,0 +1,140 @@
+// we currently get deprecation warnings by default which are noisy
+#ifndef TILEDB_NO_API_DEPRECATION_WARNINGS
+#define TILEDB_NO_API_DEPRECATION_WARNINGS
+#endif
+
+#include <Rcpp.h>                       // for R interface to C++
+#include <RcppInt64>                    // for fromInteger64
+#include <limits>
+
+#include <tiledb/tiledb>
+#include <tiledbsoma/tiledbsoma>
+#include <tiledbsoma/reindexer/reindexer.h>
+
+#include "rutilities.h"         // local declarations
+#include "xptr-utils.h"         // xptr taggging utilitie
+
+namespace tdbs = tiledbsoma;
+
+namespace {
+
+// Maps the coordinates of one dimension onto [0, n), either by joinid
+// lookup or by checking that the stored coordinates already fit
+void reindex(tdbs::IntIndexer* indexer, const int64_t* coords, int64_t* out,
+             size_t size, int64_t n, const std::string& dim) {
+    if (indexer != nullptr) {
+        indexer->lookup(coords, out, size);
+    } else {
+        std::copy(coords, coords + size, out);
+    }
+    for (size_t k = 0; k < size; k++) {
+        if (out[k] < 0 || out[k] >= n) {
+            Rcpp::stop("Coordinate %s=%lld is outside the matrix shape",
+                       dim, static_cast<long long>(coords[k]));
+        }
+    }
+}
+
+int64_t checked_extent(double value, const char* what) {
+    if (value < 0 || value > std::numeric_limits<int>::max()) {
+        Rcpp::stop("The %s of the matrix (%.0f) exceeds what R can index", what, value);
+    }
+    return static_cast<int64_t>(value);
+}
+
+}  // namespace
+
+//' Assemble a sparse matrix from a SOMAArray read
+//'
+//' Reads all remaining batches of a SOMAArray reader with columns `soma_dim_0`,
+//' `soma_dim_1` and `soma_data`, optionally maps the coordinates onto positions
+//' of the given joinids, and assembles the slots of a `Matrix` sparse matrix
+//' with a parallel counting sort in libtiledbsoma.
+//'
+//' @param sr An external pointer to a TileDB SOMAArray object
+//' @param shape Numeric vector with the number of rows and columns
+//' @param repr One of \sQuote{C}, \sQuote{R} or \sQuote{T} for the
+//' `dgCMatrix`, `dgRMatrix` or `dgTMatrix` slots
+//' @param row_joinids,col_joinids Optional integer64 vectors of `soma_joinid`
+//' values; when given, the coordinates of that dimension are replaced by their
+//' position in the vector
+//'
+//' @return A list with the zero-based slots `i`/`j`, `p` and `x` of the matrix
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List sr_sparse_matrix(Rcpp::XPtr<tdbs::SOMAArray> sr,
+                            Rcpp::NumericVector shape,
+                            const std::string& repr = "C",
+                            Rcpp::Nullable<Rcpp::NumericVector> row_joinids = R_NilValue,
+                            Rcpp::Nullable<Rcpp::NumericVector> col_joinids = R_NilValue) {
+    check_xptr_tag<tdbs::SOMAArray>(sr);
+    if (repr != "C" && repr != "R" && repr != "T") {
+        Rcpp::stop("Unsupported sparse matrix representation '%s'", repr);
+    }
+    if (shape.length() != 2) {
+        Rcpp::stop("'shape' must have two elements");
+    }
+    int64_t n_rows = checked_extent(shape[0], "number of rows");
+    int64_t n_cols = checked_extent(shape[1], "number of columns");
+
+    std::unique_ptr<tdbs::IntIndexer> row_indexer, col_indexer;
+    if (!row_joinids.isNull()) {
+        row_indexer = std::make_unique<tdbs::IntIndexer>(sr->ctx());
+        row_indexer->map_locations(Rcpp::fromInteger64(Rcpp::NumericVector(row_joinids), false));
+    }
+    if (!col_joinids.isNull()) {
+        col_indexer = std::make_unique<tdbs::IntIndexer>(sr->ctx());
+        col_indexer->map_locations(Rcpp::fromInteger64(Rcpp::NumericVector(col_joinids), false));
+    }
+
+    // A dgTMatrix is returned in CSC order, so it is assembled like a dgCMatrix
+    auto format = repr == "R" ? tdbs::CompressedFormat::csr : tdbs::CompressedFormat::csc;
+    tdbs::CompressedMatrix<double> matrix(format, n_rows, n_cols, sr->ctx());
+
+    // The reindexed batches must stay alive until `compress()`
+    std::vector<std::vector<int64_t>> rows, cols;
+    std::vector<std::vector<double>> values;
+    while (auto batch = sr->read_next()) {
+        size_t size = (*batch)->num_rows();
+        if (size == 0) {
+            continue;
+        }
+        rows.emplace_back(size);
+        cols.emplace_back(size);
+        reindex(row_indexer.get(), (*batch)->at("soma_dim_0")->data<int64_t>().data(),
+                rows.back().data(), size, n_rows, "soma_dim_0");
+        reindex(col_indexer.get(), (*batch)->at("soma_dim_1")->data<int64_t>().data(),
+                cols.back().data(), size, n_cols, "soma_dim_1");
+        values.push_back((*batch)->at("soma_data")->values_as<double>());
+        matrix.append(rows.back().data(), cols.back().data(), values.back().data(), size);
+    }
+    matrix.compress();
+    rows.clear();
+    cols.clear();
+    values.clear();
+
+    if (matrix.nnz() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        Rcpp::stop("The matrix has %.0f non-zero values, more than R can index",
+                   static_cast<double>(matrix.nnz()));
+    }
+    spdl::debug("[sr_sparse_matrix] Assembled {}x{} matrix with {} values", n_rows, n_cols, matrix.nnz());
+
+    const auto& indptr = matrix.indptr();
+    Rcpp::IntegerVector indices(matrix.indices().begin(), matrix.indices().end());
+    Rcpp::NumericVector x(matrix.data().begin(), matrix.data().end());
+    Rcpp::IntegerVector dim = Rcpp::IntegerVector::create(n_rows, n_cols);
+    if (repr == "T") {
+        Rcpp::IntegerVector j(indices.length());
+        for (int64_t col = 0; col < n_cols; col++) {
+            std::fill(j.begin() + indptr[col], j.begin() + indptr[col + 1], col);
+        }
+        return Rcpp::List::create(Rcpp::Named("i") = indices,
+                                  Rcpp::Named("j") = j,
+                                  Rcpp::Named("x") = x,
+                                  Rcpp::Named("Dim") = dim);
+    }
+    return Rcpp::List::create(Rcpp::Named(repr == "C" ? "i" : "j") = indices,
+                              Rcpp::Named("p") = Rcpp::IntegerVector(indptr.begin(), indptr.end()),
+                              Rcpp::Named("x") = x,
+                              Rcpp::Named("Dim") = dim);
+}
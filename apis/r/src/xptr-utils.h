@@ -31,6 +31,8 @@ const tiledb_xptr_object tiledb_soma_reader_t                    { 500 };
 
 const tiledb_xptr_object tiledb_soma_rindexer_t                  { 600 };
 
+const tiledb_xptr_object tiledb_soma_context_t                   { 700 };
+
 // templated checkers for external pointer tags
 template <typename T> const int32_t XPtrTagType                            = tiledb_xptr_default; // clang++ wants a value
 template <> inline const int32_t XPtrTagType<tiledb::Array>                = tiledb_xptr_object_array;
@@ -58,6 +60,8 @@ template <> inline const int32_t XPtrTagType<tdbs::SOMAArray>              = til
 
 template <> inline const int32_t XPtrTagType<tdbs::IntIndexer>  	       = tiledb_soma_rindexer_t;
 
+template <> inline const int32_t XPtrTagType<somactx_wrap_t>               = tiledb_soma_context_t;
+
 template <typename T> Rcpp::XPtr<T> make_xptr(T* p, bool finalize=true) {
     return Rcpp::XPtr<T>(p, finalize, Rcpp::wrap(XPtrTagType<T>), R_NilValue);
 }
@@ -31,12 +31,50 @@
  */
 
 #include "array_buffers.h"
+#include <cstring>
 #include "../utils/logger.h"
 
 namespace tiledbsoma {
 
 using namespace tiledb;
 
+std::shared_ptr<ArrayBuffers> ArrayBuffers::deserialize(
+    const uint8_t* buffer, size_t size, size_t& offset) {
+    uint64_t num_columns;
+    if (offset > size || size - offset < sizeof(num_columns)) {
+        throw TileDBSOMAError("[ArrayBuffers] serialized buffer truncated");
+    }
+    std::memcpy(&num_columns, buffer + offset, sizeof(num_columns));
+    offset += sizeof(num_columns);
+
+    auto buffers = std::make_shared<ArrayBuffers>();
+    for (uint64_t i = 0; i < num_columns; ++i) {
+        auto column = ColumnBuffer::deserialize(buffer, size, offset);
+        buffers->emplace(std::string(column->name()), column);
+    }
+    return buffers;
+}
+
+std::shared_ptr<ArrayBuffers> ArrayBuffers::map(
+    std::shared_ptr<const void> mapping,
+    uint8_t* buffer,
+    size_t size,
+    size_t& offset) {
+    uint64_t num_columns;
+    if (offset > size || size - offset < sizeof(num_columns)) {
+        throw TileDBSOMAError("[ArrayBuffers] serialized buffer truncated");
+    }
+    std::memcpy(&num_columns, buffer + offset, sizeof(num_columns));
+    offset += sizeof(num_columns);
+
+    auto buffers = std::make_shared<ArrayBuffers>();
+    for (uint64_t i = 0; i < num_columns; ++i) {
+        auto column = ColumnBuffer::map(mapping, buffer, size, offset);
+        buffers->emplace(std::string(column->name()), column);
+    }
+    return buffers;
+}
+
 std::shared_ptr<ColumnBuffer> ArrayBuffers::at(const std::string& name) {
     if (!contains(name)) {
         throw TileDBSOMAError(
@@ -55,4 +93,38 @@ void ArrayBuffers::emplace(
     buffers_.emplace(name, buffer);
 }
 
+size_t ArrayBuffers::nbytes() const {
+    size_t nbytes = 0;
+    for (const auto& [name, buffer] : buffers_) {
+        nbytes += buffer->nbytes();
+    }
+    return nbytes;
+}
+
+std::shared_ptr<ArrayBuffers> ArrayBuffers::clone() const {
+    auto copy = std::make_shared<ArrayBuffers>();
+    for (const auto& name : names_) {
+        copy->emplace(name, buffers_.at(name)->clone());
+    }
+    return copy;
+}
+
+std::shared_ptr<ArrayBuffers> ArrayBuffers::take(
+    const std::vector<int64_t>& rows) const {
+    auto copy = std::make_shared<ArrayBuffers>();
+    for (const auto& name : names_) {
+        copy->emplace(name, buffers_.at(name)->take(rows));
+    }
+    return copy;
+}
+
+void ArrayBuffers::serialize(std::vector<uint8_t>& buffer) const {
+    uint64_t num_columns = names_.size();
+    auto bytes = reinterpret_cast<const uint8_t*>(&num_columns);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(num_columns));
+    for (const auto& name : names_) {
+        buffers_.at(name)->serialize(buffer);
+    }
+}
+
 }  // namespace tiledbsoma
\ No newline at end of file
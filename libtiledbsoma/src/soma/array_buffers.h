@@ -46,6 +46,35 @@ using namespace tiledb;
 
 class ArrayBuffers {
    public:
+    /**
+     * @brief Restore array buffers written by `serialize`.
+     *
+     * @param buffer Serialized buffers
+     * @param size Size of `buffer`
+     * @param offset Offset of the array buffers in `buffer`, advanced past
+     * them
+     * @return std::shared_ptr<ArrayBuffers>
+     */
+    static std::shared_ptr<ArrayBuffers> deserialize(
+        const uint8_t* buffer, size_t size, size_t& offset);
+
+    /**
+     * @brief Restore array buffers written by `serialize` as views of
+     * `buffer`, without copying them (see `ColumnBuffer::map`).
+     *
+     * @param mapping Owner of `buffer`
+     * @param buffer Serialized buffers
+     * @param size Size of `buffer`
+     * @param offset Offset of the array buffers in `buffer`, advanced past
+     * them
+     * @return std::shared_ptr<ArrayBuffers>
+     */
+    static std::shared_ptr<ArrayBuffers> map(
+        std::shared_ptr<const void> mapping,
+        uint8_t* buffer,
+        size_t size,
+        size_t& offset);
+
     ArrayBuffers() = default;
     ArrayBuffers(const ArrayBuffers&) = default;
     ArrayBuffers(ArrayBuffers&&) = default;
@@ -96,6 +125,38 @@ class ArrayBuffers {
         return buffers_.at(names_.front())->size();
     }
 
+    /**
+     * @brief Returns the number of bytes allocated for the column buffers.
+     *
+     * @return size_t Number of bytes
+     */
+    size_t nbytes() const;
+
+    /**
+     * @brief Returns a deep copy of the array buffers, see
+     * `ColumnBuffer::clone`.
+     *
+     * @return std::shared_ptr<ArrayBuffers> Copy of the array buffers
+     */
+    std::shared_ptr<ArrayBuffers> clone() const;
+
+    /**
+     * @brief Returns a copy of the given rows, in the given order, see
+     * `ColumnBuffer::take`.
+     *
+     * @param rows Row indexes
+     * @return std::shared_ptr<ArrayBuffers> Copy of the rows
+     */
+    std::shared_ptr<ArrayBuffers> take(const std::vector<int64_t>& rows) const;
+
+    /**
+     * @brief Append the column buffers to a byte buffer, see
+     * `ColumnBuffer::serialize`.
+     *
+     * @param buffer Byte buffer to append to
+     */
+    void serialize(std::vector<uint8_t>& buffer) const;
+
    private:
     // A vector of column names that maintains the order the columns were added
     std::vector<std::string> names_;
@@ -0,0 +1,166 @@
+/**
+ * @file   array_handle_cache.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the ArrayHandleCache class.
+ */
+
+#include "array_handle_cache.h"
+#include "../utils/arrow_adapter.h"
+#include "../utils/logger.h"
+
+namespace tiledbsoma {
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+std::shared_ptr<Array> ArrayHandleCache::open(
+    const std::string& uri,
+    std::optional<TimestampRange> timestamp,
+    const std::function<std::shared_ptr<Array>()>& open_array) {
+    std::string key = uri;
+    if (timestamp) {
+        key += fmt::format("@{}-{}", timestamp->first, timestamp->second);
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (auto it = index_.find(key); it != index_.end()) {
+            ++hits_;
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return it->second->array;
+        }
+        ++misses_;
+    }
+
+    LOG_DEBUG(fmt::format("[ArrayHandleCache] open '{}'", key));
+    auto array = open_array();
+
+    const std::lock_guard<std::mutex> lock(mutex_);
+    // Another thread may have opened the same array meanwhile
+    if (auto it = index_.find(key); it != index_.end()) {
+        return it->second->array;
+    }
+    entries_.push_front(Entry{key, uri, array, nullptr});
+    index_[key] = entries_.begin();
+    arrays_[array.get()] = entries_.begin();
+    while (entries_.size() > capacity_) {
+        _erase(std::prev(entries_.end()));
+    }
+    return array;
+}
+
+std::unique_ptr<ArrowSchema> ArrayHandleCache::arrow_schema(
+    std::shared_ptr<Context> ctx, std::shared_ptr<Array> array) {
+    std::shared_ptr<ArrowSchema> schema = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        auto it = arrays_.find(array.get());
+        if (it == arrays_.end()) {
+            // The handle was dropped from the cache
+            return ArrowAdapter::arrow_schema_from_tiledb_array(ctx, array);
+        }
+        schema = it->second->arrow_schema;
+    }
+
+    if (schema == nullptr) {
+        schema = std::shared_ptr<ArrowSchema>(
+            ArrowAdapter::arrow_schema_from_tiledb_array(ctx, array).release(),
+            [](ArrowSchema* schema) {
+                if (schema->release != nullptr) {
+                    schema->release(schema);
+                }
+                delete schema;
+            });
+
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (auto it = arrays_.find(array.get()); it != arrays_.end()) {
+            if (it->second->arrow_schema == nullptr) {
+                it->second->arrow_schema = schema;
+            } else {
+                schema = it->second->arrow_schema;
+            }
+        }
+    }
+
+    // The cached schema is never modified, copies may be made concurrently
+    auto copy = std::make_unique<ArrowSchema>();
+    if (ArrowSchemaDeepCopy(schema.get(), copy.get()) != NANOARROW_OK) {
+        throw TileDBSOMAError(fmt::format(
+            "[ArrayHandleCache] Error copying the Arrow schema of '{}'",
+            array->uri()));
+    }
+    return copy;
+}
+
+void ArrayHandleCache::invalidate(const std::string& uri) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        auto next = std::next(it);
+        if (it->uri == uri) {
+            _erase(it);
+        }
+        it = next;
+    }
+}
+
+void ArrayHandleCache::clear() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+    arrays_.clear();
+}
+
+size_t ArrayHandleCache::size() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+uint64_t ArrayHandleCache::hits() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+uint64_t ArrayHandleCache::misses() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+void ArrayHandleCache::_erase(std::list<Entry>::iterator it) {
+    LOG_DEBUG(fmt::format("[ArrayHandleCache] drop '{}'", it->key));
+    index_.erase(it->key);
+    arrays_.erase(it->array.get());
+    entries_.erase(it);
+}
+
+}  // namespace tiledbsoma
@@ -0,0 +1,181 @@
+/**
+ * @file   array_handle_cache.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the ArrayHandleCache class, a cache of TileDB arrays
+ *   opened for read and their Arrow schemas, shared by the SOMAArrays of a
+ *   SOMAContext.
+ */
+
+#ifndef SOMA_ARRAY_HANDLE_CACHE
+#define SOMA_ARRAY_HANDLE_CACHE
+
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tiledb/tiledb>
+#include <unordered_map>
+
+#include "../utils/common.h"
+#include "nanoarrow/nanoarrow.hpp"
+
+namespace tiledbsoma {
+
+using namespace tiledb;
+
+/**
+ * @brief A cache of TileDB arrays opened for read, keyed by URI and
+ * timestamp, with the Arrow schema derived from each array.
+ *
+ * Handles are reference counted: the cache holds one reference to each
+ * array and every SOMAArray using it holds another. The least recently used
+ * handles beyond the capacity are dropped from the cache, and an array is
+ * closed once the last reference is released.
+ *
+ * An array opened without a timestamp sees the fragments written before it
+ * was first opened. Writes through a SOMAArray of the same context drop the
+ * cached handles of the array (see `invalidate`).
+ */
+class ArrayHandleCache {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    // Config key setting the number of array handles cached by a context.
+    // The cache is disabled if the key is absent or zero.
+    inline static const std::string
+        CONFIG_KEY_SIZE = "soma.cache.array_handles";
+
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    /**
+     * @brief Construct an ArrayHandleCache.
+     *
+     * @param capacity Number of cached handles
+     */
+    ArrayHandleCache(size_t capacity)
+        : capacity_(capacity) {
+    }
+
+    ArrayHandleCache() = delete;
+    ArrayHandleCache(const ArrayHandleCache&) = delete;
+    ArrayHandleCache(ArrayHandleCache&&) = delete;
+    ~ArrayHandleCache() = default;
+
+    /**
+     * @brief Return the cached array of `uri` at `timestamp`, or open it
+     * with `open_array` and cache it. Arrays are opened outside the cache
+     * lock, so distinct arrays are opened concurrently.
+     *
+     * @param uri Array URI
+     * @param timestamp Optional read timestamp range
+     * @param open_array Function opening the array for read
+     * @return std::shared_ptr<Array>
+     */
+    std::shared_ptr<Array> open(
+        const std::string& uri,
+        std::optional<TimestampRange> timestamp,
+        const std::function<std::shared_ptr<Array>()>& open_array);
+
+    /**
+     * @brief Return a copy of the Arrow schema of a cached array, derived
+     * from the TileDB schema on first use.
+     *
+     * @param ctx TileDB context
+     * @param array Array returned by `open`
+     * @return std::unique_ptr<ArrowSchema>
+     */
+    std::unique_ptr<ArrowSchema> arrow_schema(
+        std::shared_ptr<Context> ctx, std::shared_ptr<Array> array);
+
+    /**
+     * @brief Drop the cached arrays of `uri`.
+     *
+     * @param uri Array URI
+     */
+    void invalidate(const std::string& uri);
+
+    /**
+     * @brief Drop all cached arrays.
+     */
+    void clear();
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    size_t size();
+
+    uint64_t hits();
+
+    uint64_t misses();
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    struct Entry {
+        std::string key;
+        std::string uri;
+        std::shared_ptr<Array> array;
+
+        // Arrow schema of the array, derived on first use
+        std::shared_ptr<ArrowSchema> arrow_schema;
+    };
+
+    // Remove an entry, the caller holds `mutex_`
+    void _erase(std::list<Entry>::iterator it);
+
+    // Number of cached handles
+    size_t capacity_;
+
+    // Entries, most recently used first
+    std::list<Entry> entries_;
+
+    // Map: key -> entry
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+
+    // Map: array -> entry
+    std::unordered_map<const Array*, std::list<Entry>::iterator> arrays_;
+
+    // Lookup statistics
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+
+    std::mutex mutex_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_ARRAY_HANDLE_CACHE
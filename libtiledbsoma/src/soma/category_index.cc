@@ -0,0 +1,371 @@
+/**
+ * @file   category_index.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the CategoryIndex class.
+ */
+
+#include "category_index.h"
+#include <algorithm>
+#include <limits>
+#include "../utils/logger.h"
+#include "nlohmann/json.hpp"
+
+namespace tiledbsoma {
+
+using json = nlohmann::json;
+
+namespace {
+
+const std::string SOMA_JOINID = "soma_joinid";
+
+// Enumeration codes are at most 32-bit unsigned integers
+const int64_t MAX_CODE = std::numeric_limits<uint32_t>::max();
+const int64_t CODE_TILE_EXTENT = 4096;
+
+template <typename T>
+void group_codes(
+    ColumnBuffer& column,
+    tcb::span<int64_t> joinids,
+    std::map<int64_t, std::vector<int64_t>>& groups) {
+    auto codes = column.data<T>();
+    tcb::span<uint8_t> validity;
+    if (column.is_nullable()) {
+        validity = column.validity();
+    }
+    for (size_t i = 0; i < codes.size(); ++i) {
+        if (!validity.empty() && !validity[i]) {
+            continue;
+        }
+        groups[static_cast<int64_t>(codes[i])].push_back(joinids[i]);
+    }
+}
+
+// Group the joinids of the cells by the code of an enumerated column
+std::map<int64_t, std::vector<int64_t>> group_by_code(
+    ColumnBuffer& column, tcb::span<int64_t> joinids) {
+    std::map<int64_t, std::vector<int64_t>> groups;
+    switch (column.type()) {
+        case TILEDB_INT8:
+            group_codes<int8_t>(column, joinids, groups);
+            break;
+        case TILEDB_UINT8:
+            group_codes<uint8_t>(column, joinids, groups);
+            break;
+        case TILEDB_INT16:
+            group_codes<int16_t>(column, joinids, groups);
+            break;
+        case TILEDB_UINT16:
+            group_codes<uint16_t>(column, joinids, groups);
+            break;
+        case TILEDB_INT32:
+            group_codes<int32_t>(column, joinids, groups);
+            break;
+        case TILEDB_UINT32:
+            group_codes<uint32_t>(column, joinids, groups);
+            break;
+        default:
+            throw TileDBSOMAError(fmt::format(
+                "[CategoryIndex] Unsupported enumeration index type {} of "
+                "column '{}'",
+                tiledb::impl::type_to_str(column.type()),
+                column.name()));
+    }
+    return groups;
+}
+
+}  // namespace
+
+//===================================================================
+//= public static
+//===================================================================
+
+void CategoryIndex::create(
+    SOMAArray& df,
+    std::string_view index_uri,
+    const std::vector<std::string>& column_names) {
+    if (column_names.empty()) {
+        throw TileDBSOMAError("[CategoryIndex] No columns to index");
+    }
+    auto df_schema = df.tiledb_schema();
+    for (const auto& name : column_names) {
+        if (!df_schema->has_attribute(name) || !df.attr_has_enum(name)) {
+            throw TileDBSOMAError(fmt::format(
+                "[CategoryIndex] '{}' is not an enumerated column of '{}'",
+                name,
+                df.uri()));
+        }
+    }
+
+    auto tiledb_ctx = df.ctx()->tiledb_ctx();
+    Domain domain(*tiledb_ctx);
+    domain.add_dimension(Dimension::create(
+        *tiledb_ctx, "soma_column", TILEDB_STRING_ASCII, nullptr, nullptr));
+    domain.add_dimension(Dimension::create<int64_t>(
+        *tiledb_ctx, "soma_code", {0, MAX_CODE}, CODE_TILE_EXTENT));
+    ArraySchema schema(*tiledb_ctx, TILEDB_SPARSE);
+    schema.set_domain(domain);
+    auto bitmap = Attribute::create<uint8_t>(*tiledb_ctx, "soma_bitmap");
+    bitmap.set_cell_val_num(TILEDB_VAR_NUM);
+    schema.add_attribute(bitmap);
+    schema.check();
+
+    auto index = SOMAArray::create(
+        df.ctx(), index_uri, schema, "SOMACategoryIndex", df.timestamp());
+    std::string indexed_columns = json(column_names).dump();
+    index->set_metadata(
+        INDEXED_COLUMNS_KEY,
+        TILEDB_STRING_UTF8,
+        static_cast<uint32_t>(indexed_columns.length()),
+        indexed_columns.c_str());
+
+    // Index the current rows
+    std::vector<std::string> read_columns(column_names);
+    read_columns.push_back(SOMA_JOINID);
+    auto reader = SOMAArray::open(
+        OpenMode::read,
+        df.uri(),
+        df.ctx(),
+        "",
+        read_columns,
+        "auto",
+        ResultOrder::automatic,
+        df.timestamp());
+    Postings postings;
+    while (auto batch = reader->read_next()) {
+        _add(**batch, column_names, postings);
+    }
+    reader->close();
+
+    _write(*index, postings);
+    index->close();
+
+    LOG_DEBUG(fmt::format(
+        "[CategoryIndex] Created '{}' indexing {} columns of '{}'",
+        index_uri,
+        column_names.size(),
+        df.uri()));
+}
+
+void CategoryIndex::update(
+    std::shared_ptr<SOMAContext> ctx,
+    std::string_view index_uri,
+    ArrayBuffers& cells,
+    std::optional<TimestampRange> timestamp) {
+    if (!cells.contains(SOMA_JOINID)) {
+        return;
+    }
+
+    auto index = SOMAArray::open(
+        OpenMode::read,
+        index_uri,
+        ctx,
+        "",
+        {},
+        "auto",
+        ResultOrder::automatic,
+        timestamp);
+    Postings postings;
+    _add(cells, _indexed_columns(*index), postings);
+
+    // Merge with the stored bitmaps of the same categories
+    for (auto& [column, bitmaps] : postings) {
+        std::vector<int64_t> codes;
+        for (const auto& [code, bitmap] : bitmaps) {
+            codes.push_back(code);
+        }
+        for (const auto& [code, stored] : _read(*index, column, codes)) {
+            bitmaps[code] |= stored;
+        }
+    }
+    index->close();
+    if (postings.empty()) {
+        return;
+    }
+
+    auto writer = SOMAArray::open(
+        OpenMode::write,
+        index_uri,
+        ctx,
+        "",
+        {},
+        "auto",
+        ResultOrder::automatic,
+        timestamp);
+    _write(*writer, postings);
+    writer->close();
+}
+
+std::optional<JoinidBitmap> CategoryIndex::lookup(
+    SOMAArray& df,
+    const std::string& column,
+    const std::vector<std::string>& values) {
+    auto value = df.get_metadata(CATEGORY_INDEX_KEY);
+    if (!value) {
+        return std::nullopt;
+    }
+    std::string index_uri(
+        static_cast<const char*>(std::get<MetadataInfo::value>(*value)),
+        std::get<MetadataInfo::num>(*value));
+
+    auto index = SOMAArray::open(
+        OpenMode::read,
+        index_uri,
+        df.ctx(),
+        "",
+        {},
+        "auto",
+        ResultOrder::automatic,
+        df.timestamp());
+    auto columns = _indexed_columns(*index);
+    if (std::find(columns.begin(), columns.end(), column) == columns.end()) {
+        index->close();
+        return std::nullopt;
+    }
+
+    // Map the labels to enumeration codes
+    auto enumeration = df.get_attr_to_enum_mapping().at(column);
+    if (enumeration.type() != TILEDB_STRING_ASCII &&
+        enumeration.type() != TILEDB_STRING_UTF8) {
+        throw TileDBSOMAError(fmt::format(
+            "[CategoryIndex] Categories of '{}' are not strings", column));
+    }
+    std::map<std::string, int64_t> label_codes;
+    auto labels = enumeration.as_vector<std::string>();
+    for (size_t code = 0; code < labels.size(); ++code) {
+        label_codes.emplace(labels[code], code);
+    }
+    std::vector<int64_t> codes;
+    for (const auto& label : values) {
+        if (auto it = label_codes.find(label); it != label_codes.end()) {
+            codes.push_back(it->second);
+        }
+    }
+
+    JoinidBitmap joinids;
+    if (!codes.empty()) {
+        for (const auto& [code, bitmap] : _read(*index, column, codes)) {
+            joinids |= bitmap;
+        }
+    }
+    index->close();
+
+    LOG_DEBUG(fmt::format(
+        "[CategoryIndex] {} categories of '{}' match {} rows",
+        codes.size(),
+        column,
+        joinids.cardinality()));
+    return joinids;
+}
+
+//===================================================================
+//= private static
+//===================================================================
+
+std::vector<std::string> CategoryIndex::_indexed_columns(SOMAArray& index) {
+    auto value = index.get_metadata(INDEXED_COLUMNS_KEY);
+    if (!value) {
+        throw TileDBSOMAError(fmt::format(
+            "[CategoryIndex] '{}' is not a category index", index.uri()));
+    }
+    std::string columns(
+        static_cast<const char*>(std::get<MetadataInfo::value>(*value)),
+        std::get<MetadataInfo::num>(*value));
+    return json::parse(columns).get<std::vector<std::string>>();
+}
+
+void CategoryIndex::_add(
+    ArrayBuffers& cells,
+    const std::vector<std::string>& column_names,
+    Postings& postings) {
+    if (!cells.contains(SOMA_JOINID) || cells.num_rows() == 0) {
+        return;
+    }
+    auto joinids = cells.at(SOMA_JOINID)->data<int64_t>();
+    for (const auto& name : column_names) {
+        if (!cells.contains(name)) {
+            continue;
+        }
+        auto& bitmaps = postings[name];
+        for (auto& [code, group] : group_by_code(*cells.at(name), joinids)) {
+            bitmaps[code] |= JoinidBitmap::from_joinids(group);
+        }
+    }
+}
+
+std::map<int64_t, JoinidBitmap> CategoryIndex::_read(
+    SOMAArray& index,
+    const std::string& column,
+    const std::vector<int64_t>& codes) {
+    std::map<int64_t, JoinidBitmap> bitmaps;
+    if (codes.empty()) {
+        return bitmaps;
+    }
+    index.reset({"soma_code", "soma_bitmap"});
+    index.set_dim_point<std::string>("soma_column", column);
+    index.set_dim_points<int64_t>("soma_code", codes);
+    while (auto batch = index.read_next()) {
+        auto read_codes = (*batch)->at("soma_code")->data<int64_t>();
+        auto column_bitmaps = (*batch)->at("soma_bitmap");
+        for (size_t i = 0; i < read_codes.size(); ++i) {
+            auto bytes = column_bitmaps->string_view(i);
+            bitmaps[read_codes[i]] = JoinidBitmap::deserialize(
+                reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+        }
+    }
+    return bitmaps;
+}
+
+void CategoryIndex::_write(SOMAArray& index, const Postings& postings) {
+    std::string columns;
+    std::vector<uint64_t> column_offsets = {0};
+    std::vector<int64_t> codes;
+    std::vector<uint8_t> bitmaps;
+    std::vector<uint64_t> bitmap_offsets = {0};
+    for (const auto& [column, column_bitmaps] : postings) {
+        for (const auto& [code, bitmap] : column_bitmaps) {
+            columns += column;
+            column_offsets.push_back(columns.size());
+            codes.push_back(code);
+            auto bytes = bitmap.serialize();
+            bitmaps.insert(bitmaps.end(), bytes.begin(), bytes.end());
+            bitmap_offsets.push_back(bitmaps.size());
+        }
+    }
+    if (codes.empty()) {
+        return;
+    }
+    index.set_column_data(
+        "soma_column", codes.size(), columns.data(), column_offsets.data());
+    index.set_column_data("soma_code", codes.size(), codes.data());
+    index.set_column_data(
+        "soma_bitmap", codes.size(), bitmaps.data(), bitmap_offsets.data());
+    index.write(true);
+}
+
+}  // namespace tiledbsoma
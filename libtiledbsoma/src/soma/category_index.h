@@ -0,0 +1,154 @@
+/**
+ * @file   category_index.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the CategoryIndex class, a secondary index mapping each
+ *   category of enumerated dataframe columns to the soma_joinids holding it.
+ */
+
+#ifndef SOMA_CATEGORY_INDEX_H
+#define SOMA_CATEGORY_INDEX_H
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../utils/joinid_bitmap.h"
+#include "array_buffers.h"
+#include "soma_array.h"
+
+namespace tiledbsoma {
+
+/**
+ * @brief Secondary index of the enumerated columns of a SOMADataFrame,
+ * stored as a sparse array next to it. The index has one cell per column
+ * and category with the serialized JoinidBitmap of the rows holding that
+ * category, keyed by the `soma_column` name and the `soma_code`
+ * enumeration index. Enumerations are only ever extended, so the codes of
+ * existing categories are stable.
+ *
+ * A category filter resolves to joinids by reading one cell per category
+ * instead of scanning the column. The index follows appends, which is how
+ * SOMA dataframes are written: overwriting the category of an existing
+ * row leaves the row in the index of its previous category too.
+ */
+class CategoryIndex {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /**
+     * @brief Create the index array and index the current rows of a
+     * dataframe.
+     *
+     * @param df The dataframe. Rows are read through a new handle at its
+     * timestamp.
+     * @param index_uri URI of the index array to create
+     * @param column_names Enumerated attributes to index
+     */
+    static void create(
+        SOMAArray& df,
+        std::string_view index_uri,
+        const std::vector<std::string>& column_names);
+
+    /**
+     * @brief Add newly written rows to the index. Rows without
+     * `soma_joinid` or without any indexed column are ignored.
+     *
+     * @param ctx SOMAContext
+     * @param index_uri URI of the index array
+     * @param cells The written cells
+     * @param timestamp Timestamp range the dataframe was opened at
+     */
+    static void update(
+        std::shared_ptr<SOMAContext> ctx,
+        std::string_view index_uri,
+        ArrayBuffers& cells,
+        std::optional<TimestampRange> timestamp);
+
+    /**
+     * @brief Return the joinids whose `column` holds any of `values`.
+     *
+     * @param df The dataframe, open for read. Its index URI is read from
+     * the `soma_category_index_uri` metadata.
+     * @param column Enumerated attribute with string categories
+     * @param values Category labels
+     * @return std::optional<JoinidBitmap> The joinids, or std::nullopt if
+     * the dataframe has no index of `column`
+     */
+    static std::optional<JoinidBitmap> lookup(
+        SOMAArray& df,
+        const std::string& column,
+        const std::vector<std::string>& values);
+
+   private:
+    //===================================================================
+    //= private static
+    //===================================================================
+
+    // Joinids of each category code of each indexed column
+    using Postings = std::map<std::string, std::map<int64_t, JoinidBitmap>>;
+
+    // Metadata of the index array listing the indexed columns, as JSON
+    inline static const std::string
+        INDEXED_COLUMNS_KEY = "soma_indexed_columns";
+
+    /**
+     * @brief Return the indexed columns of an open index array.
+     */
+    static std::vector<std::string> _indexed_columns(SOMAArray& index);
+
+    /**
+     * @brief Add the codes of the indexed columns in `cells` to `postings`.
+     */
+    static void _add(
+        ArrayBuffers& cells,
+        const std::vector<std::string>& column_names,
+        Postings& postings);
+
+    /**
+     * @brief Read the bitmaps of some codes of a column from an open index
+     * array. Codes without rows are absent from the result.
+     */
+    static std::map<int64_t, JoinidBitmap> _read(
+        SOMAArray& index,
+        const std::string& column,
+        const std::vector<int64_t>& codes);
+
+    /**
+     * @brief Write the postings to an index array open for write, replacing
+     * the bitmaps of their codes.
+     */
+    static void _write(SOMAArray& index, const Postings& postings);
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_CATEGORY_INDEX_H
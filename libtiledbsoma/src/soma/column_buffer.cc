@@ -31,12 +31,49 @@
  */
 
 #include "column_buffer.h"
+#include <algorithm>
+#include <cstring>
 #include "../utils/logger.h"
 
 namespace tiledbsoma {
 
 using namespace tiledb;
 
+namespace {
+
+// Append bytes, padded to the next 8-byte boundary
+void put_bytes(std::vector<uint8_t>& buffer, const void* data, size_t size) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+    buffer.resize((buffer.size() + 7) / 8 * 8);
+}
+
+template <typename T>
+void put(std::vector<uint8_t>& buffer, T value) {
+    put_bytes(buffer, &value, sizeof(T));
+}
+
+// Return a pointer to `size` bytes at `offset` and advance it past their
+// padding
+const uint8_t* get_bytes(
+    const uint8_t* buffer, size_t size, size_t& offset, size_t nbytes) {
+    if (offset > size || nbytes > size - offset) {
+        throw TileDBSOMAError("[ColumnBuffer] serialized buffer truncated");
+    }
+    auto data = buffer + offset;
+    offset = std::min(size, offset + (nbytes + 7) / 8 * 8);
+    return data;
+}
+
+template <typename T>
+T get(const uint8_t* buffer, size_t size, size_t& offset) {
+    T value;
+    std::memcpy(&value, get_bytes(buffer, size, offset, sizeof(T)), sizeof(T));
+    return value;
+}
+
+}  // namespace
+
 //===================================================================
 //= public static
 //===================================================================
@@ -120,6 +157,25 @@ void ColumnBuffer::to_bitmap(tcb::span<uint8_t> bytemap) {
     }
 }
 
+std::shared_ptr<ColumnBuffer> ColumnBuffer::deserialize(
+    const uint8_t* buffer, size_t size, size_t& offset) {
+    return _restore(nullptr, buffer, size, offset);
+}
+
+std::shared_ptr<ColumnBuffer> ColumnBuffer::map(
+    std::shared_ptr<const void> mapping,
+    uint8_t* buffer,
+    size_t size,
+    size_t& offset) {
+    if (!mapping) {
+        throw TileDBSOMAError("[ColumnBuffer] mapping not set");
+    }
+    if (reinterpret_cast<uintptr_t>(buffer) % sizeof(uint64_t) != 0) {
+        throw TileDBSOMAError("[ColumnBuffer] mapping not 8-byte aligned");
+    }
+    return _restore(std::move(mapping), buffer, size, offset);
+}
+
 //===================================================================
 //= public non-static
 //===================================================================
@@ -164,6 +220,10 @@ ColumnBuffer::~ColumnBuffer() {
 }
 
 void ColumnBuffer::attach(Query& query) {
+    if (mapping_) {
+        throw TileDBSOMAError(fmt::format(
+            "[ColumnBuffer] cannot attach mapped column '{}'", name_));
+    }
     // We cannot use:
     // `set_data_buffer(const std::string& name, std::vector<T>& buf)`
     // because data_ is allocated with reserve() and data_.size()
@@ -196,6 +256,114 @@ size_t ColumnBuffer::update_size(const Query& query) {
     return num_cells_;
 }
 
+std::shared_ptr<ColumnBuffer> ColumnBuffer::clone() const {
+    auto num_elements = is_var_ ? _offsets()[num_cells_] : num_cells_;
+    auto num_bytes = num_elements * type_size_;
+
+    auto buffer = std::make_shared<ColumnBuffer>(
+        name_,
+        type_,
+        num_cells_,
+        num_bytes,
+        is_var_,
+        is_nullable_,
+        enumeration_,
+        is_ordered_);
+    buffer->num_cells_ = num_cells_;
+    buffer->data_size_ = num_elements;
+    buffer->data_.assign(_data(), _data() + num_bytes);
+    if (is_var_) {
+        buffer->offsets_.assign(_offsets(), _offsets() + num_cells_ + 1);
+    }
+    if (is_nullable_) {
+        buffer->validity_.assign(_validity(), _validity() + num_cells_);
+    }
+    buffer->has_enumeration_ = has_enumeration_;
+    buffer->enums_ = enums_;
+    buffer->enum_str_ = enum_str_;
+    buffer->enum_offsets_ = enum_offsets_;
+
+    return buffer;
+}
+
+std::shared_ptr<ColumnBuffer> ColumnBuffer::take(
+    const std::vector<int64_t>& rows) const {
+    size_t num_bytes = rows.size() * type_size_;
+    if (is_var_) {
+        num_bytes = 0;
+        for (auto row : rows) {
+            num_bytes += (_offsets()[row + 1] - _offsets()[row]) * type_size_;
+        }
+    }
+
+    auto buffer = std::make_shared<ColumnBuffer>(
+        name_,
+        type_,
+        rows.size(),
+        num_bytes,
+        is_var_,
+        is_nullable_,
+        enumeration_,
+        is_ordered_);
+    buffer->num_cells_ = rows.size();
+    if (is_var_) {
+        buffer->offsets_.push_back(0);
+        for (auto row : rows) {
+            auto first = _offsets()[row];
+            auto last = _offsets()[row + 1];
+            buffer->data_.insert(
+                buffer->data_.end(),
+                _data() + first * type_size_,
+                _data() + last * type_size_);
+            buffer->offsets_.push_back(buffer->offsets_.back() + last - first);
+        }
+        buffer->data_size_ = buffer->offsets_.back();
+    } else {
+        buffer->data_.resize(num_bytes);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            std::memcpy(
+                buffer->data_.data() + i * type_size_,
+                _data() + rows[i] * type_size_,
+                type_size_);
+        }
+        buffer->data_size_ = rows.size();
+    }
+    if (is_nullable_) {
+        for (auto row : rows) {
+            buffer->validity_.push_back(_validity()[row]);
+        }
+    }
+    buffer->has_enumeration_ = has_enumeration_;
+    buffer->enums_ = enums_;
+    buffer->enum_str_ = enum_str_;
+    buffer->enum_offsets_ = enum_offsets_;
+
+    return buffer;
+}
+
+void ColumnBuffer::serialize(std::vector<uint8_t>& buffer) const {
+    if (enumeration_.has_value() || has_enumeration_) {
+        throw TileDBSOMAError(fmt::format(
+            "[ColumnBuffer] cannot serialize enumerated column '{}'", name_));
+    }
+    auto num_elements = is_var_ ? _offsets()[num_cells_] : num_cells_;
+    auto num_bytes = num_elements * type_size_;
+
+    put<uint64_t>(buffer, name_.size());
+    put_bytes(buffer, name_.data(), name_.size());
+    put<uint32_t>(buffer, type_);
+    put<uint32_t>(buffer, (is_var_ ? 1 : 0) | (is_nullable_ ? 2 : 0));
+    put<uint64_t>(buffer, num_cells_);
+    put<uint64_t>(buffer, num_bytes);
+    put_bytes(buffer, _data(), num_bytes);
+    if (is_var_) {
+        put_bytes(buffer, _offsets(), (num_cells_ + 1) * sizeof(uint64_t));
+    }
+    if (is_nullable_) {
+        put_bytes(buffer, _validity(), num_cells_);
+    }
+}
+
 std::vector<std::string> ColumnBuffer::strings() {
     std::vector<std::string> result;
 
@@ -207,9 +375,9 @@ std::vector<std::string> ColumnBuffer::strings() {
 }
 
 std::string_view ColumnBuffer::string_view(uint64_t index) {
-    auto start = offsets_[index];
-    auto len = offsets_[index + 1] - start;
-    return std::string_view((char*)(data_.data() + start), len);
+    auto start = _offsets()[index];
+    auto len = _offsets()[index + 1] - start;
+    return std::string_view((char*)(_data() + start), len);
 }
 
 //===================================================================
@@ -264,4 +432,71 @@ std::shared_ptr<ColumnBuffer> ColumnBuffer::alloc(
         is_ordered);
 }
 
+std::shared_ptr<ColumnBuffer> ColumnBuffer::_restore(
+    std::shared_ptr<const void> mapping,
+    const uint8_t* buffer,
+    size_t size,
+    size_t& offset) {
+    auto name_size = get<uint64_t>(buffer, size, offset);
+    auto name = get_bytes(buffer, size, offset, name_size);
+    auto type = static_cast<tiledb_datatype_t>(
+        get<uint32_t>(buffer, size, offset));
+    auto flags = get<uint32_t>(buffer, size, offset);
+    bool is_var = flags & 1;
+    bool is_nullable = flags & 2;
+    auto num_cells = get<uint64_t>(buffer, size, offset);
+    auto num_bytes = get<uint64_t>(buffer, size, offset);
+    auto data = get_bytes(buffer, size, offset, num_bytes);
+    if (num_cells > size) {
+        throw TileDBSOMAError("[ColumnBuffer] serialized buffer truncated");
+    }
+    const uint64_t* offsets = nullptr;
+    if (is_var) {
+        offsets = (const uint64_t*)get_bytes(
+            buffer, size, offset, (num_cells + 1) * sizeof(uint64_t));
+    }
+    const uint8_t* validity = nullptr;
+    if (is_nullable) {
+        validity = get_bytes(buffer, size, offset, num_cells);
+    }
+
+    // A mapped column allocates nothing
+    auto column = std::make_shared<ColumnBuffer>(
+        std::string_view((const char*)name, name_size),
+        type,
+        mapping ? 0 : num_cells,
+        mapping ? 0 : num_bytes,
+        is_var,
+        is_nullable);
+    column->num_cells_ = num_cells;
+    column->data_size_ = num_bytes / column->type_size_;
+    if (mapping) {
+        // The mapping is writable, see `map`
+        column->mapped_data_ = (std::byte*)data;
+        column->mapped_offsets_ = const_cast<uint64_t*>(offsets);
+        column->mapped_validity_ = const_cast<uint8_t*>(validity);
+        column->mapping_ = std::move(mapping);
+    } else {
+        column->data_.assign(
+            (const std::byte*)data, (const std::byte*)data + num_bytes);
+        if (is_var) {
+            column->offsets_.resize(num_cells + 1);
+            std::memcpy(
+                column->offsets_.data(),
+                offsets,
+                (num_cells + 1) * sizeof(uint64_t));
+        }
+        if (is_nullable) {
+            column->validity_.assign(validity, validity + num_cells);
+        }
+    }
+    auto num_elements = is_var ? column->_offsets()[num_cells] : num_cells;
+    if (num_elements * column->type_size_ != num_bytes) {
+        throw TileDBSOMAError(fmt::format(
+            "[ColumnBuffer] serialized column '{}' has inconsistent sizes",
+            column->name_));
+    }
+    return column;
+}
+
 }  // namespace tiledbsoma
@@ -33,6 +33,7 @@
 #ifndef COLUMN_BUFFER_H
 #define COLUMN_BUFFER_H
 
+#include <algorithm>
 #include <stdexcept>  // for windows: error C2039: 'runtime_error': is not a member of 'std'
 
 #include <tiledb/tiledb>
@@ -82,6 +83,36 @@ class ColumnBuffer {
      */
     static void to_bitmap(tcb::span<uint8_t> bytemap);
 
+    /**
+     * @brief Restore a ColumnBuffer written by `serialize`.
+     *
+     * @param buffer Serialized buffers
+     * @param size Size of `buffer`
+     * @param offset Offset of the ColumnBuffer in `buffer`, advanced past it
+     * @return std::shared_ptr<ColumnBuffer>
+     */
+    static std::shared_ptr<ColumnBuffer> deserialize(
+        const uint8_t* buffer, size_t size, size_t& offset);
+
+    /**
+     * @brief Restore a ColumnBuffer written by `serialize` as a view of its
+     * buffers in `buffer`, without copying them. `buffer` must be writable,
+     * e.g. a private file mapping, since Arrow conversion rewrites the
+     * buffers in place, and 8-byte aligned. The ColumnBuffer holds a
+     * reference to `mapping` and cannot be attached to a query.
+     *
+     * @param mapping Owner of `buffer`
+     * @param buffer Serialized buffers
+     * @param size Size of `buffer`
+     * @param offset Offset of the ColumnBuffer in `buffer`, advanced past it
+     * @return std::shared_ptr<ColumnBuffer>
+     */
+    static std::shared_ptr<ColumnBuffer> map(
+        std::shared_ptr<const void> mapping,
+        uint8_t* buffer,
+        size_t size,
+        size_t& offset);
+
     //===================================================================
     //= public non-static
     //===================================================================
@@ -132,6 +163,7 @@ class ColumnBuffer {
         const void* data,
         uint64_t* offsets = nullptr,
         uint8_t* validity = nullptr) {
+        mapping_.reset();
         num_cells_ = num_elems;
 
         if (offsets != nullptr) {
@@ -177,6 +209,7 @@ class ColumnBuffer {
         const void* data,
         uint32_t* offsets,
         uint8_t* validity = nullptr) {
+        mapping_.reset();
         num_cells_ = num_elems;
 
         auto num_offsets = num_elems + 1;
@@ -231,6 +264,48 @@ class ColumnBuffer {
         return data_size_;
     }
 
+    /**
+     * @brief Return the number of bytes allocated for the data, offsets and
+     * validity buffers.
+     *
+     * @return size_t
+     */
+    size_t nbytes() const {
+        if (mapping_) {
+            return data_size_ * type_size_ +
+                   (is_var_ ? (num_cells_ + 1) * sizeof(uint64_t) : 0) +
+                   (is_nullable_ ? num_cells_ : 0);
+        }
+        return data_.capacity() + offsets_.capacity() * sizeof(uint64_t) +
+               validity_.capacity();
+    }
+
+    /**
+     * @brief Return a deep copy of the ColumnBuffer, with buffers sized to
+     * the cells it holds.
+     *
+     * @return std::shared_ptr<ColumnBuffer>
+     */
+    std::shared_ptr<ColumnBuffer> clone() const;
+
+    /**
+     * @brief Return a copy of the ColumnBuffer holding the given cells, in
+     * the given order.
+     *
+     * @param rows Cell indexes
+     * @return std::shared_ptr<ColumnBuffer>
+     */
+    std::shared_ptr<ColumnBuffer> take(const std::vector<int64_t>& rows) const;
+
+    /**
+     * @brief Append the cells to a byte buffer in native byte order. Each
+     * buffer starts at an 8-byte aligned offset, so the result can be
+     * mapped from a file. Enumerated columns cannot be serialized.
+     *
+     * @param buffer Byte buffer to append to
+     */
+    void serialize(std::vector<uint8_t>& buffer) const;
+
     /**
      * @brief Return a view of the ColumnBuffer data.
      *
@@ -239,7 +314,45 @@ class ColumnBuffer {
      */
     template <typename T>
     tcb::span<T> data() {
-        return tcb::span<T>((T*)data_.data(), num_cells_);
+        return tcb::span<T>((T*)_data(), num_cells_);
+    }
+
+    /**
+     * @brief Return the values of a numeric or Boolean column converted to
+     * T, e.g. to compute over a `soma_data` column of any type.
+     *
+     * @tparam T Output type
+     * @return std::vector<T> converted values
+     */
+    template <typename T>
+    std::vector<T> values_as() {
+        switch (type_) {
+            case TILEDB_INT8:
+                return _values_as<T, int8_t>();
+            case TILEDB_UINT8:
+            case TILEDB_BOOL:
+                return _values_as<T, uint8_t>();
+            case TILEDB_INT16:
+                return _values_as<T, int16_t>();
+            case TILEDB_UINT16:
+                return _values_as<T, uint16_t>();
+            case TILEDB_INT32:
+                return _values_as<T, int32_t>();
+            case TILEDB_UINT32:
+                return _values_as<T, uint32_t>();
+            case TILEDB_INT64:
+                return _values_as<T, int64_t>();
+            case TILEDB_UINT64:
+                return _values_as<T, uint64_t>();
+            case TILEDB_FLOAT32:
+                return _values_as<T, float>();
+            case TILEDB_FLOAT64:
+                return _values_as<T, double>();
+            default:
+                throw TileDBSOMAError(
+                    "[ColumnBuffer] Unsupported type " +
+                    tiledb::impl::type_to_str(type_) + " for " + name_);
+        }
     }
 
     /**
@@ -268,7 +381,7 @@ class ColumnBuffer {
                 "[ColumnBuffer] Offsets buffer not defined for " + name_);
         }
 
-        return tcb::span<uint64_t>(offsets_.data(), num_cells_);
+        return tcb::span<uint64_t>(_offsets(), num_cells_);
     }
 
     /**
@@ -281,7 +394,7 @@ class ColumnBuffer {
             throw TileDBSOMAError(
                 "[ColumnBuffer] Validity buffer not defined for " + name_);
         }
-        return tcb::span<uint8_t>(validity_.data(), num_cells_);
+        return tcb::span<uint8_t>(_validity(), num_cells_);
     }
 
     /**
@@ -439,10 +552,47 @@ class ColumnBuffer {
         std::optional<Enumeration> enumeration,
         bool is_ordered);
 
+    /**
+     * @brief Restore a ColumnBuffer written by `serialize`, copying its
+     * buffers, or viewing them if `mapping` is set (see `map`).
+     */
+    static std::shared_ptr<ColumnBuffer> _restore(
+        std::shared_ptr<const void> mapping,
+        const uint8_t* buffer,
+        size_t size,
+        size_t& offset);
+
     //===================================================================
     //= private non-static
     //===================================================================
 
+    template <typename T, typename V>
+    std::vector<T> _values_as() {
+        auto values = data<V>();
+        std::vector<T> result(values.size());
+        std::transform(
+            values.begin(), values.end(), result.begin(), [](V value) {
+                return static_cast<T>(value);
+            });
+        return result;
+    }
+
+    // Return the data, offsets and validity buffers, which are either owned
+    // or in the mapping
+    std::byte* _data() const {
+        return mapping_ ? mapped_data_ : const_cast<std::byte*>(data_.data());
+    }
+
+    uint64_t* _offsets() const {
+        return mapping_ ? mapped_offsets_ :
+                          const_cast<uint64_t*>(offsets_.data());
+    }
+
+    uint8_t* _validity() const {
+        return mapping_ ? mapped_validity_ :
+                          const_cast<uint8_t*>(validity_.data());
+    }
+
     // Name of the column from the schema.
     std::string name_;
 
@@ -476,6 +626,13 @@ class ColumnBuffer {
     // Validity buffer (optional).
     std::vector<uint8_t> validity_;
 
+    // Owner of the buffers of a mapped ColumnBuffer (see `map`), which are
+    // used instead of data_, offsets_ and validity_.
+    std::shared_ptr<const void> mapping_;
+    std::byte* mapped_data_ = nullptr;
+    uint64_t* mapped_offsets_ = nullptr;
+    uint8_t* mapped_validity_ = nullptr;
+
     // True if the array has at least one enumerations
     bool has_enumeration_ = false;
 
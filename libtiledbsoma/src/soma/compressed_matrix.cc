@@ -0,0 +1,375 @@
+/**
+ * @file   compressed_matrix.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the CompressedMatrix class.
+ */
+
+#include "compressed_matrix.h"
+#include <thread_pool/thread_pool.h>
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include "../utils/common.h"
+#include "../utils/logger.h"
+
+namespace tiledbsoma {
+
+// Below this many cells the counting sort runs on the calling thread
+static const size_t MIN_PARALLEL_CELLS = 1 << 16;
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+template <typename T>
+CompressedMatrix<T>::CompressedMatrix(
+    CompressedFormat format,
+    int64_t n_rows,
+    int64_t n_cols,
+    std::shared_ptr<SOMAContext> ctx)
+    : format_(format)
+    , n_rows_(n_rows)
+    , n_cols_(n_cols)
+    , ctx_(ctx) {
+    if (n_rows < 0 || n_cols < 0) {
+        throw TileDBSOMAError(fmt::format(
+            "[CompressedMatrix] Invalid shape ({}, {})", n_rows, n_cols));
+    }
+}
+
+template <typename T>
+void CompressedMatrix<T>::append(
+    const int64_t* rows, const int64_t* cols, const T* data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    chunk_offsets_.push_back(nnz_);
+    chunks_.push_back({rows, cols, data, size});
+    nnz_ += size;
+}
+
+template <typename T>
+void CompressedMatrix<T>::append(std::shared_ptr<ArrayBuffers> batch) {
+    for (auto name : {"soma_dim_0", "soma_dim_1", "soma_data"}) {
+        if (!batch->contains(name)) {
+            throw TileDBSOMAError(fmt::format(
+                "[CompressedMatrix] Batch is missing column '{}'", name));
+        }
+    }
+    auto values = batch->at("soma_data");
+    if (values->type() != tiledb::impl::type_to_tiledb<T>::tiledb_type) {
+        throw TileDBSOMAError(fmt::format(
+            "[CompressedMatrix] soma_data has type {}, expected {}",
+            tiledb::impl::type_to_str(values->type()),
+            tiledb::impl::type_to_str(
+                tiledb::impl::type_to_tiledb<T>::tiledb_type)));
+    }
+    append(
+        batch->at("soma_dim_0")->data<int64_t>().data(),
+        batch->at("soma_dim_1")->data<int64_t>().data(),
+        values->data<T>().data(),
+        batch->num_rows());
+    batches_.push_back(batch);
+}
+
+template <typename T>
+void CompressedMatrix<T>::compress() {
+    int64_t n_major = format_ == CompressedFormat::csr ? n_rows_ : n_cols_;
+
+    LOG_DEBUG(fmt::format(
+        "[CompressedMatrix] Compressing {} cells in {} chunks to {}",
+        nnz_,
+        chunks_.size(),
+        format_ == CompressedFormat::csr ? "CSR" : "CSC"));
+
+    indptr_.assign(n_major + 1, 0);
+    indices_.resize(nnz_);
+    data_.resize(nnz_);
+
+    presorted_ = _scan();
+    if (presorted_) {
+        _compress_sorted();
+    } else {
+        _compress_unsorted();
+        _sort_minor();
+    }
+
+    // The source buffers are no longer referenced
+    chunks_.clear();
+    chunk_offsets_.clear();
+    batches_.clear();
+
+    LOG_DEBUG(fmt::format(
+        "[CompressedMatrix] Compressed {} cells (presorted={})",
+        nnz_,
+        presorted_));
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+template <typename T>
+bool CompressedMatrix<T>::_scan() {
+    int64_t n_major = format_ == CompressedFormat::csr ? n_rows_ : n_cols_;
+    int64_t n_minor = format_ == CompressedFormat::csr ? n_cols_ : n_rows_;
+    std::atomic<bool> in_bounds{true};
+    std::atomic<bool> sorted{true};
+
+    _parallel_for(nnz_, _concurrency(), [&](size_t, size_t begin, size_t end) {
+        // Start from the last cell of the previous slice so slice
+        // boundaries are checked too
+        size_t first = begin == 0 ? 0 : begin - 1;
+        int64_t prev_major = -1, prev_minor = -1;
+        bool task_sorted = true;
+        _for_each_cell(
+            first, end, [&](size_t, int64_t major, int64_t minor, const T&) {
+                if (major < 0 || major >= n_major || minor < 0 ||
+                    minor >= n_minor) {
+                    in_bounds = false;
+                }
+                if (major < prev_major ||
+                    (major == prev_major && minor < prev_minor)) {
+                    task_sorted = false;
+                }
+                prev_major = major;
+                prev_minor = minor;
+            });
+        if (!task_sorted) {
+            sorted = false;
+        }
+    });
+
+    if (!in_bounds) {
+        throw TileDBSOMAError(fmt::format(
+            "[CompressedMatrix] Coordinates out of bounds for shape ({}, {})",
+            n_rows_,
+            n_cols_));
+    }
+    return sorted;
+}
+
+template <typename T>
+void CompressedMatrix<T>::_compress_sorted() {
+    int64_t n_major = format_ == CompressedFormat::csr ? n_rows_ : n_cols_;
+
+    // Each cell that starts a new major slice fills the indptr entries of
+    // the empty slices before it. Those entries are disjoint between cells,
+    // so slices can be processed concurrently.
+    _parallel_for(nnz_, _concurrency(), [&](size_t, size_t begin, size_t end) {
+        size_t first = begin == 0 ? 0 : begin - 1;
+        int64_t prev_major = -1;
+        _for_each_cell(
+            first,
+            end,
+            [&](size_t pos, int64_t major, int64_t minor, const T& value) {
+                if (pos < begin) {
+                    prev_major = major;
+                    return;
+                }
+                for (int64_t m = prev_major + 1; m <= major; ++m) {
+                    indptr_[m] = pos;
+                }
+                indices_[pos] = minor;
+                data_[pos] = value;
+                prev_major = major;
+            });
+    });
+
+    int64_t last_major = -1;
+    if (nnz_ > 0) {
+        _for_each_cell(
+            nnz_ - 1, nnz_, [&](size_t, int64_t major, int64_t, const T&) {
+                last_major = major;
+            });
+    }
+    for (int64_t m = last_major + 1; m <= n_major; ++m) {
+        indptr_[m] = nnz_;
+    }
+}
+
+template <typename T>
+void CompressedMatrix<T>::_compress_unsorted() {
+    int64_t n_major = format_ == CompressedFormat::csr ? n_rows_ : n_cols_;
+
+    // Each task histograms its own slice of the cells, which costs
+    // num_tasks * n_major counters. Only split when there are enough cells
+    // per major slice to pay for it.
+    size_t num_tasks = 1;
+    if (nnz_ >= MIN_PARALLEL_CELLS) {
+        num_tasks = std::clamp<size_t>(
+            nnz_ / std::max<int64_t>(n_major, 1), 1, _concurrency());
+    }
+    std::vector<std::vector<int64_t>> counts(
+        num_tasks, std::vector<int64_t>(n_major, 0));
+
+    _parallel_for(nnz_, num_tasks, [&](size_t task, size_t begin, size_t end) {
+        auto& task_counts = counts[task];
+        _for_each_cell(
+            begin, end, [&](size_t, int64_t major, int64_t, const T&) {
+                ++task_counts[major];
+            });
+    });
+
+    // Turn the counts into the write cursor of each task in each major
+    // slice. Within a slice, cells of earlier tasks come first, so the sort
+    // is stable.
+    int64_t offset = 0;
+    for (int64_t m = 0; m < n_major; ++m) {
+        indptr_[m] = offset;
+        for (auto& task_counts : counts) {
+            int64_t count = task_counts[m];
+            task_counts[m] = offset;
+            offset += count;
+        }
+    }
+    indptr_[n_major] = offset;
+
+    _parallel_for(nnz_, num_tasks, [&](size_t task, size_t begin, size_t end) {
+        auto& cursors = counts[task];
+        _for_each_cell(
+            begin,
+            end,
+            [&](size_t, int64_t major, int64_t minor, const T& value) {
+                int64_t pos = cursors[major]++;
+                indices_[pos] = minor;
+                data_[pos] = value;
+            });
+    });
+}
+
+template <typename T>
+void CompressedMatrix<T>::_sort_minor() {
+    int64_t n_major = format_ == CompressedFormat::csr ? n_rows_ : n_cols_;
+
+    _parallel_for(
+        n_major, _concurrency(), [&](size_t, size_t begin, size_t end) {
+            std::vector<size_t> perm;
+            std::vector<int64_t> sorted_indices;
+            std::vector<T> sorted_data;
+            for (size_t m = begin; m < end; ++m) {
+                auto first = indices_.begin() + indptr_[m];
+                auto last = indices_.begin() + indptr_[m + 1];
+                if (std::is_sorted(first, last)) {
+                    continue;
+                }
+                size_t size = last - first;
+                perm.resize(size);
+                std::iota(perm.begin(), perm.end(), 0);
+                std::sort(perm.begin(), perm.end(), [&](size_t a, size_t b) {
+                    return first[a] < first[b];
+                });
+                sorted_indices.resize(size);
+                sorted_data.resize(size);
+                for (size_t i = 0; i < size; ++i) {
+                    sorted_indices[i] = first[perm[i]];
+                    sorted_data[i] = data_[indptr_[m] + perm[i]];
+                }
+                std::copy(sorted_indices.begin(), sorted_indices.end(), first);
+                std::copy(
+                    sorted_data.begin(),
+                    sorted_data.end(),
+                    data_.begin() + indptr_[m]);
+            }
+        });
+}
+
+template <typename T>
+template <typename Fn>
+void CompressedMatrix<T>::_parallel_for(
+    size_t size, size_t num_tasks, Fn fn) {
+    if (size == 0) {
+        return;
+    }
+    num_tasks = std::clamp<size_t>(num_tasks, 1, size);
+    if (num_tasks == 1) {
+        fn(0, 0, size);
+        return;
+    }
+
+    size_t slice_size = (size + num_tasks - 1) / num_tasks;
+    std::vector<ThreadPool::Task> tasks;
+    for (size_t task = 0, begin = 0; begin < size; ++task) {
+        size_t end = std::min(begin + slice_size, size);
+        tasks.emplace_back(
+            ctx_->thread_pool()->execute([&fn, task, begin, end]() {
+                fn(task, begin, end);
+                return Status::Ok();
+            }));
+        begin = end;
+    }
+    ctx_->thread_pool()->wait_all(tasks);
+}
+
+template <typename T>
+template <typename Fn>
+void CompressedMatrix<T>::_for_each_cell(
+    size_t begin, size_t end, Fn fn) const {
+    if (begin >= end) {
+        return;
+    }
+    bool csr = format_ == CompressedFormat::csr;
+
+    // Find the chunk holding the first cell
+    size_t c = std::upper_bound(
+                   chunk_offsets_.begin(), chunk_offsets_.end(), begin) -
+               chunk_offsets_.begin() - 1;
+    size_t pos = begin;
+    for (; pos < end; ++c) {
+        const Chunk& chunk = chunks_[c];
+        const int64_t* major = csr ? chunk.rows : chunk.cols;
+        const int64_t* minor = csr ? chunk.cols : chunk.rows;
+        size_t i = pos - chunk_offsets_[c];
+        size_t stop = std::min(chunk.size, end - chunk_offsets_[c]);
+        for (; i < stop; ++i, ++pos) {
+            fn(pos, major[i], minor[i], chunk.data[i]);
+        }
+    }
+}
+
+template <typename T>
+size_t CompressedMatrix<T>::_concurrency() const {
+    if (ctx_ == nullptr || ctx_->thread_pool() == nullptr) {
+        return 1;
+    }
+    return std::max<size_t>(ctx_->thread_pool()->concurrency_level(), 1);
+}
+
+template class CompressedMatrix<int8_t>;
+template class CompressedMatrix<int16_t>;
+template class CompressedMatrix<int32_t>;
+template class CompressedMatrix<int64_t>;
+template class CompressedMatrix<uint8_t>;
+template class CompressedMatrix<uint16_t>;
+template class CompressedMatrix<uint32_t>;
+template class CompressedMatrix<uint64_t>;
+template class CompressedMatrix<float>;
+template class CompressedMatrix<double>;
+
+}  // namespace tiledbsoma
@@ -0,0 +1,230 @@
+/**
+ * @file   compressed_matrix.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the CompressedMatrix class, which assembles streamed
+ *   COO batches of a 2D sparse array (e.g. reindexed X reads) into CSR or
+ *   CSC form with a parallel counting sort on the major axis.
+ */
+
+#ifndef SOMA_COMPRESSED_MATRIX_H
+#define SOMA_COMPRESSED_MATRIX_H
+
+#include <memory>
+#include <vector>
+
+#include "array_buffers.h"
+#include "soma_context.h"
+
+namespace tiledbsoma {
+
+enum class CompressedFormat { csr, csc };
+
+/**
+ * @brief A CSR or CSC matrix built from COO batches.
+ *
+ * Batches are appended with `append()` and assembled with `compress()`.
+ * Coordinates must already be reindexed to [0, n_rows) x [0, n_cols).
+ * Appending does not copy: the coordinate and value buffers must stay alive
+ * until `compress()` returns, which is guaranteed when appending
+ * ArrayBuffers.
+ *
+ * After `compress()`, `indptr()` has `n_major + 1` entries and the minor
+ * indices of each major slice are sorted ascending, so the result is in
+ * canonical form (SOMA disallows duplicate coordinates).
+ *
+ * @tparam T The value type
+ */
+template <typename T>
+class CompressedMatrix {
+   public:
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    /**
+     * @brief Construct an empty matrix.
+     *
+     * @param format CSR or CSC
+     * @param n_rows Number of rows
+     * @param n_cols Number of columns
+     * @param ctx SOMAContext providing the thread pool, or nullptr to run
+     * on the calling thread
+     */
+    CompressedMatrix(
+        CompressedFormat format,
+        int64_t n_rows,
+        int64_t n_cols,
+        std::shared_ptr<SOMAContext> ctx = nullptr);
+
+    CompressedMatrix() = delete;
+    CompressedMatrix(const CompressedMatrix&) = delete;
+    CompressedMatrix(CompressedMatrix&&) = default;
+    ~CompressedMatrix() = default;
+
+    /**
+     * @brief Append a COO batch. The buffers are not copied.
+     *
+     * @param rows Row coordinates
+     * @param cols Column coordinates
+     * @param data Values
+     * @param size Number of cells
+     */
+    void append(
+        const int64_t* rows, const int64_t* cols, const T* data, size_t size);
+
+    /**
+     * @brief Append a COO batch read from a 2D sparse array. The batch is
+     * held until `compress()` returns.
+     *
+     * @param batch ArrayBuffers with `soma_dim_0`, `soma_dim_1` and
+     * `soma_data` columns
+     */
+    void append(std::shared_ptr<ArrayBuffers> batch);
+
+    /**
+     * @brief Assemble the appended batches. If the cells are already in
+     * major order (e.g. a `ResultOrder::rowmajor` read assembled as CSR)
+     * the counting sort is skipped and the buffers are copied in order.
+     */
+    void compress();
+
+    CompressedFormat format() const {
+        return format_;
+    }
+
+    int64_t n_rows() const {
+        return n_rows_;
+    }
+
+    int64_t n_cols() const {
+        return n_cols_;
+    }
+
+    /**
+     * @brief Return the number of stored cells.
+     */
+    size_t nnz() const {
+        return nnz_;
+    }
+
+    /**
+     * @brief Return true if `compress()` took the presorted fast path.
+     */
+    bool was_presorted() const {
+        return presorted_;
+    }
+
+    std::vector<int64_t>& indptr() {
+        return indptr_;
+    }
+
+    std::vector<int64_t>& indices() {
+        return indices_;
+    }
+
+    std::vector<T>& data() {
+        return data_;
+    }
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    struct Chunk {
+        const int64_t* rows;
+        const int64_t* cols;
+        const T* data;
+        size_t size;
+    };
+
+    /**
+     * @brief Check that all coordinates are in bounds and return true if
+     * the cells are sorted by (major, minor).
+     */
+    bool _scan();
+
+    /**
+     * @brief Copy presorted cells and count the major slices.
+     */
+    void _compress_sorted();
+
+    /**
+     * @brief Counting sort of the cells on the major axis.
+     */
+    void _compress_unsorted();
+
+    /**
+     * @brief Sort the minor indices within each major slice.
+     */
+    void _sort_minor();
+
+    /**
+     * @brief Run `fn(task, begin, end)` over `[0, size)` split into at most
+     * `num_tasks` contiguous slices on the context thread pool.
+     */
+    template <typename Fn>
+    void _parallel_for(size_t size, size_t num_tasks, Fn fn);
+
+    /**
+     * @brief Run `fn(pos, major, minor, value)` over the cells in
+     * `[begin, end)`, in append order.
+     */
+    template <typename Fn>
+    void _for_each_cell(size_t begin, size_t end, Fn fn) const;
+
+    /**
+     * @brief Return the maximum number of concurrent tasks.
+     */
+    size_t _concurrency() const;
+
+    CompressedFormat format_;
+    int64_t n_rows_;
+    int64_t n_cols_;
+    std::shared_ptr<SOMAContext> ctx_;
+
+    // Appended COO batches and the ArrayBuffers backing them
+    std::vector<Chunk> chunks_;
+    std::vector<std::shared_ptr<ArrayBuffers>> batches_;
+
+    // Position of the first cell of each chunk
+    std::vector<size_t> chunk_offsets_;
+
+    size_t nnz_ = 0;
+    bool presorted_ = false;
+
+    // Compressed result
+    std::vector<int64_t> indptr_;
+    std::vector<int64_t> indices_;
+    std::vector<T> data_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_COMPRESSED_MATRIX_H
@@ -0,0 +1,229 @@
+/**
+ * @file   dense_row_reader.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the DenseRowReader class.
+ */
+
+#include "dense_row_reader.h"
+#include <algorithm>
+#include <numeric>
+#include "../utils/logger.h"
+#include "joinid_sampler.h"
+
+namespace tiledbsoma {
+
+namespace {
+
+/**
+ * @brief Write the cells of a batch with selected rows to the output.
+ *
+ * @param sorted Selected joinids, sorted
+ * @param output_rows Output row of each sorted joinid
+ * @param present Set to 1 for each output row with a cell, if not nullptr
+ */
+template <typename T>
+void scatter(
+    std::shared_ptr<ArrayBuffers> batch,
+    const std::vector<int64_t>& sorted,
+    const std::vector<size_t>& output_rows,
+    int64_t col_origin,
+    int64_t n_cols,
+    T* out,
+    uint8_t* present) {
+    auto dim_0 = batch->at("soma_dim_0")->data<int64_t>();
+    auto dim_1 = batch->at("soma_dim_1")->data<int64_t>();
+    auto values = batch->at("soma_data")->values_as<T>();
+
+    // Cells of a row are adjacent in any read order, so the row is looked
+    // up once per run
+    int64_t joinid = 0;
+    T* row = nullptr;
+    for (size_t i = 0; i < dim_0.size(); ++i) {
+        if (i == 0 || dim_0[i] != joinid) {
+            joinid = dim_0[i];
+            auto it = std::lower_bound(sorted.begin(), sorted.end(), joinid);
+            row = nullptr;
+            if (it != sorted.end() && *it == joinid) {
+                auto output_row = output_rows[it - sorted.begin()];
+                row = out + output_row * n_cols;
+                if (present != nullptr) {
+                    present[output_row] = 1;
+                }
+            }
+        }
+        if (row != nullptr) {
+            row[dim_1[i] - col_origin] = values[i];
+        }
+    }
+}
+
+}  // namespace
+
+//===================================================================
+//= public static
+//===================================================================
+
+template <typename T>
+std::vector<T> DenseRowReader::read(
+    SOMAArray& array,
+    const std::vector<int64_t>& joinids,
+    std::vector<uint8_t>* present) {
+    auto domain = array.tiledb_schema()->domain();
+    if (domain.ndim() != 2 || !domain.has_dimension("soma_dim_0") ||
+        !domain.has_dimension("soma_dim_1") ||
+        !array.tiledb_schema()->has_attribute("soma_data")) {
+        throw TileDBSOMAError(fmt::format(
+            "[DenseRowReader] {} is not a 2D SOMA NDArray", array.uri()));
+    }
+    auto rows_dim = domain.dimension("soma_dim_0");
+    auto cols_dim = domain.dimension("soma_dim_1");
+    if (rows_dim.type() != TILEDB_INT64 || cols_dim.type() != TILEDB_INT64) {
+        throw TileDBSOMAError(fmt::format(
+            "[DenseRowReader] Dimensions must be int64, got {} and {}",
+            tiledb::impl::type_to_str(rows_dim.type()),
+            tiledb::impl::type_to_str(cols_dim.type())));
+    }
+
+    // Sort the selection, keeping the output row of each joinid
+    std::vector<size_t> output_rows(joinids.size());
+    std::iota(output_rows.begin(), output_rows.end(), 0);
+    std::sort(
+        output_rows.begin(), output_rows.end(), [&joinids](auto a, auto b) {
+            return joinids[a] < joinids[b];
+        });
+    std::vector<int64_t> sorted(joinids.size());
+    for (size_t i = 0; i < joinids.size(); ++i) {
+        sorted[i] = joinids[output_rows[i]];
+    }
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+        throw TileDBSOMAError("[DenseRowReader] Joinids must be unique");
+    }
+
+    auto col_origin = cols_dim.domain<int64_t>().first;
+    auto n_cols = array.shape()[1];
+    std::vector<T> result(joinids.size() * n_cols, 0);
+    if (present != nullptr) {
+        present->assign(joinids.size(), 0);
+    }
+    if (joinids.empty() || n_cols == 0) {
+        return result;
+    }
+
+    // A dense array is decoded in whole tiles, so each tile is read as one
+    // range, while a sparse array decodes the cells of the selected rows
+    // only, so runs of joinids are read apart unless a few rows separate
+    // them
+    auto extent = rows_dim.tile<int64_t>();
+    bool dense = array.tiledb_schema()->array_type() == TILEDB_DENSE;
+    auto ranges = JoinidSampler::tile_ranges(
+        JoinidBitmap::from_joinids(sorted),
+        rows_dim.domain<int64_t>().first,
+        extent,
+        dense ? extent : JoinidSampler::MAX_RANGE_GAP);
+
+    // Read contiguous slices of the ranges through separate handles on the
+    // context thread pool. The slices hold distinct rows, so the
+    // partitions write disjoint parts of the result.
+    auto& pool = array.ctx()->thread_pool();
+    size_t num_partitions = pool == nullptr ?
+                                1 :
+                                std::clamp<size_t>(
+                                    ranges.size() / MIN_RANGES_PER_PARTITION,
+                                    1,
+                                    pool->concurrency_level());
+    std::vector<std::exception_ptr> errors(num_partitions);
+    auto read_partition = [&](size_t p) {
+        try {
+            auto first = ranges.begin() + ranges.size() * p / num_partitions;
+            auto last = ranges.begin() +
+                        ranges.size() * (p + 1) / num_partitions;
+            auto reader = SOMAArray::open(
+                OpenMode::read,
+                array.uri(),
+                array.ctx(),
+                "",
+                {"soma_dim_0", "soma_dim_1", "soma_data"},
+                "auto",
+                ResultOrder::automatic,
+                array.timestamp());
+            reader->set_dim_ranges<int64_t>(
+                "soma_dim_0", std::vector(first, last));
+            reader->set_dim_ranges<int64_t>(
+                "soma_dim_1", {{col_origin, col_origin + n_cols - 1}});
+            while (auto batch = reader->read_next()) {
+                scatter(
+                    *batch,
+                    sorted,
+                    output_rows,
+                    col_origin,
+                    n_cols,
+                    result.data(),
+                    present == nullptr ? nullptr : present->data());
+            }
+            reader->close();
+        } catch (...) {
+            errors[p] = std::current_exception();
+        }
+    };
+    if (num_partitions == 1) {
+        read_partition(0);
+    } else {
+        std::vector<ThreadPool::Task> tasks;
+        for (size_t p = 0; p < num_partitions; ++p) {
+            tasks.emplace_back(pool->execute([&read_partition, p]() {
+                read_partition(p);
+                return Status::Ok();
+            }));
+        }
+        pool->wait_all(tasks);
+    }
+
+    // Every partition has finished, so the first error can be rethrown
+    for (const auto& error : errors) {
+        if (error != nullptr) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    LOG_DEBUG(fmt::format(
+        "[DenseRowReader] Read {} rows of {} columns in {} ranges and {} "
+        "partitions",
+        joinids.size(),
+        n_cols,
+        ranges.size(),
+        num_partitions));
+    return result;
+}
+
+template std::vector<float> DenseRowReader::read<float>(
+    SOMAArray&, const std::vector<int64_t>&, std::vector<uint8_t>*);
+template std::vector<double> DenseRowReader::read<double>(
+    SOMAArray&, const std::vector<int64_t>&, std::vector<uint8_t>*);
+
+}  // namespace tiledbsoma
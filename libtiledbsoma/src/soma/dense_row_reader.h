@@ -0,0 +1,91 @@
+/**
+ * @file   dense_row_reader.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the DenseRowReader class, which reads selected rows of
+ *   a 2D array, e.g. an obsm or varm embedding, into a dense row-major
+ *   matrix.
+ */
+
+#ifndef SOMA_DENSE_ROW_READER_H
+#define SOMA_DENSE_ROW_READER_H
+
+#include <vector>
+
+#include "soma_array.h"
+
+namespace tiledbsoma {
+
+/**
+ * @brief Read selected rows of a 2D SOMADenseNDArray or SOMASparseNDArray
+ * into a contiguous row-major matrix.
+ *
+ * The selected joinids are coalesced into ranges of `soma_dim_0` (see
+ * `JoinidSampler::tile_ranges`), one per tile of a dense array and one per
+ * run of joinids of a sparse array, which are split into partitions read
+ * on the context thread pool through their own handles. Each partition
+ * scatters its cells straight into the output as they are read, so the
+ * values are copied once, whatever the array type or read order. Cells
+ * that are not stored in a sparse array are zero.
+ */
+class DenseRowReader {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /**
+     * @brief Read the rows of the joinids for all columns of the array.
+     *
+     * @param array 2D array with int64 `soma_dim_0` and `soma_dim_1` and a
+     * numeric `soma_data`. It is not modified.
+     * @param joinids Distinct `soma_dim_0` coordinates, in output order
+     * @param present If not nullptr, set to 1 for each output row with at
+     * least one cell read and to 0 for the others, e.g. the rows of a
+     * sparse array with no stored cells
+     * @return std::vector<T> The (joinids.size(), shape()[1]) matrix in
+     * row-major order
+     */
+    template <typename T>
+    static std::vector<T> read(
+        SOMAArray& array,
+        const std::vector<int64_t>& joinids,
+        std::vector<uint8_t>* present = nullptr);
+
+   private:
+    //===================================================================
+    //= private static
+    //===================================================================
+
+    // Minimum number of tile ranges read by one partition
+    static constexpr size_t MIN_RANGES_PER_PARTITION = 16;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_DENSE_ROW_READER_H
@@ -0,0 +1,396 @@
+/**
+ * @file   disk_cache.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the DiskCache class.
+ */
+
+#include "disk_cache.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include "../utils/logger.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tiledbsoma {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char MAGIC[8] = {'S', 'O', 'M', 'A', 'D', 'C', '0', '1'};
+
+const std::string EXTENSION = ".batches";
+
+// Stable across processes, unlike std::hash, so entries can be shared
+std::string fnv1a(const std::string& value) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : value) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return fmt::format("{:016x}", hash);
+}
+
+template <typename T>
+void put_value(std::vector<uint8_t>& buffer, T value) {
+    auto bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+T get_value(const uint8_t* buffer, size_t size, size_t& offset) {
+    T value;
+    if (offset > size || size - offset < sizeof(T)) {
+        throw TileDBSOMAError("[DiskCache] entry truncated");
+    }
+    std::memcpy(&value, buffer + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+}
+
+#if !defined(_WIN32)
+
+// Private mapping of an entry, unmapped when the last batch viewing it is
+// released. Pages are copy-on-write, since Arrow conversion rewrites the
+// buffers in place, so the entry itself is never modified and may be
+// removed or replaced while mapped.
+struct Mapping {
+    Mapping(uint8_t* data, size_t size)
+        : data(data)
+        , size(size) {
+    }
+
+    ~Mapping() {
+        munmap(data, size);
+    }
+
+    uint8_t* data;
+    size_t size;
+};
+
+// Return the mapping of the entry, or nullptr if it cannot be read
+std::shared_ptr<Mapping> map_entry(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(
+            nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    return std::make_shared<Mapping>(static_cast<uint8_t*>(data), st.st_size);
+}
+
+#else
+
+// Copy of an entry, where it is not mapped
+struct Mapping {
+    std::vector<uint64_t> storage;  // 8-byte aligned
+    uint8_t* data;
+    size_t size;
+};
+
+// Return a copy of the entry, or nullptr if it cannot be read
+std::shared_ptr<Mapping> map_entry(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return nullptr;
+    }
+    auto mapping = std::make_shared<Mapping>();
+    mapping->size = file.tellg();
+    mapping->storage.resize((mapping->size + 7) / 8);
+    mapping->data = (uint8_t*)mapping->storage.data();
+    file.seekg(0);
+    file.read((char*)mapping->data, mapping->size);
+    if (!file) {
+        return nullptr;
+    }
+    return mapping;
+}
+
+#endif
+
+bool is_entry(const fs::directory_entry& entry) {
+    return entry.is_regular_file() &&
+           entry.path().extension().string() == EXTENSION;
+}
+
+}  // namespace
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+DiskCache::DiskCache(const std::string& directory, size_t capacity)
+    : directory_(directory)
+    , capacity_(capacity) {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    if (ec) {
+        throw TileDBSOMAError(fmt::format(
+            "[DiskCache] cannot create directory '{}': {}",
+            directory_,
+            ec.message()));
+    }
+}
+
+std::optional<std::vector<std::shared_ptr<ArrayBuffers>>> DiskCache::get(
+    const std::string& uri, const std::string& key) {
+    auto path = _path(uri, key);
+    auto mapping = map_entry(path);
+    if (!mapping) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        ++misses_;
+        return std::nullopt;
+    }
+    auto buffer = mapping->data;
+    auto size = mapping->size;
+
+    std::vector<std::shared_ptr<ArrayBuffers>> batches;
+    try {
+        size_t offset = 0;
+        if (size < sizeof(MAGIC) ||
+            std::memcmp(buffer, MAGIC, sizeof(MAGIC)) != 0) {
+            throw TileDBSOMAError("[DiskCache] not a cache entry");
+        }
+        offset += sizeof(MAGIC);
+        auto key_size = get_value<uint64_t>(buffer, size, offset);
+        if (key_size != key.size() || size - offset < key_size ||
+            std::memcmp(buffer + offset, key.data(), key_size) != 0) {
+            // A different read with the same file name
+            const std::lock_guard<std::mutex> lock(mutex_);
+            ++misses_;
+            return std::nullopt;
+        }
+        offset = (offset + key_size + 7) / 8 * 8;
+        auto num_batches = get_value<uint64_t>(buffer, size, offset);
+        for (uint64_t i = 0; i < num_batches; ++i) {
+            batches.push_back(ArrayBuffers::map(mapping, buffer, size, offset));
+        }
+    } catch (const TileDBSOMAError& e) {
+        LOG_WARN(fmt::format(
+            "[DiskCache] removing corrupt entry '{}': {}", path, e.what()));
+        std::error_code ec;
+        fs::remove(path, ec);
+        const std::lock_guard<std::mutex> lock(mutex_);
+        ++misses_;
+        return std::nullopt;
+    }
+
+    // Mark the entry most recently used for eviction
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+    LOG_DEBUG(fmt::format(
+        "[DiskCache] hit for '{}': {} batches, {} bytes",
+        uri,
+        batches.size(),
+        size));
+    const std::lock_guard<std::mutex> lock(mutex_);
+    ++hits_;
+    return batches;
+}
+
+bool DiskCache::put(
+    const std::string& uri,
+    const std::string& key,
+    const std::vector<std::shared_ptr<ArrayBuffers>>& batches) {
+    std::vector<uint8_t> buffer(MAGIC, MAGIC + sizeof(MAGIC));
+    put_value<uint64_t>(buffer, key.size());
+    buffer.insert(buffer.end(), key.begin(), key.end());
+    buffer.resize((buffer.size() + 7) / 8 * 8);
+    put_value<uint64_t>(buffer, batches.size());
+    try {
+        for (const auto& batch : batches) {
+            batch->serialize(buffer);
+            if (buffer.size() > capacity_) {
+                break;
+            }
+        }
+    } catch (const TileDBSOMAError& e) {
+        LOG_DEBUG(fmt::format("[DiskCache] skip '{}': {}", uri, e.what()));
+        return false;
+    }
+    if (buffer.size() > capacity_) {
+        LOG_DEBUG(fmt::format(
+            "[DiskCache] skip {} bytes of '{}', over the {} byte budget",
+            buffer.size(),
+            uri,
+            capacity_));
+        return false;
+    }
+
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto path = _path(uri, key);
+    std::error_code ec;
+    fs::remove(path, ec);
+    _evict(buffer.size());
+
+    // Write to a unique temporary name and rename, so readers in other
+    // processes never see a partial entry
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    auto tmp_path = fmt::format("{}.{:016x}.tmp", path, rng());
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        file.write((const char*)buffer.data(), buffer.size());
+        if (!file) {
+            file.close();
+            fs::remove(tmp_path, ec);
+            LOG_WARN(fmt::format("[DiskCache] cannot write '{}'", tmp_path));
+            return false;
+        }
+    }
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+    LOG_DEBUG(fmt::format(
+        "[DiskCache] wrote {} batches of '{}', {} bytes",
+        batches.size(),
+        uri,
+        buffer.size()));
+    return true;
+}
+
+void DiskCache::invalidate(const std::string& uri) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto prefix = fnv1a(uri) + "-";
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory_, ec)) {
+        if (is_entry(entry) &&
+            entry.path().filename().string().rfind(prefix, 0) == 0) {
+            fs::remove(entry.path(), ec);
+        }
+    }
+}
+
+void DiskCache::clear() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory_, ec)) {
+        // Also remove the temporary files of interrupted writes
+        if (is_entry(entry) || entry.path().extension() == ".tmp") {
+            fs::remove(entry.path(), ec);
+        }
+    }
+}
+
+size_t DiskCache::nbytes() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    size_t nbytes = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory_, ec)) {
+        if (is_entry(entry)) {
+            nbytes += entry.file_size(ec);
+        }
+    }
+    return nbytes;
+}
+
+size_t DiskCache::size() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    size_t size = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory_, ec)) {
+        size += is_entry(entry);
+    }
+    return size;
+}
+
+uint64_t DiskCache::hits() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+uint64_t DiskCache::misses() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+std::string DiskCache::_path(
+    const std::string& uri, const std::string& key) const {
+    return (fs::path(directory_) / (fnv1a(uri) + "-" + fnv1a(key) + EXTENSION))
+        .string();
+}
+
+void DiskCache::_evict(size_t incoming) {
+    struct File {
+        fs::file_time_type time;
+        size_t size;
+        fs::path path;
+    };
+    std::vector<File> files;
+    size_t nbytes = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory_, ec)) {
+        if (is_entry(entry)) {
+            File file{
+                entry.last_write_time(ec), entry.file_size(ec), entry.path()};
+            if (!ec) {
+                nbytes += file.size;
+                files.push_back(std::move(file));
+            }
+        }
+    }
+
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) {
+        return a.time < b.time;
+    });
+    for (const auto& file : files) {
+        if (nbytes + incoming <= capacity_) {
+            break;
+        }
+        LOG_DEBUG(fmt::format(
+            "[DiskCache] evict {} bytes of '{}'",
+            file.size,
+            file.path.string()));
+        fs::remove(file.path, ec);
+        nbytes -= file.size;
+    }
+}
+
+}  // namespace tiledbsoma
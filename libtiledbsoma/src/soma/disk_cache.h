@@ -0,0 +1,176 @@
+/**
+ * @file   disk_cache.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the DiskCache class, a cache of read results in a
+ *   local scratch directory.
+ */
+
+#ifndef SOMA_DISK_CACHE
+#define SOMA_DISK_CACHE
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "array_buffers.h"
+
+namespace tiledbsoma {
+
+/**
+ * @brief A cache of the result batches of complete reads in a local scratch
+ * directory, bounded by a byte budget. It backs up the in-memory
+ * `ResultCache` for reads repeated across epochs or processes, e.g. the same
+ * X selection read by every epoch of a training run.
+ *
+ * Each read is stored in one file named after the array URI and the read
+ * fingerprint (see `SOMAArray::read_next`). Batches are serialized with
+ * `ArrayBuffers::serialize`, so the files hold the decoded cells with
+ * 8-byte aligned buffers, and hits are mapped rather than read: the
+ * returned batches view the mapping, which is released with the last of
+ * them.
+ * Files are written to a temporary name and renamed, so several processes
+ * may share a directory. The least recently used files are removed when
+ * the budget is exceeded.
+ */
+class DiskCache {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    // Config key setting the scratch directory of the context disk cache.
+    // The cache is disabled if the key is absent.
+    inline static const std::string
+        CONFIG_KEY_DIR = "soma.read.disk_cache_dir";
+
+    // Config key setting the byte budget of the context disk cache. The
+    // cache is disabled if the key is absent or zero.
+    inline static const std::string
+        CONFIG_KEY_BYTES = "soma.read.disk_cache_bytes";
+
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    /**
+     * @brief Construct a DiskCache, creating its directory if needed.
+     *
+     * @param directory Scratch directory
+     * @param capacity Byte budget of the cache
+     */
+    DiskCache(const std::string& directory, size_t capacity);
+
+    DiskCache() = delete;
+    DiskCache(const DiskCache&) = delete;
+    DiskCache(DiskCache&&) = delete;
+    ~DiskCache() = default;
+
+    /**
+     * @brief Return the batches cached for `key` and mark the entry most
+     * recently used, or std::nullopt on a miss. The batches view a private
+     * mapping of the entry, which stays valid if the entry is evicted.
+     *
+     * @param uri URI of the array read
+     * @param key Read fingerprint
+     */
+    std::optional<std::vector<std::shared_ptr<ArrayBuffers>>> get(
+        const std::string& uri, const std::string& key);
+
+    /**
+     * @brief Write the batches of a complete read, removing least recently
+     * used entries to stay within the byte budget. Results larger than the
+     * budget, and results with enumerated columns, are not cached.
+     *
+     * @param uri URI of the array read
+     * @param key Read fingerprint
+     * @param batches Result batches
+     * @return true if the batches were cached
+     */
+    bool put(
+        const std::string& uri,
+        const std::string& key,
+        const std::vector<std::shared_ptr<ArrayBuffers>>& batches);
+
+    /**
+     * @brief Remove all entries of an array, e.g. after a write.
+     *
+     * @param uri URI of the array
+     */
+    void invalidate(const std::string& uri);
+
+    /**
+     * @brief Remove all entries.
+     */
+    void clear();
+
+    const std::string& directory() const {
+        return directory_;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    size_t nbytes();
+
+    size_t size();
+
+    uint64_t hits();
+
+    uint64_t misses();
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    // Path of the entry file of a read
+    std::string _path(const std::string& uri, const std::string& key) const;
+
+    // Remove least recently used entries until `incoming` more bytes fit in
+    // the budget, the caller holds `mutex_`
+    void _evict(size_t incoming);
+
+    // Scratch directory
+    std::string directory_;
+
+    // Byte budget
+    size_t capacity_;
+
+    // Lookup statistics
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+
+    std::mutex mutex_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_DISK_CACHE
@@ -0,0 +1,164 @@
+/**
+ * @file   graph_traversal.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the GraphTraversal class.
+ */
+
+#include "graph_traversal.h"
+#include "../reindexer/reindexer.h"
+#include "../utils/logger.h"
+#include "compressed_matrix.h"
+
+namespace tiledbsoma {
+
+//===================================================================
+//= public static
+//===================================================================
+
+Neighborhood GraphTraversal::k_hop(
+    SOMAArray& graph, const JoinidBitmap& seeds, uint32_t hops, bool subgraph) {
+    auto schema = graph.tiledb_schema();
+    auto domain = schema->domain();
+    if (schema->array_type() != TILEDB_SPARSE || domain.ndim() != 2 ||
+        !domain.has_dimension("soma_dim_0") ||
+        !domain.has_dimension("soma_dim_1")) {
+        throw TileDBSOMAError(fmt::format(
+            "[GraphTraversal] {} is not a 2D SOMASparseNDArray", graph.uri()));
+    }
+
+    // Each level holds the nodes first reached at its hop
+    Edges edges;
+    JoinidBitmap visited = seeds;
+    JoinidBitmap frontier = seeds;
+    std::vector<JoinidBitmap> levels = {seeds};
+    for (uint32_t hop = 1; hop <= hops && !frontier.empty(); ++hop) {
+        auto neighbors = _read_rows(
+            graph, frontier, nullptr, subgraph ? &edges : nullptr);
+        frontier = neighbors - visited;
+        visited |= frontier;
+        levels.push_back(frontier);
+    }
+
+    Neighborhood result;
+    result.joinids = visited.to_joinids();
+    size_t n = result.joinids.size();
+    if (n == 0) {
+        if (subgraph) {
+            result.indptr = {0};
+        }
+        return result;
+    }
+    IntIndexer indexer(graph.ctx());
+    indexer.map_locations(result.joinids);
+
+    result.hops.resize(n);
+    for (size_t hop = 0; hop < levels.size(); ++hop) {
+        auto joinids = levels[hop].to_joinids();
+        std::vector<int64_t> positions(joinids.size());
+        indexer.lookup(joinids.data(), positions.data(), joinids.size());
+        for (auto position : positions) {
+            result.hops[position] = hop;
+        }
+    }
+    if (!subgraph) {
+        return result;
+    }
+
+    // Every node was reached from a row already read, except the last
+    // frontier, whose rows are read for the edges between found nodes only
+    if (!frontier.empty()) {
+        _read_rows(graph, frontier, &visited, &edges);
+    }
+
+    size_t nnz = edges.data.size();
+    std::vector<int64_t> rows(nnz), cols(nnz);
+    indexer.lookup(edges.rows.data(), rows.data(), nnz);
+    indexer.lookup(edges.cols.data(), cols.data(), nnz);
+
+    CompressedMatrix<double> matrix(CompressedFormat::csr, n, n, graph.ctx());
+    matrix.append(rows.data(), cols.data(), edges.data.data(), nnz);
+    matrix.compress();
+    result.indptr = std::move(matrix.indptr());
+    result.indices = std::move(matrix.indices());
+    result.data = std::move(matrix.data());
+
+    LOG_DEBUG(fmt::format(
+        "[GraphTraversal] {} hops from {} seeds reached {} nodes with {} "
+        "edges",
+        levels.size() - 1,
+        seeds.cardinality(),
+        n,
+        result.data.size()));
+    return result;
+}
+
+//===================================================================
+//= private static
+//===================================================================
+
+JoinidBitmap GraphTraversal::_read_rows(
+    SOMAArray& graph,
+    const JoinidBitmap& rows,
+    const JoinidBitmap* cols,
+    Edges* edges) {
+    std::vector<std::string> column_names = {"soma_dim_1"};
+    if (edges != nullptr) {
+        column_names = {"soma_dim_0", "soma_dim_1", "soma_data"};
+    }
+    auto reader = SOMAArray::open(
+        OpenMode::read,
+        graph.uri(),
+        graph.ctx(),
+        "",
+        column_names,
+        "auto",
+        ResultOrder::automatic,
+        graph.timestamp());
+    reader->set_dim_joinids("soma_dim_0", rows);
+    if (cols != nullptr) {
+        reader->set_dim_joinids("soma_dim_1", *cols);
+    }
+
+    JoinidBitmap neighbors;
+    while (auto batch = reader->read_next()) {
+        auto dim_1 = (*batch)->at("soma_dim_1")->data<int64_t>();
+        neighbors |= JoinidBitmap::from_joinids(dim_1.data(), dim_1.size());
+        if (edges != nullptr) {
+            auto dim_0 = (*batch)->at("soma_dim_0")->data<int64_t>();
+            edges->rows.insert(edges->rows.end(), dim_0.begin(), dim_0.end());
+            edges->cols.insert(edges->cols.end(), dim_1.begin(), dim_1.end());
+            auto data = (*batch)->at("soma_data")->values_as<double>();
+            edges->data.insert(edges->data.end(), data.begin(), data.end());
+        }
+    }
+    reader->close();
+    return neighbors;
+}
+
+}  // namespace tiledbsoma
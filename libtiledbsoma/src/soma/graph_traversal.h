@@ -0,0 +1,135 @@
+/**
+ * @file   graph_traversal.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the GraphTraversal class, which expands k-hop
+ *   neighborhoods and extracts induced subgraphs of a graph stored as a 2D
+ *   sparse array, e.g. obsp["connectivities"].
+ */
+
+#ifndef SOMA_GRAPH_TRAVERSAL_H
+#define SOMA_GRAPH_TRAVERSAL_H
+
+#include <vector>
+
+#include "../utils/joinid_bitmap.h"
+#include "soma_array.h"
+
+namespace tiledbsoma {
+
+/**
+ * @brief Nodes of a neighborhood and the CSR adjacency of the subgraph they
+ * induce. Row and column i of the adjacency is `joinids[i]`.
+ */
+struct Neighborhood {
+    // Nodes, ascending
+    std::vector<int64_t> joinids;
+
+    // Hop at which each node was reached, 0 for the seeds
+    std::vector<uint32_t> hops;
+
+    // (n, n) CSR adjacency with the edge values as double. Empty if the
+    // subgraph was not requested.
+    std::vector<int64_t> indptr;
+    std::vector<int64_t> indices;
+    std::vector<double> data;
+};
+
+/**
+ * @brief Traversal of a graph stored as a 2D SOMASparseNDArray, with an
+ * edge from `soma_dim_0` to `soma_dim_1` for each stored cell.
+ *
+ * Each hop reads the rows of its whole frontier with a single query, the
+ * frontier being a JoinidBitmap added as coalesced subarray ranges. The
+ * edges read while expanding are kept, so extracting the induced subgraph
+ * only reads the rows of the last frontier, restricted to the nodes found.
+ */
+class GraphTraversal {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /**
+     * @brief Expand the neighborhood of the seeds up to `hops` edges away.
+     *
+     * @param graph 2D sparse array. It is not modified: rows are read
+     * through new handles.
+     * @param seeds Nodes to start from
+     * @param hops Maximum number of edges from the seeds
+     * @param subgraph If true, also extract the induced subgraph
+     * @return Neighborhood
+     */
+    static Neighborhood k_hop(
+        SOMAArray& graph,
+        const JoinidBitmap& seeds,
+        uint32_t hops,
+        bool subgraph = true);
+
+    /**
+     * @brief Extract the subgraph induced by a set of nodes.
+     *
+     * @param graph 2D sparse array. It is not modified.
+     * @param nodes Nodes of the subgraph
+     * @return Neighborhood The nodes, all at hop 0, and their adjacency
+     */
+    static Neighborhood induced_subgraph(
+        SOMAArray& graph, const JoinidBitmap& nodes) {
+        return k_hop(graph, nodes, 0, true);
+    }
+
+   private:
+    //===================================================================
+    //= private static
+    //===================================================================
+
+    // Edges read from the graph, in COO form
+    struct Edges {
+        std::vector<int64_t> rows;
+        std::vector<int64_t> cols;
+        std::vector<double> data;
+    };
+
+    /**
+     * @brief Read the edges of some rows, optionally restricted to some
+     * columns.
+     *
+     * @param cols Columns to read, or nullptr for all columns
+     * @param edges Edges to append to, or nullptr to read only `soma_dim_1`
+     * @return JoinidBitmap The columns of the edges read
+     */
+    static JoinidBitmap _read_rows(
+        SOMAArray& graph,
+        const JoinidBitmap& rows,
+        const JoinidBitmap* cols,
+        Edges* edges);
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_GRAPH_TRAVERSAL_H
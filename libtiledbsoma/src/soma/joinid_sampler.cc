@@ -0,0 +1,399 @@
+/**
+ * @file   joinid_sampler.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the JoinidSampler class.
+ */
+
+#include "joinid_sampler.h"
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <unordered_set>
+#include "../reindexer/reindexer.h"
+#include "../utils/logger.h"
+
+namespace tiledbsoma {
+
+//===================================================================
+//= public static
+//===================================================================
+
+std::vector<int64_t> JoinidSampler::uniform(
+    const JoinidBitmap& population, size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    auto ranges = population.to_ranges();
+
+    // Cumulative number of joinids before each range, to map positions in
+    // the population back to joinids
+    std::vector<uint64_t> starts(ranges.size());
+    uint64_t total = 0;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        starts[i] = total;
+        total += ranges[i].second - ranges[i].first + 1;
+    }
+
+    auto positions = _sample_positions(total, n, rng);
+    std::vector<int64_t> sample(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        auto range = std::upper_bound(
+                         starts.begin(), starts.end(), positions[i]) -
+                     starts.begin() - 1;
+        sample[i] = ranges[range].first + (positions[i] - starts[range]);
+    }
+    LOG_DEBUG(fmt::format(
+        "[JoinidSampler] Sampled {} of {} joinids", sample.size(), total));
+    return sample;
+}
+
+JoinidBitmap JoinidSampler::non_empty_joinids(
+    SOMAArray& array, const std::string& dim) {
+    JoinidBitmap joinids;
+    if (array.nnz() > 0) {
+        auto [lower, upper] = array.non_empty_domain<int64_t>(dim);
+        joinids.add_range(lower, upper);
+    }
+    return joinids;
+}
+
+std::vector<int64_t> JoinidSampler::stratified(
+    SOMAArray& array,
+    const std::string& column,
+    size_t n,
+    uint64_t seed,
+    std::optional<JoinidBitmap> population) {
+    auto reader = SOMAArray::open(
+        OpenMode::read,
+        array.uri(),
+        array.ctx(),
+        "",
+        {"soma_joinid", column},
+        "auto",
+        ResultOrder::automatic,
+        array.timestamp());
+    if (population.has_value() &&
+        reader->tiledb_schema()->domain().has_dimension("soma_joinid")) {
+        reader->set_dim_joinids("soma_joinid", *population);
+    }
+
+    // Joinids of each stratum, keyed by validity and the value bytes. An
+    // ordered map keeps the sample deterministic for a given seed.
+    std::map<std::pair<bool, std::string>, std::vector<int64_t>> strata;
+    while (auto batch = reader->read_next()) {
+        auto joinids = (*batch)->at("soma_joinid")->data<int64_t>();
+        auto values = (*batch)->at(column);
+        auto value_size = values->is_var() ?
+                              0 :
+                              tiledb::impl::type_size(values->type());
+        auto bytes = values->is_var() ? nullptr :
+                                        values->data<char>().data();
+        for (size_t i = 0; i < joinids.size(); ++i) {
+            if (population.has_value() && !population->contains(joinids[i])) {
+                continue;
+            }
+            if (values->is_nullable() && !values->validity()[i]) {
+                strata[{false, ""}].push_back(joinids[i]);
+            } else if (values->is_var()) {
+                strata[{true, std::string(values->string_view(i))}]
+                    .push_back(joinids[i]);
+            } else {
+                strata[{true,
+                        std::string(bytes + i * value_size, value_size)}]
+                    .push_back(joinids[i]);
+            }
+        }
+    }
+    reader->close();
+
+    std::vector<uint64_t> sizes;
+    uint64_t total = 0;
+    for (const auto& [key, joinids] : strata) {
+        sizes.push_back(joinids.size());
+        total += joinids.size();
+    }
+    n = std::min<uint64_t>(n, total);
+
+    // Largest remainder apportionment of the sample over the strata
+    std::vector<uint64_t> quotas;
+    std::vector<std::pair<long double, size_t>> remainders;
+    uint64_t allocated = 0;
+    for (auto size : sizes) {
+        auto share = static_cast<long double>(n) * size / total;
+        quotas.push_back(
+            std::min<uint64_t>(static_cast<uint64_t>(share), size));
+        remainders.emplace_back(share - quotas.back(), remainders.size());
+        allocated += quotas.back();
+    }
+    std::stable_sort(
+        remainders.begin(), remainders.end(), [](auto& a, auto& b) {
+            return a.first > b.first;
+        });
+    for (size_t i = 0; allocated < n && i < remainders.size(); ++i) {
+        auto stratum = remainders[i].second;
+        if (quotas[stratum] < sizes[stratum]) {
+            quotas[stratum]++;
+            allocated++;
+        }
+    }
+
+    std::mt19937_64 rng(seed);
+    std::vector<int64_t> sample;
+    sample.reserve(n);
+    size_t stratum = 0;
+    for (const auto& [key, joinids] : strata) {
+        for (auto position :
+             _sample_positions(joinids.size(), quotas[stratum++], rng)) {
+            sample.push_back(joinids[position]);
+        }
+    }
+    std::shuffle(sample.begin(), sample.end(), rng);
+    LOG_DEBUG(fmt::format(
+        "[JoinidSampler] Sampled {} of {} joinids from {} strata of {}",
+        sample.size(),
+        total,
+        strata.size(),
+        column));
+    return sample;
+}
+
+std::vector<std::pair<int64_t, int64_t>> JoinidSampler::tile_ranges(
+    const JoinidBitmap& joinids,
+    int64_t origin,
+    int64_t extent,
+    int64_t max_gap) {
+    if (extent <= 0) {
+        throw TileDBSOMAError(fmt::format(
+            "[JoinidSampler] Tile extent must be positive, got {}", extent));
+    }
+    if (max_gap < 0) {
+        throw TileDBSOMAError(fmt::format(
+            "[JoinidSampler] Range gap must be non-negative, got {}",
+            max_gap));
+    }
+    std::vector<std::pair<int64_t, int64_t>> ranges;
+    for (auto [start, end] : joinids.to_ranges()) {
+        auto tile = (start - origin) / extent;
+        if (!ranges.empty() &&
+            (ranges.back().second - origin) / extent == tile &&
+            start - ranges.back().second - 1 <= max_gap) {
+            ranges.back().second = end;
+        } else {
+            ranges.emplace_back(start, end);
+        }
+        // Split runs spanning several tiles at the tile bounds
+        auto last = ranges.back().second;
+        auto tile_end = origin + (tile + 1) * extent - 1;
+        while (last > tile_end) {
+            ranges.back().second = tile_end;
+            ranges.emplace_back(tile_end + 1, last);
+            tile_end += extent;
+        }
+    }
+    return ranges;
+}
+
+SampledRows JoinidSampler::read(
+    SOMAArray& array,
+    const std::string& dim,
+    std::vector<int64_t> joinids,
+    std::vector<std::string> column_names) {
+    auto dimension = array.tiledb_schema()->domain().dimension(dim);
+    if (dimension.type() != TILEDB_INT64) {
+        throw TileDBSOMAError(fmt::format(
+            "[JoinidSampler] Dimension {} must be int64, got {}",
+            dim,
+            tiledb::impl::type_to_str(dimension.type())));
+    }
+    auto sorted = JoinidBitmap::from_joinids(joinids);
+    if (sorted.cardinality() != joinids.size()) {
+        throw TileDBSOMAError("[JoinidSampler] Sampled joinids must be unique");
+    }
+    if (!column_names.empty() &&
+        std::find(column_names.begin(), column_names.end(), dim) ==
+            column_names.end()) {
+        column_names.push_back(dim);
+    }
+
+    SampledRows result;
+    result.joinids = std::move(joinids);
+    if (result.joinids.empty()) {
+        return result;
+    }
+
+    auto ranges = tile_ranges(
+        sorted,
+        dimension.domain<int64_t>().first,
+        dimension.tile<int64_t>(),
+        MAX_RANGE_GAP);
+
+    // Position of each joinid in the sample. The partitions already run on
+    // the context thread pool, so the lookups of each stay on its thread.
+    IntIndexer indexer;
+    indexer.map_locations(result.joinids);
+
+    // The sampled rows read by a partition, and their sample positions
+    struct Partition {
+        std::vector<std::shared_ptr<ArrayBuffers>> batches;
+        std::vector<int64_t> positions;
+        size_t num_rows_read = 0;
+    };
+
+    // Read contiguous slices of the ranges through separate handles on the
+    // context thread pool, so the partitions are submitted to TileDB
+    // concurrently
+    auto& pool = array.ctx()->thread_pool();
+    size_t num_partitions = pool == nullptr ?
+                                1 :
+                                std::clamp<size_t>(
+                                    ranges.size() / MIN_RANGES_PER_PARTITION,
+                                    1,
+                                    pool->concurrency_level());
+    std::vector<Partition> partitions(num_partitions);
+    std::vector<std::exception_ptr> errors(num_partitions);
+    auto read_partition = [&](size_t p) {
+        try {
+            auto first = ranges.begin() + ranges.size() * p / num_partitions;
+            auto last = ranges.begin() +
+                        ranges.size() * (p + 1) / num_partitions;
+            auto reader = SOMAArray::open(
+                OpenMode::read,
+                array.uri(),
+                array.ctx(),
+                "",
+                column_names,
+                "auto",
+                ResultOrder::automatic,
+                array.timestamp());
+            reader->set_dim_ranges<int64_t>(dim, std::vector(first, last));
+            auto& partition = partitions[p];
+            std::vector<int64_t> positions, rows;
+            while (auto batch = reader->read_next()) {
+                // Drop the unsampled rows of the bridged gaps
+                auto values = (*batch)->at(dim)->data<int64_t>();
+                positions.resize(values.size());
+                indexer.lookup(values.data(), positions.data(), values.size());
+                rows.clear();
+                for (size_t row = 0; row < values.size(); ++row) {
+                    if (positions[row] >= 0) {
+                        rows.push_back(row);
+                        partition.positions.push_back(positions[row]);
+                    }
+                }
+                partition.num_rows_read += values.size();
+                if (rows.empty()) {
+                    continue;
+                }
+                partition.batches.push_back(
+                    rows.size() == values.size() ? *batch :
+                                                   (*batch)->take(rows));
+            }
+            reader->close();
+        } catch (...) {
+            errors[p] = std::current_exception();
+        }
+    };
+    if (num_partitions == 1) {
+        read_partition(0);
+    } else {
+        std::vector<ThreadPool::Task> tasks;
+        for (size_t p = 0; p < num_partitions; ++p) {
+            tasks.emplace_back(pool->execute([&read_partition, p]() {
+                read_partition(p);
+                return Status::Ok();
+            }));
+        }
+        pool->wait_all(tasks);
+    }
+
+    // Every partition has finished, so the first error can be rethrown
+    for (const auto& error : errors) {
+        if (error != nullptr) {
+            std::rethrow_exception(error);
+        }
+    }
+    std::vector<int64_t> positions;
+    size_t num_rows_read = 0;
+    for (auto& partition : partitions) {
+        result.batches.insert(
+            result.batches.end(),
+            partition.batches.begin(),
+            partition.batches.end());
+        positions.insert(
+            positions.end(),
+            partition.positions.begin(),
+            partition.positions.end());
+        num_rows_read += partition.num_rows_read;
+    }
+
+    // Counting sort of the rows by sample position, stable so the cells of
+    // a sparse array row keep their read order
+    std::vector<int64_t> starts(result.joinids.size() + 1, 0);
+    for (auto position : positions) {
+        starts[position + 1]++;
+    }
+    std::partial_sum(starts.begin(), starts.end(), starts.begin());
+    result.permutation.resize(positions.size());
+    for (size_t row = 0; row < positions.size(); ++row) {
+        result.permutation[starts[positions[row]]++] = row;
+    }
+    LOG_DEBUG(fmt::format(
+        "[JoinidSampler] Kept {} of {} rows read for {} joinids in {} ranges",
+        positions.size(),
+        num_rows_read,
+        result.joinids.size(),
+        ranges.size()));
+    return result;
+}
+
+//===================================================================
+//= private static
+//===================================================================
+
+std::vector<uint64_t> JoinidSampler::_sample_positions(
+    uint64_t n, uint64_t k, std::mt19937_64& rng) {
+    std::vector<uint64_t> positions;
+    if (k >= n) {
+        positions.resize(n);
+        std::iota(positions.begin(), positions.end(), 0);
+    } else {
+        // Floyd's algorithm: k draws whatever the population size
+        std::unordered_set<uint64_t> selected;
+        selected.reserve(k);
+        positions.reserve(k);
+        for (uint64_t j = n - k; j < n; ++j) {
+            auto t = std::uniform_int_distribution<uint64_t>(0, j)(rng);
+            auto position = selected.insert(t).second ? t : j;
+            selected.insert(position);
+            positions.push_back(position);
+        }
+    }
+    std::shuffle(positions.begin(), positions.end(), rng);
+    return positions;
+}
+
+}  // namespace tiledbsoma
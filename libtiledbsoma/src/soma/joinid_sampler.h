@@ -0,0 +1,177 @@
+/**
+ * @file   joinid_sampler.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the JoinidSampler class, which draws uniform or
+ *   stratified random samples of soma_joinids and reads the sampled rows of
+ *   an array with few, coalesced ranges.
+ */
+
+#ifndef SOMA_JOINID_SAMPLER_H
+#define SOMA_JOINID_SAMPLER_H
+
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "../utils/joinid_bitmap.h"
+#include "array_buffers.h"
+#include "soma_array.h"
+
+namespace tiledbsoma {
+
+/**
+ * @brief The rows of a sample read by `JoinidSampler::read`.
+ */
+struct SampledRows {
+    // Sampled soma_joinids, in sample order
+    std::vector<int64_t> joinids;
+
+    // Result batches, holding only the rows of sampled joinids
+    std::vector<std::shared_ptr<ArrayBuffers>> batches;
+
+    // Rows of the concatenated batches, grouped in sample order. Taking
+    // these rows reorders the batches.
+    std::vector<int64_t> permutation;
+};
+
+class JoinidSampler {
+   public:
+    // Largest gap of unsampled joinids bridged between two runs of sampled
+    // joinids by `read`, trading a few unselected rows for fewer ranges
+    static constexpr int64_t MAX_RANGE_GAP = 16;
+
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /**
+     * @brief Draw a uniform random sample of distinct soma_joinids. The
+     * cost is linear in the sample size and in the number of ranges of the
+     * population, not in its cardinality.
+     *
+     * @param population Joinids to sample from, e.g. the non-empty domain of
+     * a dataframe or the obs joinids of an axis query
+     * @param n Sample size. The whole population is returned, shuffled, if
+     * it has at most n joinids.
+     * @param seed Random seed
+     * @return std::vector<int64_t> The sample, in random order
+     */
+    static std::vector<int64_t> uniform(
+        const JoinidBitmap& population, size_t n, uint64_t seed);
+
+    /**
+     * @brief Return the joinids spanned by the non-empty domain of an int64
+     * dimension, e.g. to sample uniformly from the rows of an array. It is
+     * empty if the array is.
+     */
+    static JoinidBitmap non_empty_joinids(
+        SOMAArray& array, const std::string& dim);
+
+    /**
+     * @brief Draw a random sample of distinct soma_joinids, stratified by
+     * the values of a column. Each value gets a share of the sample
+     * proportional to its number of rows, rounded with the largest
+     * remainder method. Null is a value of its own.
+     *
+     * @param array Array with a `soma_joinid` column, e.g. obs. It is not
+     * modified: the column is read through a new handle.
+     * @param column Column to stratify by
+     * @param n Sample size
+     * @param seed Random seed
+     * @param population Optional joinids to sample from. All rows are
+     * sampled from if not given.
+     * @return std::vector<int64_t> The sample, in random order
+     */
+    static std::vector<int64_t> stratified(
+        SOMAArray& array,
+        const std::string& column,
+        size_t n,
+        uint64_t seed,
+        std::optional<JoinidBitmap> population = std::nullopt);
+
+    /**
+     * @brief Return the ranges covering the runs of consecutive joinids,
+     * split at space tile bounds. Runs in the same tile are merged when at
+     * most `max_gap` joinids separate them, so the ranges select at most
+     * `max_gap` unsampled joinids per run, while a sparse array still
+     * decodes only the cells of the selected rows.
+     *
+     * @param joinids Joinids to cover
+     * @param origin Lower bound of the dimension domain
+     * @param extent Tile extent of the dimension
+     * @param max_gap Largest number of unsampled joinids between two merged
+     * runs
+     */
+    static std::vector<std::pair<int64_t, int64_t>> tile_ranges(
+        const JoinidBitmap& joinids,
+        int64_t origin,
+        int64_t extent,
+        int64_t max_gap);
+
+    /**
+     * @brief Read the rows of the sampled joinids of an int64 dimension.
+     * The joinids are coalesced into ranges (see `tile_ranges`), which are
+     * split into partitions read on the context thread pool through their
+     * own handles.
+     * Each partition drops the unsampled rows of its batches before they
+     * are kept.
+     *
+     * @param array Array to read. It is not modified.
+     * @param dim Int64 dimension the joinids belong to
+     * @param joinids Distinct joinids, in sample order
+     * @param column_names Columns to read, or all columns if empty. `dim`
+     * is added if missing.
+     * @return SampledRows The batches and the permutation restoring the
+     * sample order
+     */
+    static SampledRows read(
+        SOMAArray& array,
+        const std::string& dim,
+        std::vector<int64_t> joinids,
+        std::vector<std::string> column_names = {});
+
+   private:
+    //===================================================================
+    //= private static
+    //===================================================================
+
+    // Minimum number of tile ranges read by one partition
+    static constexpr size_t MIN_RANGES_PER_PARTITION = 64;
+
+    /**
+     * @brief Return k distinct positions in [0, n) in random order, with
+     * Floyd's algorithm.
+     */
+    static std::vector<uint64_t> _sample_positions(
+        uint64_t n, uint64_t k, std::mt19937_64& rng);
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_JOINID_SAMPLER_H
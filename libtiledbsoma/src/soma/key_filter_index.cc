@@ -0,0 +1,497 @@
+/**
+ * @file   key_filter_index.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the KeyFilterIndex class.
+ */
+
+#include "key_filter_index.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include "../utils/logger.h"
+#include "nlohmann/json.hpp"
+
+namespace tiledbsoma {
+
+using json = nlohmann::json;
+
+//===================================================================
+//= public static
+//===================================================================
+
+void KeyFilterIndex::create(
+    SOMAArray& df,
+    std::string_view index_uri,
+    const std::vector<std::string>& column_names,
+    double fpp) {
+    if (column_names.empty()) {
+        throw TileDBSOMAError("[KeyFilterIndex] No columns to index");
+    }
+    auto df_domain = df.tiledb_schema()->domain();
+    for (const auto& name : column_names) {
+        if (!df_domain.has_dimension(name) ||
+            df_domain.dimension(name).cell_val_num() != TILEDB_VAR_NUM) {
+            throw TileDBSOMAError(fmt::format(
+                "[KeyFilterIndex] '{}' is not a string index column of '{}'",
+                name,
+                df.uri()));
+        }
+    }
+    // Validates the rate before anything is created
+    BloomFilter::for_capacity(1, fpp);
+
+    auto tiledb_ctx = df.ctx()->tiledb_ctx();
+    Domain domain(*tiledb_ctx);
+    domain.add_dimension(Dimension::create(
+        *tiledb_ctx, "soma_column", TILEDB_STRING_ASCII, nullptr, nullptr));
+    domain.add_dimension(Dimension::create<int64_t>(
+        *tiledb_ctx,
+        "soma_write",
+        {0, std::numeric_limits<int64_t>::max() - 1}));
+    ArraySchema schema(*tiledb_ctx, TILEDB_SPARSE);
+    schema.set_domain(domain);
+    auto filter = Attribute::create<uint8_t>(*tiledb_ctx, "soma_filter");
+    filter.set_cell_val_num(TILEDB_VAR_NUM);
+    schema.add_attribute(filter);
+    schema.add_attribute(
+        Attribute::create<uint64_t>(*tiledb_ctx, "soma_fragment_start"));
+    schema.add_attribute(
+        Attribute::create<uint64_t>(*tiledb_ctx, "soma_fragment_end"));
+    // Processes writing at the same nanosecond keep both filters
+    schema.set_allows_dups(true);
+    schema.check();
+
+    auto index = SOMAArray::create(
+        df.ctx(), index_uri, schema, "SOMAKeyFilterIndex", df.timestamp());
+    std::string indexed_columns = json(column_names).dump();
+    index->set_metadata(
+        INDEXED_COLUMNS_KEY,
+        TILEDB_STRING_UTF8,
+        static_cast<uint32_t>(indexed_columns.length()),
+        indexed_columns.c_str());
+    index->set_metadata(FPP_KEY, TILEDB_FLOAT64, 1, &fpp);
+
+    // Add one filter of the current keys, tied to all current fragments
+    auto fragments = _fragments(df, df.timestamp());
+    if (!fragments.empty()) {
+        TimestampRange covered = fragments.front();
+        for (const auto& fragment : fragments) {
+            covered.first = std::min(covered.first, fragment.first);
+            covered.second = std::max(covered.second, fragment.second);
+        }
+        _write(
+            *index,
+            _build(df, column_names, fpp, df.timestamp()),
+            covered);
+    }
+    index->close();
+
+    LOG_DEBUG(fmt::format(
+        "[KeyFilterIndex] Created '{}' of {} columns of {} fragments of '{}'",
+        index_uri,
+        column_names.size(),
+        fragments.size(),
+        df.uri()));
+}
+
+void KeyFilterIndex::update(
+    std::shared_ptr<SOMAContext> ctx,
+    std::string_view index_uri,
+    ArrayBuffers& cells,
+    const TimestampRange& fragment,
+    std::optional<TimestampRange> timestamp) {
+    if (cells.num_rows() == 0) {
+        return;
+    }
+
+    auto index = SOMAArray::open(
+        OpenMode::read,
+        index_uri,
+        ctx,
+        "",
+        {},
+        "auto",
+        ResultOrder::automatic,
+        timestamp);
+    auto [column_names, fpp] = _options(*index);
+    index->close();
+
+    std::map<std::string, BloomFilter> filters;
+    for (const auto& name : column_names) {
+        if (!cells.contains(name)) {
+            continue;
+        }
+        auto column = cells.at(name);
+        auto& column_filter = filters[name] = BloomFilter::for_capacity(
+            column->size(), fpp);
+        for (size_t i = 0; i < column->size(); ++i) {
+            column_filter.add(column->string_view(i));
+        }
+    }
+    if (filters.empty()) {
+        return;
+    }
+
+    auto writer = SOMAArray::open(
+        OpenMode::write,
+        index_uri,
+        ctx,
+        "",
+        {},
+        "auto",
+        ResultOrder::automatic,
+        timestamp);
+    _write(*writer, filters, fragment);
+    writer->close();
+}
+
+std::optional<KeyFilterIndex::Candidates> KeyFilterIndex::filter(
+    SOMAArray& df,
+    const std::string& column,
+    const std::vector<std::string>& keys) {
+    auto value = df.get_metadata(KEY_FILTER_INDEX_KEY);
+    if (!value) {
+        return std::nullopt;
+    }
+    std::string index_uri(
+        static_cast<const char*>(std::get<MetadataInfo::value>(*value)),
+        std::get<MetadataInfo::num>(*value));
+
+    auto indexed = _filters(df.ctx(), index_uri);
+    if (std::find(indexed->columns.begin(), indexed->columns.end(), column) ==
+        indexed->columns.end()) {
+        return std::nullopt;
+    }
+
+    // Filters of fragments the dataframe does not see are left out
+    auto timestamp = df.timestamp();
+    std::vector<const Filter*> filters;
+    for (const auto& column_filter : indexed->filters) {
+        if (column_filter.column == column &&
+            (!timestamp ||
+             (column_filter.fragment.first <= timestamp->second &&
+              column_filter.fragment.second >= timestamp->first))) {
+            filters.push_back(&column_filter);
+        }
+    }
+
+    // Each key is hashed once for all filters
+    Candidates candidates;
+    std::vector<bool> passed(filters.size(), false);
+    for (const auto& key : keys) {
+        auto hash = BloomFilter::hash(key);
+        bool candidate = false;
+        for (size_t i = 0; i < filters.size(); ++i) {
+            if (filters[i]->keys.may_contain(hash)) {
+                passed[i] = true;
+                candidate = true;
+            }
+        }
+        if (candidate) {
+            candidates.keys.push_back(key);
+        }
+    }
+
+    // The keys are read from the fragments whose filters they pass, and
+    // from any fragment no filter covers, e.g. one written before the
+    // index or merged since
+    auto include = [&candidates](const TimestampRange& fragment) {
+        if (!candidates.fragments) {
+            candidates.fragments = fragment;
+            return;
+        }
+        auto& covered = *candidates.fragments;
+        covered.first = std::min(covered.first, fragment.first);
+        covered.second = std::max(covered.second, fragment.second);
+    };
+    for (size_t i = 0; i < filters.size(); ++i) {
+        if (passed[i]) {
+            include(filters[i]->fragment);
+        }
+    }
+    for (const auto& fragment : _fragments(df, timestamp)) {
+        bool covered = std::any_of(
+            filters.begin(), filters.end(), [&fragment](const Filter* f) {
+                return f->fragment.first <= fragment.first &&
+                       fragment.second <= f->fragment.second;
+            });
+        if (!covered) {
+            include(fragment);
+        }
+    }
+
+    LOG_DEBUG(fmt::format(
+        "[KeyFilterIndex] {} of {} keys of '{}' pass {} filters",
+        candidates.keys.size(),
+        keys.size(),
+        column,
+        filters.size()));
+    return candidates;
+}
+
+void KeyFilterIndex::compact(
+    SOMAArray& df, std::string_view index_uri, const Config& cfg) {
+    auto ctx = df.ctx();
+    auto index = SOMAArray::open(
+        OpenMode::read,
+        index_uri,
+        ctx,
+        "",
+        {},
+        "auto",
+        ResultOrder::automatic,
+        std::nullopt);
+    auto [column_names, fpp] = _options(*index);
+    index->close();
+
+    // Consolidation merges every fragment, so the filter covers the keys
+    // of all fragments, whatever the timestamp of the dataframe
+    auto fragments = _fragments(df, std::nullopt);
+    int64_t write_id;
+    if (fragments.empty()) {
+        write_id = _next_write_id();
+    } else {
+        TimestampRange covered = fragments.front();
+        for (const auto& fragment : fragments) {
+            covered.first = std::min(covered.first, fragment.first);
+            covered.second = std::max(covered.second, fragment.second);
+        }
+        auto writer = SOMAArray::open(
+            OpenMode::write,
+            index_uri,
+            ctx,
+            "",
+            {},
+            "auto",
+            ResultOrder::automatic,
+            std::nullopt);
+        write_id = _write(
+            *writer,
+            _build(df, column_names, fpp, std::nullopt),
+            covered);
+        writer->close();
+    }
+
+    // Delete the replaced filters, and purge them from the index array
+    auto tiledb_ctx = ctx->tiledb_ctx();
+    std::string uri(index_uri);
+    Array array(*tiledb_ctx, uri, TILEDB_DELETE);
+    Query query(*tiledb_ctx, array, TILEDB_DELETE);
+    query.set_condition(QueryCondition::create<int64_t>(
+        *tiledb_ctx, "soma_write", write_id, TILEDB_LT));
+    query.submit();
+    array.close();
+
+    Config index_cfg = cfg;
+    index_cfg["sm.consolidation.mode"] = "fragments";
+    index_cfg["sm.consolidation.purge_deleted_cells"] = "true";
+    Array::consolidate(Context(index_cfg), uri);
+    Array::vacuum(Context(index_cfg), uri);
+
+    LOG_DEBUG(fmt::format(
+        "[KeyFilterIndex] Compacted '{}' to the keys of {} fragments of '{}'",
+        index_uri,
+        fragments.size(),
+        df.uri()));
+}
+
+//===================================================================
+//= private static
+//===================================================================
+
+std::pair<std::vector<std::string>, double> KeyFilterIndex::_options(
+    SOMAArray& index) {
+    auto columns = index.get_metadata(INDEXED_COLUMNS_KEY);
+    auto fpp = index.get_metadata(FPP_KEY);
+    if (!columns || !fpp) {
+        throw TileDBSOMAError(fmt::format(
+            "[KeyFilterIndex] '{}' is not a key filter index", index.uri()));
+    }
+    std::string column_names(
+        static_cast<const char*>(std::get<MetadataInfo::value>(*columns)),
+        std::get<MetadataInfo::num>(*columns));
+    return {
+        json::parse(column_names).get<std::vector<std::string>>(),
+        *static_cast<const double*>(std::get<MetadataInfo::value>(*fpp))};
+}
+
+std::shared_ptr<const KeyFilterIndex::Filters> KeyFilterIndex::_filters(
+    std::shared_ptr<SOMAContext> ctx, const std::string& index_uri) {
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<const Filters>> cache;
+
+    FragmentInfo fragment_info(*ctx->tiledb_ctx(), index_uri);
+    fragment_info.load();
+    std::array<uint64_t, 2> state = {fragment_info.fragment_num(), 0};
+    for (uint32_t fid = 0; fid < fragment_info.fragment_num(); fid++) {
+        auto frag_ts = fragment_info.timestamp_range(fid);
+        state[1] = std::max(state[1], frag_ts.second);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = cache.find(index_uri);
+        if (it != cache.end() && it->second->state == state) {
+            return it->second;
+        }
+    }
+
+    // Filters are read at the latest timestamp, and those of fragments a
+    // dataframe does not see are left out by `filter`
+    auto index = SOMAArray::open(
+        OpenMode::read,
+        index_uri,
+        ctx,
+        "",
+        {"soma_column",
+         "soma_filter",
+         "soma_fragment_start",
+         "soma_fragment_end"},
+        "auto",
+        ResultOrder::automatic,
+        std::nullopt);
+    auto indexed = std::make_shared<Filters>();
+    indexed->state = state;
+    indexed->columns = _options(*index).first;
+    while (auto batch = index->read_next()) {
+        auto columns = (*batch)->at("soma_column");
+        auto column_filters = (*batch)->at("soma_filter");
+        auto starts = (*batch)->at("soma_fragment_start")->data<uint64_t>();
+        auto ends = (*batch)->at("soma_fragment_end")->data<uint64_t>();
+        for (size_t i = 0; i < column_filters->size(); ++i) {
+            auto bytes = column_filters->string_view(i);
+            indexed->filters.push_back(
+                {std::string(columns->string_view(i)),
+                 {starts[i], ends[i]},
+                 BloomFilter::deserialize(
+                     reinterpret_cast<const uint8_t*>(bytes.data()),
+                     bytes.size())});
+        }
+    }
+    index->close();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cache.size() >= MAX_CACHED_INDEXES && !cache.count(index_uri)) {
+        cache.erase(cache.begin());
+    }
+    cache[index_uri] = indexed;
+    return indexed;
+}
+
+std::vector<TimestampRange> KeyFilterIndex::_fragments(
+    SOMAArray& df, std::optional<TimestampRange> timestamp) {
+    FragmentInfo fragment_info(*df.ctx()->tiledb_ctx(), df.uri());
+    fragment_info.load();
+
+    std::vector<TimestampRange> fragments;
+    for (uint32_t fid = 0; fid < fragment_info.fragment_num(); fid++) {
+        auto frag_ts = fragment_info.timestamp_range(fid);
+        if (timestamp && (frag_ts.first > timestamp->second ||
+                          frag_ts.second < timestamp->first)) {
+            continue;
+        }
+        fragments.push_back(frag_ts);
+    }
+    return fragments;
+}
+
+std::map<std::string, BloomFilter> KeyFilterIndex::_build(
+    SOMAArray& df,
+    const std::vector<std::string>& column_names,
+    double fpp,
+    std::optional<TimestampRange> timestamp) {
+    auto reader = SOMAArray::open(
+        OpenMode::read,
+        df.uri(),
+        df.ctx(),
+        "",
+        column_names,
+        "auto",
+        ResultOrder::automatic,
+        timestamp);
+    auto num_keys = reader->nnz();
+    std::map<std::string, BloomFilter> filters;
+    for (const auto& name : column_names) {
+        filters[name] = BloomFilter::for_capacity(num_keys, fpp);
+    }
+    while (auto batch = reader->read_next()) {
+        for (auto& [name, column_filter] : filters) {
+            auto column = (*batch)->at(name);
+            for (size_t i = 0; i < column->size(); ++i) {
+                column_filter.add(column->string_view(i));
+            }
+        }
+    }
+    reader->close();
+    return filters;
+}
+
+int64_t KeyFilterIndex::_write(
+    SOMAArray& index,
+    const std::map<std::string, BloomFilter>& filters,
+    const TimestampRange& fragment) {
+    auto write_id = _next_write_id();
+    std::string columns;
+    std::vector<uint64_t> column_offsets = {0};
+    std::vector<int64_t> write_ids(filters.size(), write_id);
+    std::vector<uint64_t> starts(filters.size(), fragment.first);
+    std::vector<uint64_t> ends(filters.size(), fragment.second);
+    std::vector<uint8_t> bytes;
+    std::vector<uint64_t> byte_offsets = {0};
+    for (const auto& [column, column_filter] : filters) {
+        columns += column;
+        column_offsets.push_back(columns.size());
+        auto serialized = column_filter.serialize();
+        bytes.insert(bytes.end(), serialized.begin(), serialized.end());
+        byte_offsets.push_back(bytes.size());
+    }
+    index.set_column_data(
+        "soma_column", filters.size(), columns.data(), column_offsets.data());
+    index.set_column_data("soma_write", write_ids.size(), write_ids.data());
+    index.set_column_data(
+        "soma_filter", filters.size(), bytes.data(), byte_offsets.data());
+    index.set_column_data("soma_fragment_start", starts.size(), starts.data());
+    index.set_column_data("soma_fragment_end", ends.size(), ends.data());
+    index.write(true);
+    return write_id;
+}
+
+int64_t KeyFilterIndex::_next_write_id() {
+    static std::atomic<int64_t> last_id{0};
+    int64_t id = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::system_clock::now().time_since_epoch())
+                     .count();
+    int64_t last = last_id.load();
+    while (!last_id.compare_exchange_weak(last, std::max(id, last + 1))) {
+    }
+    return std::max(id, last + 1);
+}
+
+}  // namespace tiledbsoma
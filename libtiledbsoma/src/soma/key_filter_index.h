@@ -0,0 +1,227 @@
+/**
+ * @file   key_filter_index.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the KeyFilterIndex class, per-write Bloom filters of the
+ *   string index columns of a dataframe used to drop absent lookup keys.
+ */
+
+#ifndef SOMA_KEY_FILTER_INDEX_H
+#define SOMA_KEY_FILTER_INDEX_H
+
+#include <array>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../utils/bloom_filter.h"
+#include "array_buffers.h"
+#include "soma_array.h"
+
+namespace tiledbsoma {
+
+/**
+ * @brief Bloom filters of the string dimensions of a SOMADataFrame, e.g.
+ * `obs_id`, stored as a sparse array next to it. Each write, and so each
+ * fragment, of the dataframe adds one filter per indexed column, keyed by
+ * the `soma_column` name and a `soma_write` id, and tied to the timestamp
+ * range of its fragment.
+ *
+ * A point lookup of string keys first drops the keys no filter may
+ * contain. Misses then add no subarray range and read no tiles, and only
+ * false positives (1% by default) still reach TileDB. The remaining keys
+ * are read from the fragments whose filters they pass only, by narrowing
+ * the timestamp range of the read. Consolidating the fragments of the
+ * dataframe replaces their filters by one filter of the merged fragment.
+ */
+class KeyFilterIndex {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    // Default false positive rate of the filters
+    static constexpr double DEFAULT_FPP = 0.01;
+
+    /**
+     * @brief The keys of a lookup that may be present, and where.
+     */
+    struct Candidates {
+        // Keys passing at least one filter, in input order
+        std::vector<std::string> keys;
+
+        // Timestamp range covering the fragments whose filters the keys
+        // pass and the fragments no filter covers, or std::nullopt if
+        // there are none
+        std::optional<TimestampRange> fragments;
+    };
+
+    /**
+     * @brief Create the index array and add a filter of the current keys of
+     * a dataframe.
+     *
+     * @param df The dataframe. Keys are read through a new handle at its
+     * timestamp.
+     * @param index_uri URI of the index array to create
+     * @param column_names String dimensions to index
+     * @param fpp False positive rate of the filters
+     */
+    static void create(
+        SOMAArray& df,
+        std::string_view index_uri,
+        const std::vector<std::string>& column_names,
+        double fpp = DEFAULT_FPP);
+
+    /**
+     * @brief Add a filter of newly written keys to the index.
+     *
+     * @param ctx SOMAContext
+     * @param index_uri URI of the index array
+     * @param cells The written cells
+     * @param fragment Timestamp range of the fragment holding the cells
+     * @param timestamp Timestamp range the dataframe was opened at
+     */
+    static void update(
+        std::shared_ptr<SOMAContext> ctx,
+        std::string_view index_uri,
+        ArrayBuffers& cells,
+        const TimestampRange& fragment,
+        std::optional<TimestampRange> timestamp);
+
+    /**
+     * @brief Return the keys that may be present in `column`, and the
+     * fragments they may be read from.
+     *
+     * @param df The dataframe, open for read. Its index URI is read from
+     * the `soma_key_filter_index_uri` metadata.
+     * @param column String dimension
+     * @param keys Lookup keys
+     * @return std::optional<Candidates> The candidates, or std::nullopt if
+     * the dataframe has no index of `column`
+     */
+    static std::optional<Candidates> filter(
+        SOMAArray& df,
+        const std::string& column,
+        const std::vector<std::string>& keys);
+
+    /**
+     * @brief Replace the filters of the index by one filter per column of
+     * the current keys of the dataframe, after its fragments have been
+     * consolidated, and purge the replaced filters.
+     *
+     * @param df The dataframe. Keys are read through a new handle.
+     * @param index_uri URI of the index array
+     * @param cfg Config of the consolidation
+     */
+    static void compact(
+        SOMAArray& df, std::string_view index_uri, const Config& cfg);
+
+   private:
+    //===================================================================
+    //= private static
+    //===================================================================
+
+    // Metadata of the index array listing the indexed columns, as JSON
+    inline static const std::string
+        INDEXED_COLUMNS_KEY = "soma_indexed_columns";
+
+    // Metadata of the index array holding the false positive rate
+    inline static const std::string FPP_KEY = "soma_false_positive_rate";
+
+    // Number of indexes whose deserialized filters are kept in memory
+    static constexpr size_t MAX_CACHED_INDEXES = 64;
+
+    // A deserialized filter of the keys of one column in one fragment
+    struct Filter {
+        std::string column;
+        TimestampRange fragment;
+        BloomFilter keys;
+    };
+
+    // The deserialized filters of an index, and the fragment state of the
+    // index array they were read at
+    struct Filters {
+        std::array<uint64_t, 2> state;
+        std::vector<std::string> columns;
+        std::vector<Filter> filters;
+    };
+
+    /**
+     * @brief Return the indexed columns and false positive rate of an open
+     * index array.
+     */
+    static std::pair<std::vector<std::string>, double> _options(
+        SOMAArray& index);
+
+    /**
+     * @brief Return the filters of an index, deserialized once per
+     * fragment state of the index array.
+     */
+    static std::shared_ptr<const Filters> _filters(
+        std::shared_ptr<SOMAContext> ctx, const std::string& index_uri);
+
+    /**
+     * @brief Return the timestamp ranges of the fragments of a dataframe
+     * that overlap `timestamp`.
+     */
+    static std::vector<TimestampRange> _fragments(
+        SOMAArray& df, std::optional<TimestampRange> timestamp);
+
+    /**
+     * @brief Return one filter per column of the keys of a dataframe at
+     * `timestamp`.
+     */
+    static std::map<std::string, BloomFilter> _build(
+        SOMAArray& df,
+        const std::vector<std::string>& column_names,
+        double fpp,
+        std::optional<TimestampRange> timestamp);
+
+    /**
+     * @brief Write one filter per column of the keys of a fragment to an
+     * index array open for write.
+     *
+     * @return int64_t The write id of the filters
+     */
+    static int64_t _write(
+        SOMAArray& index,
+        const std::map<std::string, BloomFilter>& filters,
+        const TimestampRange& fragment);
+
+    /**
+     * @brief Return a new write id: the current time in nanoseconds, made
+     * unique within the process.
+     */
+    static int64_t _next_write_id();
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_KEY_FILTER_INDEX_H
@@ -0,0 +1,326 @@
+/**
+ * @file   knn_search.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the KnnSearch class.
+ */
+
+#include "knn_search.h"
+#include <thread_pool/thread_pool.h>
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <limits>
+#include "../utils/common.h"
+#include "../utils/logger.h"
+#include "dense_row_reader.h"
+
+namespace tiledbsoma {
+
+namespace {
+
+// Number of independent partial sums of the distance kernels
+constexpr int64_t LANES = 8;
+
+float squared_l2(const float* a, const float* b, int64_t dim) {
+    float partial[LANES] = {};
+    int64_t j = 0;
+    for (; j + LANES <= dim; j += LANES) {
+        for (int64_t lane = 0; lane < LANES; ++lane) {
+            float diff = a[j + lane] - b[j + lane];
+            partial[lane] += diff * diff;
+        }
+    }
+    float sum = 0;
+    for (; j < dim; ++j) {
+        float diff = a[j] - b[j];
+        sum += diff * diff;
+    }
+    for (int64_t lane = 0; lane < LANES; ++lane) {
+        sum += partial[lane];
+    }
+    return sum;
+}
+
+float dot(const float* a, const float* b, int64_t dim) {
+    float partial[LANES] = {};
+    int64_t j = 0;
+    for (; j + LANES <= dim; j += LANES) {
+        for (int64_t lane = 0; lane < LANES; ++lane) {
+            partial[lane] += a[j + lane] * b[j + lane];
+        }
+    }
+    float sum = 0;
+    for (; j < dim; ++j) {
+        sum += a[j] * b[j];
+    }
+    for (int64_t lane = 0; lane < LANES; ++lane) {
+        sum += partial[lane];
+    }
+    return sum;
+}
+
+// Inverse of the norm of a vector, or zero for the zero vector
+float inverse_norm(const float* a, int64_t dim) {
+    float norm = std::sqrt(dot(a, a, dim));
+    return norm > 0 ? 1 / norm : 0;
+}
+
+}  // namespace
+
+//===================================================================
+//= public static
+//===================================================================
+
+KnnResult KnnSearch::search(
+    SOMAArray& array,
+    const float* queries,
+    int64_t n_queries,
+    int64_t dim,
+    int64_t k,
+    KnnMetric metric,
+    std::optional<JoinidBitmap> candidates,
+    size_t block_rows) {
+    if (block_rows == 0) {
+        throw TileDBSOMAError("[KnnSearch] block_rows must be positive");
+    }
+    auto shape = array.shape();
+    if (shape.size() != 2) {
+        throw TileDBSOMAError(fmt::format(
+            "[KnnSearch] {} is not a 2D SOMA NDArray", array.uri()));
+    }
+    if (shape[1] != dim) {
+        throw TileDBSOMAError(fmt::format(
+            "[KnnSearch] Queries have {} dimensions but {} has {}",
+            dim,
+            array.uri(),
+            shape[1]));
+    }
+    KnnSearch knn(queries, n_queries, dim, k, metric, array.ctx());
+    if (!candidates.has_value()) {
+        candidates = JoinidBitmap::from_ranges(
+            {array.non_empty_domain<int64_t>("soma_dim_0")});
+    }
+
+    // Walk the candidate ranges block_rows joinids at a time
+    auto ranges = candidates->to_ranges();
+    size_t range = 0;
+    int64_t joinid = ranges.empty() ? 0 : ranges[0].first;
+    auto next_block = [&]() {
+        std::vector<int64_t> block;
+        while (block.size() < block_rows && range < ranges.size()) {
+            block.push_back(joinid);
+            if (joinid < ranges[range].second) {
+                ++joinid;
+            } else if (++range < ranges.size()) {
+                joinid = ranges[range].first;
+            }
+        }
+        return block;
+    };
+
+    // Rows with no stored cells read as zeros, which would rank as real
+    // rows, so they are dropped from the block
+    using Block = std::pair<std::vector<int64_t>, std::vector<float>>;
+    auto read_block = [&array, dim](std::vector<int64_t> joinids) {
+        std::vector<uint8_t> present;
+        auto rows = DenseRowReader::read<float>(array, joinids, &present);
+        size_t kept = 0;
+        for (size_t r = 0; r < joinids.size(); ++r) {
+            if (!present[r]) {
+                continue;
+            }
+            if (kept != r) {
+                joinids[kept] = joinids[r];
+                std::copy_n(
+                    rows.begin() + r * dim, dim, rows.begin() + kept * dim);
+            }
+            ++kept;
+        }
+        joinids.resize(kept);
+        rows.resize(kept * dim);
+        return Block(std::move(joinids), std::move(rows));
+    };
+
+    // Read the next block while searching the current one
+    std::future<Block> pending;
+    if (auto block = next_block(); !block.empty()) {
+        pending = std::async(std::launch::async, read_block, std::move(block));
+    }
+    size_t num_rows = 0;
+    while (pending.valid()) {
+        auto [joinids, rows] = pending.get();
+        if (auto block = next_block(); !block.empty()) {
+            pending = std::async(
+                std::launch::async, read_block, std::move(block));
+        }
+        knn.update(joinids.data(), rows.data(), joinids.size());
+        num_rows += joinids.size();
+    }
+
+    LOG_DEBUG(fmt::format(
+        "[KnnSearch] Searched {} rows of {} for {} queries",
+        num_rows,
+        array.uri(),
+        n_queries));
+    return knn.result();
+}
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+KnnSearch::KnnSearch(
+    const float* queries,
+    int64_t n_queries,
+    int64_t dim,
+    int64_t k,
+    KnnMetric metric,
+    std::shared_ptr<SOMAContext> ctx)
+    : n_queries_(n_queries)
+    , dim_(dim)
+    , k_(k)
+    , metric_(metric)
+    , ctx_(ctx) {
+    if (n_queries < 0 || dim <= 0 || k < 0) {
+        throw TileDBSOMAError(fmt::format(
+            "[KnnSearch] Invalid search of {} neighbors of {} queries in {} "
+            "dimensions",
+            k,
+            n_queries,
+            dim));
+    }
+    if (queries == nullptr && n_queries > 0) {
+        throw TileDBSOMAError("[KnnSearch] Missing queries");
+    }
+    queries_.assign(queries, queries + n_queries * dim);
+    if (metric_ == KnnMetric::cosine) {
+        for (int64_t q = 0; q < n_queries; ++q) {
+            float* query = queries_.data() + q * dim;
+            float scale = inverse_norm(query, dim);
+            for (int64_t j = 0; j < dim; ++j) {
+                query[j] *= scale;
+            }
+        }
+    }
+    heaps_.resize(n_queries);
+    for (auto& heap : heaps_) {
+        heap.reserve(k);
+    }
+}
+
+void KnnSearch::update(const int64_t* joinids, const float* rows, size_t size) {
+    if (size == 0 || k_ == 0 || n_queries_ == 0) {
+        return;
+    }
+
+    std::vector<float> inverse_norms;
+    if (metric_ == KnnMetric::cosine) {
+        inverse_norms.resize(size);
+        for (size_t r = 0; r < size; ++r) {
+            inverse_norms[r] = inverse_norm(rows + r * dim_, dim_);
+        }
+    }
+
+    size_t num_tasks = std::clamp<size_t>(
+        size * n_queries_ * dim_ / MIN_TERMS_PER_TASK,
+        1,
+        std::min<size_t>(_concurrency(), n_queries_));
+
+    auto search = [&](size_t task) {
+        for (int64_t q = task; q < n_queries_; q += num_tasks) {
+            const float* query = queries_.data() + q * dim_;
+            auto& heap = heaps_[q];
+            for (size_t r = 0; r < size; ++r) {
+                const float* row = rows + r * dim_;
+                float distance = metric_ == KnnMetric::l2 ?
+                                     squared_l2(query, row, dim_) :
+                                     1 - dot(query, row, dim_) *
+                                             inverse_norms[r];
+                if (std::isnan(distance)) {
+                    continue;
+                }
+                std::pair<float, int64_t> neighbor(distance, joinids[r]);
+                if (heap.size() < static_cast<size_t>(k_)) {
+                    heap.push_back(neighbor);
+                    std::push_heap(heap.begin(), heap.end());
+                } else if (neighbor < heap.front()) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = neighbor;
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+        }
+    };
+
+    if (num_tasks == 1) {
+        search(0);
+    } else {
+        std::vector<ThreadPool::Task> tasks;
+        for (size_t task = 0; task < num_tasks; ++task) {
+            tasks.emplace_back(ctx_->thread_pool()->execute([&search, task]() {
+                search(task);
+                return Status::Ok();
+            }));
+        }
+        ctx_->thread_pool()->wait_all(tasks);
+    }
+}
+
+KnnResult KnnSearch::result() const {
+    KnnResult result;
+    result.k = k_;
+    result.joinids.assign(n_queries_ * k_, -1);
+    result.distances.assign(
+        n_queries_ * k_, std::numeric_limits<float>::infinity());
+    for (int64_t q = 0; q < n_queries_; ++q) {
+        auto neighbors = heaps_[q];
+        std::sort_heap(neighbors.begin(), neighbors.end());
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            auto [distance, joinid] = neighbors[i];
+            result.joinids[q * k_ + i] = joinid;
+            result.distances[q * k_ + i] = metric_ == KnnMetric::l2 ?
+                                               std::sqrt(distance) :
+                                               distance;
+        }
+    }
+    return result;
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+size_t KnnSearch::_concurrency() const {
+    if (ctx_ == nullptr || ctx_->thread_pool() == nullptr) {
+        return 1;
+    }
+    return std::max<size_t>(ctx_->thread_pool()->concurrency_level(), 1);
+}
+
+}  // namespace tiledbsoma
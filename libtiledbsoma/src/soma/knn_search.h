@@ -0,0 +1,201 @@
+/**
+ * @file   knn_search.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the KnnSearch class, which finds the exact k nearest
+ *   rows of a stored embedding, e.g. obsm["X_pca"], to a set of query
+ *   vectors.
+ */
+
+#ifndef SOMA_KNN_SEARCH_H
+#define SOMA_KNN_SEARCH_H
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "../utils/joinid_bitmap.h"
+#include "soma_array.h"
+#include "soma_context.h"
+
+namespace tiledbsoma {
+
+enum class KnnMetric { l2, cosine };
+
+/**
+ * @brief The neighbors of each query, nearest first. Both vectors are
+ * row-major (n_queries, k). Queries with fewer than k candidates are padded
+ * with joinid -1 and an infinite distance.
+ */
+struct KnnResult {
+    int64_t k = 0;
+    std::vector<int64_t> joinids;
+    std::vector<float> distances;
+};
+
+/**
+ * @brief Exact, brute-force k-nearest-neighbor search, accumulated block by
+ * block over the rows of an embedding.
+ *
+ * Each query keeps a max-heap of its k nearest rows so far, so memory is
+ * bounded by the queries, the heaps and the current block whatever the
+ * number of rows. Each task of the context thread pool owns an interleaved
+ * subset of the queries and their heaps, so no reduction is needed. The
+ * distance kernels keep independent partial sums, which lets the compiler
+ * vectorize them without relaxing floating-point semantics.
+ *
+ * Distances are Euclidean for `KnnMetric::l2` and one minus the cosine
+ * similarity for `KnnMetric::cosine`. Ties are broken by the smaller joinid.
+ */
+class KnnSearch {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /**
+     * @brief Search the rows of a 2D SOMADenseNDArray or SOMASparseNDArray.
+     * Blocks of rows are read with `DenseRowReader`, the next block being
+     * read while distances to the current one are computed. Rows of a
+     * sparse array with no stored cells are not candidates.
+     *
+     * @param array Embedding with `dim` columns. It is not modified.
+     * @param queries Row-major (n_queries, dim) query vectors
+     * @param n_queries Number of queries
+     * @param dim Number of dimensions of the queries
+     * @param k Number of neighbors per query
+     * @param metric Distance metric
+     * @param candidates Rows to search, or the non-empty domain of
+     * `soma_dim_0` if not given
+     * @param block_rows Number of rows read at once
+     * @return KnnResult
+     */
+    static KnnResult search(
+        SOMAArray& array,
+        const float* queries,
+        int64_t n_queries,
+        int64_t dim,
+        int64_t k,
+        KnnMetric metric = KnnMetric::l2,
+        std::optional<JoinidBitmap> candidates = std::nullopt,
+        size_t block_rows = DEFAULT_BLOCK_ROWS);
+
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    /**
+     * @brief Construct a search with empty heaps.
+     *
+     * @param queries Row-major (n_queries, dim) query vectors. They are
+     * copied.
+     * @param n_queries Number of queries
+     * @param dim Number of dimensions of the embedding
+     * @param k Number of neighbors per query
+     * @param metric Distance metric
+     * @param ctx SOMAContext providing the thread pool, or nullptr to run
+     * on the calling thread
+     */
+    KnnSearch(
+        const float* queries,
+        int64_t n_queries,
+        int64_t dim,
+        int64_t k,
+        KnnMetric metric = KnnMetric::l2,
+        std::shared_ptr<SOMAContext> ctx = nullptr);
+
+    KnnSearch() = delete;
+    KnnSearch(const KnnSearch&) = delete;
+    KnnSearch(KnnSearch&&) = default;
+    ~KnnSearch() = default;
+
+    /**
+     * @brief Offer a block of rows as candidates to every query.
+     *
+     * @param joinids Joinid of each row
+     * @param rows Row-major (size, dim) embedding rows
+     * @param size Number of rows
+     */
+    void update(const int64_t* joinids, const float* rows, size_t size);
+
+    /**
+     * @brief Return the neighbors found so far, nearest first.
+     */
+    KnnResult result() const;
+
+    int64_t n_queries() const {
+        return n_queries_;
+    }
+
+    int64_t dim() const {
+        return dim_;
+    }
+
+    int64_t k() const {
+        return k_;
+    }
+
+   private:
+    //===================================================================
+    //= private static
+    //===================================================================
+
+    // Default number of rows read per block by `search()`
+    static constexpr size_t DEFAULT_BLOCK_ROWS = 1 << 14;
+
+    // Below this many distance terms per task a block runs on fewer tasks
+    static constexpr size_t MIN_TERMS_PER_TASK = 1 << 18;
+
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    /**
+     * @brief Return the maximum number of concurrent tasks.
+     */
+    size_t _concurrency() const;
+
+    int64_t n_queries_;
+    int64_t dim_;
+    int64_t k_;
+    KnnMetric metric_;
+    std::shared_ptr<SOMAContext> ctx_;
+
+    // Queries, normalized to unit length for the cosine metric
+    std::vector<float> queries_;
+
+    // Max-heap of (distance, joinid) of each query, ordered by
+    // `std::less`, so the farthest kept neighbor is at the front. Distances
+    // are squared for the l2 metric until `result()`.
+    std::vector<std::vector<std::pair<float, int64_t>>> heaps_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_KNN_SEARCH_H
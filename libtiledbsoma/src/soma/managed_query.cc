@@ -31,8 +31,11 @@
  */
 
 #include "managed_query.h"
+#include <thread_pool/thread_pool.h>
 #include <tiledb/array_experimental.h>
 #include <tiledb/attribute_experimental.h>
+#include <numeric>
+#include "../reindexer/reindexer.h"
 #include "../utils/logger.h"
 #include "utils/common.h"
 namespace tiledbsoma {
@@ -54,11 +57,13 @@ ManagedQuery::ManagedQuery(
     reset();
 }
 
-void ManagedQuery::close() {
+void ManagedQuery::close(bool close_array) {
     if (query_future_.valid()) {
         query_future_.get();
     }
-    array_->close();
+    if (close_array) {
+        array_->close();
+    }
 }
 
 void ManagedQuery::reset() {
@@ -72,6 +77,46 @@ void ManagedQuery::reset() {
     total_num_cells_ = 0;
     buffers_.reset();
     query_submitted_ = false;
+    condition_.reset();
+}
+
+void ManagedQuery::reopen(const TimestampRange& timestamp) {
+    if (query_submitted_ || subarray_range_set_) {
+        throw TileDBSOMAError(fmt::format(
+            "[ManagedQuery] [{}] cannot reopen a query with ranges selected",
+            name_));
+    }
+    auto layout = query_->query_layout();
+    array_->set_open_timestamp_start(timestamp.first);
+    array_->set_open_timestamp_end(timestamp.second);
+    array_->reopen();
+
+    // The query and subarray hold the array as it was opened
+    query_ = std::make_unique<Query>(*ctx_, *array_);
+    subarray_ = std::make_unique<Subarray>(*ctx_, *array_);
+    query_->set_layout(layout);
+    if (condition_) {
+        query_->set_condition(*condition_);
+    }
+    LOG_DEBUG(fmt::format(
+        "[ManagedQuery] [{}] reopened at timestamps {}-{}",
+        name_,
+        timestamp.first,
+        timestamp.second));
+}
+
+std::optional<TimestampRange> ManagedQuery::written_timestamp_range() const {
+    auto num_fragments = query_->fragment_num();
+    if (num_fragments == 0) {
+        return std::nullopt;
+    }
+    TimestampRange written = query_->fragment_timestamp_range(0);
+    for (uint32_t i = 1; i < num_fragments; ++i) {
+        auto range = query_->fragment_timestamp_range(i);
+        written.first = std::min(written.first, range.first);
+        written.second = std::max(written.second, range.second);
+    }
+    return written;
 }
 
 void ManagedQuery::select_columns(
@@ -297,6 +342,56 @@ void ManagedQuery::submit_read() {
     });
 }
 
+std::string ManagedQuery::selection_key() {
+    std::string key;
+    auto append = [&key](const void* data, size_t size) {
+        key.append(static_cast<const char*>(data), size);
+    };
+    auto append_string = [&](const std::string& value) {
+        uint64_t size = value.size();
+        append(&size, sizeof(size));
+        key.append(value);
+    };
+
+    uint64_t num_columns = columns_.size();
+    append(&num_columns, sizeof(num_columns));
+    for (const auto& name : columns_) {
+        append_string(name);
+    }
+
+    auto layout = query_->query_layout();
+    append(&layout, sizeof(layout));
+
+    // Range bounds are appended as raw bytes of the dimension type
+    auto dimensions = array_->schema().domain().dimensions();
+    for (uint32_t i = 0; i < dimensions.size(); ++i) {
+        uint64_t num_ranges = subarray_->range_num(i);
+        append(&num_ranges, sizeof(num_ranges));
+        for (uint64_t j = 0; j < num_ranges; ++j) {
+            if (dimensions[i].cell_val_num() == TILEDB_VAR_NUM) {
+                auto [start, stop] = subarray_->range(i, j);
+                append_string(start);
+                append_string(stop);
+            } else {
+                const void *start, *stop, *stride;
+                ctx_->handle_error(tiledb_subarray_get_range(
+                    ctx_->ptr().get(),
+                    subarray_->ptr().get(),
+                    i,
+                    j,
+                    &start,
+                    &stop,
+                    &stride));
+                auto size = tiledb_datatype_size(dimensions[i].type());
+                append(start, size);
+                append(stop, size);
+            }
+        }
+    }
+
+    return key;
+}
+
 std::shared_ptr<ArrayBuffers> ManagedQuery::results() {
     if (is_empty_query()) {
         return buffers_;
@@ -365,6 +460,76 @@ std::shared_ptr<ArrayBuffers> ManagedQuery::results() {
     return buffers_;
 }
 
+PointRows ManagedQuery::point_rows(
+    const std::vector<int64_t>& points, const int64_t* values, size_t size) {
+    PointRows result;
+    result.offsets.assign(1, 0);
+    if (points.empty()) {
+        return result;
+    }
+
+    // Slot of each distinct point
+    std::vector<int64_t> distinct(points);
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(
+        std::unique(distinct.begin(), distinct.end()), distinct.end());
+    IntIndexer indexer;
+    indexer.map_locations(distinct);
+
+    // Counting sort of the result rows by slot, stable so the rows of a
+    // point keep their result order
+    std::vector<int64_t> slots(size);
+    indexer.lookup(values, slots.data(), size);
+    std::vector<int64_t> starts(distinct.size() + 1, 0);
+    for (auto slot : slots) {
+        if (slot >= 0) {
+            starts[slot + 1]++;
+        }
+    }
+    std::partial_sum(starts.begin(), starts.end(), starts.begin());
+    std::vector<int64_t> by_slot(starts.back());
+    auto next = starts;
+    for (size_t row = 0; row < size; ++row) {
+        if (slots[row] >= 0) {
+            by_slot[next[slots[row]]++] = row;
+        }
+    }
+
+    // Rows of each point, in the order of the points
+    std::vector<int64_t> point_slots(points.size());
+    indexer.lookup(points.data(), point_slots.data(), points.size());
+    result.offsets.reserve(points.size() + 1);
+    for (auto slot : point_slots) {
+        result.rows.insert(
+            result.rows.end(),
+            by_slot.begin() + starts[slot],
+            by_slot.begin() + starts[slot + 1]);
+        result.offsets.push_back(result.rows.size());
+    }
+    return result;
+}
+
+size_t ManagedQuery::_concurrency_level() const {
+    return thread_pool_ == nullptr ? 1 : thread_pool_->concurrency_level();
+}
+
+void ManagedQuery::_run_tasks(std::vector<std::function<void()>>& tasks) {
+    if (tasks.size() == 1 || _concurrency_level() == 1) {
+        for (auto& task : tasks) {
+            task();
+        }
+        return;
+    }
+    std::vector<ThreadPool::Task> futures;
+    for (auto& task : tasks) {
+        futures.emplace_back(thread_pool_->execute([&task]() {
+            task();
+            return Status::Ok();
+        }));
+    }
+    thread_pool_->wait_all(futures);
+}
+
 void ManagedQuery::check_column_name(const std::string& name) {
     if (!buffers_->contains(name)) {
         throw TileDBSOMAError(fmt::format(
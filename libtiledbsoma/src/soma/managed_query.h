@@ -33,8 +33,13 @@
 #ifndef MANAGED_QUERY_H
 #define MANAGED_QUERY_H
 
+#include <algorithm>
+#include <functional>
 #include <future>
+#include <limits>
+#include <optional>
 #include <stdexcept>  // for windows: error C2039: 'runtime_error': is not a member of 'std'
+#include <type_traits>
 #include <unordered_set>
 
 #include <tiledb/tiledb>
@@ -42,11 +47,28 @@
 #include "../utils/common.h"
 #include "array_buffers.h"
 #include "column_buffer.h"
+#include "logger_public.h"
 
 namespace tiledbsoma {
 
 using namespace tiledb;
 
+class ThreadPool;
+
+/**
+ * @brief The result rows matching each point of a point selection, see
+ * `ManagedQuery::point_rows`.
+ */
+struct PointRows {
+    // Result rows, grouped by point in the order of the points. A point
+    // given twice has its rows listed twice.
+    std::vector<int64_t> rows;
+
+    // The rows matching points[i] are rows[offsets[i]] to
+    // rows[offsets[i + 1] - 1], none for a point matching no cell
+    std::vector<int64_t> offsets;
+};
+
 class ManagedQuery {
    public:
     //===================================================================
@@ -81,7 +103,8 @@ class ManagedQuery {
         , results_complete_(other.results_complete_)
         , total_num_cells_(other.total_num_cells_)
         , buffers_(other.buffers_)
-        , query_submitted_(other.query_submitted_) {
+        , query_submitted_(other.query_submitted_)
+        , thread_pool_(other.thread_pool_) {
     }
 
     ~ManagedQuery() = default;
@@ -90,8 +113,10 @@ class ManagedQuery {
      * @brief Close the array after waiting for any asynchronous queries to
      * complete.
      *
+     * @param close_array If false, only wait for the queries, leaving the
+     * array open for other users of a shared handle
      */
-    void close();
+    void close(bool close_array = true);
 
     /**
      * @brief Reset the state of this ManagedQuery object to prepare for a new
@@ -112,6 +137,13 @@ class ManagedQuery {
     void select_columns(
         const std::vector<std::string>& names, bool if_not_empty = false);
 
+    /**
+     * @brief Clear the column selection, so that all columns are read.
+     */
+    void reset_columns() {
+        columns_.clear();
+    }
+
     /**
      * @brief Returns the column names set by the query.
      *
@@ -140,7 +172,12 @@ class ManagedQuery {
     }
 
     /**
-     * @brief Select dimension points to query.
+     * @brief Select dimension points to query. The points are sorted and
+     * deduplicated, and on integer dimensions runs of consecutive points are
+     * coalesced into one range, so the subarray holds the fewest ranges that
+     * cover the points. Results follow the layout of the query, not the
+     * order of `points`; a dimension point may match any number of cells.
+     * See `point_rows` to map the results back to `points`.
      *
      * @tparam T Dimension type
      * @param dim Dimension name
@@ -148,12 +185,7 @@ class ManagedQuery {
      */
     template <typename T>
     void select_points(const std::string& dim, const std::vector<T>& points) {
-        subarray_range_set_ = true;
-        subarray_range_empty_[dim] = true;
-        for (auto& point : points) {
-            subarray_->add_range(dim, point, point);
-            subarray_range_empty_[dim] = false;
-        }
+        _select_points(dim, points.data(), points.size());
     }
 
     /**
@@ -165,12 +197,7 @@ class ManagedQuery {
      */
     template <typename T>
     void select_points(const std::string& dim, const tcb::span<T> points) {
-        subarray_range_set_ = true;
-        subarray_range_empty_[dim] = true;
-        for (auto& point : points) {
-            subarray_->add_range(dim, point, point);
-            subarray_range_empty_[dim] = false;
-        }
+        _select_points(dim, points.data(), points.size());
     }
 
     /**
@@ -194,6 +221,7 @@ class ManagedQuery {
      */
     void set_condition(const QueryCondition& qc) {
         query_->set_condition(qc);
+        condition_ = qc;
     }
 
     /**
@@ -334,6 +362,29 @@ class ManagedQuery {
         return schema_;
     }
 
+    /**
+     * @brief Return true if a range has been selected on any dimension.
+     */
+    bool has_ranges() const {
+        return subarray_range_set_;
+    }
+
+    /**
+     * @brief Reopen the array at a timestamp range before the query is
+     * submitted, so the query reads only the fragments in the range. The
+     * column selection, layout and query condition are kept, and no range
+     * may be selected yet.
+     *
+     * @param timestamp Timestamp range to open the array at
+     */
+    void reopen(const TimestampRange& timestamp);
+
+    /**
+     * @brief Return the timestamp range of the fragments written by the
+     * submitted write query, or std::nullopt if it wrote none.
+     */
+    std::optional<TimestampRange> written_timestamp_range() const;
+
     /**
      * @brief Return true if the only ranges selected were empty.
      *
@@ -359,6 +410,178 @@ class ManagedQuery {
         return query_->query_type();
     }
 
+    /**
+     * @brief Return a fingerprint of the selection of the query: the
+     * selected columns, the layout and the ranges of each dimension. Two
+     * queries on the same array with equal fingerprints (and conditions)
+     * read the same cells.
+     *
+     * @return std::string Fingerprint, as raw bytes
+     */
+    std::string selection_key();
+
+    /**
+     * @brief Map the results of a point selection on an int64 dimension
+     * back to the points: taking `rows` of the results lists the cells of
+     * each point in the order of `points`, repeating the cells of repeated
+     * points and skipping points that match no cell.
+     *
+     * @param points Points passed to `select_points`
+     * @param values Dimension values of the result rows, e.g. of all the
+     * batches of the read concatenated
+     * @param size Number of result rows
+     * @return PointRows The rows of each point
+     */
+    static PointRows point_rows(
+        const std::vector<int64_t>& points,
+        const int64_t* values,
+        size_t size);
+
+    /**
+     * @brief Return the number of ranges selected on a dimension.
+     *
+     * @param dim Dimension name
+     * @return uint64_t Number of ranges
+     */
+    uint64_t num_ranges(const std::string& dim) const {
+        return subarray_->range_num(dim);
+    }
+
+    /**
+     * @brief Set the thread pool used to sort large point selections. Without
+     * one, points are sorted on the calling thread.
+     *
+     * @param thread_pool Thread pool, usually the one of the SOMAContext
+     */
+    void set_thread_pool(std::shared_ptr<ThreadPool> thread_pool) {
+        thread_pool_ = thread_pool;
+    }
+
+   private:
+    //===================================================================
+    //= private static
+    //===================================================================
+
+    // Below this many points per thread, points are sorted on one thread
+    static constexpr size_t MIN_POINTS_PER_THREAD = 1 << 16;
+
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    /**
+     * @brief Return the concurrency level of the thread pool, or 1 without
+     * one.
+     */
+    size_t _concurrency_level() const;
+
+    /**
+     * @brief Run the tasks, on the thread pool when there are several.
+     */
+    void _run_tasks(std::vector<std::function<void()>>& tasks);
+
+    /**
+     * @brief Return a sorted copy of the points without duplicates. Large
+     * unsorted inputs are sorted in slices on the thread pool, then merged.
+     */
+    template <typename T>
+    std::vector<T> _sorted_unique(const T* data, size_t size) {
+        std::vector<T> points(data, data + size);
+        if (!std::is_sorted(points.begin(), points.end())) {
+            size_t num_threads = std::min<size_t>(
+                _concurrency_level(), size / MIN_POINTS_PER_THREAD);
+            if (num_threads <= 1) {
+                std::sort(points.begin(), points.end());
+            } else {
+                _parallel_sort(points, num_threads);
+            }
+        }
+        points.erase(std::unique(points.begin(), points.end()), points.end());
+        return points;
+    }
+
+    template <typename T>
+    void _parallel_sort(std::vector<T>& points, size_t num_threads) {
+        // Slice boundaries: slice i is [bounds[i], bounds[i + 1])
+        size_t slice_size = (points.size() + num_threads - 1) / num_threads;
+        std::vector<size_t> bounds;
+        for (size_t b = 0; b < points.size(); b += slice_size) {
+            bounds.push_back(b);
+        }
+        bounds.push_back(points.size());
+
+        std::vector<std::function<void()>> tasks;
+        for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+            auto first = points.begin() + bounds[i];
+            auto last = points.begin() + bounds[i + 1];
+            tasks.push_back([first, last]() { std::sort(first, last); });
+        }
+        _run_tasks(tasks);
+
+        // Merge neighbouring slices pairwise until one is left
+        while (bounds.size() > 2) {
+            std::vector<size_t> merged;
+            tasks.clear();
+            for (size_t i = 0; i + 2 < bounds.size(); i += 2) {
+                auto first = points.begin() + bounds[i];
+                auto middle = points.begin() + bounds[i + 1];
+                auto last = points.begin() + bounds[i + 2];
+                tasks.push_back([first, middle, last]() {
+                    std::inplace_merge(first, middle, last);
+                });
+                merged.push_back(bounds[i]);
+            }
+            if (bounds.size() % 2 == 0) {
+                // Odd number of slices: the last one is carried over
+                merged.push_back(bounds[bounds.size() - 2]);
+            }
+            merged.push_back(points.size());
+            _run_tasks(tasks);
+            bounds = std::move(merged);
+        }
+    }
+
+    /**
+     * @brief Add the ranges covering the points to the subarray.
+     */
+    template <typename T>
+    void _select_points(const std::string& dim, const T* data, size_t size) {
+        subarray_range_set_ = true;
+        subarray_range_empty_[dim] = true;
+        if (size == 0) {
+            return;
+        }
+
+        auto points = _sorted_unique(data, size);
+        size_t num_ranges = 0;
+        if constexpr (std::is_integral_v<T>) {
+            T start = points[0], stop = points[0];
+            for (size_t i = 1; i < points.size(); ++i) {
+                if (stop != std::numeric_limits<T>::max() &&
+                    points[i] == stop + 1) {
+                    stop = points[i];
+                    continue;
+                }
+                subarray_->add_range(dim, start, stop);
+                ++num_ranges;
+                start = stop = points[i];
+            }
+            subarray_->add_range(dim, start, stop);
+            ++num_ranges;
+        } else {
+            for (auto& point : points) {
+                subarray_->add_range(dim, point, point);
+            }
+            num_ranges = points.size();
+        }
+        subarray_range_empty_[dim] = false;
+
+        LOG_DEBUG(
+            "[ManagedQuery] [" + name_ + "] select_points on " + dim + ": " +
+            std::to_string(size) + " points in " + std::to_string(num_ranges) +
+            " ranges");
+    }
+
    private:
     //===================================================================
     //= private non-static
@@ -404,6 +627,9 @@ class ManagedQuery {
     // Total number of cells read by the query
     size_t total_num_cells_ = 0;
 
+    // Query condition set on the query, kept to rebuild it on reopen
+    std::optional<QueryCondition> condition_;
+
     // A collection of ColumnBuffers attached to the query
     std::shared_ptr<ArrayBuffers> buffers_;
 
@@ -412,6 +638,9 @@ class ManagedQuery {
 
     // Future for asyncronous query
     std::future<void> query_future_;
+
+    // Thread pool for sorting large point selections
+    std::shared_ptr<ThreadPool> thread_pool_;
 };
 };  // namespace tiledbsoma
 
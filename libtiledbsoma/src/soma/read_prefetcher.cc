@@ -0,0 +1,150 @@
+/**
+ * @file   read_prefetcher.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the ReadPrefetcher class.
+ */
+
+#include "read_prefetcher.h"
+#include "../utils/logger.h"
+
+namespace tiledbsoma {
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+ReadPrefetcher::ReadPrefetcher(
+    SOMAArray& array,
+    size_t queue_depth,
+    std::map<std::string, std::shared_ptr<IntIndexer>> reindexers)
+    : array_(array)
+    , queue_depth_(queue_depth)
+    , reindexers_(std::move(reindexers)) {
+    if (queue_depth_ == 0) {
+        throw TileDBSOMAError("[ReadPrefetcher] queue_depth must be positive");
+    }
+    for (const auto& [name, indexer] : reindexers_) {
+        if (indexer == nullptr) {
+            throw TileDBSOMAError(fmt::format(
+                "[ReadPrefetcher] Missing indexer for column '{}'", name));
+        }
+    }
+    thread_ = std::thread(&ReadPrefetcher::_run, this);
+}
+
+ReadPrefetcher::~ReadPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::optional<ReadPrefetcher::ArrowBatch> ReadPrefetcher::next() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !queue_.empty() || done_; });
+    if (queue_.empty()) {
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+        return std::nullopt;
+    }
+    auto batch = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    cv_.notify_all();
+    return batch;
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+void ReadPrefetcher::_run() {
+    size_t num_batches = 0;
+    try {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] {
+                    return queue_.size() < queue_depth_ || stop_;
+                });
+                if (stop_) {
+                    break;
+                }
+            }
+
+            auto buffers = array_.read_next();
+            if (!buffers) {
+                break;
+            }
+            _reindex(**buffers);
+            auto batch = ArrowAdapter::to_arrow(*buffers);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.push_back(std::move(batch));
+            }
+            cv_.notify_all();
+            ++num_batches;
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = std::current_exception();
+    }
+
+    LOG_DEBUG(fmt::format(
+        "[ReadPrefetcher] Read {} batches of {}", num_batches, array_.uri()));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ = true;
+    }
+    cv_.notify_all();
+}
+
+void ReadPrefetcher::_reindex(ArrayBuffers& buffers) const {
+    for (const auto& [name, indexer] : reindexers_) {
+        auto column = buffers.at(name);
+        if (column->type() != TILEDB_INT64) {
+            throw TileDBSOMAError(fmt::format(
+                "[ReadPrefetcher] Cannot reindex column '{}' of type {}",
+                name,
+                tiledb::impl::type_to_str(column->type())));
+        }
+        // Each position is read before it is written, so the lookup can
+        // run in place
+        auto values = column->data<int64_t>();
+        indexer->lookup(values.data(), values.data(), values.size());
+    }
+}
+
+}  // namespace tiledbsoma
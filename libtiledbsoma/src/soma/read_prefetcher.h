@@ -0,0 +1,133 @@
+/**
+ * @file   read_prefetcher.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the ReadPrefetcher class, which reads batches of a
+ *   SOMAArray ahead of the consumer on a background thread.
+ */
+
+#ifndef SOMA_READ_PREFETCHER_H
+#define SOMA_READ_PREFETCHER_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "../reindexer/reindexer.h"
+#include "../utils/arrow_adapter.h"
+#include "soma_array.h"
+
+namespace tiledbsoma {
+
+/**
+ * @brief Reads the batches of a SOMAArray query on a background thread.
+ *
+ * The thread runs `read_next`, optionally reindexes int64 columns, and
+ * converts each batch to an Arrow struct array, keeping up to
+ * `queue_depth` finished batches ahead of the consumer. The consumer only
+ * waits on the queue, so bindings can drop their interpreter lock for the
+ * whole wait and import each batch with a single call.
+ *
+ * The array must be opened for read with its selection set before the
+ * prefetcher is constructed, and must not be used by the caller until the
+ * prefetcher is exhausted or destroyed.
+ */
+class ReadPrefetcher {
+   public:
+    using ArrowBatch =
+        std::pair<std::unique_ptr<ArrowArray>, std::unique_ptr<ArrowSchema>>;
+
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    /**
+     * @brief Construct a prefetcher and start reading.
+     *
+     * @param array SOMAArray opened for read
+     * @param queue_depth Maximum number of finished batches held
+     * @param reindexers Indexers applied to int64 columns by name, whose
+     * values are replaced by their positions (or -1 when absent)
+     */
+    ReadPrefetcher(
+        SOMAArray& array,
+        size_t queue_depth = 2,
+        std::map<std::string, std::shared_ptr<IntIndexer>> reindexers = {});
+
+    ReadPrefetcher() = delete;
+    ReadPrefetcher(const ReadPrefetcher&) = delete;
+    ReadPrefetcher(ReadPrefetcher&&) = delete;
+    ~ReadPrefetcher();
+
+    /**
+     * @brief Return the next batch, waiting for it if needed, or
+     * std::nullopt when the query is complete. An error raised while
+     * reading is rethrown here.
+     */
+    std::optional<ArrowBatch> next();
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    /**
+     * @brief Body of the background thread.
+     */
+    void _run();
+
+    /**
+     * @brief Replace the values of the reindexed columns of a batch.
+     */
+    void _reindex(ArrayBuffers& buffers) const;
+
+    SOMAArray& array_;
+    size_t queue_depth_;
+    std::map<std::string, std::shared_ptr<IntIndexer>> reindexers_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<ArrowBatch> queue_;
+    std::exception_ptr error_;
+    bool done_ = false;
+    bool stop_ = false;
+
+    // Declared last so that it starts after, and is joined before, the
+    // state it uses
+    std::thread thread_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_READ_PREFETCHER_H
@@ -0,0 +1,150 @@
+/**
+ * @file   result_cache.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the ResultCache class.
+ */
+
+#include "result_cache.h"
+#include "../utils/logger.h"
+
+namespace tiledbsoma {
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+std::optional<std::vector<std::shared_ptr<ArrayBuffers>>> ResultCache::get(
+    const std::string& key) {
+    std::vector<std::shared_ptr<ArrayBuffers>> batches;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            ++misses_;
+            return std::nullopt;
+        }
+        ++hits_;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        batches = it->second->batches;
+    }
+
+    // Copy outside the lock. Cached batches are never modified, so sharing
+    // them with a concurrent eviction is safe.
+    std::vector<std::shared_ptr<ArrayBuffers>> result;
+    result.reserve(batches.size());
+    for (const auto& batch : batches) {
+        result.push_back(batch->clone());
+    }
+    return result;
+}
+
+bool ResultCache::put(
+    const std::string& uri,
+    const std::string& key,
+    std::vector<std::shared_ptr<ArrayBuffers>> batches) {
+    size_t nbytes = 0;
+    for (const auto& batch : batches) {
+        nbytes += batch->nbytes();
+    }
+    if (nbytes > capacity_) {
+        LOG_DEBUG(fmt::format(
+            "[ResultCache] skip {} bytes of '{}', over the {} byte budget",
+            nbytes,
+            uri,
+            capacity_));
+        return false;
+    }
+
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (auto it = index_.find(key); it != index_.end()) {
+        _erase(it->second);
+    }
+    while (nbytes_ + nbytes > capacity_) {
+        LOG_DEBUG(fmt::format(
+            "[ResultCache] evict {} bytes of '{}'",
+            entries_.back().nbytes,
+            entries_.back().uri));
+        _erase(std::prev(entries_.end()));
+    }
+
+    entries_.push_front(Entry{uri, key, std::move(batches), nbytes});
+    index_[key] = entries_.begin();
+    nbytes_ += nbytes;
+    return true;
+}
+
+void ResultCache::invalidate(const std::string& uri) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        auto next = std::next(it);
+        if (it->uri == uri) {
+            _erase(it);
+        }
+        it = next;
+    }
+}
+
+void ResultCache::clear() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+    nbytes_ = 0;
+}
+
+size_t ResultCache::nbytes() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return nbytes_;
+}
+
+size_t ResultCache::size() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+uint64_t ResultCache::hits() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+uint64_t ResultCache::misses() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+void ResultCache::_erase(std::list<Entry>::iterator it) {
+    nbytes_ -= it->nbytes;
+    index_.erase(it->key);
+    entries_.erase(it);
+}
+
+}  // namespace tiledbsoma
@@ -0,0 +1,170 @@
+/**
+ * @file   result_cache.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the ResultCache class, an LRU cache of read results
+ *   shared by the SOMAArrays of a SOMAContext.
+ */
+
+#ifndef SOMA_RESULT_CACHE
+#define SOMA_RESULT_CACHE
+
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "array_buffers.h"
+
+namespace tiledbsoma {
+
+/**
+ * @brief An LRU cache of the result batches of complete reads, bounded by a
+ * byte budget. Entries are keyed by a fingerprint of the read (see
+ * `SOMAArray::read_next`) and grouped by array URI for invalidation.
+ *
+ * The cache owns its batches: `put` takes batches that are not shared with
+ * readers, and `get` returns copies, since readers may modify batches in
+ * place (e.g. when converting to Arrow).
+ */
+class ResultCache {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    // Config key setting the byte budget of the context result cache. The
+    // cache is disabled if the key is absent or zero.
+    inline static const std::string
+        CONFIG_KEY_BYTES = "soma.read.result_cache_bytes";
+
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    /**
+     * @brief Construct a ResultCache.
+     *
+     * @param capacity Byte budget of the cache
+     */
+    ResultCache(size_t capacity)
+        : capacity_(capacity) {
+    }
+
+    ResultCache() = delete;
+    ResultCache(const ResultCache&) = delete;
+    ResultCache(ResultCache&&) = delete;
+    ~ResultCache() = default;
+
+    /**
+     * @brief Return copies of the batches cached for `key` and mark the
+     * entry most recently used, or std::nullopt on a miss.
+     *
+     * @param key Read fingerprint
+     */
+    std::optional<std::vector<std::shared_ptr<ArrayBuffers>>> get(
+        const std::string& key);
+
+    /**
+     * @brief Insert the batches of a complete read, evicting least recently
+     * used entries to stay within the byte budget. Results larger than the
+     * budget are not cached.
+     *
+     * @param uri URI of the array read
+     * @param key Read fingerprint
+     * @param batches Result batches, owned by the cache from now on
+     * @return true if the batches were cached
+     */
+    bool put(
+        const std::string& uri,
+        const std::string& key,
+        std::vector<std::shared_ptr<ArrayBuffers>> batches);
+
+    /**
+     * @brief Drop all entries of an array, e.g. after a write.
+     *
+     * @param uri URI of the array
+     */
+    void invalidate(const std::string& uri);
+
+    /**
+     * @brief Drop all entries.
+     */
+    void clear();
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    size_t nbytes();
+
+    size_t size();
+
+    uint64_t hits();
+
+    uint64_t misses();
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    struct Entry {
+        std::string uri;
+        std::string key;
+        std::vector<std::shared_ptr<ArrayBuffers>> batches;
+        size_t nbytes;
+    };
+
+    // Remove an entry, the caller holds `mutex_`
+    void _erase(std::list<Entry>::iterator it);
+
+    // Byte budget
+    size_t capacity_;
+
+    // Bytes held by the entries
+    size_t nbytes_ = 0;
+
+    // Entries, most recently used first
+    std::list<Entry> entries_;
+
+    // Map: key -> entry
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+
+    // Lookup statistics
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+
+    std::mutex mutex_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_RESULT_CACHE
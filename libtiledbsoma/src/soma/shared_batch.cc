@@ -0,0 +1,454 @@
+/**
+ * @file   shared_batch.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the SharedBatch class.
+ */
+
+#include "shared_batch.h"
+#include <cerrno>
+#include <cstring>
+#include "../utils/common.h"
+#include "../utils/logger.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tiledbsoma {
+
+namespace {
+
+constexpr char MAGIC[8] = {'S', 'O', 'M', 'A', 'S', 'H', 'M', '1'};
+
+// Buffers are aligned for SIMD access, as Arrow recommends
+constexpr uint64_t ALIGNMENT = 64;
+
+constexpr int MAX_BUFFERS = 3;
+
+struct SegmentHeader {
+    char magic[8];
+    uint64_t size;
+    int64_t num_rows;
+    uint64_t num_columns;
+    uint64_t num_nodes;
+};
+
+// An array of the segment: the columns first, then their dictionaries.
+// Offsets are relative to the start of the segment.
+struct NodeEntry {
+    uint64_t name;
+    uint64_t format;
+    int64_t flags;
+    int64_t length;
+    int64_t null_count;
+    int64_t n_buffers;
+    uint64_t buffers[MAX_BUFFERS];
+    uint64_t buffer_sizes[MAX_BUFFERS];
+    int64_t dictionary;
+};
+
+uint64_t align(uint64_t offset) {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+#if !defined(_WIN32)
+
+// Columns exported by ArrowAdapter::to_arrow, released on every exit path
+struct ExportedColumns {
+    ~ExportedColumns() {
+        for (auto& [array, schema] : tables) {
+            if (array->release != nullptr) {
+                array->release(array.get());
+            }
+            if (schema->release != nullptr) {
+                schema->release(schema.get());
+            }
+        }
+    }
+
+    std::vector<ArrowTable> tables;
+};
+
+// A read-only mapping of a segment, unmapped with its last reference
+struct Mapping {
+    Mapping(const uint8_t* data, size_t size)
+        : data(data)
+        , size(size) {
+    }
+
+    ~Mapping() {
+        munmap((void*)data, size);
+    }
+
+    const uint8_t* data;
+    size_t size;
+};
+
+void release_array(struct ArrowArray* array) {
+    for (int64_t i = 0; i < array->n_children; ++i) {
+        if (array->children[i] == nullptr) {
+            continue;
+        }
+        if (array->children[i]->release != nullptr) {
+            array->children[i]->release(array->children[i]);
+        }
+        free(array->children[i]);
+    }
+    free(array->children);
+    if (array->dictionary != nullptr) {
+        if (array->dictionary->release != nullptr) {
+            array->dictionary->release(array->dictionary);
+        }
+        free(array->dictionary);
+    }
+    free(array->buffers);
+    delete static_cast<std::shared_ptr<Mapping>*>(array->private_data);
+    array->release = nullptr;
+}
+
+// Initialize an array owning a reference to the mapping, with no buffers
+// or children yet, so it can be released at any point of the import
+void init_array(
+    struct ArrowArray* array, const std::shared_ptr<Mapping>& mapping) {
+    std::memset(array, 0, sizeof(*array));
+    array->private_data = new std::shared_ptr<Mapping>(mapping);
+    array->release = &release_array;
+}
+
+const char* segment_string(const Mapping& mapping, uint64_t offset) {
+    if (offset >= mapping.size ||
+        std::memchr(mapping.data + offset, '\0', mapping.size - offset) ==
+            nullptr) {
+        throw TileDBSOMAError("[SharedBatch] Corrupt segment string");
+    }
+    return reinterpret_cast<const char*>(mapping.data + offset);
+}
+
+void import_node(
+    const std::shared_ptr<Mapping>& mapping,
+    const NodeEntry* nodes,
+    uint64_t num_nodes,
+    uint64_t index,
+    struct ArrowArray* array,
+    struct ArrowSchema* schema) {
+    const auto& node = nodes[index];
+    if (node.n_buffers < 0 || node.n_buffers > MAX_BUFFERS) {
+        throw TileDBSOMAError("[SharedBatch] Corrupt segment node");
+    }
+
+    ArrowSchemaInit(schema);
+    if (ArrowSchemaSetFormat(schema, segment_string(*mapping, node.format)) !=
+            NANOARROW_OK ||
+        ArrowSchemaSetName(schema, segment_string(*mapping, node.name)) !=
+            NANOARROW_OK) {
+        throw TileDBSOMAError("[SharedBatch] Cannot create schema");
+    }
+    schema->flags = node.flags;
+
+    init_array(array, mapping);
+    array->length = node.length;
+    array->null_count = node.null_count;
+    array->n_buffers = node.n_buffers;
+    array->buffers = (const void**)calloc(node.n_buffers, sizeof(void*));
+    for (int64_t i = 0; i < node.n_buffers; ++i) {
+        if (node.buffer_sizes[i] == 0) {
+            continue;
+        }
+        if (node.buffers[i] > mapping->size ||
+            node.buffer_sizes[i] > mapping->size - node.buffers[i]) {
+            throw TileDBSOMAError("[SharedBatch] Corrupt segment buffer");
+        }
+        array->buffers[i] = mapping->data + node.buffers[i];
+    }
+
+    if (node.dictionary >= 0) {
+        // Dictionaries follow their column, which rules out cycles
+        if ((uint64_t)node.dictionary <= index ||
+            (uint64_t)node.dictionary >= num_nodes) {
+            throw TileDBSOMAError("[SharedBatch] Corrupt segment dictionary");
+        }
+        if (ArrowSchemaAllocateDictionary(schema) != NANOARROW_OK) {
+            throw TileDBSOMAError("[SharedBatch] Cannot create schema");
+        }
+        array->dictionary = (ArrowArray*)calloc(1, sizeof(ArrowArray));
+        import_node(
+            mapping,
+            nodes,
+            num_nodes,
+            node.dictionary,
+            array->dictionary,
+            schema->dictionary);
+    }
+}
+
+#endif
+
+}  // namespace
+
+//===================================================================
+//= public static
+//===================================================================
+
+#if !defined(_WIN32)
+
+size_t SharedBatch::write(
+    const std::string& name, std::shared_ptr<ArrayBuffers> batch) {
+    // Export the columns as read_next results are exported, so workers see
+    // the same Arrow layout
+    ExportedColumns columns;
+    for (const auto& column_name : batch->names()) {
+        columns.tables.push_back(
+            ArrowAdapter::to_arrow(batch->at(column_name)));
+    }
+    std::vector<std::pair<ArrowArray*, ArrowSchema*>> arrays;
+    for (auto& [array, schema] : columns.tables) {
+        arrays.emplace_back(array.get(), schema.get());
+    }
+    std::vector<int64_t> dictionaries(arrays.size(), -1);
+    for (size_t i = 0; i < arrays.size(); ++i) {
+        if (arrays[i].first->dictionary != nullptr) {
+            dictionaries[i] = arrays.size();
+            dictionaries.push_back(-1);
+            arrays.emplace_back(
+                arrays[i].first->dictionary, arrays[i].second->dictionary);
+        }
+    }
+
+    // Lay out the descriptors, the names and formats, then the buffers
+    std::vector<NodeEntry> nodes(arrays.size());
+    std::vector<std::string> names(arrays.size());
+    std::vector<const void*> sources(arrays.size() * MAX_BUFFERS);
+    uint64_t size = sizeof(SegmentHeader) + nodes.size() * sizeof(NodeEntry);
+    for (size_t i = 0; i < arrays.size(); ++i) {
+        auto [array, schema] = arrays[i];
+        auto& node = nodes[i];
+        names[i] = schema->name == nullptr ? "" : schema->name;
+        if (array->offset != 0 || array->n_buffers > MAX_BUFFERS ||
+            array->n_children != 0) {
+            throw TileDBSOMAError(fmt::format(
+                "[SharedBatch] Unsupported Arrow layout for column '{}'",
+                names[i]));
+        }
+        node.name = size;
+        size += names[i].size() + 1;
+        node.format = size;
+        size += strlen(schema->format) + 1;
+        node.flags = schema->flags;
+        node.length = array->length;
+        node.null_count = array->null_count;
+        node.n_buffers = array->n_buffers;
+        node.dictionary = dictionaries[i];
+
+        ArrowArrayView view;
+        ArrowError error;
+        if (ArrowArrayViewInitFromSchema(&view, schema, &error) !=
+                NANOARROW_OK ||
+            ArrowArrayViewSetArray(&view, array, &error) != NANOARROW_OK) {
+            ArrowArrayViewReset(&view);
+            throw TileDBSOMAError(fmt::format(
+                "[SharedBatch] Cannot export column '{}': {}",
+                names[i],
+                error.message));
+        }
+        for (int64_t b = 0; b < array->n_buffers; ++b) {
+            auto buffer_size = array->buffers[b] == nullptr ?
+                                   0 :
+                                   view.buffer_views[b].size_bytes;
+            size = align(size);
+            node.buffers[b] = buffer_size == 0 ? 0 : size;
+            node.buffer_sizes[b] = buffer_size;
+            sources[i * MAX_BUFFERS + b] = array->buffers[b];
+            size += buffer_size;
+        }
+        ArrowArrayViewReset(&view);
+    }
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        throw TileDBSOMAError(fmt::format(
+            "[SharedBatch] Cannot create segment {}: {}",
+            name,
+            strerror(errno)));
+    }
+    void* data = MAP_FAILED;
+    if (ftruncate(fd, size) == 0) {
+        data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    auto err = errno;
+    close(fd);
+    if (data == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw TileDBSOMAError(fmt::format(
+            "[SharedBatch] Cannot map segment {} of {} bytes: {}",
+            name,
+            size,
+            strerror(err)));
+    }
+
+    auto segment = static_cast<uint8_t*>(data);
+    SegmentHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.size = size;
+    header.num_rows = batch->num_rows();
+    header.num_columns = columns.tables.size();
+    header.num_nodes = nodes.size();
+    std::memcpy(segment, &header, sizeof(header));
+    std::memcpy(
+        segment + sizeof(header),
+        nodes.data(),
+        nodes.size() * sizeof(NodeEntry));
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        auto schema = arrays[i].second;
+        std::strcpy((char*)segment + nodes[i].name, names[i].c_str());
+        std::strcpy((char*)segment + nodes[i].format, schema->format);
+        for (int64_t b = 0; b < nodes[i].n_buffers; ++b) {
+            if (nodes[i].buffer_sizes[b] > 0) {
+                std::memcpy(
+                    segment + nodes[i].buffers[b],
+                    sources[i * MAX_BUFFERS + b],
+                    nodes[i].buffer_sizes[b]);
+            }
+        }
+    }
+    munmap(data, size);
+
+    LOG_DEBUG(fmt::format(
+        "[SharedBatch] Wrote {} rows of {} columns to {} ({} bytes)",
+        header.num_rows,
+        header.num_columns,
+        name,
+        size));
+    return size;
+}
+
+ArrowTable SharedBatch::open(const std::string& name, bool unlink) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw TileDBSOMAError(fmt::format(
+            "[SharedBatch] Cannot open segment {}: {}", name, strerror(errno)));
+    }
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(SegmentHeader)) {
+        data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw TileDBSOMAError(
+            fmt::format("[SharedBatch] Cannot map segment {}", name));
+    }
+    if (unlink) {
+        shm_unlink(name.c_str());
+    }
+    auto mapping = std::make_shared<Mapping>(
+        static_cast<const uint8_t*>(data), st.st_size);
+
+    SegmentHeader header;
+    std::memcpy(&header, mapping->data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.size != mapping->size ||
+        header.num_nodes >
+            (mapping->size - sizeof(header)) / sizeof(NodeEntry) ||
+        header.num_columns > header.num_nodes) {
+        throw TileDBSOMAError(
+            fmt::format("[SharedBatch] {} is not a batch segment", name));
+    }
+    auto nodes = reinterpret_cast<const NodeEntry*>(
+        mapping->data + sizeof(header));
+
+    auto array = std::make_unique<ArrowArray>();
+    auto schema = std::make_unique<ArrowSchema>();
+    ArrowSchemaInit(schema.get());
+    init_array(array.get(), mapping);
+    try {
+        if (ArrowSchemaSetFormat(schema.get(), "+s") != NANOARROW_OK ||
+            ArrowSchemaSetName(schema.get(), "") != NANOARROW_OK ||
+            ArrowSchemaAllocateChildren(schema.get(), header.num_columns) !=
+                NANOARROW_OK) {
+            throw TileDBSOMAError("[SharedBatch] Cannot create schema");
+        }
+        schema->flags = 0;
+        array->length = header.num_rows;
+        array->n_buffers = 1;
+        array->buffers = (const void**)calloc(1, sizeof(void*));
+        array->children = (ArrowArray**)calloc(
+            header.num_columns, sizeof(ArrowArray*));
+        array->n_children = header.num_columns;
+        for (uint64_t i = 0; i < header.num_columns; ++i) {
+            array->children[i] = (ArrowArray*)calloc(1, sizeof(ArrowArray));
+            import_node(
+                mapping,
+                nodes,
+                header.num_nodes,
+                i,
+                array->children[i],
+                schema->children[i]);
+        }
+    } catch (...) {
+        array->release(array.get());
+        schema->release(schema.get());
+        throw;
+    }
+    LOG_DEBUG(fmt::format(
+        "[SharedBatch] Mapped {} rows of {} columns from {}",
+        header.num_rows,
+        header.num_columns,
+        name));
+    return ArrowTable(std::move(array), std::move(schema));
+}
+
+void SharedBatch::unlink(const std::string& name) {
+    if (shm_unlink(name.c_str()) != 0) {
+        throw TileDBSOMAError(fmt::format(
+            "[SharedBatch] Cannot remove segment {}: {}",
+            name,
+            strerror(errno)));
+    }
+}
+
+#else
+
+size_t SharedBatch::write(const std::string&, std::shared_ptr<ArrayBuffers>) {
+    throw TileDBSOMAError("[SharedBatch] Shared memory is not supported");
+}
+
+ArrowTable SharedBatch::open(const std::string&, bool) {
+    throw TileDBSOMAError("[SharedBatch] Shared memory is not supported");
+}
+
+void SharedBatch::unlink(const std::string&) {
+    throw TileDBSOMAError("[SharedBatch] Shared memory is not supported");
+}
+
+#endif
+
+}  // namespace tiledbsoma
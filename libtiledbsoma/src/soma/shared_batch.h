@@ -0,0 +1,98 @@
+/**
+ * @file   shared_batch.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the SharedBatch class, which hands read batches from
+ *   one process to others through POSIX shared memory.
+ */
+
+#ifndef SOMA_SHARED_BATCH_H
+#define SOMA_SHARED_BATCH_H
+
+#include <string>
+
+#include "../utils/arrow_adapter.h"
+#include "array_buffers.h"
+
+namespace tiledbsoma {
+
+/**
+ * @brief Hand read batches from a reader process to worker processes
+ * through named POSIX shared memory segments, so the batches are read and
+ * decoded once per node rather than once per worker.
+ *
+ * The segment holds the Arrow C data layout of the batch: the buffers of
+ * each column, as exported by `ArrowAdapter::to_arrow`, and a small
+ * descriptor table. Workers map the segment read-only and get an Arrow
+ * struct array whose buffers point into the mapping. The segment is
+ * unmapped when the array and all its children are released.
+ *
+ * Segment names follow `shm_open`: a leading slash and no other slashes,
+ * e.g. "/soma-batch-1234-0".
+ */
+class SharedBatch {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /**
+     * @brief Write a batch into a new shared memory segment. As with
+     * `ArrowAdapter::to_arrow`, the validity and boolean buffers of the
+     * batch are converted to bitmaps in place, so the batch should not be
+     * exported again.
+     *
+     * @param name Segment name. The segment must not exist.
+     * @param batch Batch to write
+     * @return size_t Size of the segment in bytes
+     */
+    static size_t write(
+        const std::string& name, std::shared_ptr<ArrayBuffers> batch);
+
+    /**
+     * @brief Map a segment written by `write` without copying it.
+     *
+     * @param name Segment name
+     * @param unlink Remove the segment name once it is mapped. The memory is
+     * freed when the last mapping of the segment is released.
+     * @return ArrowTable A struct array with one child per column and its
+     * schema
+     */
+    static ArrowTable open(const std::string& name, bool unlink = true);
+
+    /**
+     * @brief Remove a segment name, e.g. when a batch is not consumed.
+     *
+     * @param name Segment name
+     */
+    static void unlink(const std::string& name);
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_SHARED_BATCH_H
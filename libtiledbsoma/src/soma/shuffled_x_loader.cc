@@ -0,0 +1,279 @@
+/**
+ * @file   shuffled_x_loader.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the ShuffledXLoader class.
+ */
+
+#include "shuffled_x_loader.h"
+#include <algorithm>
+#include <numeric>
+#include "../utils/logger.h"
+#include "compressed_matrix.h"
+
+namespace tiledbsoma {
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+std::vector<float> XMinibatch::to_dense() const {
+    std::vector<float> dense(n_rows() * n_cols, 0);
+    for (size_t row = 0; row < n_rows(); ++row) {
+        for (int64_t pos = indptr[row]; pos < indptr[row + 1]; ++pos) {
+            dense[row * n_cols + indices[pos]] = data[pos];
+        }
+    }
+    return dense;
+}
+
+ShuffledXLoader::ShuffledXLoader(
+    std::shared_ptr<SOMAContext> ctx,
+    std::string_view uri,
+    std::vector<int64_t> obs_joinids,
+    std::vector<int64_t> var_joinids,
+    ShuffledXLoaderOptions options,
+    std::optional<TimestampRange> timestamp)
+    : ctx_(ctx)
+    , uri_(uri)
+    , options_(options)
+    , timestamp_(timestamp)
+    , obs_joinids_(std::move(obs_joinids))
+    , var_joinids_(std::move(var_joinids)) {
+    if (options_.batch_size == 0 || options_.chunk_size == 0 ||
+        options_.buffer_size == 0) {
+        throw TileDBSOMAError(
+            "[ShuffledXLoader] batch_size, chunk_size and buffer_size must "
+            "be positive");
+    }
+    if (options_.shard >= options_.num_shards) {
+        throw TileDBSOMAError(fmt::format(
+            "[ShuffledXLoader] Invalid shard {} of {}",
+            options_.shard,
+            options_.num_shards));
+    }
+
+    std::sort(obs_joinids_.begin(), obs_joinids_.end());
+    obs_joinids_.erase(
+        std::unique(obs_joinids_.begin(), obs_joinids_.end()),
+        obs_joinids_.end());
+
+    var_bitmap_ = JoinidBitmap::from_joinids(var_joinids_);
+    var_indexer_ = std::make_shared<IntIndexer>(ctx_);
+    var_indexer_->map_locations(var_joinids_);
+
+    set_epoch(0);
+}
+
+ShuffledXLoader::~ShuffledXLoader() {
+    if (prefetch_.valid()) {
+        prefetch_.wait();
+    }
+}
+
+void ShuffledXLoader::set_epoch(uint64_t epoch) {
+    if (prefetch_.valid()) {
+        prefetch_.wait();
+        prefetch_ = {};
+    }
+    epoch_ = epoch;
+    pending_.clear();
+    buffers_.clear();
+    next_buffer_ = 0;
+    num_rows_ = 0;
+
+    // Every shard computes the same chunk order from the seed and epoch
+    uint64_t epoch_seed = options_.seed + epoch * 0x9E3779B97F4A7C15ULL;
+    size_t num_chunks = (obs_joinids_.size() + options_.chunk_size - 1) /
+                        options_.chunk_size;
+    std::vector<size_t> chunks(num_chunks);
+    std::iota(chunks.begin(), chunks.end(), 0);
+    if (options_.shuffle) {
+        std::mt19937_64 chunk_rng(epoch_seed);
+        std::shuffle(chunks.begin(), chunks.end(), chunk_rng);
+    }
+    rng_.seed(epoch_seed ^ ((options_.shard + 1) * 0xBF58476D1CE4E5B9ULL));
+
+    std::vector<int64_t> buffer;
+    for (size_t i = options_.shard; i < num_chunks;
+         i += options_.num_shards) {
+        size_t begin = chunks[i] * options_.chunk_size;
+        size_t end = std::min(
+            begin + options_.chunk_size, obs_joinids_.size());
+        buffer.insert(
+            buffer.end(),
+            obs_joinids_.begin() + begin,
+            obs_joinids_.begin() + end);
+        num_rows_ += end - begin;
+        if (buffer.size() >= options_.buffer_size) {
+            buffers_.push_back(std::move(buffer));
+            buffer.clear();
+        }
+    }
+    if (!buffer.empty()) {
+        buffers_.push_back(std::move(buffer));
+    }
+
+    LOG_DEBUG(fmt::format(
+        "[ShuffledXLoader] Epoch {} of shard {}/{}: {} rows in {} buffers",
+        epoch_,
+        options_.shard,
+        options_.num_shards,
+        num_rows_,
+        buffers_.size()));
+
+    _prefetch();
+}
+
+std::optional<XMinibatch> ShuffledXLoader::next() {
+    while (pending_.size() < options_.batch_size && prefetch_.valid()) {
+        auto buffer = prefetch_.get();
+        _prefetch();
+
+        std::vector<int64_t> rows(buffer->joinids.size());
+        std::iota(rows.begin(), rows.end(), 0);
+        if (options_.shuffle) {
+            std::shuffle(rows.begin(), rows.end(), rng_);
+        }
+        for (auto row : rows) {
+            pending_.emplace_back(buffer, row);
+        }
+    }
+
+    if (pending_.empty() ||
+        (options_.drop_last && pending_.size() < options_.batch_size)) {
+        pending_.clear();
+        return std::nullopt;
+    }
+
+    XMinibatch batch;
+    batch.n_cols = var_joinids_.size();
+    size_t n_rows = std::min(options_.batch_size, pending_.size());
+    batch.obs_joinids.reserve(n_rows);
+    batch.indptr.reserve(n_rows + 1);
+    batch.indptr.push_back(0);
+    for (size_t i = 0; i < n_rows; ++i) {
+        auto& [buffer, row] = pending_.front();
+        auto begin = buffer->indptr[row];
+        auto end = buffer->indptr[row + 1];
+        batch.obs_joinids.push_back(buffer->joinids[row]);
+        batch.indices.insert(
+            batch.indices.end(),
+            buffer->indices.begin() + begin,
+            buffer->indices.begin() + end);
+        batch.data.insert(
+            batch.data.end(),
+            buffer->data.begin() + begin,
+            buffer->data.begin() + end);
+        batch.indptr.push_back(batch.indices.size());
+        pending_.pop_front();
+    }
+    return batch;
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+std::shared_ptr<ShuffledXLoader::Buffer> ShuffledXLoader::_load(
+    std::vector<int64_t> joinids) const {
+    auto buffer = std::make_shared<Buffer>();
+    std::sort(joinids.begin(), joinids.end());
+    buffer->joinids = std::move(joinids);
+    auto n_rows = static_cast<int64_t>(buffer->joinids.size());
+    auto n_cols = static_cast<int64_t>(var_joinids_.size());
+    if (n_rows == 0 || n_cols == 0) {
+        buffer->indptr.assign(n_rows + 1, 0);
+        return buffer;
+    }
+
+    IntIndexer obs_indexer(ctx_);
+    obs_indexer.map_locations(buffer->joinids);
+
+    // A row-major read of sorted rows is already in CSR order, so the
+    // assembly below takes the presorted path
+    auto x = SOMASparseNDArray::open(
+        uri_,
+        OpenMode::read,
+        ctx_,
+        {"soma_dim_0", "soma_dim_1", "soma_data"},
+        ResultOrder::rowmajor,
+        timestamp_);
+    x->set_dim_joinids(
+        "soma_dim_0", JoinidBitmap::from_joinids(buffer->joinids));
+    x->set_dim_joinids("soma_dim_1", var_bitmap_);
+
+    // The reindexed batches must stay alive until `compress()`
+    CompressedMatrix<float> matrix(CompressedFormat::csr, n_rows, n_cols, ctx_);
+    std::vector<std::vector<int64_t>> rows, cols;
+    std::vector<std::vector<float>> values;
+    while (auto batch = x->read_next()) {
+        size_t size = (*batch)->num_rows();
+        if (size == 0) {
+            continue;
+        }
+        rows.emplace_back(size);
+        cols.emplace_back(size);
+        obs_indexer.lookup(
+            (*batch)->at("soma_dim_0")->data<int64_t>().data(),
+            rows.back().data(),
+            size);
+        var_indexer_->lookup(
+            (*batch)->at("soma_dim_1")->data<int64_t>().data(),
+            cols.back().data(),
+            size);
+        values.push_back((*batch)->at("soma_data")->values_as<float>());
+        matrix.append(
+            rows.back().data(), cols.back().data(), values.back().data(), size);
+    }
+    x->close();
+    matrix.compress();
+
+    buffer->indptr = std::move(matrix.indptr());
+    buffer->indices = std::move(matrix.indices());
+    buffer->data = std::move(matrix.data());
+
+    LOG_DEBUG(fmt::format(
+        "[ShuffledXLoader] Loaded {} rows with {} cells",
+        n_rows,
+        buffer->data.size()));
+    return buffer;
+}
+
+void ShuffledXLoader::_prefetch() {
+    if (next_buffer_ >= buffers_.size()) {
+        return;
+    }
+    prefetch_ = std::async(
+        std::launch::async,
+        [this, joinids = buffers_[next_buffer_++]]() mutable {
+            return _load(std::move(joinids));
+        });
+}
+
+}  // namespace tiledbsoma
@@ -0,0 +1,226 @@
+/**
+ * @file   shuffled_x_loader.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the ShuffledXLoader class, which streams shuffled,
+ *   reindexed minibatches of obs rows of an X layer for model training.
+ */
+
+#ifndef SOMA_SHUFFLED_X_LOADER_H
+#define SOMA_SHUFFLED_X_LOADER_H
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "../reindexer/reindexer.h"
+#include "../utils/joinid_bitmap.h"
+#include "soma_context.h"
+#include "soma_sparse_ndarray.h"
+
+namespace tiledbsoma {
+
+struct ShuffledXLoaderOptions {
+    // Seed of the shuffle. All shards of a run must use the same seed.
+    uint64_t seed = 0;
+
+    // Number of obs rows per minibatch
+    size_t batch_size = 1024;
+
+    // Number of consecutive obs joinids read together. Chunks are the unit
+    // of the global shuffle, so larger chunks read faster but mix less.
+    size_t chunk_size = 64;
+
+    // Number of obs rows held in memory and shuffled together
+    size_t buffer_size = 1 << 16;
+
+    // If false, rows are emitted in soma_joinid order
+    bool shuffle = true;
+
+    // The loader emits every `num_shards`-th chunk starting at `shard`, so
+    // distributed ranks and data loader workers read disjoint rows
+    uint32_t shard = 0;
+    uint32_t num_shards = 1;
+
+    // Drop the last minibatch of an epoch if it is smaller than batch_size
+    bool drop_last = false;
+};
+
+/**
+ * @brief A minibatch of obs rows of an X layer in CSR form. Column indices
+ * are positions in the var joinids of the loader.
+ */
+struct XMinibatch {
+    // soma_joinid of each row
+    std::vector<int64_t> obs_joinids;
+
+    std::vector<int64_t> indptr;
+    std::vector<int64_t> indices;
+    std::vector<float> data;
+
+    // Number of columns
+    int64_t n_cols = 0;
+
+    size_t n_rows() const {
+        return obs_joinids.size();
+    }
+
+    /**
+     * @brief Return the minibatch as a row-major (n_rows, n_cols) matrix.
+     */
+    std::vector<float> to_dense() const;
+};
+
+/**
+ * @brief Streams shuffled minibatches of obs rows of a 2D sparse array.
+ *
+ * The selected obs joinids are split into chunks of consecutive joinids,
+ * which keeps reads local. Each epoch, the chunks are shuffled, the shard
+ * takes its share of them, and consecutive chunks are grouped into buffers
+ * of about `buffer_size` rows. Buffers are read on a background thread one
+ * buffer ahead of the consumer, and the rows of each buffer are shuffled
+ * before being split into minibatches. Rows left over at the end of a
+ * buffer are emitted with the rows of the next one, so all minibatches but
+ * the last have `batch_size` rows.
+ */
+class ShuffledXLoader {
+   public:
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    /**
+     * @brief Construct a loader and schedule epoch 0. The first buffer is
+     * read in the background immediately.
+     *
+     * @param ctx SOMAContext
+     * @param uri URI of the 2D sparse array (e.g. an X layer)
+     * @param obs_joinids soma_dim_0 joinids to emit
+     * @param var_joinids soma_dim_1 joinids to read, whose positions are
+     * the column indices of the minibatches
+     * @param options Loader options
+     * @param timestamp Optional timestamp range to read at
+     */
+    ShuffledXLoader(
+        std::shared_ptr<SOMAContext> ctx,
+        std::string_view uri,
+        std::vector<int64_t> obs_joinids,
+        std::vector<int64_t> var_joinids,
+        ShuffledXLoaderOptions options = ShuffledXLoaderOptions(),
+        std::optional<TimestampRange> timestamp = std::nullopt);
+
+    ShuffledXLoader() = delete;
+    ShuffledXLoader(const ShuffledXLoader&) = delete;
+    ShuffledXLoader(ShuffledXLoader&&) = delete;
+    ~ShuffledXLoader();
+
+    /**
+     * @brief Restart the loader at the beginning of an epoch. Each epoch
+     * has its own shuffle, derived from the seed.
+     *
+     * @param epoch Epoch number
+     */
+    void set_epoch(uint64_t epoch);
+
+    uint64_t epoch() const {
+        return epoch_;
+    }
+
+    /**
+     * @brief Return the number of rows this shard emits per epoch.
+     */
+    size_t num_rows() const {
+        return num_rows_;
+    }
+
+    /**
+     * @brief Return the next minibatch of the epoch, or std::nullopt at the
+     * end of the epoch.
+     */
+    std::optional<XMinibatch> next();
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    // Rows of a buffer in CSR form, ordered by soma_joinid
+    struct Buffer {
+        std::vector<int64_t> joinids;
+        std::vector<int64_t> indptr;
+        std::vector<int64_t> indices;
+        std::vector<float> data;
+    };
+
+    /**
+     * @brief Read the X rows of the given obs joinids.
+     */
+    std::shared_ptr<Buffer> _load(std::vector<int64_t> joinids) const;
+
+    /**
+     * @brief Start reading the next scheduled buffer, if any.
+     */
+    void _prefetch();
+
+    std::shared_ptr<SOMAContext> ctx_;
+    std::string uri_;
+    ShuffledXLoaderOptions options_;
+    std::optional<TimestampRange> timestamp_;
+
+    // Sorted obs joinids
+    std::vector<int64_t> obs_joinids_;
+
+    // Selected var joinids and their positions
+    std::vector<int64_t> var_joinids_;
+    JoinidBitmap var_bitmap_;
+    std::shared_ptr<IntIndexer> var_indexer_;
+
+    uint64_t epoch_ = 0;
+    size_t num_rows_ = 0;
+
+    // Obs joinids of each buffer of the epoch, and the next one to read
+    std::vector<std::vector<int64_t>> buffers_;
+    size_t next_buffer_ = 0;
+
+    // Shuffles the rows within buffers
+    std::mt19937_64 rng_;
+
+    // Rows not yet emitted, in emission order
+    std::deque<std::pair<std::shared_ptr<Buffer>, int64_t>> pending_;
+
+    // Buffer being read in the background. Declared last so that it is
+    // waited on before the state it reads is destroyed.
+    std::future<std::shared_ptr<Buffer>> prefetch_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_SHUFFLED_X_LOADER_H
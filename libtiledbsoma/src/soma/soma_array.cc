@@ -31,9 +31,15 @@
  */
 
 #include "soma_array.h"
+#include <algorithm>
 #include <tiledb/array_experimental.h>
 #include "../utils/logger.h"
 #include "../utils/util.h"
+#include "array_handle_cache.h"
+#include "category_index.h"
+#include "disk_cache.h"
+#include "key_filter_index.h"
+#include "result_cache.h"
 namespace tiledbsoma {
 using namespace tiledb;
 
@@ -172,6 +178,7 @@ SOMAArray::SOMAArray(
     , timestamp_(timestamp)
     , mq_(std::make_unique<ManagedQuery>(arr, ctx_->tiledb_ctx(), name_))
     , arr_(arr) {
+    mq_->set_thread_pool(ctx_->thread_pool());
     reset({}, batch_size_, result_order_);
     fill_metadata_cache();
 }
@@ -203,6 +210,17 @@ void SOMAArray::fill_metadata_cache() {
     }
 }
 
+std::optional<std::string> SOMAArray::_metadata_string(
+    const std::string& key) const {
+    auto it = metadata_.find(key);
+    if (it == metadata_.end()) {
+        return std::nullopt;
+    }
+    return std::string(
+        static_cast<const char*>(std::get<MetadataInfo::value>(it->second)),
+        std::get<MetadataInfo::num>(it->second));
+}
+
 const std::string SOMAArray::uri() const {
     return uri_;
 };
@@ -211,6 +229,15 @@ std::shared_ptr<SOMAContext> SOMAArray::ctx() {
     return ctx_;
 };
 
+std::unique_ptr<ArrowSchema> SOMAArray::arrow_schema() const {
+    if (array_cached_) {
+        return ctx_->array_handle_cache()->arrow_schema(
+            ctx_->tiledb_ctx(), arr_);
+    }
+    return ArrowAdapter::arrow_schema_from_tiledb_array(
+        ctx_->tiledb_ctx(), arr_);
+}
+
 void SOMAArray::open(OpenMode mode, std::optional<TimestampRange> timestamp) {
     timestamp_ = timestamp;
 
@@ -220,19 +247,33 @@ void SOMAArray::open(OpenMode mode, std::optional<TimestampRange> timestamp) {
 }
 
 void SOMAArray::close() {
-    if (arr_->query_type() == TILEDB_WRITE)
+    if (arr_->query_type() == TILEDB_WRITE) {
         meta_cache_arr_->close();
+        // Cached handles do not see the data and metadata written
+        if (auto cache = ctx_->array_handle_cache()) {
+            cache->invalidate(uri_);
+        }
+    }
 
     // Close the array through the managed query to ensure any pending queries
-    // are completed.
-    mq_->close();
+    // are completed. A cached handle is shared and stays open.
+    mq_->close(!array_cached_);
     metadata_.clear();
+    closed_ = true;
 }
 
 void SOMAArray::reset(
     std::vector<std::string> column_names,
     std::string_view batch_size,
     ResultOrder result_order) {
+    // Undo the narrowing of a key lookup before the query is rebuilt
+    if (unnarrowed_timestamp_) {
+        arr_->set_open_timestamp_start(unnarrowed_timestamp_->first);
+        arr_->set_open_timestamp_end(unnarrowed_timestamp_->second);
+        arr_->reopen();
+        unnarrowed_timestamp_.reset();
+    }
+
     // Reset managed query
     mq_->reset();
 
@@ -263,9 +304,217 @@ void SOMAArray::reset(
     result_order_ = result_order;
     first_read_next_ = true;
     submitted_ = false;
+    late_materialization_columns_.reset();
+    condition_key_ = "";
+    cached_batches_.reset();
+    cached_num_cells_ = 0;
+    result_cache_key_.reset();
+    result_cache_batches_.clear();
+    result_cache_nbytes_ = 0;
+}
+
+void SOMAArray::set_condition(
+    QueryCondition& qc, std::vector<std::string> filter_columns) {
+    mq_->set_condition(qc);
+    condition_key_.reset();
+
+    auto config = ctx_->tiledb_ctx()->config();
+    if (config.contains(CONFIG_KEY_LATE_MATERIALIZATION) &&
+        config.get(CONFIG_KEY_LATE_MATERIALIZATION) == "true") {
+        set_late_materialization(std::move(filter_columns));
+    }
+}
+
+void SOMAArray::_late_materialize() {
+    auto filter_columns = std::move(*late_materialization_columns_);
+    late_materialization_columns_.reset();
+
+    // The matching cells are selected by dimension value in the second
+    // phase, which is exact only for a single int64 dimension without
+    // duplicates
+    auto schema = mq_->schema();
+    auto dims = schema->domain().dimensions();
+    if (dims.size() != 1 || dims[0].type() != TILEDB_INT64 ||
+        schema->allows_dups()) {
+        return;
+    }
+    auto dim = dims[0].name();
+
+    auto projection = mq_->column_names();
+    if (projection.empty()) {
+        projection.push_back(dim);
+        for (uint32_t i = 0; i < schema->attribute_num(); ++i) {
+            projection.push_back(schema->attribute(i).name());
+        }
+    }
+
+    std::vector<std::string> phase_columns{dim};
+    for (const auto& name : filter_columns) {
+        if (name != dim) {
+            phase_columns.push_back(name);
+        }
+    }
+
+    // Nothing is saved if the first phase reads all selected columns
+    bool covered = std::all_of(
+        projection.begin(), projection.end(), [&](const auto& name) {
+            return std::find(
+                       phase_columns.begin(), phase_columns.end(), name) !=
+                   phase_columns.end();
+        });
+    if (covered) {
+        return;
+    }
+
+    // First phase: read the dimension and filter columns with the query
+    // condition and the selected ranges
+    auto selected = mq_->column_names();
+    mq_->reset_columns();
+    mq_->select_columns(phase_columns);
+
+    JoinidBitmap matches;
+    while (auto batch = _read_next()) {
+        auto joinids = (*batch)->at(dim)->data<int64_t>();
+        matches |= JoinidBitmap::from_joinids(joinids.data(), joinids.size());
+    }
+
+    LOG_DEBUG(fmt::format(
+        "[SOMAArray] late materialization of '{}': {} matching cells",
+        uri_,
+        matches.cardinality()));
+
+    // Second phase: read the selected columns of the matching cells. The
+    // query condition is not reapplied, the matching cells already satisfy
+    // it.
+    std::string batch_size = batch_size_;
+    auto result_cache_key = std::move(result_cache_key_);
+    reset(selected, batch_size, result_order_);
+    set_dim_joinids(dim, matches);
+    result_cache_key_ = std::move(result_cache_key);
+}
+
+void SOMAArray::_lookup_result_cache() {
+    auto cache = ctx_->result_cache();
+    auto disk_cache = _disk_cache();
+    if ((cache == nullptr && disk_cache == nullptr) || !condition_key_ ||
+        mode() != OpenMode::read || mq_->is_empty_query()) {
+        return;
+    }
+
+    std::string key = uri_;
+    key.push_back('\0');
+    if (timestamp_) {
+        key += std::to_string(timestamp_->first) + "-" +
+               std::to_string(timestamp_->second);
+    }
+    key.push_back('\0');
+    key += *condition_key_;
+    key.push_back('\0');
+    key += std::to_string(static_cast<int>(result_order_));
+    key.push_back('\0');
+    key += mq_->selection_key();
+
+    if (cache != nullptr) {
+        if (auto batches = cache->get(key)) {
+            LOG_DEBUG(fmt::format(
+                "[SOMAArray] result cache hit for '{}': {} batches",
+                uri_,
+                batches->size()));
+            cached_batches_.emplace(batches->begin(), batches->end());
+            return;
+        }
+    }
+    if (disk_cache != nullptr) {
+        if (auto batches = disk_cache->get(uri_, key)) {
+            LOG_DEBUG(fmt::format(
+                "[SOMAArray] disk cache hit for '{}': {} batches",
+                uri_,
+                batches->size()));
+            // Keep the read in memory for the next lookup
+            if (cache != nullptr) {
+                std::vector<std::shared_ptr<ArrayBuffers>> copies;
+                for (const auto& batch : *batches) {
+                    copies.push_back(batch->clone());
+                }
+                cache->put(uri_, key, std::move(copies));
+            }
+            cached_batches_.emplace(batches->begin(), batches->end());
+            return;
+        }
+    }
+    result_cache_key_ = std::move(key);
+}
+
+std::shared_ptr<DiskCache> SOMAArray::_disk_cache() {
+    // Entries outlive the process, so only reads at a fixed timestamp can
+    // be served from disk without missing later writes
+    if (!timestamp_) {
+        return nullptr;
+    }
+    return ctx_->disk_cache();
+}
+
+void SOMAArray::_record_result(std::shared_ptr<ArrayBuffers> batch) {
+    auto cache = ctx_->result_cache();
+    auto disk_cache = _disk_cache();
+    size_t capacity = std::max(
+        cache ? cache->capacity() : 0,
+        disk_cache ? disk_cache->capacity() : 0);
+
+    // Copy the batch before it is returned, readers may modify it in place
+    auto copy = batch->clone();
+    result_cache_nbytes_ += copy->nbytes();
+    if (result_cache_nbytes_ > capacity) {
+        LOG_DEBUG(fmt::format(
+            "[SOMAArray] read of '{}' exceeds the result cache budget", uri_));
+        result_cache_key_.reset();
+        result_cache_batches_.clear();
+        return;
+    }
+    result_cache_batches_.push_back(copy);
+
+    if (mq_->results_complete()) {
+        if (disk_cache != nullptr) {
+            disk_cache->put(uri_, *result_cache_key_, result_cache_batches_);
+        }
+        if (cache != nullptr) {
+            cache->put(
+                uri_, *result_cache_key_, std::move(result_cache_batches_));
+        }
+        result_cache_key_.reset();
+        result_cache_batches_.clear();
+    }
 }
 
 std::optional<std::shared_ptr<ArrayBuffers>> SOMAArray::read_next() {
+    if (first_read_next_ && !cached_batches_ && !result_cache_key_) {
+        _lookup_result_cache();
+    }
+
+    // Serve a read found in the result cache
+    if (cached_batches_) {
+        first_read_next_ = false;
+        if (cached_batches_->empty()) {
+            return std::nullopt;
+        }
+        auto batch = cached_batches_->front();
+        cached_batches_->pop_front();
+        cached_num_cells_ += batch->num_rows();
+        return batch;
+    }
+
+    if (late_materialization_columns_) {
+        _late_materialize();
+    }
+
+    auto batch = _read_next();
+    if (batch && result_cache_key_) {
+        _record_result(*batch);
+    }
+    return batch;
+}
+
+std::optional<std::shared_ptr<ArrayBuffers>> SOMAArray::_read_next() {
     // If the query is complete, return `std::nullopt`
     if (mq_->is_complete(true)) {
         return std::nullopt;
@@ -444,6 +693,38 @@ uint64_t SOMAArray::_get_max_capacity(tiledb_datatype_t index_type) {
     }
 }
 
+void SOMAArray::set_dim_points(
+    const std::string& dim, const std::vector<std::string>& points) {
+    if (mode() == OpenMode::read && metadata_.count(KEY_FILTER_INDEX_KEY)) {
+        if (auto candidates = KeyFilterIndex::filter(*this, dim, points)) {
+            if (candidates->fragments) {
+                _narrow_to_fragments(*candidates->fragments);
+            }
+            mq_->select_points(dim, candidates->keys);
+            return;
+        }
+    }
+    mq_->select_points(dim, points);
+}
+
+void SOMAArray::_narrow_to_fragments(const TimestampRange& fragments) {
+    // A shared handle cannot be reopened, and ranges already selected
+    // belong to the query on the array as it is opened
+    if (array_cached_ || submitted_ || mq_->has_ranges()) {
+        return;
+    }
+    TimestampRange opened = unnarrowed_timestamp_.value_or(TimestampRange(
+        arr_->open_timestamp_start(), arr_->open_timestamp_end()));
+    TimestampRange narrowed(
+        std::max(opened.first, fragments.first),
+        std::min(opened.second, fragments.second));
+    if (narrowed.first > narrowed.second || narrowed == opened) {
+        return;
+    }
+    mq_->reopen(narrowed);
+    unnarrowed_timestamp_ = opened;
+}
+
 void SOMAArray::set_column_data(
     std::string_view name,
     uint64_t num_elems,
@@ -664,19 +945,163 @@ void SOMAArray::write(bool sort_coords) {
     if (mq_->query_type() != TILEDB_WRITE) {
         throw TileDBSOMAError("[SOMAArray] array must be opened in write mode");
     }
+
+    // The column-major layout is only mirrored while it holds every cell of
+    // this array. Once another writer or a failed mirror leaves it behind,
+    // its recorded state stays stale and reads fall back to this array.
+    std::unique_ptr<SOMAArray> layout;
+    auto layout_uri = _metadata_string(COLMAJOR_LAYOUT_KEY);
+    if (layout_uri && array_buffer_ != nullptr) {
+        layout = SOMAArray::open(
+            OpenMode::write,
+            *layout_uri,
+            ctx_,
+            "",
+            {},
+            "auto",
+            ResultOrder::automatic,
+            timestamp_);
+        if (layout->layout_source_state() != fragment_state()) {
+            LOG_WARN(fmt::format(
+                "[SOMAArray] column-major layout '{}' of '{}' is stale and "
+                "is not updated",
+                *layout_uri,
+                uri_));
+            layout->close();
+            layout = nullptr;
+        }
+    }
+
     mq_->submit_write(sort_coords);
 
+    // The cells are written: reset the query and drop the cached reads of
+    // this array first, so a failed update of a layout or index below
+    // cannot leave them stale
+    auto written = array_buffer_;
+    auto written_timestamp = mq_->written_timestamp_range();
     mq_->reset();
     array_buffer_ = nullptr;
+    if (auto cache = ctx_->result_cache()) {
+        cache->invalidate(uri_);
+    }
+    if (auto cache = ctx_->disk_cache()) {
+        cache->invalidate(uri_);
+    }
+    if (auto cache = ctx_->array_handle_cache()) {
+        cache->invalidate(uri_);
+    }
+
+    // Mirror the cells to the layout, whose global order differs, so the
+    // write is always unordered
+    if (layout != nullptr) {
+        try {
+            for (auto& name : written->names()) {
+                layout->mq_->set_column_data(written->at(name));
+            }
+            layout->mq_->submit_write(true);
+            layout->set_layout_source_state(fragment_state());
+            layout->close();
+        } catch (const std::exception& e) {
+            LOG_WARN(fmt::format(
+                "[SOMAArray] cannot update column-major layout '{}' of '{}', "
+                "reads fall back to the array: {}",
+                *layout_uri,
+                uri_,
+                e.what()));
+        }
+    }
+
+    // Add the written rows to the category index
+    auto index_uri = _metadata_string(CATEGORY_INDEX_KEY);
+    if (index_uri && written != nullptr) {
+        CategoryIndex::update(ctx_, *index_uri, *written, timestamp_);
+    }
+
+    // Add a filter of the written keys to the key filter index
+    auto filter_uri = _metadata_string(KEY_FILTER_INDEX_KEY);
+    if (filter_uri && written != nullptr && written_timestamp) {
+        KeyFilterIndex::update(
+            ctx_, *filter_uri, *written, *written_timestamp, timestamp_);
+    }
 }
 
 void SOMAArray::consolidate_and_vacuum(std::vector<std::string> modes) {
     for (auto mode : modes) {
         auto cfg = ctx_->tiledb_ctx()->config();
         cfg["sm.consolidation.mode"] = mode;
-        Array::consolidate(Context(cfg), uri_);
-        Array::vacuum(Context(cfg), uri_);
+        if (auto layout_uri = _metadata_string(COLMAJOR_LAYOUT_KEY)) {
+            _consolidate_with_layout(cfg, *layout_uri);
+        } else {
+            Array::consolidate(Context(cfg), uri_);
+            Array::vacuum(Context(cfg), uri_);
+        }
+        // Filters are tied to the fragments that were just merged
+        auto filter_uri = _metadata_string(KEY_FILTER_INDEX_KEY);
+        if (filter_uri && mode == "fragments") {
+            KeyFilterIndex::compact(*this, *filter_uri, cfg);
+        }
+    }
+}
+
+void SOMAArray::_consolidate_with_layout(
+    const Config& cfg, const std::string& layout_uri) {
+    // Consolidating fragments changes the fragment state of this array, so
+    // a layout that was current is recorded as current again
+    auto layout = SOMAArray::open(
+        OpenMode::write,
+        layout_uri,
+        ctx_,
+        "",
+        {},
+        "auto",
+        ResultOrder::automatic,
+        timestamp_);
+    bool current = layout->layout_source_state() == fragment_state();
+    Array::consolidate(Context(cfg), uri_);
+    Array::vacuum(Context(cfg), uri_);
+    Array::consolidate(Context(cfg), layout_uri);
+    Array::vacuum(Context(cfg), layout_uri);
+    if (current) {
+        layout->set_layout_source_state(fragment_state());
+    }
+    layout->close();
+}
+
+std::array<uint64_t, 2> SOMAArray::fragment_state() const {
+    FragmentInfo fragment_info(*ctx_->tiledb_ctx(), uri_);
+    fragment_info.load();
+
+    std::array<uint64_t, 2> state = {0, 0};
+    for (uint32_t fid = 0; fid < fragment_info.fragment_num(); fid++) {
+        auto frag_ts = fragment_info.timestamp_range(fid);
+        if (timestamp_ && frag_ts.second > timestamp_->second) {
+            continue;
+        }
+        state[0]++;
+        state[1] = std::max(state[1], frag_ts.second);
+    }
+    return state;
+}
+
+std::optional<std::array<uint64_t, 2>> SOMAArray::layout_source_state()
+    const {
+    auto it = metadata_.find(COLMAJOR_SOURCE_STATE_KEY);
+    if (it == metadata_.end() ||
+        std::get<MetadataInfo::dtype>(it->second) != TILEDB_UINT64 ||
+        std::get<MetadataInfo::num>(it->second) != 2) {
+        return std::nullopt;
     }
+    auto value = static_cast<const uint64_t*>(
+        std::get<MetadataInfo::value>(it->second));
+    return std::array<uint64_t, 2>{value[0], value[1]};
+}
+
+void SOMAArray::set_layout_source_state(
+    const std::array<uint64_t, 2>& state) {
+    // Written directly, since the metadata cache would keep a pointer to
+    // the caller's value
+    arr_->put_metadata(
+        COLMAJOR_SOURCE_STATE_KEY, TILEDB_UINT64, 2, state.data());
 }
 
 uint64_t SOMAArray::nnz() {
@@ -977,22 +1402,39 @@ void SOMAArray::validate(
     // Validate parameters
     auto tdb_mode = mode == OpenMode::read ? TILEDB_READ : TILEDB_WRITE;
 
-    try {
+    auto open_array = [&]() {
         LOG_DEBUG(fmt::format("[SOMAArray] opening array '{}'", uri_));
+        std::shared_ptr<Array> array;
         if (timestamp) {
-            arr_ = std::make_shared<Array>(
+            array = std::make_shared<Array>(
                 *ctx_->tiledb_ctx(),
                 uri_,
                 tdb_mode,
                 TemporalPolicy(
                     TimestampStartEnd, timestamp->first, timestamp->second));
         } else {
-            arr_ = std::make_shared<Array>(*ctx_->tiledb_ctx(), uri_, tdb_mode);
+            array = std::make_shared<Array>(
+                *ctx_->tiledb_ctx(), uri_, tdb_mode);
         }
         LOG_TRACE(fmt::format("[SOMAArray] loading enumerations"));
         ArrayExperimental::load_all_enumerations(
-            *ctx_->tiledb_ctx(), *(arr_.get()));
+            *ctx_->tiledb_ctx(), *(array.get()));
+        return array;
+    };
+
+    try {
+        // Arrays opened for read may be shared through the context cache
+        auto cache = ctx_->array_handle_cache();
+        array_cached_ = cache != nullptr && tdb_mode == TILEDB_READ;
+        if (array_cached_) {
+            arr_ = cache->open(uri_, timestamp, open_array);
+        } else {
+            arr_ = open_array();
+        }
+        unnarrowed_timestamp_.reset();
+        closed_ = false;
         mq_ = std::make_unique<ManagedQuery>(arr_, ctx_->tiledb_ctx(), name);
+        mq_->set_thread_pool(ctx_->thread_pool());
     } catch (const std::exception& e) {
         throw TileDBSOMAError(
             fmt::format("Error opening array: '{}'\n  {}", uri_, e.what()));
@@ -35,11 +35,14 @@
 
 #include <stdexcept>  // for windows: error C2039: 'runtime_error': is not a member of 'std'
 
+#include <array>
+#include <deque>
 #include <future>
 
 #include <tiledb/tiledb>
 #include <tiledb/tiledb_experimental>
 #include "../utils/arrow_adapter.h"
+#include "../utils/joinid_bitmap.h"
 #include "enums.h"
 #include "logger_public.h"
 #include "managed_query.h"
@@ -48,12 +51,19 @@
 namespace tiledbsoma {
 using namespace tiledb;
 
+class DiskCache;
+
 class SOMAArray : public SOMAObject {
    public:
     //===================================================================
     //= public static
     //===================================================================
 
+    // Config key enabling late materialization of filtered reads, see
+    // `set_late_materialization`. Accepts "true" or "false" (default).
+    inline static const std::string
+        CONFIG_KEY_LATE_MATERIALIZATION = "soma.read.late_materialization";
+
     /**
      * @brief Create a SOMAArray object at the given URI.
      *
@@ -179,9 +189,14 @@ class SOMAArray : public SOMAObject {
               other.arr_, other.ctx_->tiledb_ctx(), other.name_))
         , arr_(other.arr_)
         , meta_cache_arr_(other.meta_cache_arr_)
+        , array_cached_(other.array_cached_)
+        , unnarrowed_timestamp_(other.unnarrowed_timestamp_)
+        , closed_(other.closed_)
         , first_read_next_(other.first_read_next_)
         , submitted_(other.submitted_)
+        , late_materialization_columns_(other.late_materialization_columns_)
         , array_buffer_(other.array_buffer_) {
+        mq_->set_thread_pool(ctx_->thread_pool());
         fill_metadata_cache();
     }
 
@@ -233,7 +248,7 @@ class SOMAArray : public SOMAObject {
      * @return bool true if open
      */
     bool is_open() const {
-        return arr_->is_open();
+        return !closed_ && arr_->is_open();
     }
 
     /**
@@ -343,6 +358,19 @@ class SOMAArray : public SOMAObject {
         mq_->select_points(dim, points);
     }
 
+    /**
+     * @brief Set the dimension slice using multiple string points. If the
+     * array has a KeyFilterIndex of the dimension, keys it rules out are
+     * dropped first, so they add no range. When this is the first range
+     * selected, the read is also narrowed to the timestamp range of the
+     * fragments whose filters the remaining keys pass, until `reset`.
+     *
+     * @param dim
+     * @param points
+     */
+    void set_dim_points(
+        const std::string& dim, const std::vector<std::string>& points);
+
     /**
      * @brief Set the dimension slice using multiple ranges
      *
@@ -358,6 +386,23 @@ class SOMAArray : public SOMAObject {
         mq_->select_ranges(dim, ranges);
     }
 
+    /**
+     * @brief Set the slice of an int64 dimension from a joinid set. The set
+     * is added as coalesced ranges, so runs of consecutive joinids cost one
+     * subarray range each. An empty set selects nothing.
+     *
+     * @param dim Dimension name
+     * @param joinids Joinid set
+     */
+    void set_dim_joinids(const std::string& dim, const JoinidBitmap& joinids) {
+        auto ranges = joinids.to_ranges();
+        LOG_DEBUG(
+            "[SOMAArray] set_dim_joinids: " +
+            std::to_string(joinids.cardinality()) + " joinids in " +
+            std::to_string(ranges.size()) + " ranges");
+        mq_->select_ranges(dim, ranges);
+    }
+
     /**
      * @brief Set a query condition.
      *
@@ -365,6 +410,49 @@ class SOMAArray : public SOMAObject {
      */
     void set_condition(QueryCondition& qc) {
         mq_->set_condition(qc);
+        condition_key_.reset();
+    }
+
+    /**
+     * @brief Set a query condition that references `filter_columns`. If
+     * `soma.read.late_materialization` is set to "true" in the context
+     * config, the read is late materialized (see `set_late_materialization`).
+     *
+     * @param qc Query condition
+     * @param filter_columns Names of the columns referenced by `qc`
+     */
+    void set_condition(
+        QueryCondition& qc, std::vector<std::string> filter_columns);
+
+    /**
+     * @brief Read the next query in two phases. The first phase reads only
+     * the dimension and `filter_columns`, applying the query condition, to
+     * find the matching cells. The second phase reads the selected columns
+     * of the matching cells only, so the remaining columns are decoded only
+     * where the condition holds.
+     *
+     * This applies to arrays with a single int64 dimension that do not
+     * allow duplicates, when the selected columns are not already covered
+     * by the first phase. Otherwise the query is read in one phase. The
+     * setting is cleared by `reset`.
+     *
+     * @param filter_columns Names of the columns referenced by the query
+     * condition
+     */
+    void set_late_materialization(std::vector<std::string> filter_columns) {
+        late_materialization_columns_ = std::move(filter_columns);
+    }
+
+    /**
+     * @brief Identify the query condition set on this array, e.g. by the
+     * expression it was parsed from. Reads with a query condition are only
+     * served from the context result cache (see `read_next`) when the
+     * condition is identified.
+     *
+     * @param key Identifier of the query condition
+     */
+    void set_condition_key(std::string key) {
+        condition_key_ = std::move(key);
     }
 
     /**
@@ -412,6 +500,17 @@ class SOMAArray : public SOMAObject {
      *       ...process batch ...
      *   }
      *
+     * If the context has a result cache (`soma.read.result_cache_bytes`),
+     * a read is keyed by the URI, timestamp, selection, query condition and
+     * result order. A read found in the cache returns copies of the cached
+     * batches without I/O, and a complete read is added to the cache. Writes
+     * through `write` invalidate the cached reads of the array.
+     *
+     * If the context also has a disk cache (`soma.read.disk_cache_dir` and
+     * `soma.read.disk_cache_bytes`), reads of arrays opened at a timestamp
+     * are looked up there on a result cache miss and written there once
+     * complete, so later epochs or processes skip TileDB decoding.
+     *
      * @return std::optional<std::shared_ptr<ArrayBuffers>>
      */
     std::optional<std::shared_ptr<ArrayBuffers>> read_next();
@@ -505,6 +604,9 @@ class SOMAArray : public SOMAObject {
      * @return true if the query is complete, as described above
      */
     bool is_complete(bool query_status_only = false) {
+        if (cached_batches_) {
+            return cached_batches_->empty();
+        }
         return mq_->is_complete(query_status_only);
     }
 
@@ -516,6 +618,9 @@ class SOMAArray : public SOMAObject {
      * query
      */
     bool results_complete() {
+        if (cached_batches_) {
+            return cached_batches_->empty();
+        }
         return mq_->results_complete();
     }
 
@@ -526,6 +631,9 @@ class SOMAArray : public SOMAObject {
      * @return size_t Total number of cells read
      */
     size_t total_num_cells() {
+        if (cached_batches_) {
+            return cached_num_cells_;
+        }
         return mq_->total_num_cells();
     }
 
@@ -561,10 +669,7 @@ class SOMAArray : public SOMAObject {
      *
      * @return std::unique_ptr<ArrowSchema> Schema
      */
-    std::unique_ptr<ArrowSchema> arrow_schema() const {
-        return ArrowAdapter::arrow_schema_from_tiledb_array(
-            ctx_->tiledb_ctx(), arr_);
-    }
+    std::unique_ptr<ArrowSchema> arrow_schema() const;
 
     /**
      * @brief Get the capacity of each dimension.
@@ -748,6 +853,26 @@ class SOMAArray : public SOMAObject {
      */
     std::optional<TimestampRange> timestamp();
 
+   protected:
+    /**
+     * Return the number of fragments visible at the open timestamp and the
+     * end timestamp of the newest one. A copy of the array that records
+     * this state holds the same cells as long as the state is unchanged.
+     */
+    std::array<uint64_t, 2> fragment_state() const;
+
+    /**
+     * Return the source fragment state recorded by a column-major layout,
+     * if any.
+     */
+    std::optional<std::array<uint64_t, 2>> layout_source_state() const;
+
+    /**
+     * Record the source fragment state of a column-major layout open for
+     * write.
+     */
+    void set_layout_source_state(const std::array<uint64_t, 2>& state);
+
    private:
     //===================================================================
     //= private non-static
@@ -956,6 +1081,17 @@ class SOMAArray : public SOMAObject {
     // Fills the metadata cache upon opening the array.
     void fill_metadata_cache();
 
+    // String value of a metadata key, if any
+    std::optional<std::string> _metadata_string(const std::string& key) const;
+
+    // Reopens arr_ at the timestamp range of the fragments that may hold
+    // the keys of a lookup, if no range is selected yet
+    void _narrow_to_fragments(const TimestampRange& fragments);
+
+    // Consolidates and vacuums this array and its column-major layout
+    void _consolidate_with_layout(
+        const Config& cfg, const std::string& layout_uri);
+
     // Helper function for set_array_data
     ArrowTable _cast_table(
         std::unique_ptr<ArrowSchema> arrow_schema,
@@ -993,15 +1129,60 @@ class SOMAArray : public SOMAObject {
     // for the metadata value pointers in the cache to be accessible
     std::shared_ptr<Array> meta_cache_arr_;
 
+    // True if arr_ is shared through the context array handle cache
+    bool array_cached_ = false;
+
+    // Timestamp range arr_ was opened at, while a key lookup has narrowed
+    // it to the fragments that may hold the keys (see `set_dim_points`)
+    std::optional<TimestampRange> unnarrowed_timestamp_;
+
+    // True if the array was closed. A cached arr_ stays open when closed.
+    bool closed_ = false;
+
     // True if this is the first call to read_next()
     bool first_read_next_ = true;
 
     // True if the query was submitted
     bool submitted_ = false;
 
+    // Filter columns of a late materialized read, see
+    // `set_late_materialization`
+    std::optional<std::vector<std::string>> late_materialization_columns_;
+
+    // Identifier of the query condition for the result cache: empty if no
+    // condition is set, std::nullopt if the condition is not identified
+    std::optional<std::string> condition_key_ = "";
+
+    // Remaining batches of a read served from the result cache, and the
+    // number of cells returned so far
+    std::optional<std::deque<std::shared_ptr<ArrayBuffers>>> cached_batches_;
+    size_t cached_num_cells_ = 0;
+
+    // Result cache key and copies of the batches of a read to be cached
+    // once complete
+    std::optional<std::string> result_cache_key_;
+    std::vector<std::shared_ptr<ArrayBuffers>> result_cache_batches_;
+    size_t result_cache_nbytes_ = 0;
+
     // Unoptimized method for computing nnz() (issue `count_cells` query)
     uint64_t nnz_slow();
 
+    // Read the next batch of the managed query
+    std::optional<std::shared_ptr<ArrayBuffers>> _read_next();
+
+    // Look up the read in the result cache at the start of `read_next`
+    void _lookup_result_cache();
+
+    // Return the context disk cache if reads of this array may use it
+    std::shared_ptr<DiskCache> _disk_cache();
+
+    // Record a batch of a read to be cached
+    void _record_result(std::shared_ptr<ArrayBuffers> batch);
+
+    // Run the first phase of a late materialized read and select the
+    // matching cells for the second phase
+    void _late_materialize();
+
     // ArrayBuffers to hold ColumnBuffers alive when submitting to write query
     std::shared_ptr<ArrayBuffers> array_buffer_ = nullptr;
 };
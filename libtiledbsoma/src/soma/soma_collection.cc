@@ -31,6 +31,8 @@
  */
 
 #include "soma_collection.h"
+#include <thread_pool/thread_pool.h>
+#include "../utils/logger.h"
 #include "soma_experiment.h"
 #include "soma_measurement.h"
 
@@ -79,11 +81,146 @@ void SOMACollection::close() {
 
 std::unique_ptr<SOMAObject> SOMACollection::get(const std::string& key) {
     auto tiledb_obj = SOMAGroup::get(key);
+    // The member type is known from the group, which saves a storage lookup
+    std::optional<std::string> soma_type = std::nullopt;
+    if (tiledb_obj.type() == Object::Type::Array) {
+        soma_type = "SOMAArray";
+    } else if (tiledb_obj.type() == Object::Type::Group) {
+        soma_type = "SOMAGroup";
+    }
     auto soma_obj = SOMAObject::open(
-        tiledb_obj.uri(), OpenMode::read, this->ctx(), this->timestamp());
+        tiledb_obj.uri(),
+        OpenMode::read,
+        this->ctx(),
+        this->timestamp(),
+        soma_type);
     return soma_obj;
 }
 
+std::map<std::string, std::shared_ptr<SOMAObject>>
+SOMACollection::open_members(const std::vector<std::string>& paths) {
+    // A member is opened if it is requested or leads to a requested member,
+    // or if it is nested under a requested collection
+    auto selected = [&paths](const std::string& path) {
+        if (paths.empty()) {
+            return true;
+        }
+        for (const auto& p : paths) {
+            if (p == path || p.rfind(path + "/", 0) == 0 ||
+                path.rfind(p + "/", 0) == 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    struct PendingMember {
+        SOMACollection* parent;
+        std::string key;
+        std::string path;
+        SOMAGroupEntry entry;
+    };
+
+    std::map<std::string, std::shared_ptr<SOMAObject>> opened;
+    std::vector<std::pair<std::string, SOMACollection*>> level = {
+        {"", this}};
+    while (!level.empty()) {
+        std::vector<std::pair<std::string, SOMACollection*>> next_level;
+        std::vector<PendingMember> pending;
+        for (const auto& [prefix, collection] : level) {
+            for (const auto& [key, entry] : collection->members_map()) {
+                auto path = prefix.empty() ? key : prefix + "/" + key;
+                if (!selected(path)) {
+                    continue;
+                }
+                auto child = collection->_opened_member<SOMAObject>(key);
+                if (child == nullptr) {
+                    pending.push_back({collection, key, path, entry});
+                    continue;
+                }
+                opened[path] = child;
+                if (auto coll = dynamic_cast<SOMACollection*>(child.get())) {
+                    next_level.emplace_back(path, coll);
+                }
+            }
+        }
+
+        // Open all members of this level concurrently on the context thread
+        // pool, which bounds the number of opens in flight. The member type
+        // is known from the group, which saves a storage lookup per member.
+        std::vector<std::shared_ptr<SOMAObject>> children(pending.size());
+        std::vector<std::exception_ptr> errors(pending.size());
+        auto open_member = [&](size_t i) {
+            const auto& member = pending[i];
+            std::optional<std::string> soma_type = std::nullopt;
+            if (member.entry.second == "SOMAArray" ||
+                member.entry.second == "SOMAGroup") {
+                soma_type = member.entry.second;
+            }
+            try {
+                children[i] = SOMAObject::open(
+                    member.entry.first,
+                    OpenMode::read,
+                    ctx(),
+                    timestamp(),
+                    soma_type);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        };
+        auto& pool = ctx()->thread_pool();
+        if (pool == nullptr || pending.size() <= 1) {
+            for (size_t i = 0; i < pending.size(); ++i) {
+                open_member(i);
+            }
+        } else {
+            std::vector<ThreadPool::Task> tasks;
+            for (size_t i = 0; i < pending.size(); ++i) {
+                tasks.emplace_back(pool->execute([&open_member, i]() {
+                    open_member(i);
+                    return Status::Ok();
+                }));
+            }
+            pool->wait_all(tasks);
+        }
+
+        // Every open has finished, so the first error can be rethrown
+        std::exception_ptr error = nullptr;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (errors[i] != nullptr) {
+                if (error == nullptr) {
+                    error = errors[i];
+                }
+                continue;
+            }
+            pending[i].parent->children_[pending[i].key] = children[i];
+            opened[pending[i].path] = children[i];
+            if (auto coll = dynamic_cast<SOMACollection*>(children[i].get())) {
+                next_level.emplace_back(pending[i].path, coll);
+            }
+        }
+        if (error != nullptr) {
+            std::rethrow_exception(error);
+        }
+
+        LOG_DEBUG(fmt::format(
+            "[SOMACollection] {} opened {} members concurrently",
+            uri(),
+            pending.size()));
+        level = std::move(next_level);
+    }
+    return opened;
+}
+
+std::shared_ptr<SOMAObject> SOMACollection::member(const std::string& key) {
+    auto child = _opened_member<SOMAObject>(key);
+    if (child == nullptr) {
+        child = get(key);
+        children_[key] = child;
+    }
+    return child;
+}
+
 std::shared_ptr<SOMACollection> SOMACollection::add_new_collection(
     std::string_view key,
     std::string_view uri,
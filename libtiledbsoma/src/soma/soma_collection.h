@@ -139,6 +139,31 @@ class SOMACollection : public SOMAGroup {
      */
     std::unique_ptr<SOMAObject> get(const std::string& key);
 
+    /**
+     * @brief Open the members of this collection and of its nested
+     * collections for read. The tree is walked breadth-first and all the
+     * members of one level are opened concurrently, so opening a whole
+     * experiment costs one round of storage requests per level instead of
+     * one per member. Opened members are kept as children of their parent
+     * collection and are closed with it.
+     *
+     * @param paths Member paths relative to this collection, e.g.
+     * "ms/RNA/X/data". Only the given members and the collections leading
+     * to them are opened. All members are opened if empty.
+     * @return std::map<std::string, std::shared_ptr<SOMAObject>> The opened
+     * members keyed by their relative path
+     */
+    std::map<std::string, std::shared_ptr<SOMAObject>> open_members(
+        const std::vector<std::string>& paths = {});
+
+    /**
+     * @brief Return the member associated with the key, opening it for read
+     * if it was not already opened by `open_members`.
+     *
+     * @param key of member
+     */
+    std::shared_ptr<SOMAObject> member(const std::string& key);
+
     /**
      * Create and add a SOMACollection to the SOMACollection.
      *
@@ -276,6 +301,19 @@ class SOMACollection : public SOMAGroup {
     //= protected non-static
     //===================================================================
 
+    /**
+     * @brief Return the already opened member associated with the key if it
+     * has type T, or nullptr.
+     */
+    template <typename T>
+    std::shared_ptr<T> _opened_member(const std::string& key) {
+        auto it = children_.find(key);
+        if (it == children_.end() || !it->second->is_open()) {
+            return nullptr;
+        }
+        return std::dynamic_pointer_cast<T>(it->second);
+    }
+
     // Members of the SOMACollection
     std::map<std::string, std::shared_ptr<SOMAObject>> children_;
 };
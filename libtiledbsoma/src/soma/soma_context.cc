@@ -31,6 +31,10 @@
  */
 #include "soma_context.h"
 #include <thread_pool/thread_pool.h>
+#include "../utils/logger.h"
+#include "array_handle_cache.h"
+#include "disk_cache.h"
+#include "result_cache.h"
 
 namespace tiledbsoma {
 
@@ -50,4 +54,60 @@ std::shared_ptr<ThreadPool>& SOMAContext::thread_pool() {
     }
     return thread_pool_;
 }
+
+std::shared_ptr<ResultCache> SOMAContext::result_cache() {
+    const std::lock_guard<std::mutex> lock(cache_mutex_);
+    // The first thread that gets here will create the context result cache
+    if (!result_cache_init_) {
+        result_cache_init_ = true;
+        auto capacity = _config_size(ResultCache::CONFIG_KEY_BYTES);
+        if (capacity > 0) {
+            result_cache_ = std::make_shared<ResultCache>(capacity);
+        }
+    }
+    return result_cache_;
+}
+
+std::shared_ptr<DiskCache> SOMAContext::disk_cache() {
+    const std::lock_guard<std::mutex> lock(cache_mutex_);
+    if (!disk_cache_init_) {
+        disk_cache_init_ = true;
+        auto cfg = tiledb_config();
+        auto dir = cfg.find(DiskCache::CONFIG_KEY_DIR);
+        auto capacity = _config_size(DiskCache::CONFIG_KEY_BYTES);
+        if (dir != cfg.end() && !dir->second.empty() && capacity > 0) {
+            disk_cache_ = std::make_shared<DiskCache>(dir->second, capacity);
+        }
+    }
+    return disk_cache_;
+}
+
+std::shared_ptr<ArrayHandleCache> SOMAContext::array_handle_cache() {
+    const std::lock_guard<std::mutex> lock(cache_mutex_);
+    if (!array_handle_cache_init_) {
+        array_handle_cache_init_ = true;
+        auto capacity = _config_size(ArrayHandleCache::CONFIG_KEY_SIZE);
+        if (capacity > 0) {
+            array_handle_cache_ = std::make_shared<ArrayHandleCache>(capacity);
+        }
+    }
+    return array_handle_cache_;
+}
+
+size_t SOMAContext::_config_size(const std::string& key) const {
+    auto cfg = tiledb_config();
+    auto it = cfg.find(key);
+    if (it == cfg.end()) {
+        return 0;
+    }
+    try {
+        return std::stoull(it->second);
+    } catch (const std::exception& e) {
+        throw TileDBSOMAError(fmt::format(
+            "[SOMAContext] Error parsing {}: '{}' ({})",
+            key,
+            it->second,
+            e.what()));
+    }
+}
 }  // namespace tiledbsoma
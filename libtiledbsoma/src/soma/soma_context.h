@@ -39,6 +39,9 @@
 #include <tiledb/tiledb>
 
 namespace tiledbsoma {
+class ArrayHandleCache;
+class DiskCache;
+class ResultCache;
 class ThreadPool;
 
 using namespace tiledb;
@@ -73,6 +76,25 @@ class SOMAContext {
 
     std::shared_ptr<ThreadPool>& thread_pool();
 
+    /**
+     * @brief Return the result cache shared by the arrays opened with this
+     * context, or nullptr if `soma.read.result_cache_bytes` is not set.
+     */
+    std::shared_ptr<ResultCache> result_cache();
+
+    /**
+     * @brief Return the disk cache of read results shared by the arrays
+     * opened with this context, or nullptr if `soma.read.disk_cache_dir`
+     * or `soma.read.disk_cache_bytes` is not set.
+     */
+    std::shared_ptr<DiskCache> disk_cache();
+
+    /**
+     * @brief Return the cache of arrays opened for read with this context,
+     * or nullptr if `soma.cache.array_handles` is not set.
+     */
+    std::shared_ptr<ArrayHandleCache> array_handle_cache();
+
    private:
     //===================================================================
     //= private non-static
@@ -86,6 +108,24 @@ class SOMAContext {
 
     // Semaphore to create and use the thread_pool
     std::mutex thread_pool_mutex_;
+
+    // Result cache, created on first use
+    std::shared_ptr<ResultCache> result_cache_ = nullptr;
+    bool result_cache_init_ = false;
+
+    // Disk cache, created on first use
+    std::shared_ptr<DiskCache> disk_cache_ = nullptr;
+    bool disk_cache_init_ = false;
+
+    // Array handle cache, created on first use
+    std::shared_ptr<ArrayHandleCache> array_handle_cache_ = nullptr;
+    bool array_handle_cache_init_ = false;
+
+    // Semaphore to create the caches
+    std::mutex cache_mutex_;
+
+    // Parse a size from the config, zero if the key is absent
+    size_t _config_size(const std::string& key) const;
 };
 }  // namespace tiledbsoma
 
@@ -31,6 +31,7 @@
  */
 
 #include "soma_dataframe.h"
+#include "category_index.h"
 
 namespace tiledbsoma {
 using namespace tiledb;
@@ -94,4 +95,118 @@ uint64_t SOMADataFrame::count() {
     return this->nnz();
 }
 
+void SOMADataFrame::create_category_index(
+    std::string_view index_uri, const std::vector<std::string>& column_names) {
+    if (mode() != OpenMode::write) {
+        throw TileDBSOMAError(
+            "[SOMADataFrame] dataframe must be opened in write mode");
+    }
+    if (has_metadata(CATEGORY_INDEX_KEY)) {
+        throw TileDBSOMAError(fmt::format(
+            "[SOMADataFrame] '{}' already has a category index", uri()));
+    }
+
+    CategoryIndex::create(*this, index_uri, column_names);
+
+    // The cached metadata value points to this string
+    category_index_uri_ = index_uri;
+    set_metadata(
+        CATEGORY_INDEX_KEY,
+        TILEDB_STRING_UTF8,
+        static_cast<uint32_t>(category_index_uri_.length()),
+        category_index_uri_.c_str());
+}
+
+std::optional<std::string> SOMADataFrame::category_index_uri() {
+    return _metadata_value(CATEGORY_INDEX_KEY);
+}
+
+void SOMADataFrame::create_key_filter_index(
+    std::string_view index_uri,
+    const std::vector<std::string>& column_names,
+    double fpp) {
+    if (mode() != OpenMode::write) {
+        throw TileDBSOMAError(
+            "[SOMADataFrame] dataframe must be opened in write mode");
+    }
+    if (has_metadata(KEY_FILTER_INDEX_KEY)) {
+        throw TileDBSOMAError(fmt::format(
+            "[SOMADataFrame] '{}' already has a key filter index", uri()));
+    }
+
+    KeyFilterIndex::create(*this, index_uri, column_names, fpp);
+
+    // The cached metadata value points to this string
+    key_filter_index_uri_ = index_uri;
+    set_metadata(
+        KEY_FILTER_INDEX_KEY,
+        TILEDB_STRING_UTF8,
+        static_cast<uint32_t>(key_filter_index_uri_.length()),
+        key_filter_index_uri_.c_str());
+}
+
+std::optional<std::string> SOMADataFrame::key_filter_index_uri() {
+    return _metadata_value(KEY_FILTER_INDEX_KEY);
+}
+
+std::vector<int64_t> SOMADataFrame::sample_joinids(
+    size_t n, uint64_t seed, std::optional<std::string> stratify_by) {
+    if (stratify_by.has_value()) {
+        return JoinidSampler::stratified(*this, *stratify_by, n, seed);
+    }
+    if (tiledb_schema()->domain().has_dimension("soma_joinid")) {
+        // Without gaps, the joinids are those of the non-empty domain
+        auto joinids = JoinidSampler::non_empty_joinids(*this, "soma_joinid");
+        if (joinids.cardinality() == nnz()) {
+            return JoinidSampler::uniform(joinids, n, seed);
+        }
+    }
+
+    // Otherwise the joinids must be read
+    auto reader = SOMAArray::open(
+        OpenMode::read,
+        uri(),
+        ctx(),
+        "",
+        {"soma_joinid"},
+        "auto",
+        ResultOrder::automatic,
+        timestamp());
+    JoinidBitmap population;
+    while (auto batch = reader->read_next()) {
+        auto joinids = (*batch)->at("soma_joinid")->data<int64_t>();
+        population |= JoinidBitmap::from_joinids(
+            joinids.data(), joinids.size());
+    }
+    reader->close();
+    return JoinidSampler::uniform(population, n, seed);
+}
+
+SampledRows SOMADataFrame::read_sample(
+    std::vector<int64_t> joinids, std::vector<std::string> column_names) {
+    if (!tiledb_schema()->domain().has_dimension("soma_joinid")) {
+        throw TileDBSOMAError(fmt::format(
+            "[SOMADataFrame] cannot read a sample of '{}': soma_joinid is not "
+            "an index column",
+            uri()));
+    }
+    return JoinidSampler::read(
+        *this, "soma_joinid", std::move(joinids), std::move(column_names));
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+std::optional<std::string> SOMADataFrame::_metadata_value(
+    const std::string& key) {
+    auto value = get_metadata(key);
+    if (!value) {
+        return std::nullopt;
+    }
+    return std::string(
+        static_cast<const char*>(std::get<MetadataInfo::value>(*value)),
+        std::get<MetadataInfo::num>(*value));
+}
+
 }  // namespace tiledbsoma
@@ -35,6 +35,8 @@
 
 #include <filesystem>
 
+#include "joinid_sampler.h"
+#include "key_filter_index.h"
 #include "soma_array.h"
 
 namespace tiledbsoma {
@@ -162,6 +164,91 @@ class SOMADataFrame : public SOMAArray {
      * @return int64_t
      */
     uint64_t count();
+
+    /**
+     * @brief Create a category index of enumerated columns (see
+     * CategoryIndex) and index the current rows. The dataframe must be open
+     * for write.
+     *
+     * The index URI is recorded in the `soma_category_index_uri` metadata.
+     * From then on rows written through SOMAArray are added to the index,
+     * and category filters of SOMAExperimentAxisQuery on indexed columns
+     * resolve from it without reading the dataframe.
+     *
+     * @param index_uri URI of the new index array
+     * @param column_names Enumerated columns to index
+     */
+    void create_category_index(
+        std::string_view index_uri,
+        const std::vector<std::string>& column_names);
+
+    /**
+     * @brief Return the URI of the category index, if any.
+     */
+    std::optional<std::string> category_index_uri();
+
+    /**
+     * @brief Create a key filter index of string index columns (see
+     * KeyFilterIndex) with a filter of the current keys. The dataframe must
+     * be open for write.
+     *
+     * The index URI is recorded in the `soma_key_filter_index_uri`
+     * metadata. From then on each write through SOMAArray adds a filter of
+     * its keys, and string point lookups through `set_dim_points` skip the
+     * keys no filter may contain.
+     *
+     * @param index_uri URI of the new index array
+     * @param column_names String index columns to index
+     * @param fpp False positive rate of the filters
+     */
+    void create_key_filter_index(
+        std::string_view index_uri,
+        const std::vector<std::string>& column_names,
+        double fpp = KeyFilterIndex::DEFAULT_FPP);
+
+    /**
+     * @brief Return the URI of the key filter index, if any.
+     */
+    std::optional<std::string> key_filter_index_uri();
+
+    /**
+     * @brief Draw a random sample of soma_joinids, uniform over the rows or
+     * stratified by the values of a column (see JoinidSampler). A uniform
+     * sample of a dataframe indexed by soma_joinid, with no gaps between its
+     * joinids, costs time in proportion to the sample size only. Otherwise
+     * the soma_joinid column is read.
+     *
+     * @param n Sample size. All joinids are returned, shuffled, if there
+     * are at most n rows.
+     * @param seed Random seed
+     * @param stratify_by Optional column to stratify the sample by
+     * @return std::vector<int64_t> The sample, in random order
+     */
+    std::vector<int64_t> sample_joinids(
+        size_t n,
+        uint64_t seed,
+        std::optional<std::string> stratify_by = std::nullopt);
+
+    /**
+     * @brief Read the rows of sampled soma_joinids, see
+     * `JoinidSampler::read`. soma_joinid must be an index column.
+     *
+     * @param joinids Distinct soma_joinids, in sample order
+     * @param column_names Columns to read, or all columns if empty
+     * @return SampledRows The batches and the permutation restoring the
+     * sample order
+     */
+    SampledRows read_sample(
+        std::vector<int64_t> joinids,
+        std::vector<std::string> column_names = {});
+
+   private:
+    // String value of a metadata key, if any
+    std::optional<std::string> _metadata_value(const std::string& key);
+
+    // Backing storage of the cached index URI metadata values
+    std::string category_index_uri_;
+    std::string key_filter_index_uri_;
 };
 }  // namespace tiledbsoma
 
@@ -98,6 +98,12 @@ std::unique_ptr<SOMAExperiment> SOMAExperiment::open(
 
 std::shared_ptr<SOMADataFrame> SOMAExperiment::obs(
     std::vector<std::string> column_names, ResultOrder result_order) {
+    if (obs_ == nullptr) {
+        obs_ = _opened_member<SOMADataFrame>("obs");
+        if (obs_ != nullptr) {
+            obs_->reset(column_names, "auto", result_order);
+        }
+    }
     if (obs_ == nullptr) {
         obs_ = SOMADataFrame::open(
             (std::filesystem::path(uri()) / "obs").string(),
@@ -111,6 +117,9 @@ std::shared_ptr<SOMADataFrame> SOMAExperiment::obs(
 }
 
 std::shared_ptr<SOMACollection> SOMAExperiment::ms() {
+    if (ms_ == nullptr) {
+        ms_ = _opened_member<SOMACollection>("ms");
+    }
     if (ms_ == nullptr) {
         ms_ = SOMACollection::open(
             (std::filesystem::path(uri()) / "ms").string(),
@@ -0,0 +1,504 @@
+/**
+ * @file   soma_experiment_axis_query.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the SOMAExperimentAxisQuery class.
+ */
+
+#include "soma_experiment_axis_query.h"
+#include <algorithm>
+#include "../utils/logger.h"
+#include "category_index.h"
+
+namespace tiledbsoma {
+using namespace tiledb;
+
+namespace {
+
+const std::string SOMA_JOINID = "soma_joinid";
+
+std::string member_uri(
+    const std::map<std::string, SOMAGroupEntry>& members,
+    const std::string& name,
+    const std::string& where) {
+    auto it = members.find(name);
+    if (it == members.end()) {
+        throw TileDBSOMAError(fmt::format(
+            "[SOMAExperimentAxisQuery] '{}' not found in {}", name, where));
+    }
+    return it->second.first;
+}
+
+// Restrict a value filter to the rows whose column holds one of the labels
+void add_category_condition(
+    const Context& ctx,
+    std::optional<QueryCondition>& qc,
+    const std::string& column,
+    const std::vector<std::string>& labels) {
+    std::optional<QueryCondition> matches;
+    for (const auto& label : labels) {
+        auto eq = QueryCondition::create(ctx, column, label, TILEDB_EQ);
+        matches = matches ? matches->combine(eq, TILEDB_OR) : eq;
+    }
+    if (matches) {
+        qc = qc ? qc->combine(*matches, TILEDB_AND) : *matches;
+    }
+}
+
+}  // namespace
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+SOMAExperimentAxisQuery::SOMAExperimentAxisQuery(
+    std::shared_ptr<SOMAExperiment> experiment,
+    std::string_view measurement_name,
+    SOMAAxisQuery obs_query,
+    SOMAAxisQuery var_query)
+    : experiment_(experiment)
+    , measurement_name_(measurement_name)
+    , obs_query_(std::move(obs_query))
+    , var_query_(std::move(var_query)) {
+    if (experiment_ == nullptr) {
+        throw TileDBSOMAError(
+            "[SOMAExperimentAxisQuery] experiment must not be null");
+    }
+}
+
+std::shared_ptr<SOMAMeasurement> SOMAExperimentAxisQuery::measurement() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    if (measurement_ == nullptr) {
+        auto uri = member_uri(
+            experiment_->ms()->members_map(), measurement_name_, "ms");
+        measurement_ = SOMAMeasurement::open(
+            uri, OpenMode::read, experiment_->ctx(), experiment_->timestamp());
+    }
+    return measurement_;
+}
+
+const JoinidBitmap& SOMAExperimentAxisQuery::obs_bitmap() {
+    _resolve_joinids();
+    return *obs_bitmap_;
+}
+
+const JoinidBitmap& SOMAExperimentAxisQuery::var_bitmap() {
+    _resolve_joinids();
+    return *var_bitmap_;
+}
+
+const std::vector<int64_t>& SOMAExperimentAxisQuery::obs_joinids() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    if (!obs_joinids_) {
+        obs_joinids_ = obs_bitmap().to_joinids();
+    }
+    return *obs_joinids_;
+}
+
+const std::vector<int64_t>& SOMAExperimentAxisQuery::var_joinids() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    if (!var_joinids_) {
+        var_joinids_ = var_bitmap().to_joinids();
+    }
+    return *var_joinids_;
+}
+
+std::shared_ptr<IntIndexer> SOMAExperimentAxisQuery::obs_indexer() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    if (obs_indexer_ == nullptr) {
+        obs_indexer_ = std::make_shared<IntIndexer>(experiment_->ctx());
+        obs_indexer_->map_locations(obs_joinids());
+    }
+    return obs_indexer_;
+}
+
+std::shared_ptr<IntIndexer> SOMAExperimentAxisQuery::var_indexer() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    if (var_indexer_ == nullptr) {
+        var_indexer_ = std::make_shared<IntIndexer>(experiment_->ctx());
+        var_indexer_->map_locations(var_joinids());
+    }
+    return var_indexer_;
+}
+
+std::vector<std::shared_ptr<ArrayBuffers>> SOMAExperimentAxisQuery::obs(
+    std::vector<std::string> column_names) {
+    auto uri = member_uri(experiment_->members_map(), "obs", "experiment");
+    return _read_axis(uri, obs_query_, obs_bitmap(), column_names);
+}
+
+std::vector<std::shared_ptr<ArrayBuffers>> SOMAExperimentAxisQuery::var(
+    std::vector<std::string> column_names) {
+    auto uri = member_uri(measurement()->members_map(), "var", "measurement");
+    return _read_axis(uri, var_query_, var_bitmap(), column_names);
+}
+
+std::unique_ptr<SOMASparseNDArray> SOMAExperimentAxisQuery::X(
+    const std::string& layer,
+    std::string_view batch_size,
+    ResultOrder result_order) {
+    std::string uri;
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        uri = member_uri(measurement()->X()->members_map(), layer, "X");
+    }
+
+    // An unconstrained axis reads the whole dimension. Otherwise runs of
+    // consecutive joinids are added as one subarray range each, to the
+    // layout of X expected to scan the fewest cells for the selection.
+    std::optional<JoinidBitmap> obs, var;
+    if (!obs_query_.is_unconstrained()) {
+        obs = obs_bitmap();
+    }
+    if (!var_query_.is_unconstrained()) {
+        var = var_bitmap();
+    }
+    auto x = SOMASparseNDArray::open_layout(
+        uri,
+        experiment_->ctx(),
+        obs,
+        var,
+        {},
+        result_order,
+        experiment_->timestamp());
+    x->reset({}, batch_size, result_order);
+    if (obs) {
+        x->set_dim_joinids("soma_dim_0", *obs);
+    }
+    if (var) {
+        x->set_dim_joinids("soma_dim_1", *var);
+    }
+    return x;
+}
+
+std::vector<std::shared_ptr<ArrayBuffers>> SOMAExperimentAxisQuery::read_X(
+    const std::string& layer, bool reindex, ResultOrder result_order) {
+    std::vector<std::shared_ptr<ArrayBuffers>> batches;
+    for_each_X_batch(
+        layer,
+        [&batches](std::shared_ptr<ArrayBuffers> batch) {
+            batches.push_back(batch);
+        },
+        reindex,
+        result_order);
+
+    LOG_DEBUG(fmt::format(
+        "[SOMAExperimentAxisQuery] read_X '{}' returned {} batches",
+        layer,
+        batches.size()));
+    return batches;
+}
+
+void SOMAExperimentAxisQuery::for_each_X_batch(
+    const std::string& layer,
+    std::function<void(std::shared_ptr<ArrayBuffers>)> fn,
+    bool reindex,
+    ResultOrder result_order) {
+    auto x = X(layer, "auto", result_order);
+    std::shared_ptr<IntIndexer> obs_idx = nullptr;
+    std::shared_ptr<IntIndexer> var_idx = nullptr;
+    if (reindex) {
+        obs_idx = obs_indexer();
+        var_idx = var_indexer();
+    }
+
+    // Each read allocates fresh buffers, so the next batch can be read while
+    // the current one is processed
+    auto read_ahead = [&x]() {
+        return std::async(
+            std::launch::async, [&x]() { return x->read_next(); });
+    };
+    auto next = read_ahead();
+    while (auto batch = next.get()) {
+        next = read_ahead();
+        if (reindex) {
+            _reindex(*batch, "soma_dim_0", obs_idx, n_obs());
+            _reindex(*batch, "soma_dim_1", var_idx, n_vars());
+        }
+        fn(*batch);
+    }
+    x->close();
+}
+
+SparseMoments SOMAExperimentAxisQuery::X_moments(
+    const std::string& layer, int64_t ddof) {
+    SparseMoments moments(n_obs(), n_vars(), experiment_->ctx());
+    for_each_X_batch(
+        layer,
+        [&moments](std::shared_ptr<ArrayBuffers> batch) {
+            moments.update(batch);
+        },
+        true);
+    moments.finalize(ddof);
+    return moments;
+}
+
+std::vector<double> SOMAExperimentAxisQuery::X_matmul(
+    const std::string& layer, const double* rhs, int64_t k) {
+    SparseDenseProduct product(n_obs(), n_vars(), rhs, k, experiment_->ctx());
+    for_each_X_batch(
+        layer,
+        [&product](std::shared_ptr<ArrayBuffers> batch) {
+            product.update(batch);
+        },
+        true);
+    return std::move(product.result());
+}
+
+std::unique_ptr<ShuffledXLoader> SOMAExperimentAxisQuery::X_loader(
+    const std::string& layer, ShuffledXLoaderOptions options) {
+    std::string uri;
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        uri = member_uri(measurement()->X()->members_map(), layer, "X");
+    }
+    return std::make_unique<ShuffledXLoader>(
+        experiment_->ctx(),
+        uri,
+        obs_joinids(),
+        var_joinids(),
+        options,
+        experiment_->timestamp());
+}
+
+KnnResult SOMAExperimentAxisQuery::obsm_knn(
+    const std::string& name,
+    const float* queries,
+    int64_t n_queries,
+    int64_t dim,
+    int64_t k,
+    KnnMetric metric) {
+    std::string uri;
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        uri = member_uri(measurement()->obsm()->members_map(), name, "obsm");
+    }
+    auto obsm = SOMAArray::open(
+        OpenMode::read,
+        uri,
+        experiment_->ctx(),
+        "",
+        {},
+        "auto",
+        ResultOrder::automatic,
+        experiment_->timestamp());
+    auto result = KnnSearch::search(
+        *obsm, queries, n_queries, dim, k, metric, obs_bitmap());
+    obsm->close();
+    return result;
+}
+
+std::map<std::string, std::vector<std::shared_ptr<ArrayBuffers>>>
+SOMAExperimentAxisQuery::read_X_layers(
+    const std::vector<std::string>& layers,
+    bool reindex,
+    ResultOrder result_order) {
+    // Resolve the shared state before fanning out so the layer reads only
+    // touch TileDB
+    measurement()->X();
+    _resolve_joinids();
+    if (reindex) {
+        obs_indexer();
+        var_indexer();
+    }
+
+    using Batches = std::vector<std::shared_ptr<ArrayBuffers>>;
+    std::vector<std::future<Batches>> futures;
+    for (auto& layer : layers) {
+        futures.push_back(std::async(std::launch::async, [&, layer]() {
+            return read_X(layer, reindex, result_order);
+        }));
+    }
+
+    std::map<std::string, Batches> results;
+    for (size_t i = 0; i < layers.size(); ++i) {
+        results[layers[i]] = futures[i].get();
+    }
+    return results;
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+void SOMAExperimentAxisQuery::_resolve_joinids() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    if (obs_bitmap_ && var_bitmap_) {
+        return;
+    }
+
+    auto obs_uri = member_uri(experiment_->members_map(), "obs", "experiment");
+    auto var_uri = member_uri(
+        measurement()->members_map(), "var", "measurement");
+
+    LOG_DEBUG(fmt::format(
+        "[SOMAExperimentAxisQuery] resolving joinids of {} and {}",
+        obs_uri,
+        var_uri));
+
+    // The two axes are independent, so read them concurrently
+    auto obs_future = std::async(std::launch::async, [&]() {
+        return _read_joinids(obs_uri, obs_query_);
+    });
+    auto var_future = std::async(std::launch::async, [&]() {
+        return _read_joinids(var_uri, var_query_);
+    });
+    obs_bitmap_ = obs_future.get();
+    var_bitmap_ = var_future.get();
+
+    LOG_DEBUG(fmt::format(
+        "[SOMAExperimentAxisQuery] resolved {} obs and {} var joinids "
+        "({} bytes)",
+        obs_bitmap_->cardinality(),
+        var_bitmap_->cardinality(),
+        obs_bitmap_->nbytes() + var_bitmap_->nbytes()));
+}
+
+JoinidBitmap SOMAExperimentAxisQuery::_read_joinids(
+    const std::string& uri, const SOMAAxisQuery& axis_query) {
+    auto df = SOMADataFrame::open(
+        uri,
+        OpenMode::read,
+        experiment_->ctx(),
+        {SOMA_JOINID},
+        ResultOrder::automatic,
+        experiment_->timestamp());
+
+    bool joinid_is_dim = df->tiledb_schema()->domain().has_dimension(
+        SOMA_JOINID);
+    bool has_selection = axis_query.coords() || axis_query.ranges();
+    JoinidBitmap selection = axis_query.selection();
+
+    // Category filters on indexed columns resolve from the index, the
+    // others join the value filter
+    std::optional<QueryCondition> qc = axis_query.condition();
+    bool indexed = false;
+    for (const auto& [column, labels] : axis_query.categories()) {
+        std::optional<JoinidBitmap> matches;
+        if (labels.empty()) {
+            matches = JoinidBitmap();
+        } else {
+            matches = CategoryIndex::lookup(*df, column, labels);
+        }
+        if (matches) {
+            selection = has_selection ? selection & *matches : *matches;
+            has_selection = true;
+            indexed = true;
+        } else {
+            add_category_condition(
+                *experiment_->ctx()->tiledb_ctx(), qc, column, labels);
+        }
+    }
+
+    // The index holds only existing rows, so without a remaining value
+    // filter the selection is the result
+    if ((indexed && !qc) || (has_selection && selection.empty())) {
+        df->close();
+        return selection;
+    }
+
+    if (joinid_is_dim && has_selection) {
+        df->set_dim_joinids(SOMA_JOINID, selection);
+    }
+    if (qc) {
+        df->set_condition(*qc);
+    }
+
+    JoinidBitmap joinids;
+    while (auto batch = df->read_next()) {
+        auto data = (*batch)->at(SOMA_JOINID)->data<int64_t>();
+        joinids |= JoinidBitmap::from_joinids(data.data(), data.size());
+    }
+    df->close();
+
+    // When soma_joinid is not a dimension the coordinates are applied after
+    // the read
+    if (!joinid_is_dim && has_selection) {
+        joinids &= selection;
+    }
+    return joinids;
+}
+
+std::vector<std::shared_ptr<ArrayBuffers>> SOMAExperimentAxisQuery::_read_axis(
+    const std::string& uri,
+    const SOMAAxisQuery& axis_query,
+    const JoinidBitmap& joinids,
+    std::vector<std::string> column_names) {
+    auto df = SOMADataFrame::open(
+        uri,
+        OpenMode::read,
+        experiment_->ctx(),
+        column_names,
+        ResultOrder::automatic,
+        experiment_->timestamp());
+
+    if (!axis_query.is_unconstrained()) {
+        if (df->tiledb_schema()->domain().has_dimension(SOMA_JOINID)) {
+            // The joinids already reflect the coordinates and value filter
+            df->set_dim_joinids(SOMA_JOINID, joinids);
+        } else if (axis_query.coords() || axis_query.ranges()) {
+            throw TileDBSOMAError(fmt::format(
+                "[SOMAExperimentAxisQuery] cannot select coordinates on {}: "
+                "soma_joinid is not a dimension",
+                uri));
+        } else if (joinids.empty()) {
+            df->close();
+            return {};
+        } else {
+            auto qc = axis_query.condition();
+            for (const auto& [column, labels] : axis_query.categories()) {
+                add_category_condition(
+                    *experiment_->ctx()->tiledb_ctx(), qc, column, labels);
+            }
+            df->set_condition(*qc);
+        }
+    }
+
+    std::vector<std::shared_ptr<ArrayBuffers>> batches;
+    while (auto batch = df->read_next()) {
+        batches.push_back(*batch);
+    }
+    df->close();
+    return batches;
+}
+
+void SOMAExperimentAxisQuery::_reindex(
+    std::shared_ptr<ArrayBuffers> batch,
+    const std::string& dim_name,
+    std::shared_ptr<IntIndexer> indexer,
+    size_t num_joinids) {
+    auto data = batch->at(dim_name)->data<int64_t>();
+    if (data.empty() || num_joinids == 0) {
+        return;
+    }
+    std::vector<int64_t> positions(data.size());
+    indexer->lookup(data.data(), positions.data(), data.size());
+    std::copy(positions.begin(), positions.end(), data.begin());
+}
+
+}  // namespace tiledbsoma
@@ -0,0 +1,463 @@
+/**
+ * @file   soma_experiment_axis_query.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the SOMAAxisQuery and SOMAExperimentAxisQuery classes.
+ *   An axis query selects obs and var joinids of a measurement in a
+ *   SOMAExperiment and reads the matching slices of the X layers. The whole
+ *   plan (value filters, joinid materialization, reindexing and X reads) runs
+ *   natively, with the obs/var axes and the X layers resolved concurrently.
+ */
+
+#ifndef SOMA_EXPERIMENT_AXIS_QUERY
+#define SOMA_EXPERIMENT_AXIS_QUERY
+
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <tiledb/tiledb>
+
+#include "../reindexer/reindexer.h"
+#include "../utils/joinid_bitmap.h"
+#include "array_buffers.h"
+#include "knn_search.h"
+#include "shuffled_x_loader.h"
+#include "soma_dataframe.h"
+#include "soma_experiment.h"
+#include "soma_measurement.h"
+#include "soma_sparse_ndarray.h"
+#include "sparse_dense_product.h"
+#include "sparse_moments.h"
+
+namespace tiledbsoma {
+
+using namespace tiledb;
+
+/**
+ * @brief The selection applied to one axis (obs or var) of an experiment
+ * axis query. Coordinates and ranges select soma_joinids, and the optional
+ * value filter is applied to the axis dataframe. An axis query with no
+ * coordinates, ranges or value filter selects the whole axis.
+ */
+class SOMAAxisQuery {
+   public:
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    SOMAAxisQuery() = default;
+    SOMAAxisQuery(const SOMAAxisQuery&) = default;
+    SOMAAxisQuery(SOMAAxisQuery&&) = default;
+    SOMAAxisQuery& operator=(const SOMAAxisQuery&) = default;
+    SOMAAxisQuery& operator=(SOMAAxisQuery&&) = default;
+    ~SOMAAxisQuery() = default;
+
+    /**
+     * @brief Select soma_joinid points on this axis.
+     *
+     * @param coords soma_joinid values
+     */
+    SOMAAxisQuery& set_coords(std::vector<int64_t> coords) {
+        coords_ = std::move(coords);
+        return *this;
+    }
+
+    /**
+     * @brief Select inclusive soma_joinid ranges on this axis. Ranges are
+     * combined with any coordinates as a union.
+     *
+     * @param ranges Inclusive [start, stop] soma_joinid ranges
+     */
+    SOMAAxisQuery& set_ranges(std::vector<std::pair<int64_t, int64_t>> ranges) {
+        ranges_ = std::move(ranges);
+        return *this;
+    }
+
+    /**
+     * @brief Set the value filter applied to the axis dataframe.
+     *
+     * @param qc TileDB QueryCondition
+     */
+    SOMAAxisQuery& set_condition(const QueryCondition& qc) {
+        condition_ = qc;
+        return *this;
+    }
+
+    /**
+     * @brief Set category filters on enumerated columns of the axis
+     * dataframe. A row matches if each column holds one of its listed
+     * categories. Columns with a CategoryIndex resolve without reading the
+     * dataframe; the others are applied as a value filter.
+     *
+     * @param categories Category labels of each column
+     */
+    SOMAAxisQuery& set_categories(
+        std::map<std::string, std::vector<std::string>> categories) {
+        categories_ = std::move(categories);
+        return *this;
+    }
+
+    const std::optional<std::vector<int64_t>>& coords() const {
+        return coords_;
+    }
+
+    const std::optional<std::vector<std::pair<int64_t, int64_t>>>& ranges()
+        const {
+        return ranges_;
+    }
+
+    const std::optional<QueryCondition>& condition() const {
+        return condition_;
+    }
+
+    const std::map<std::string, std::vector<std::string>>& categories()
+        const {
+        return categories_;
+    }
+
+    /**
+     * @brief Return the union of the coordinates and ranges as a joinid
+     * set. The set is empty if neither is given.
+     */
+    JoinidBitmap selection() const {
+        JoinidBitmap joinids;
+        if (coords_) {
+            joinids = JoinidBitmap::from_joinids(*coords_);
+        }
+        if (ranges_) {
+            joinids |= JoinidBitmap::from_ranges(*ranges_);
+        }
+        return joinids;
+    }
+
+    /**
+     * @brief Return true if the axis query selects the whole axis.
+     */
+    bool is_unconstrained() const {
+        return !coords_.has_value() && !ranges_.has_value() &&
+               !condition_.has_value() && categories_.empty();
+    }
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    // Selected soma_joinid points
+    std::optional<std::vector<int64_t>> coords_;
+
+    // Selected soma_joinid ranges
+    std::optional<std::vector<std::pair<int64_t, int64_t>>> ranges_;
+
+    // Value filter on the axis dataframe
+    std::optional<QueryCondition> condition_;
+
+    // Category labels selected in each enumerated column
+    std::map<std::string, std::vector<std::string>> categories_;
+};
+
+class SOMAExperimentAxisQuery {
+   public:
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    /**
+     * @brief Construct a query on one measurement of an experiment. No I/O
+     * is performed until the joinids or X data are first requested.
+     *
+     * @param experiment The SOMAExperiment, opened for read
+     * @param measurement_name Name of the measurement in `experiment.ms`
+     * @param obs_query Selection on the obs axis
+     * @param var_query Selection on the var axis
+     */
+    SOMAExperimentAxisQuery(
+        std::shared_ptr<SOMAExperiment> experiment,
+        std::string_view measurement_name,
+        SOMAAxisQuery obs_query = SOMAAxisQuery(),
+        SOMAAxisQuery var_query = SOMAAxisQuery());
+
+    SOMAExperimentAxisQuery() = delete;
+    SOMAExperimentAxisQuery(const SOMAExperimentAxisQuery&) = delete;
+    SOMAExperimentAxisQuery(SOMAExperimentAxisQuery&&) = delete;
+    ~SOMAExperimentAxisQuery() = default;
+
+    /**
+     * @brief Return the measurement this query runs against.
+     */
+    std::shared_ptr<SOMAMeasurement> measurement();
+
+    /**
+     * @brief Return the set of obs soma_joinids matching the obs query. The
+     * obs and var axes are resolved concurrently on first use.
+     */
+    const JoinidBitmap& obs_bitmap();
+
+    /**
+     * @brief Return the set of var soma_joinids matching the var query.
+     */
+    const JoinidBitmap& var_bitmap();
+
+    /**
+     * @brief Return the sorted obs soma_joinids matching the obs query,
+     * materialized from `obs_bitmap()` on first use.
+     */
+    const std::vector<int64_t>& obs_joinids();
+
+    /**
+     * @brief Return the sorted var soma_joinids matching the var query.
+     */
+    const std::vector<int64_t>& var_joinids();
+
+    size_t n_obs() {
+        return obs_bitmap().cardinality();
+    }
+
+    size_t n_vars() {
+        return var_bitmap().cardinality();
+    }
+
+    /**
+     * @brief Return an IntIndexer mapping obs soma_joinids to their position
+     * in `obs_joinids()`.
+     */
+    std::shared_ptr<IntIndexer> obs_indexer();
+
+    /**
+     * @brief Return an IntIndexer mapping var soma_joinids to their position
+     * in `var_joinids()`.
+     */
+    std::shared_ptr<IntIndexer> var_indexer();
+
+    /**
+     * @brief Read the selected obs rows.
+     *
+     * @param column_names Columns to read, or all columns if empty
+     * @return std::vector<std::shared_ptr<ArrayBuffers>> The result batches
+     */
+    std::vector<std::shared_ptr<ArrayBuffers>> obs(
+        std::vector<std::string> column_names = {});
+
+    /**
+     * @brief Read the selected var rows.
+     *
+     * @param column_names Columns to read, or all columns if empty
+     * @return std::vector<std::shared_ptr<ArrayBuffers>> The result batches
+     */
+    std::vector<std::shared_ptr<ArrayBuffers>> var(
+        std::vector<std::string> column_names = {});
+
+    /**
+     * @brief Open an X layer for read with the obs and var selections of
+     * this query already set on `soma_dim_0` and `soma_dim_1`. The caller
+     * drives the read with `read_next()`.
+     *
+     * @param layer Name of the X layer
+     * @param batch_size Read batch size
+     * @param result_order Read result order
+     * @return std::unique_ptr<SOMASparseNDArray>
+     */
+    std::unique_ptr<SOMASparseNDArray> X(
+        const std::string& layer,
+        std::string_view batch_size = "auto",
+        ResultOrder result_order = ResultOrder::automatic);
+
+    /**
+     * @brief Read all selected cells of an X layer.
+     *
+     * @param layer Name of the X layer
+     * @param reindex If true, replace `soma_dim_0` and `soma_dim_1` with the
+     * positions of the joinids in `obs_joinids()` and `var_joinids()`
+     * @param result_order Read result order
+     * @return std::vector<std::shared_ptr<ArrayBuffers>> The result batches
+     */
+    std::vector<std::shared_ptr<ArrayBuffers>> read_X(
+        const std::string& layer,
+        bool reindex = false,
+        ResultOrder result_order = ResultOrder::automatic);
+
+    /**
+     * @brief Stream the selected cells of an X layer through `fn`, one
+     * batch at a time. The next batch is read while `fn` runs on the
+     * current one, so only two batches are held at once.
+     *
+     * @param layer Name of the X layer
+     * @param fn Called with each batch, in read order
+     * @param reindex See `read_X`
+     * @param result_order Read result order
+     */
+    void for_each_X_batch(
+        const std::string& layer,
+        std::function<void(std::shared_ptr<ArrayBuffers>)> fn,
+        bool reindex = false,
+        ResultOrder result_order = ResultOrder::automatic);
+
+    /**
+     * @brief Compute the per-obs and per-var nnz, mean and variance of the
+     * selected cells of an X layer in a single streaming pass. Rows are
+     * indexed by position in `obs_joinids()` and columns by position in
+     * `var_joinids()`.
+     *
+     * @param layer Name of the X layer
+     * @param ddof Delta degrees of freedom of the variance
+     * @return SparseMoments The finalized moments
+     */
+    SparseMoments X_moments(const std::string& layer, int64_t ddof = 1);
+
+    /**
+     * @brief Multiply the selected cells of an X layer by a dense matrix in
+     * a single streaming pass, without materializing X. Rows of `rhs` are
+     * indexed by position in `var_joinids()` and rows of the result by
+     * position in `obs_joinids()`.
+     *
+     * @param layer Name of the X layer
+     * @param rhs Row-major dense matrix of shape (n_vars, k)
+     * @param k Number of columns of `rhs`
+     * @return std::vector<double> The row-major (n_obs, k) product
+     */
+    std::vector<double> X_matmul(
+        const std::string& layer, const double* rhs, int64_t k);
+
+    /**
+     * @brief Create a loader streaming shuffled minibatches of the selected
+     * obs rows of an X layer, with columns indexed by position in
+     * `var_joinids()`.
+     *
+     * @param layer Name of the X layer
+     * @param options Loader options
+     * @return std::unique_ptr<ShuffledXLoader>
+     */
+    std::unique_ptr<ShuffledXLoader> X_loader(
+        const std::string& layer,
+        ShuffledXLoaderOptions options = ShuffledXLoaderOptions());
+
+    /**
+     * @brief Find the exact k nearest selected obs rows of an obsm
+     * embedding to each query vector, streaming the embedding in blocks.
+     *
+     * @param name Name of the obsm array, e.g. "X_pca"
+     * @param queries Row-major (n_queries, dim) query vectors
+     * @param n_queries Number of queries
+     * @param dim Number of dimensions of the queries, which must match the
+     * number of columns of the embedding
+     * @param k Number of neighbors per query
+     * @param metric Distance metric
+     * @return KnnResult The obs soma_joinids and distances of the neighbors
+     */
+    KnnResult obsm_knn(
+        const std::string& name,
+        const float* queries,
+        int64_t n_queries,
+        int64_t dim,
+        int64_t k,
+        KnnMetric metric = KnnMetric::l2);
+
+    /**
+     * @brief Read several X layers concurrently.
+     *
+     * @param layers Names of the X layers
+     * @param reindex See `read_X`
+     * @param result_order Read result order
+     * @return std::map<std::string, std::vector<std::shared_ptr<ArrayBuffers>>>
+     * The result batches of each layer
+     */
+    std::map<std::string, std::vector<std::shared_ptr<ArrayBuffers>>>
+    read_X_layers(
+        const std::vector<std::string>& layers,
+        bool reindex = false,
+        ResultOrder result_order = ResultOrder::automatic);
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    /**
+     * @brief Resolve the obs and var joinids concurrently, once.
+     */
+    void _resolve_joinids();
+
+    /**
+     * @brief Read the soma_joinids of an axis dataframe matching an axis
+     * query.
+     */
+    JoinidBitmap _read_joinids(
+        const std::string& uri, const SOMAAxisQuery& axis_query);
+
+    /**
+     * @brief Read the selected rows of an axis dataframe.
+     */
+    std::vector<std::shared_ptr<ArrayBuffers>> _read_axis(
+        const std::string& uri,
+        const SOMAAxisQuery& axis_query,
+        const JoinidBitmap& joinids,
+        std::vector<std::string> column_names);
+
+    /**
+     * @brief Replace the soma_joinids of a dim buffer with their positions.
+     */
+    void _reindex(
+        std::shared_ptr<ArrayBuffers> batch,
+        const std::string& dim_name,
+        std::shared_ptr<IntIndexer> indexer,
+        size_t num_joinids);
+
+    // The experiment the query runs against
+    std::shared_ptr<SOMAExperiment> experiment_;
+
+    // Name of the measurement in `experiment.ms`
+    std::string measurement_name_;
+
+    // Lazily opened measurement
+    std::shared_ptr<SOMAMeasurement> measurement_ = nullptr;
+
+    // Axis selections
+    SOMAAxisQuery obs_query_;
+    SOMAAxisQuery var_query_;
+
+    // Resolved joinid sets
+    std::optional<JoinidBitmap> obs_bitmap_;
+    std::optional<JoinidBitmap> var_bitmap_;
+
+    // Lazily materialized sorted joinids
+    std::optional<std::vector<int64_t>> obs_joinids_;
+    std::optional<std::vector<int64_t>> var_joinids_;
+
+    // Lazily built indexers
+    std::shared_ptr<IntIndexer> obs_indexer_ = nullptr;
+    std::shared_ptr<IntIndexer> var_indexer_ = nullptr;
+
+    // Guards lazy state shared by concurrent layer reads
+    std::recursive_mutex mutex_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_EXPERIMENT_AXIS_QUERY
@@ -126,6 +126,12 @@ std::unique_ptr<SOMAMeasurement> SOMAMeasurement::open(
 
 std::shared_ptr<SOMADataFrame> SOMAMeasurement::var(
     std::vector<std::string> column_names, ResultOrder result_order) {
+    if (var_ == nullptr) {
+        var_ = _opened_member<SOMADataFrame>("var");
+        if (var_ != nullptr) {
+            var_->reset(column_names, "auto", result_order);
+        }
+    }
     if (var_ == nullptr) {
         var_ = SOMADataFrame::open(
             (std::filesystem::path(uri()) / "var").string(),
@@ -139,6 +145,9 @@ std::shared_ptr<SOMADataFrame> SOMAMeasurement::var(
 }
 
 std::shared_ptr<SOMACollection> SOMAMeasurement::X() {
+    if (X_ == nullptr) {
+        X_ = _opened_member<SOMACollection>("X");
+    }
     if (X_ == nullptr) {
         X_ = SOMACollection::open(
             (std::filesystem::path(uri()) / "X").string(),
@@ -150,6 +159,9 @@ std::shared_ptr<SOMACollection> SOMAMeasurement::X() {
 }
 
 std::shared_ptr<SOMACollection> SOMAMeasurement::obsm() {
+    if (obsm_ == nullptr) {
+        obsm_ = _opened_member<SOMACollection>("obsm");
+    }
     if (obsm_ == nullptr) {
         obsm_ = SOMACollection::open(
             (std::filesystem::path(uri()) / "obsm").string(),
@@ -161,6 +173,9 @@ std::shared_ptr<SOMACollection> SOMAMeasurement::obsm() {
 }
 
 std::shared_ptr<SOMACollection> SOMAMeasurement::obsp() {
+    if (obsp_ == nullptr) {
+        obsp_ = _opened_member<SOMACollection>("obsp");
+    }
     if (obsp_ == nullptr) {
         obsp_ = SOMACollection::open(
             (std::filesystem::path(uri()) / "obsp").string(),
@@ -172,6 +187,9 @@ std::shared_ptr<SOMACollection> SOMAMeasurement::obsp() {
 }
 
 std::shared_ptr<SOMACollection> SOMAMeasurement::varm() {
+    if (varm_ == nullptr) {
+        varm_ = _opened_member<SOMACollection>("varm");
+    }
     if (varm_ == nullptr) {
         varm_ = SOMACollection::open(
             (std::filesystem::path(uri()) / "varm").string(),
@@ -183,6 +201,9 @@ std::shared_ptr<SOMACollection> SOMAMeasurement::varm() {
 }
 
 std::shared_ptr<SOMACollection> SOMAMeasurement::varp() {
+    if (varp_ == nullptr) {
+        varp_ = _opened_member<SOMACollection>("varp");
+    }
     if (varp_ == nullptr) {
         varp_ = SOMACollection::open(
             (std::filesystem::path(uri()) / "varp").string(),
@@ -31,10 +31,71 @@
  */
 
 #include "soma_sparse_ndarray.h"
+#include <array>
+#include "../utils/logger.h"
 
 namespace tiledbsoma {
 using namespace tiledb;
 
+namespace {
+
+// Selected coordinates and touched tiles of one dimension
+struct AxisSelection {
+    double count;
+    double tiles;
+    double extent;
+};
+
+AxisSelection axis_selection(
+    const Dimension& dim, const std::optional<JoinidBitmap>& joinids) {
+    auto [lo, hi] = dim.domain<int64_t>();
+    uint64_t extent = dim.tile_extent<int64_t>();
+    uint64_t span = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo);
+    if (!joinids) {
+        return {span + 1.0, span / extent + 1.0, double(extent)};
+    }
+
+    uint64_t tiles = 0;
+    std::optional<uint64_t> last_tile;
+    for (auto [start, stop] : joinids->to_ranges()) {
+        if (stop < lo || start > hi) {
+            continue;
+        }
+        uint64_t first = (static_cast<uint64_t>(std::max(start, lo)) -
+                          static_cast<uint64_t>(lo)) /
+                         extent;
+        uint64_t last = (static_cast<uint64_t>(std::min(stop, hi)) -
+                         static_cast<uint64_t>(lo)) /
+                        extent;
+        if (last_tile && first <= *last_tile) {
+            first = *last_tile + 1;
+        }
+        if (first <= last) {
+            tiles += last - first + 1;
+        }
+        last_tile = last;
+    }
+    return {double(joinids->cardinality()), double(tiles), double(extent)};
+}
+
+// Estimated cells scanned to read a selection from a layout: each selected
+// coordinate of the major dimension reads a stripe of the minor extent from
+// every touched tile of the minor dimension
+double scan_cost(
+    const ArraySchema& schema,
+    const std::optional<JoinidBitmap>& rows,
+    const std::optional<JoinidBitmap>& cols) {
+    auto domain = schema.domain();
+    std::array<AxisSelection, 2> axes = {
+        axis_selection(domain.dimension(0), rows),
+        axis_selection(domain.dimension(1), cols)};
+    size_t major = schema.tile_order() == TILEDB_COL_MAJOR ? 1 : 0;
+    auto& minor_axis = axes[1 - major];
+    return axes[major].count * minor_axis.tiles * minor_axis.extent;
+}
+
+}  // namespace
+
 //===================================================================
 //= public static
 //===================================================================
@@ -101,6 +162,56 @@ std::unique_ptr<SOMASparseNDArray> SOMASparseNDArray::open(
         mode, uri, ctx, column_names, result_order, timestamp);
 }
 
+std::unique_ptr<SOMASparseNDArray> SOMASparseNDArray::open_layout(
+    std::string_view uri,
+    std::shared_ptr<SOMAContext> ctx,
+    const std::optional<JoinidBitmap>& rows,
+    const std::optional<JoinidBitmap>& cols,
+    std::vector<std::string> column_names,
+    ResultOrder result_order,
+    std::optional<TimestampRange> timestamp) {
+    auto array = SOMASparseNDArray::open(
+        uri, OpenMode::read, ctx, column_names, result_order, timestamp);
+    auto layout_uri = array->colmajor_layout_uri();
+    if (!layout_uri || array->tiledb_schema()->domain().ndim() != 2) {
+        return array;
+    }
+
+    auto layout = SOMASparseNDArray::open(
+        *layout_uri,
+        OpenMode::read,
+        ctx,
+        column_names,
+        result_order,
+        timestamp);
+    // A layout left behind by writes that did not go through SOMAArray, or
+    // by a failed mirror, is skipped
+    if (layout->layout_source_state() != array->fragment_state()) {
+        LOG_DEBUG(fmt::format(
+            "[SOMASparseNDArray] Column-major layout '{}' of '{}' is stale",
+            *layout_uri,
+            uri));
+        layout->close();
+        return array;
+    }
+
+    auto cost = scan_cost(*array->tiledb_schema(), rows, cols);
+    auto layout_cost = scan_cost(*layout->tiledb_schema(), rows, cols);
+    LOG_DEBUG(fmt::format(
+        "[SOMASparseNDArray] Estimated cells scanned: {} in '{}', {} in "
+        "column-major layout '{}'",
+        cost,
+        uri,
+        layout_cost,
+        *layout_uri));
+    if (layout_cost < cost) {
+        array->close();
+        return layout;
+    }
+    layout->close();
+    return array;
+}
+
 bool SOMASparseNDArray::exists(std::string_view uri) {
     try {
         auto obj = SOMAObject::open(
@@ -118,4 +229,127 @@ bool SOMASparseNDArray::exists(std::string_view uri) {
 std::unique_ptr<ArrowSchema> SOMASparseNDArray::schema() const {
     return this->arrow_schema();
 }
+
+void SOMASparseNDArray::create_colmajor_layout(std::string_view layout_uri) {
+    if (mode() != OpenMode::write) {
+        throw TileDBSOMAError(
+            "[SOMASparseNDArray] array must be opened in write mode");
+    }
+    if (has_metadata(COLMAJOR_LAYOUT_KEY)) {
+        throw TileDBSOMAError(fmt::format(
+            "[SOMASparseNDArray] '{}' already has a column-major layout",
+            uri()));
+    }
+
+    auto source = tiledb_schema();
+    auto source_domain = source->domain();
+    if (source_domain.ndim() != 2) {
+        throw TileDBSOMAError(
+            "[SOMASparseNDArray] column-major layouts require a 2D array");
+    }
+
+    // Same coordinates with swapped tile extents, each clamped to the
+    // domain of its dimension
+    auto tiledb_ctx = ctx()->tiledb_ctx();
+    Domain domain(*tiledb_ctx);
+    for (unsigned i = 0; i < 2; ++i) {
+        auto dim = source_domain.dimension(i);
+        auto [lo, hi] = dim.domain<int64_t>();
+        uint64_t extent = source_domain.dimension(1 - i).tile_extent<int64_t>();
+        uint64_t span = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo);
+        if (span < extent - 1) {
+            extent = span + 1;
+        }
+        auto layout_dim = Dimension::create<int64_t>(
+            *tiledb_ctx, dim.name(), {lo, hi}, static_cast<int64_t>(extent));
+        layout_dim.set_filter_list(dim.filter_list());
+        domain.add_dimension(layout_dim);
+    }
+
+    ArraySchema schema(*tiledb_ctx, TILEDB_SPARSE);
+    schema.set_domain(domain);
+    for (unsigned i = 0; i < source->attribute_num(); ++i) {
+        schema.add_attribute(source->attribute(i));
+    }
+    schema.set_capacity(source->capacity());
+    schema.set_allows_dups(source->allows_dups());
+    schema.set_coords_filter_list(source->coords_filter_list());
+    schema.set_offsets_filter_list(source->offsets_filter_list());
+    schema.set_validity_filter_list(source->validity_filter_list());
+    schema.set_tile_order(TILEDB_COL_MAJOR);
+    schema.set_cell_order(TILEDB_COL_MAJOR);
+    schema.check();
+
+    SOMAArray::create(
+        ctx(), layout_uri, schema, "SOMASparseNDArray", timestamp());
+
+    // Copy the existing cells batch by batch
+    auto reader = SOMAArray::open(
+        OpenMode::read,
+        uri(),
+        ctx(),
+        "",
+        {},
+        "auto",
+        ResultOrder::automatic,
+        timestamp());
+    auto writer = SOMASparseNDArray::open(
+        layout_uri,
+        OpenMode::write,
+        ctx(),
+        {},
+        ResultOrder::automatic,
+        timestamp());
+    uint64_t cells = 0;
+    while (auto batch = reader->read_next()) {
+        if ((*batch)->num_rows() == 0) {
+            continue;
+        }
+        for (auto& name : (*batch)->names()) {
+            auto column = (*batch)->at(name);
+            writer->set_column_data(
+                name, column->size(), column->data<std::byte>().data());
+        }
+        writer->write(true);
+        cells += (*batch)->num_rows();
+    }
+    reader->close();
+    writer->set_layout_source_state(fragment_state());
+    writer->close();
+
+    // The cached metadata value points to this string
+    colmajor_layout_uri_ = layout_uri;
+    set_metadata(
+        COLMAJOR_LAYOUT_KEY,
+        TILEDB_STRING_UTF8,
+        static_cast<uint32_t>(colmajor_layout_uri_.length()),
+        colmajor_layout_uri_.c_str());
+
+    LOG_DEBUG(fmt::format(
+        "[SOMASparseNDArray] Created column-major layout '{}' of '{}' with "
+        "{} cells",
+        layout_uri,
+        uri(),
+        cells));
+}
+
+std::vector<int64_t> SOMASparseNDArray::sample_joinids(
+    size_t n, uint64_t seed) {
+    return JoinidSampler::uniform(
+        JoinidSampler::non_empty_joinids(*this, "soma_dim_0"), n, seed);
+}
+
+SampledRows SOMASparseNDArray::read_sample(std::vector<int64_t> joinids) {
+    return JoinidSampler::read(*this, "soma_dim_0", std::move(joinids));
+}
+
+std::optional<std::string> SOMASparseNDArray::colmajor_layout_uri() {
+    auto value = get_metadata(COLMAJOR_LAYOUT_KEY);
+    if (!value) {
+        return std::nullopt;
+    }
+    return std::string(
+        static_cast<const char*>(std::get<MetadataInfo::value>(*value)),
+        std::get<MetadataInfo::num>(*value));
+}
 }  // namespace tiledbsoma
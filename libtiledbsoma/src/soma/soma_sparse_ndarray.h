@@ -35,6 +35,7 @@
 
 #include <filesystem>
 
+#include "joinid_sampler.h"
 #include "soma_array.h"
 
 namespace tiledbsoma {
@@ -98,6 +99,38 @@ class SOMASparseNDArray : public SOMAArray {
      */
     static bool exists(std::string_view uri);
 
+    /**
+     * @brief Open the layout of a 2D SOMASparseNDArray expected to scan the
+     * fewest cells for a selection: the array itself, or its column-major
+     * layout if it has one (see `create_colmajor_layout`).
+     *
+     * The estimate assumes uniform density. Each selected coordinate of the
+     * major dimension of a layout scans the whole extent of every tile of
+     * the minor dimension that the selection touches.
+     *
+     * The column-major layout is only considered while the source fragment
+     * state it records matches the array, i.e. while it holds every cell of
+     * the array. Otherwise the array itself is returned.
+     *
+     * @param uri URI of the array
+     * @param ctx SOMAContext
+     * @param rows Selected `soma_dim_0` coordinates, or all if not given
+     * @param cols Selected `soma_dim_1` coordinates, or all if not given
+     * @param column_names Columns to read
+     * @param result_order Read result order
+     * @param timestamp Timestamp range to open the layouts at
+     * @return std::unique_ptr<SOMASparseNDArray> The layout, open for read.
+     * The selection is not set.
+     */
+    static std::unique_ptr<SOMASparseNDArray> open_layout(
+        std::string_view uri,
+        std::shared_ptr<SOMAContext> ctx,
+        const std::optional<JoinidBitmap>& rows,
+        const std::optional<JoinidBitmap>& cols,
+        std::vector<std::string> column_names = {},
+        ResultOrder result_order = ResultOrder::automatic,
+        std::optional<TimestampRange> timestamp = std::nullopt);
+
     //===================================================================
     //= public non-static
     //===================================================================
@@ -157,6 +190,53 @@ class SOMASparseNDArray : public SOMAArray {
      * @return std::unique_ptr<ArrowSchema>
      */
     std::unique_ptr<ArrowSchema> schema() const;
+
+    /**
+     * @brief Create a copy of this 2D array in column-major tile and cell
+     * order, with the tile extents of the two dimensions swapped, so cells
+     * are stored as in the transposed matrix while keeping their
+     * coordinates. The array must be open for write.
+     *
+     * The existing cells are copied and the layout URI is recorded in the
+     * `soma_colmajor_layout_uri` metadata. From then on writes and
+     * `consolidate_and_vacuum` through SOMAArray apply to both layouts,
+     * and `open_layout` routes reads to the cheaper one. Each copy records
+     * the fragment state of the array in the `soma_colmajor_source_state`
+     * metadata of the layout; once a write bypasses SOMAArray the layout is
+     * stale and no longer used.
+     *
+     * @param layout_uri URI of the new array
+     */
+    void create_colmajor_layout(std::string_view layout_uri);
+
+    /**
+     * @brief Return the URI of the column-major layout, if any.
+     */
+    std::optional<std::string> colmajor_layout_uri();
+
+    /**
+     * @brief Draw a uniform random sample of the `soma_dim_0` coordinates
+     * spanned by the array, see `JoinidSampler::uniform`.
+     *
+     * @param n Sample size
+     * @param seed Random seed
+     * @return std::vector<int64_t> The sample, in random order
+     */
+    std::vector<int64_t> sample_joinids(size_t n, uint64_t seed);
+
+    /**
+     * @brief Read the cells of sampled `soma_dim_0` coordinates, e.g. the
+     * X rows of an obs sample, see `JoinidSampler::read`.
+     *
+     * @param joinids Distinct `soma_dim_0` coordinates, in sample order
+     * @return SampledRows The batches and the permutation grouping their
+     * cells in sample order
+     */
+    SampledRows read_sample(std::vector<int64_t> joinids);
+
+   private:
+    // Backing storage of the cached layout URI metadata value
+    std::string colmajor_layout_uri_;
 };
 }  // namespace tiledbsoma
 
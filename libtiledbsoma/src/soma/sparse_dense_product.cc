@@ -0,0 +1,189 @@
+/**
+ * @file   sparse_dense_product.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the SparseDenseProduct class.
+ */
+
+#include "sparse_dense_product.h"
+#include <thread_pool/thread_pool.h>
+#include <algorithm>
+#include <numeric>
+#include "../utils/common.h"
+#include "../utils/logger.h"
+
+namespace tiledbsoma {
+
+// Below this many multiply-adds per task a batch runs on fewer tasks
+static const size_t MIN_FLOPS_PER_TASK = 1 << 18;
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+SparseDenseProduct::SparseDenseProduct(
+    int64_t n_rows,
+    int64_t n_cols,
+    const double* rhs,
+    int64_t k,
+    std::shared_ptr<SOMAContext> ctx)
+    : n_rows_(n_rows)
+    , n_cols_(n_cols)
+    , rhs_(rhs)
+    , k_(k)
+    , ctx_(ctx) {
+    if (n_rows < 0 || n_cols < 0 || k < 0) {
+        throw TileDBSOMAError(fmt::format(
+            "[SparseDenseProduct] Invalid shape ({}, {}) @ ({}, {})",
+            n_rows,
+            n_cols,
+            n_cols,
+            k));
+    }
+    if (rhs == nullptr && n_cols > 0 && k > 0) {
+        throw TileDBSOMAError("[SparseDenseProduct] Missing dense operand");
+    }
+    result_.assign(n_rows * k, 0);
+}
+
+template <typename T>
+void SparseDenseProduct::update(
+    const int64_t* rows, const int64_t* cols, const T* data, size_t size) {
+    if (size == 0 || k_ == 0) {
+        return;
+    }
+
+    size_t num_tasks = std::clamp<size_t>(
+        size * k_ / MIN_FLOPS_PER_TASK, 1, _concurrency());
+
+    for (size_t i = 0; i < size; ++i) {
+        if (rows[i] < 0 || rows[i] >= n_rows_ || cols[i] < 0 ||
+            cols[i] >= n_cols_) {
+            throw TileDBSOMAError(fmt::format(
+                "[SparseDenseProduct] Coordinates out of bounds for shape ({}, "
+                "{})",
+                n_rows_,
+                n_cols_));
+        }
+    }
+
+    // Add the products of cells [first, last) of `cells`, or of the batch
+    // if `cells` is null
+    auto multiply = [&](const size_t* cells, size_t first, size_t last) {
+        const int64_t k = k_;
+        for (size_t c = first; c < last; ++c) {
+            size_t i = cells ? cells[c] : c;
+            double value = static_cast<double>(data[i]);
+            double* out = result_.data() + rows[i] * k;
+            const double* in = rhs_ + cols[i] * k;
+            for (int64_t j = 0; j < k; ++j) {
+                out[j] += value * in[j];
+            }
+        }
+    };
+
+    if (num_tasks == 1) {
+        multiply(nullptr, 0, size);
+        return;
+    }
+
+    // Bucket the cells once by the task owning their row, each task owning
+    // a contiguous block of result rows. The buckets keep the batch order,
+    // so each row sums its products in the same order for any number of
+    // tasks.
+    int64_t rows_per_task = std::max<int64_t>(
+        (n_rows_ + num_tasks - 1) / num_tasks, 1);
+    std::vector<size_t> starts(num_tasks + 1, 0);
+    for (size_t i = 0; i < size; ++i) {
+        starts[rows[i] / rows_per_task + 1]++;
+    }
+    std::partial_sum(starts.begin(), starts.end(), starts.begin());
+    std::vector<size_t> cells(size);
+    {
+        auto next = starts;
+        for (size_t i = 0; i < size; ++i) {
+            cells[next[rows[i] / rows_per_task]++] = i;
+        }
+    }
+
+    std::vector<ThreadPool::Task> tasks;
+    for (size_t task = 0; task < num_tasks; ++task) {
+        tasks.emplace_back(ctx_->thread_pool()->execute([&, task]() {
+            multiply(cells.data(), starts[task], starts[task + 1]);
+            return Status::Ok();
+        }));
+    }
+    ctx_->thread_pool()->wait_all(tasks);
+}
+
+void SparseDenseProduct::update(std::shared_ptr<ArrayBuffers> batch) {
+    for (auto name : {"soma_dim_0", "soma_dim_1", "soma_data"}) {
+        if (!batch->contains(name)) {
+            throw TileDBSOMAError(fmt::format(
+                "[SparseDenseProduct] Batch is missing column '{}'", name));
+        }
+    }
+    const int64_t* rows = batch->at("soma_dim_0")->data<int64_t>().data();
+    const int64_t* cols = batch->at("soma_dim_1")->data<int64_t>().data();
+    auto values = batch->at("soma_data")->values_as<double>();
+    update(rows, cols, values.data(), batch->num_rows());
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+size_t SparseDenseProduct::_concurrency() const {
+    if (ctx_ == nullptr || ctx_->thread_pool() == nullptr) {
+        return 1;
+    }
+    return std::max<size_t>(ctx_->thread_pool()->concurrency_level(), 1);
+}
+
+template void SparseDenseProduct::update(
+    const int64_t*, const int64_t*, const int8_t*, size_t);
+template void SparseDenseProduct::update(
+    const int64_t*, const int64_t*, const uint8_t*, size_t);
+template void SparseDenseProduct::update(
+    const int64_t*, const int64_t*, const int16_t*, size_t);
+template void SparseDenseProduct::update(
+    const int64_t*, const int64_t*, const uint16_t*, size_t);
+template void SparseDenseProduct::update(
+    const int64_t*, const int64_t*, const int32_t*, size_t);
+template void SparseDenseProduct::update(
+    const int64_t*, const int64_t*, const uint32_t*, size_t);
+template void SparseDenseProduct::update(
+    const int64_t*, const int64_t*, const int64_t*, size_t);
+template void SparseDenseProduct::update(
+    const int64_t*, const int64_t*, const uint64_t*, size_t);
+template void SparseDenseProduct::update(
+    const int64_t*, const int64_t*, const float*, size_t);
+template void SparseDenseProduct::update(
+    const int64_t*, const int64_t*, const double*, size_t);
+
+}  // namespace tiledbsoma
@@ -0,0 +1,145 @@
+/**
+ * @file   sparse_dense_product.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the SparseDenseProduct class, which multiplies a 2D
+ *   sparse array streamed as COO batches (e.g. reindexed X reads) by a dense
+ *   matrix.
+ */
+
+#ifndef SOMA_SPARSE_DENSE_PRODUCT_H
+#define SOMA_SPARSE_DENSE_PRODUCT_H
+
+#include <memory>
+#include <vector>
+
+#include "array_buffers.h"
+#include "soma_context.h"
+
+namespace tiledbsoma {
+
+/**
+ * @brief The product `A @ B` of a sparse matrix A, accumulated batch by
+ * batch, and a dense row-major matrix B.
+ *
+ * Coordinates of A must already be reindexed to [0, n_rows) x [0, n_cols).
+ * B has shape (n_cols, k) and the result has shape (n_rows, k), both
+ * row-major, so each cell of A adds a scaled row of B to a row of the
+ * result with a contiguous, vectorizable inner loop. Only the current batch
+ * and the dense result are held in memory.
+ *
+ * Each task of the context thread pool owns a contiguous block of the
+ * result rows, and a counting pass buckets the cells of a batch by owner
+ * once, so tasks never write the same row and no reduction is needed.
+ */
+class SparseDenseProduct {
+   public:
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    /**
+     * @brief Construct a zero result.
+     *
+     * @param n_rows Number of rows of A
+     * @param n_cols Number of columns of A, and rows of B
+     * @param rhs B in row-major order. It is not copied and must stay alive
+     * until the last `update()`.
+     * @param k Number of columns of B
+     * @param ctx SOMAContext providing the thread pool, or nullptr to run
+     * on the calling thread
+     */
+    SparseDenseProduct(
+        int64_t n_rows,
+        int64_t n_cols,
+        const double* rhs,
+        int64_t k,
+        std::shared_ptr<SOMAContext> ctx = nullptr);
+
+    SparseDenseProduct() = delete;
+    SparseDenseProduct(const SparseDenseProduct&) = delete;
+    SparseDenseProduct(SparseDenseProduct&&) = default;
+    ~SparseDenseProduct() = default;
+
+    /**
+     * @brief Accumulate a COO batch of A.
+     *
+     * @param rows Row coordinates
+     * @param cols Column coordinates
+     * @param data Values
+     * @param size Number of cells
+     */
+    template <typename T>
+    void update(
+        const int64_t* rows, const int64_t* cols, const T* data, size_t size);
+
+    /**
+     * @brief Accumulate a COO batch read from a 2D sparse array.
+     *
+     * @param batch ArrayBuffers with `soma_dim_0`, `soma_dim_1` and a
+     * numeric `soma_data` column
+     */
+    void update(std::shared_ptr<ArrayBuffers> batch);
+
+    int64_t n_rows() const {
+        return n_rows_;
+    }
+
+    int64_t k() const {
+        return k_;
+    }
+
+    /**
+     * @brief Return the (n_rows, k) row-major result.
+     */
+    std::vector<double>& result() {
+        return result_;
+    }
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    /**
+     * @brief Return the maximum number of concurrent tasks.
+     */
+    size_t _concurrency() const;
+
+    int64_t n_rows_;
+    int64_t n_cols_;
+    const double* rhs_;
+    int64_t k_;
+    std::shared_ptr<SOMAContext> ctx_;
+
+    std::vector<double> result_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_SPARSE_DENSE_PRODUCT_H
@@ -0,0 +1,248 @@
+/**
+ * @file   sparse_moments.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the SparseMoments class.
+ */
+
+#include "sparse_moments.h"
+#include <thread_pool/thread_pool.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include "../utils/common.h"
+#include "../utils/logger.h"
+
+namespace tiledbsoma {
+
+// Below this many cells per task a batch is accumulated on fewer tasks
+static const size_t MIN_CELLS_PER_TASK = 1 << 16;
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+SparseMoments::SparseMoments(
+    int64_t n_rows, int64_t n_cols, std::shared_ptr<SOMAContext> ctx)
+    : n_rows_(n_rows)
+    , n_cols_(n_cols)
+    , ctx_(ctx) {
+    if (n_rows < 0 || n_cols < 0) {
+        throw TileDBSOMAError(fmt::format(
+            "[SparseMoments] Invalid shape ({}, {})", n_rows, n_cols));
+    }
+}
+
+template <typename T>
+void SparseMoments::update(
+    const int64_t* rows, const int64_t* cols, const T* data, size_t size) {
+    if (finalized_) {
+        throw TileDBSOMAError(
+            "[SparseMoments] Cannot update moments after finalize");
+    }
+    if (size == 0) {
+        return;
+    }
+
+    size_t num_tasks = std::clamp<size_t>(
+        size / MIN_CELLS_PER_TASK, 1, _concurrency());
+    rows_.resize(n_rows_);
+    cols_.resize(n_cols_);
+
+    // Welford update of the stored values of one row or column
+    auto add = [](Accumulator& acc, int64_t pos, double value) {
+        int64_t n = ++acc.nnz[pos];
+        double delta = value - acc.mean[pos];
+        acc.mean[pos] += delta / n;
+        acc.m2[pos] += delta * (value - acc.mean[pos]);
+    };
+
+    for (size_t i = 0; i < size; ++i) {
+        if (rows[i] < 0 || rows[i] >= n_rows_ || cols[i] < 0 ||
+            cols[i] >= n_cols_) {
+            throw TileDBSOMAError(fmt::format(
+                "[SparseMoments] Coordinates out of bounds for shape ({}, {})",
+                n_rows_,
+                n_cols_));
+        }
+    }
+
+    if (num_tasks == 1) {
+        for (size_t i = 0; i < size; ++i) {
+            double value = static_cast<double>(data[i]);
+            if (value != 0) {
+                add(rows_, rows[i], value);
+                add(cols_, cols[i], value);
+            }
+        }
+        return;
+    }
+
+    // Bucket the nonzero cells once by the task owning their row and by the
+    // task owning their column, each task owning a contiguous block of rows
+    // and one of columns. The buckets keep the batch order, so the values of
+    // a row or column are added in the same order for any number of tasks.
+    int64_t rows_per_task = std::max<int64_t>(
+        (n_rows_ + num_tasks - 1) / num_tasks, 1);
+    int64_t cols_per_task = std::max<int64_t>(
+        (n_cols_ + num_tasks - 1) / num_tasks, 1);
+    std::vector<size_t> row_starts(num_tasks + 1, 0);
+    std::vector<size_t> col_starts(num_tasks + 1, 0);
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] != 0) {
+            row_starts[rows[i] / rows_per_task + 1]++;
+            col_starts[cols[i] / cols_per_task + 1]++;
+        }
+    }
+    std::partial_sum(row_starts.begin(), row_starts.end(), row_starts.begin());
+    std::partial_sum(col_starts.begin(), col_starts.end(), col_starts.begin());
+    std::vector<size_t> by_row(row_starts.back());
+    std::vector<size_t> by_col(col_starts.back());
+    {
+        auto row_next = row_starts;
+        auto col_next = col_starts;
+        for (size_t i = 0; i < size; ++i) {
+            if (data[i] != 0) {
+                by_row[row_next[rows[i] / rows_per_task]++] = i;
+                by_col[col_next[cols[i] / cols_per_task]++] = i;
+            }
+        }
+    }
+
+    // The tasks own disjoint rows and columns, so they never write to the
+    // same accumulator entry
+    std::vector<ThreadPool::Task> tasks;
+    for (size_t task = 0; task < num_tasks; ++task) {
+        tasks.emplace_back(ctx_->thread_pool()->execute([&, task]() {
+            for (size_t k = row_starts[task]; k < row_starts[task + 1]; ++k) {
+                auto i = by_row[k];
+                add(rows_, rows[i], static_cast<double>(data[i]));
+            }
+            for (size_t k = col_starts[task]; k < col_starts[task + 1]; ++k) {
+                auto i = by_col[k];
+                add(cols_, cols[i], static_cast<double>(data[i]));
+            }
+            return Status::Ok();
+        }));
+    }
+    ctx_->thread_pool()->wait_all(tasks);
+}
+
+void SparseMoments::update(std::shared_ptr<ArrayBuffers> batch) {
+    for (auto name : {"soma_dim_0", "soma_dim_1", "soma_data"}) {
+        if (!batch->contains(name)) {
+            throw TileDBSOMAError(fmt::format(
+                "[SparseMoments] Batch is missing column '{}'", name));
+        }
+    }
+    const int64_t* rows = batch->at("soma_dim_0")->data<int64_t>().data();
+    const int64_t* cols = batch->at("soma_dim_1")->data<int64_t>().data();
+    auto values = batch->at("soma_data")->values_as<double>();
+    update(rows, cols, values.data(), batch->num_rows());
+}
+
+void SparseMoments::finalize(int64_t ddof) {
+    if (finalized_) {
+        return;
+    }
+
+    rows_.resize(n_rows_);
+    cols_.resize(n_cols_);
+    rows_.finalize(n_cols_, ddof);
+    cols_.finalize(n_rows_, ddof);
+    finalized_ = true;
+
+    LOG_DEBUG(fmt::format(
+        "[SparseMoments] Finalized moments of shape ({}, {})",
+        n_rows_,
+        n_cols_));
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+void SparseMoments::Accumulator::resize(size_t n) {
+    if (nnz.size() == n) {
+        return;
+    }
+    nnz.assign(n, 0);
+    mean.assign(n, 0);
+    m2.assign(n, 0);
+}
+
+void SparseMoments::Accumulator::finalize(int64_t n, int64_t ddof) {
+    // Merge the stored values with the `n - nnz` implicit zeros, whose mean
+    // and M2 are both zero
+    variance.resize(nnz.size());
+    for (size_t i = 0; i < nnz.size(); ++i) {
+        if (n <= ddof) {
+            mean[i] = n > 0 ? mean[i] * nnz[i] / n :
+                              std::numeric_limits<double>::quiet_NaN();
+            variance[i] = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+        double k = static_cast<double>(nnz[i]);
+        double total_m2 = m2[i] + mean[i] * mean[i] * k * (n - k) / n;
+        mean[i] = mean[i] * k / n;
+        variance[i] = total_m2 / (n - ddof);
+    }
+    m2.clear();
+    m2.shrink_to_fit();
+}
+
+size_t SparseMoments::_concurrency() const {
+    if (ctx_ == nullptr || ctx_->thread_pool() == nullptr) {
+        return 1;
+    }
+    return std::max<size_t>(ctx_->thread_pool()->concurrency_level(), 1);
+}
+
+template void SparseMoments::update(
+    const int64_t*, const int64_t*, const int8_t*, size_t);
+template void SparseMoments::update(
+    const int64_t*, const int64_t*, const uint8_t*, size_t);
+template void SparseMoments::update(
+    const int64_t*, const int64_t*, const int16_t*, size_t);
+template void SparseMoments::update(
+    const int64_t*, const int64_t*, const uint16_t*, size_t);
+template void SparseMoments::update(
+    const int64_t*, const int64_t*, const int32_t*, size_t);
+template void SparseMoments::update(
+    const int64_t*, const int64_t*, const uint32_t*, size_t);
+template void SparseMoments::update(
+    const int64_t*, const int64_t*, const int64_t*, size_t);
+template void SparseMoments::update(
+    const int64_t*, const int64_t*, const uint64_t*, size_t);
+template void SparseMoments::update(
+    const int64_t*, const int64_t*, const float*, size_t);
+template void SparseMoments::update(
+    const int64_t*, const int64_t*, const double*, size_t);
+
+}  // namespace tiledbsoma
@@ -0,0 +1,189 @@
+/**
+ * @file   sparse_moments.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the SparseMoments class, which accumulates per-row and
+ *   per-column nnz, mean and variance of a 2D sparse array (e.g. reindexed
+ *   X reads) in a single streaming pass.
+ */
+
+#ifndef SOMA_SPARSE_MOMENTS_H
+#define SOMA_SPARSE_MOMENTS_H
+
+#include <memory>
+#include <vector>
+
+#include "array_buffers.h"
+#include "soma_context.h"
+
+namespace tiledbsoma {
+
+/**
+ * @brief Streaming per-row and per-column moments of a sparse matrix.
+ *
+ * Batches are accumulated with `update()` and the moments are computed by
+ * `finalize()`. Coordinates must already be reindexed to
+ * [0, n_rows) x [0, n_cols). Cells that are not stored count as zeros, so
+ * the mean and variance of a row are taken over all `n_cols` entries.
+ * Stored zeros are treated like cells that are not stored.
+ *
+ * The stored values of each row and column are accumulated with Welford's
+ * algorithm and merged (Chan et al.) with the implicit zeros at
+ * `finalize()`, so the result is numerically stable regardless of the
+ * number of batches. The tasks of the context thread pool share one set of
+ * accumulators: each task owns a contiguous block of rows and one of
+ * columns, and a counting pass buckets the cells of a batch by owner once,
+ * so memory is O(n_rows + n_cols + batch) and the result does not depend on
+ * the number of tasks.
+ */
+class SparseMoments {
+   public:
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    /**
+     * @brief Construct empty moments.
+     *
+     * @param n_rows Number of rows
+     * @param n_cols Number of columns
+     * @param ctx SOMAContext providing the thread pool, or nullptr to run
+     * on the calling thread
+     */
+    SparseMoments(
+        int64_t n_rows,
+        int64_t n_cols,
+        std::shared_ptr<SOMAContext> ctx = nullptr);
+
+    SparseMoments() = delete;
+    SparseMoments(const SparseMoments&) = delete;
+    SparseMoments(SparseMoments&&) = default;
+    ~SparseMoments() = default;
+
+    /**
+     * @brief Accumulate a COO batch.
+     *
+     * @param rows Row coordinates
+     * @param cols Column coordinates
+     * @param data Values
+     * @param size Number of cells
+     */
+    template <typename T>
+    void update(
+        const int64_t* rows, const int64_t* cols, const T* data, size_t size);
+
+    /**
+     * @brief Accumulate a COO batch read from a 2D sparse array.
+     *
+     * @param batch ArrayBuffers with `soma_dim_0`, `soma_dim_1` and a
+     * numeric `soma_data` column
+     */
+    void update(std::shared_ptr<ArrayBuffers> batch);
+
+    /**
+     * @brief Compute the moments. No more
+     * batches may be accumulated afterwards.
+     *
+     * @param ddof Delta degrees of freedom of the variance, which is
+     * divided by `n - ddof`
+     */
+    void finalize(int64_t ddof = 1);
+
+    int64_t n_rows() const {
+        return n_rows_;
+    }
+
+    int64_t n_cols() const {
+        return n_cols_;
+    }
+
+    /**
+     * @brief Return the number of non-zero values of each row.
+     */
+    const std::vector<int64_t>& row_nnz() const {
+        return rows_.nnz;
+    }
+
+    const std::vector<double>& row_mean() const {
+        return rows_.mean;
+    }
+
+    const std::vector<double>& row_variance() const {
+        return rows_.variance;
+    }
+
+    /**
+     * @brief Return the number of non-zero values of each column.
+     */
+    const std::vector<int64_t>& col_nnz() const {
+        return cols_.nnz;
+    }
+
+    const std::vector<double>& col_mean() const {
+        return cols_.mean;
+    }
+
+    const std::vector<double>& col_variance() const {
+        return cols_.variance;
+    }
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    // Running moments of the stored values along one axis. After
+    // `finalize()`, `m2` is replaced by `variance`.
+    struct Accumulator {
+        std::vector<int64_t> nnz;
+        std::vector<double> mean;
+        std::vector<double> m2;
+        std::vector<double> variance;
+
+        void resize(size_t n);
+        void finalize(int64_t n, int64_t ddof);
+    };
+
+    /**
+     * @brief Return the maximum number of concurrent tasks.
+     */
+    size_t _concurrency() const;
+
+    int64_t n_rows_;
+    int64_t n_cols_;
+    std::shared_ptr<SOMAContext> ctx_;
+    bool finalized_ = false;
+
+    // Accumulators of each row and column, allocated on first use
+    Accumulator rows_;
+    Accumulator cols_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_SPARSE_MOMENTS_H
@@ -31,6 +31,7 @@
  */
 
 #include "arrow_adapter.h"
+#include "../soma/array_buffers.h"
 #include "../soma/column_buffer.h"
 #include "../utils/logger.h"
 
@@ -846,6 +847,47 @@ ArrowAdapter::to_arrow(std::shared_ptr<ColumnBuffer> column) {
     return std::pair(std::move(array), std::move(schema));
 }
 
+std::pair<std::unique_ptr<ArrowArray>, std::unique_ptr<ArrowSchema>>
+ArrowAdapter::to_arrow(std::shared_ptr<ArrayBuffers> buffers) {
+    auto& names = buffers->names();
+    auto n_children = static_cast<int64_t>(names.size());
+
+    std::unique_ptr<ArrowSchema> schema = std::make_unique<ArrowSchema>();
+    schema->format = strdup("+s");
+    schema->name = strdup("");
+    schema->n_children = n_children;
+    schema->children = (ArrowSchema**)calloc(n_children, sizeof(ArrowSchema*));
+    schema->release = &release_schema;
+
+    std::unique_ptr<ArrowArray> array = std::make_unique<ArrowArray>();
+    array->length = n_children > 0 ? buffers->num_rows() : 0;
+    array->n_buffers = 1;
+    array->buffers = (const void**)malloc(sizeof(void*));
+    array->buffers[0] = nullptr;  // a struct array has no validity
+    array->n_children = n_children;
+    array->children = (ArrowArray**)calloc(n_children, sizeof(ArrowArray*));
+    array->release = &release_array;
+
+    for (int64_t i = 0; i < n_children; ++i) {
+        // The release callbacks free children with `free`, so each column
+        // is moved into a malloc'd struct and its own handle is disarmed
+        auto [child_array, child_schema] = to_arrow(buffers->at(names[i]));
+        schema->children[i] = (ArrowSchema*)malloc(sizeof(ArrowSchema));
+        *schema->children[i] = *child_schema;
+        child_schema->release = nullptr;
+        array->children[i] = (ArrowArray*)malloc(sizeof(ArrowArray));
+        *array->children[i] = *child_array;
+        child_array->release = nullptr;
+    }
+
+    LOG_TRACE(fmt::format(
+        "[ArrowAdapter] create struct array of {} columns and {} rows",
+        n_children,
+        array->length));
+
+    return std::pair(std::move(array), std::move(schema));
+}
+
 bool ArrowAdapter::_isvar(const char* format) {
     if ((strcmp(format, "U") == 0) || (strcmp(format, "Z") == 0) ||
         (strcmp(format, "u") == 0) || (strcmp(format, "z") == 0)) {
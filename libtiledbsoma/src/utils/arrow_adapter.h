@@ -16,6 +16,7 @@ namespace tiledbsoma {
 using namespace tiledb;
 using json = nlohmann::json;
 
+class ArrayBuffers;
 class ColumnBuffer;
 
 /**
@@ -180,6 +181,17 @@ class ArrowAdapter {
     static std::pair<std::unique_ptr<ArrowArray>, std::unique_ptr<ArrowSchema>>
     to_arrow(std::shared_ptr<ColumnBuffer> column);
 
+    /**
+     * @brief Convert ArrayBuffers to an Arrow struct array with one child
+     * per column, so a whole batch crosses the C data interface in one
+     * import.
+     *
+     * @return std::pair<std::unique_ptr<ArrowArray>,
+     * std::unique_ptr<ArrowSchema>>
+     */
+    static std::pair<std::unique_ptr<ArrowArray>, std::unique_ptr<ArrowSchema>>
+    to_arrow(std::shared_ptr<ArrayBuffers> buffers);
+
     /**
      * @brief Create a an ArrowSchema from TileDB Schema
      *
@@ -0,0 +1,172 @@
+/**
+ * @file   bloom_filter.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the BloomFilter class.
+ */
+
+#include "bloom_filter.h"
+#include <algorithm>
+#include <cmath>
+#include "common.h"
+#include "logger.h"
+
+namespace tiledbsoma {
+
+namespace {
+
+// Serialization format version
+const uint8_t FORMAT_VERSION = 1;
+
+// Most probes per key. More only pay off at false positive rates far below
+// what the filters are sized for.
+const uint32_t MAX_HASHES = 16;
+
+// splitmix64 finalizer, spreading the FNV-1a hash over all 64 bits
+uint64_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+template <typename T>
+void put(std::vector<uint8_t>& buffer, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+template <typename T>
+T get(const uint8_t* buffer, size_t size, size_t& offset) {
+    if (offset + sizeof(T) > size) {
+        throw TileDBSOMAError("[BloomFilter] truncated buffer");
+    }
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(buffer[offset + i]) << (8 * i);
+    }
+    offset += sizeof(T);
+    return value;
+}
+
+}  // namespace
+
+//===================================================================
+//= public static
+//===================================================================
+
+BloomFilter BloomFilter::for_capacity(uint64_t num_keys, double fpp) {
+    if (!(fpp > 0 && fpp < 1)) {
+        throw TileDBSOMAError(fmt::format(
+            "[BloomFilter] false positive rate must be in (0, 1), got {}",
+            fpp));
+    }
+
+    // Optimal size m = -n ln(p) / ln(2)^2 and probe count k = m / n ln(2)
+    double n = std::max<uint64_t>(num_keys, 1);
+    double ln2 = std::log(2.0);
+    double bits = std::ceil(-n * std::log(fpp) / (ln2 * ln2));
+    BloomFilter filter;
+    filter.words_.assign((static_cast<uint64_t>(bits) + 63) / 64, 0);
+    filter.num_hashes_ = std::clamp<uint32_t>(
+        static_cast<uint32_t>(std::round(bits / n * ln2)), 1, MAX_HASHES);
+    return filter;
+}
+
+BloomFilter BloomFilter::deserialize(const uint8_t* buffer, size_t size) {
+    size_t offset = 0;
+    auto version = get<uint8_t>(buffer, size, offset);
+    if (version != FORMAT_VERSION) {
+        throw TileDBSOMAError(fmt::format(
+            "[BloomFilter] unsupported format version {}", version));
+    }
+    BloomFilter filter;
+    filter.num_hashes_ = get<uint32_t>(buffer, size, offset);
+    auto num_words = get<uint64_t>(buffer, size, offset);
+    if (num_words > (size - offset) / sizeof(uint64_t)) {
+        throw TileDBSOMAError("[BloomFilter] truncated buffer");
+    }
+    filter.words_.resize(num_words);
+    for (auto& word : filter.words_) {
+        word = get<uint64_t>(buffer, size, offset);
+    }
+    return filter;
+}
+
+BloomFilter::Hash BloomFilter::hash(std::string_view key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    // The second hash is non-zero so the probes of a key are distinct
+    return {mix(hash), mix(hash ^ 0x9E3779B97F4A7C15ULL) | 1};
+}
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+void BloomFilter::add(const Hash& hash) {
+    if (words_.empty()) {
+        throw TileDBSOMAError(
+            "[BloomFilter] cannot add to a filter without capacity");
+    }
+    uint64_t bits = num_bits();
+    for (uint32_t i = 0; i < num_hashes_; ++i) {
+        uint64_t bit = (hash.first + i * hash.second) % bits;
+        words_[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+bool BloomFilter::may_contain(const Hash& hash) const {
+    if (words_.empty()) {
+        return false;
+    }
+    uint64_t bits = num_bits();
+    for (uint32_t i = 0; i < num_hashes_; ++i) {
+        uint64_t bit = (hash.first + i * hash.second) % bits;
+        if (!(words_[bit / 64] & (uint64_t(1) << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<uint8_t> BloomFilter::serialize() const {
+    std::vector<uint8_t> buffer;
+    buffer.reserve(13 + words_.size() * sizeof(uint64_t));
+    put<uint8_t>(buffer, FORMAT_VERSION);
+    put<uint32_t>(buffer, num_hashes_);
+    put<uint64_t>(buffer, words_.size());
+    for (auto word : words_) {
+        put<uint64_t>(buffer, word);
+    }
+    return buffer;
+}
+
+}  // namespace tiledbsoma
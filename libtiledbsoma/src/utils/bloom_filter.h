@@ -0,0 +1,121 @@
+/**
+ * @file   bloom_filter.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the BloomFilter class, a probabilistic set of string
+ *   keys with no false negatives, used to skip lookups of absent keys.
+ */
+
+#ifndef TILEDBSOMA_BLOOM_FILTER_H
+#define TILEDBSOMA_BLOOM_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace tiledbsoma {
+
+class BloomFilter {
+   public:
+    // Pair of independent 64-bit hashes of a key. The probes are derived
+    // from it by double hashing, so one hash serves filters of any size.
+    using Hash = std::pair<uint64_t, uint64_t>;
+
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /**
+     * @brief Create an empty filter sized for `num_keys` keys at a false
+     * positive rate of at most `fpp`.
+     */
+    static BloomFilter for_capacity(uint64_t num_keys, double fpp = 0.01);
+
+    /**
+     * @brief Restore a filter written by `serialize()`.
+     */
+    static BloomFilter deserialize(const uint8_t* buffer, size_t size);
+
+    /**
+     * @brief Hash a key. The hash is stable across platforms and
+     * processes, so serialized filters can be shared.
+     */
+    static Hash hash(std::string_view key);
+
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    BloomFilter() = default;
+
+    void add(std::string_view key) {
+        add(hash(key));
+    }
+
+    void add(const Hash& hash);
+
+    /**
+     * @brief Return false if the key was never added. A true result may be
+     * a false positive.
+     */
+    bool may_contain(std::string_view key) const {
+        return may_contain(hash(key));
+    }
+
+    bool may_contain(const Hash& hash) const;
+
+    uint64_t num_bits() const {
+        return words_.size() * 64;
+    }
+
+    uint32_t num_hashes() const {
+        return num_hashes_;
+    }
+
+    /**
+     * @brief Serialize to a portable little-endian byte buffer.
+     */
+    std::vector<uint8_t> serialize() const;
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    // Bit array, a whole number of words
+    std::vector<uint64_t> words_;
+
+    // Number of probes per key
+    uint32_t num_hashes_ = 0;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // TILEDBSOMA_BLOOM_FILTER_H
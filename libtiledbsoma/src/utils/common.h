@@ -43,6 +43,19 @@ const std::string SOMA_OBJECT_TYPE_KEY = "soma_object_type";
 const std::string ENCODING_VERSION_KEY = "soma_encoding_version";
 const std::string ENCODING_VERSION_VAL = "1";
 
+// Metadata of a sparse array naming its column-major layout, if any
+const std::string COLMAJOR_LAYOUT_KEY = "soma_colmajor_layout_uri";
+
+// Metadata of a column-major layout holding the fragment state of its source
+// array (see `SOMAArray::fragment_state`) as of the last cells it copied
+const std::string COLMAJOR_SOURCE_STATE_KEY = "soma_colmajor_source_state";
+
+// Metadata of a dataframe naming its category index array, if any
+const std::string CATEGORY_INDEX_KEY = "soma_category_index_uri";
+
+// Metadata of a dataframe naming its key filter index array, if any
+const std::string KEY_FILTER_INDEX_KEY = "soma_key_filter_index_uri";
+
 using MetadataValue = std::tuple<tiledb_datatype_t, uint32_t, const void*>;
 enum MetadataInfo { dtype = 0, num, value };
 
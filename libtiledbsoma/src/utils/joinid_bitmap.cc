@@ -0,0 +1,821 @@
+/**
+ * @file   joinid_bitmap.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the JoinidBitmap class.
+ */
+
+#include "joinid_bitmap.h"
+#include <algorithm>
+#include <bitset>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include "common.h"
+#include "logger.h"
+
+namespace tiledbsoma {
+
+namespace {
+
+// Values per container
+const uint32_t CONTAINER_SIZE = 1 << 16;
+
+// Words per bitmap container
+const size_t NUM_WORDS = CONTAINER_SIZE / 64;
+
+// Largest array container. Above this a bitmap container (8 KiB) is smaller.
+const uint32_t MAX_ARRAY_SIZE = 4096;
+
+// Largest key of a non-negative int64 joinid
+const uint64_t MAX_KEY =
+    static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) >> 16;
+
+// Serialization tags
+const uint8_t ARRAY_CONTAINER = 0;
+const uint8_t BITMAP_CONTAINER = 1;
+const uint8_t RUN_CONTAINER = 2;
+
+uint32_t popcount(uint64_t word) {
+    return static_cast<uint32_t>(std::bitset<64>(word).count());
+}
+
+// Number of trailing zero bits of a non-zero word
+uint32_t count_trailing_zeros(uint64_t word) {
+    return popcount((word & (~word + 1)) - 1);
+}
+
+void check_joinid(int64_t joinid) {
+    if (joinid < 0) {
+        throw TileDBSOMAError(fmt::format(
+            "[JoinidBitmap] joinids must be non-negative, got {}", joinid));
+    }
+}
+
+template <typename T>
+void put(std::vector<uint8_t>& buffer, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+template <typename T>
+T get(const uint8_t* buffer, size_t size, size_t& offset) {
+    if (offset + sizeof(T) > size) {
+        throw TileDBSOMAError("[JoinidBitmap] truncated buffer");
+    }
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(buffer[offset + i]) << (8 * i);
+    }
+    offset += sizeof(T);
+    return value;
+}
+
+}  // namespace
+
+// Defined ahead of its uses below
+template <typename OnContainer, typename OnFull>
+void JoinidBitmap::_visit(OnContainer on_container, OnFull on_full) const {
+    size_t c = 0, r = 0;
+    while (c < keys_.size() || r < full_.size()) {
+        if (r == full_.size() ||
+            (c < keys_.size() && keys_[c] < full_[r].first)) {
+            on_container(keys_[c], containers_[c]);
+            ++c;
+        } else {
+            on_full(full_[r].first, full_[r].second);
+            ++r;
+        }
+    }
+}
+
+//===================================================================
+//= public static
+//===================================================================
+
+JoinidBitmap JoinidBitmap::from_joinids(const int64_t* joinids, size_t size) {
+    std::vector<int64_t> sorted(joinids, joinids + size);
+    if (!std::is_sorted(sorted.begin(), sorted.end())) {
+        std::sort(sorted.begin(), sorted.end());
+    }
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    if (!sorted.empty()) {
+        check_joinid(sorted.front());
+    }
+
+    // Each run of joinids sharing a key becomes one container
+    JoinidBitmap bitmap;
+    for (size_t begin = 0; begin < sorted.size();) {
+        uint64_t key = static_cast<uint64_t>(sorted[begin]) >> 16;
+        size_t end = begin;
+        while (end < sorted.size() &&
+               static_cast<uint64_t>(sorted[end]) >> 16 == key) {
+            ++end;
+        }
+
+        Container container;
+        container.cardinality = end - begin;
+        if (container.cardinality > MAX_ARRAY_SIZE) {
+            container.words.assign(NUM_WORDS, 0);
+            for (size_t i = begin; i < end; ++i) {
+                uint16_t low = sorted[i] & 0xFFFF;
+                container.words[low / 64] |= uint64_t(1) << (low % 64);
+            }
+        } else {
+            container.values.reserve(container.cardinality);
+            for (size_t i = begin; i < end; ++i) {
+                container.values.push_back(sorted[i] & 0xFFFF);
+            }
+        }
+        bitmap._append(key, std::move(container));
+        begin = end;
+    }
+    return bitmap;
+}
+
+JoinidBitmap JoinidBitmap::from_ranges(
+    const std::vector<std::pair<int64_t, int64_t>>& ranges) {
+    JoinidBitmap bitmap;
+    for (auto& [start, stop] : ranges) {
+        bitmap.add_range(start, stop);
+    }
+    return bitmap;
+}
+
+JoinidBitmap JoinidBitmap::deserialize(const uint8_t* buffer, size_t size) {
+    JoinidBitmap bitmap;
+    size_t offset = 0;
+
+    // Items must be sorted and disjoint: each starts at or after next_key
+    uint64_t next_key = 0;
+    auto num_items = get<uint64_t>(buffer, size, offset);
+    for (uint64_t c = 0; c < num_items; ++c) {
+        auto key = get<uint64_t>(buffer, size, offset);
+        auto kind = get<uint8_t>(buffer, size, offset);
+        if (key < next_key) {
+            throw TileDBSOMAError("[JoinidBitmap] container keys not sorted");
+        }
+        if (key > MAX_KEY) {
+            throw TileDBSOMAError(fmt::format(
+                "[JoinidBitmap] container key {} out of range", key));
+        }
+        if (kind == RUN_CONTAINER) {
+            auto last = get<uint64_t>(buffer, size, offset);
+            if (last < key || last > MAX_KEY) {
+                throw TileDBSOMAError(fmt::format(
+                    "[JoinidBitmap] invalid run [{}, {}]", key, last));
+            }
+            bitmap._append_full(key, last);
+            next_key = last + 1;
+            continue;
+        }
+
+        Container container;
+        container.cardinality = get<uint32_t>(buffer, size, offset);
+        // Validate the untrusted cardinality before allocating for it
+        if (kind == ARRAY_CONTAINER) {
+            if (container.cardinality > MAX_ARRAY_SIZE) {
+                throw TileDBSOMAError(fmt::format(
+                    "[JoinidBitmap] array container cardinality {} exceeds {}",
+                    container.cardinality,
+                    MAX_ARRAY_SIZE));
+            }
+            if (size - offset < size_t(2) * container.cardinality) {
+                throw TileDBSOMAError("[JoinidBitmap] truncated buffer");
+            }
+            container.values.resize(container.cardinality);
+            for (auto& value : container.values) {
+                value = get<uint16_t>(buffer, size, offset);
+            }
+            if (std::adjacent_find(
+                    container.values.begin(),
+                    container.values.end(),
+                    std::greater_equal<uint16_t>()) !=
+                container.values.end()) {
+                throw TileDBSOMAError(
+                    "[JoinidBitmap] array container values not sorted");
+            }
+        } else if (kind == BITMAP_CONTAINER) {
+            if (size - offset < sizeof(uint64_t) * NUM_WORDS) {
+                throw TileDBSOMAError("[JoinidBitmap] truncated buffer");
+            }
+            container.words.resize(NUM_WORDS);
+            uint32_t count = 0;
+            for (auto& word : container.words) {
+                word = get<uint64_t>(buffer, size, offset);
+                count += popcount(word);
+            }
+            if (count != container.cardinality) {
+                throw TileDBSOMAError(fmt::format(
+                    "[JoinidBitmap] bitmap container cardinality {} does not "
+                    "match its {} set bits",
+                    container.cardinality,
+                    count));
+            }
+        } else {
+            throw TileDBSOMAError(fmt::format(
+                "[JoinidBitmap] invalid container kind {}", kind));
+        }
+        // An empty container would make empty() false for an empty set
+        if (container.cardinality == 0) {
+            throw TileDBSOMAError("[JoinidBitmap] empty container");
+        }
+        _normalize(container);
+        bitmap._append(key, std::move(container));
+        next_key = key + 1;
+    }
+    if (offset != size) {
+        throw TileDBSOMAError("[JoinidBitmap] trailing bytes in buffer");
+    }
+    return bitmap;
+}
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+void JoinidBitmap::add(int64_t joinid) {
+    check_joinid(joinid);
+    uint64_t key = static_cast<uint64_t>(joinid) >> 16;
+    if (_is_full(key)) {
+        return;
+    }
+    Container& container = _container(key);
+    uint16_t low = joinid & 0xFFFF;
+    if (container.is_bitmap()) {
+        uint64_t& word = container.words[low / 64];
+        uint64_t bit = uint64_t(1) << (low % 64);
+        if (!(word & bit)) {
+            word |= bit;
+            ++container.cardinality;
+            _settle(key);
+        }
+        return;
+    }
+    auto it = std::lower_bound(
+        container.values.begin(), container.values.end(), low);
+    if (it == container.values.end() || *it != low) {
+        container.values.insert(it, low);
+        ++container.cardinality;
+        _normalize(container);
+    }
+}
+
+void JoinidBitmap::add_range(int64_t start, int64_t stop) {
+    check_joinid(start);
+    if (start > stop) {
+        throw TileDBSOMAError(fmt::format(
+            "[JoinidBitmap] invalid range [{}, {}]", start, stop));
+    }
+
+    uint64_t first_key = static_cast<uint64_t>(start) >> 16;
+    uint64_t last_key = static_cast<uint64_t>(stop) >> 16;
+    uint32_t lo = start & 0xFFFF;
+    uint32_t hi = stop & 0xFFFF;
+    if (first_key == last_key) {
+        if (lo == 0 && hi == CONTAINER_SIZE - 1) {
+            _add_full(first_key, last_key);
+        } else {
+            _add_values(first_key, lo, hi);
+        }
+        return;
+    }
+
+    // Partial containers at either end; the keys in between are one full run
+    uint64_t full_first = first_key;
+    uint64_t full_last = last_key;
+    if (lo != 0) {
+        _add_values(first_key, lo, CONTAINER_SIZE - 1);
+        ++full_first;
+    }
+    if (hi != CONTAINER_SIZE - 1) {
+        _add_values(last_key, 0, hi);
+        --full_last;
+    }
+    if (full_first <= full_last) {
+        _add_full(full_first, full_last);
+    }
+}
+
+bool JoinidBitmap::contains(int64_t joinid) const {
+    if (joinid < 0) {
+        return false;
+    }
+    uint64_t key = static_cast<uint64_t>(joinid) >> 16;
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+    if (it == keys_.end() || *it != key) {
+        return _is_full(key);
+    }
+    const Container& container = containers_[it - keys_.begin()];
+    uint16_t low = joinid & 0xFFFF;
+    if (container.is_bitmap()) {
+        return (container.words[low / 64] >> (low % 64)) & 1;
+    }
+    return std::binary_search(
+        container.values.begin(), container.values.end(), low);
+}
+
+uint64_t JoinidBitmap::cardinality() const {
+    uint64_t cardinality = 0;
+    for (auto& container : containers_) {
+        cardinality += container.cardinality;
+    }
+    for (auto& [first, last] : full_) {
+        cardinality += (last - first + 1) * CONTAINER_SIZE;
+    }
+    return cardinality;
+}
+
+size_t JoinidBitmap::nbytes() const {
+    size_t nbytes = keys_.size() * (sizeof(uint64_t) + sizeof(Container)) +
+                    full_.size() * sizeof(full_[0]);
+    for (auto& container : containers_) {
+        nbytes += container.values.size() * sizeof(uint16_t) +
+                  container.words.size() * sizeof(uint64_t);
+    }
+    return nbytes;
+}
+
+JoinidBitmap& JoinidBitmap::operator|=(const JoinidBitmap& other) {
+    _apply(other, SetOp::set_union);
+    return *this;
+}
+
+JoinidBitmap& JoinidBitmap::operator&=(const JoinidBitmap& other) {
+    _apply(other, SetOp::set_intersection);
+    return *this;
+}
+
+JoinidBitmap& JoinidBitmap::operator-=(const JoinidBitmap& other) {
+    _apply(other, SetOp::set_difference);
+    return *this;
+}
+
+bool JoinidBitmap::operator==(const JoinidBitmap& other) const {
+    // Containers are normalized, so equal sets have equal representations
+    return keys_ == other.keys_ && containers_ == other.containers_ &&
+           full_ == other.full_;
+}
+
+std::vector<int64_t> JoinidBitmap::to_joinids() const {
+    std::vector<int64_t> joinids;
+    joinids.reserve(cardinality());
+    _visit(
+        [&joinids](uint64_t key, const Container& container) {
+            int64_t base = static_cast<int64_t>(key << 16);
+            if (!container.is_bitmap()) {
+                for (auto value : container.values) {
+                    joinids.push_back(base + value);
+                }
+                return;
+            }
+            for (size_t w = 0; w < NUM_WORDS; ++w) {
+                for (uint64_t word = container.words[w]; word != 0;
+                     word &= word - 1) {
+                    joinids.push_back(
+                        base + w * 64 + count_trailing_zeros(word));
+                }
+            }
+        },
+        [&joinids](uint64_t first, uint64_t last) {
+            uint64_t stop = ((last + 1) << 16) - 1;
+            for (uint64_t joinid = first << 16; joinid <= stop; ++joinid) {
+                joinids.push_back(static_cast<int64_t>(joinid));
+            }
+        });
+    return joinids;
+}
+
+std::vector<std::pair<int64_t, int64_t>> JoinidBitmap::to_ranges() const {
+    std::vector<std::pair<int64_t, int64_t>> ranges;
+
+    // Runs that continue across container boundaries are coalesced
+    auto emit = [&ranges](int64_t start, int64_t stop) {
+        if (!ranges.empty() && ranges.back().second + 1 == start) {
+            ranges.back().second = stop;
+        } else {
+            ranges.emplace_back(start, stop);
+        }
+    };
+
+    auto emit_container = [&emit](uint64_t key, const Container& container) {
+        int64_t base = static_cast<int64_t>(key << 16);
+        if (!container.is_bitmap()) {
+            for (auto value : container.values) {
+                emit(base + value, base + value);
+            }
+            return;
+        }
+
+        // Alternate between searching for the next set bit (run start) and
+        // the next clear bit (run end)
+        bool in_run = false;
+        int64_t run_start = 0;
+        for (size_t w = 0; w < NUM_WORDS; ++w) {
+            uint64_t word = container.words[w];
+            uint32_t bit = 0;
+            while (bit < 64) {
+                if (!in_run) {
+                    uint64_t ones = word >> bit;
+                    if (ones == 0) {
+                        break;
+                    }
+                    bit += count_trailing_zeros(ones);
+                    run_start = base + w * 64 + bit;
+                    in_run = true;
+                } else {
+                    uint64_t zeros = ~word >> bit;
+                    if (zeros == 0) {
+                        break;
+                    }
+                    bit += count_trailing_zeros(zeros);
+                    emit(run_start, base + w * 64 + bit - 1);
+                    in_run = false;
+                }
+            }
+        }
+        if (in_run) {
+            emit(run_start, base + CONTAINER_SIZE - 1);
+        }
+    };
+
+    _visit(emit_container, [&emit](uint64_t first, uint64_t last) {
+        emit(
+            static_cast<int64_t>(first << 16),
+            static_cast<int64_t>(((last + 1) << 16) - 1));
+    });
+    return ranges;
+}
+
+std::vector<uint8_t> JoinidBitmap::serialize() const {
+    std::vector<uint8_t> buffer;
+    buffer.reserve(sizeof(uint64_t) + nbytes());
+    put<uint64_t>(buffer, keys_.size() + full_.size());
+    _visit(
+        [&buffer](uint64_t key, const Container& container) {
+            put<uint64_t>(buffer, key);
+            put<uint8_t>(
+                buffer,
+                container.is_bitmap() ? BITMAP_CONTAINER : ARRAY_CONTAINER);
+            put<uint32_t>(buffer, container.cardinality);
+            for (auto value : container.values) {
+                put<uint16_t>(buffer, value);
+            }
+            for (auto word : container.words) {
+                put<uint64_t>(buffer, word);
+            }
+        },
+        [&buffer](uint64_t first, uint64_t last) {
+            put<uint64_t>(buffer, first);
+            put<uint8_t>(buffer, RUN_CONTAINER);
+            put<uint64_t>(buffer, last);
+        });
+    return buffer;
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+JoinidBitmap::Container& JoinidBitmap::_container(uint64_t key) {
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+    size_t index = it - keys_.begin();
+    if (it == keys_.end() || *it != key) {
+        keys_.insert(it, key);
+        containers_.insert(containers_.begin() + index, Container());
+    }
+    return containers_[index];
+}
+
+void JoinidBitmap::_add_values(uint64_t key, uint32_t lo, uint32_t hi) {
+    if (_is_full(key)) {
+        return;
+    }
+    Container& container = _container(key);
+
+    if (!container.is_bitmap() &&
+        container.values.size() + (hi - lo + 1) <= MAX_ARRAY_SIZE) {
+        std::vector<uint16_t> range(hi - lo + 1);
+        std::iota(range.begin(), range.end(), lo);
+        std::vector<uint16_t> merged;
+        merged.reserve(container.values.size() + range.size());
+        std::set_union(
+            container.values.begin(),
+            container.values.end(),
+            range.begin(),
+            range.end(),
+            std::back_inserter(merged));
+        container.values = std::move(merged);
+        container.cardinality = container.values.size();
+        return;
+    }
+
+    if (!container.is_bitmap()) {
+        container.words.assign(NUM_WORDS, 0);
+        for (auto value : container.values) {
+            container.words[value / 64] |= uint64_t(1) << (value % 64);
+        }
+        container.values.clear();
+        container.values.shrink_to_fit();
+    }
+
+    // Set bits lo..hi, a word at a time
+    for (uint32_t w = lo / 64; w <= hi / 64; ++w) {
+        uint32_t from = w == lo / 64 ? lo % 64 : 0;
+        uint32_t to = w == hi / 64 ? hi % 64 : 63;
+        uint64_t mask = (~uint64_t(0) >> (63 - (to - from))) << from;
+        container.words[w] |= mask;
+    }
+    container.cardinality = 0;
+    for (auto word : container.words) {
+        container.cardinality += popcount(word);
+    }
+    _normalize(container);
+    _settle(key);
+}
+
+bool JoinidBitmap::_is_full(uint64_t key) const {
+    auto it = std::upper_bound(
+        full_.begin(), full_.end(), key, [](uint64_t k, const auto& run) {
+            return k < run.first;
+        });
+    return it != full_.begin() && std::prev(it)->second >= key;
+}
+
+void JoinidBitmap::_settle(uint64_t key) {
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+    if (it != keys_.end() && *it == key &&
+        containers_[it - keys_.begin()].cardinality == CONTAINER_SIZE) {
+        _add_full(key, key);
+    }
+}
+
+void JoinidBitmap::_add_full(uint64_t first, uint64_t last) {
+    auto keys_begin = std::lower_bound(keys_.begin(), keys_.end(), first);
+    auto keys_end = std::upper_bound(keys_begin, keys_.end(), last);
+    containers_.erase(
+        containers_.begin() + (keys_begin - keys_.begin()),
+        containers_.begin() + (keys_end - keys_.begin()));
+    keys_.erase(keys_begin, keys_end);
+
+    // Merge with the runs it overlaps or adjoins
+    auto begin = std::lower_bound(
+        full_.begin(), full_.end(), first, [](const auto& run, uint64_t k) {
+            return run.second + 1 < k;
+        });
+    auto end = begin;
+    while (end != full_.end() && end->first <= last + 1) {
+        first = std::min(first, end->first);
+        last = std::max(last, end->second);
+        ++end;
+    }
+    full_.emplace(full_.erase(begin, end), first, last);
+}
+
+void JoinidBitmap::_append(uint64_t key, Container container) {
+    if (container.cardinality == CONTAINER_SIZE) {
+        _append_full(key, key);
+    } else if (container.cardinality > 0) {
+        keys_.push_back(key);
+        containers_.push_back(std::move(container));
+    }
+}
+
+void JoinidBitmap::_append_full(uint64_t first, uint64_t last) {
+    if (!full_.empty() && full_.back().second + 1 == first) {
+        full_.back().second = last;
+    } else {
+        full_.emplace_back(first, last);
+    }
+}
+
+void JoinidBitmap::_apply(const JoinidBitmap& other, SetOp op) {
+    // What an operand holds from `key` on -- a container, a full run or
+    // nothing -- and the last key through which that holds
+    struct Segment {
+        const Container* container;
+        bool full;
+        uint64_t last;
+    };
+    auto segment = [](const JoinidBitmap& bitmap,
+                      size_t& c,
+                      size_t& r,
+                      uint64_t key) -> Segment {
+        while (c < bitmap.keys_.size() && bitmap.keys_[c] < key) {
+            ++c;
+        }
+        while (r < bitmap.full_.size() && bitmap.full_[r].second < key) {
+            ++r;
+        }
+        if (c < bitmap.keys_.size() && bitmap.keys_[c] == key) {
+            return {&bitmap.containers_[c], false, key};
+        }
+        if (r < bitmap.full_.size() && bitmap.full_[r].first <= key) {
+            return {nullptr, true, bitmap.full_[r].second};
+        }
+        uint64_t next = MAX_KEY + 1;
+        if (c < bitmap.keys_.size()) {
+            next = std::min(next, bitmap.keys_[c]);
+        }
+        if (r < bitmap.full_.size()) {
+            next = std::min(next, bitmap.full_[r].first);
+        }
+        return {nullptr, false, next - 1};
+    };
+
+    // Sweep both operands in key order, one segment at a time, so that full
+    // runs cost O(1) however many keys they span
+    JoinidBitmap result;
+    size_t lc = 0, lr = 0, rc = 0, rr = 0;
+    for (uint64_t key = 0; key <= MAX_KEY;) {
+        Segment lhs = segment(*this, lc, lr, key);
+        Segment rhs = segment(other, rc, rr, key);
+        const Container* l = lhs.container;
+        const Container* r = rhs.container;
+        uint64_t last = std::min(lhs.last, rhs.last);
+        switch (op) {
+            case SetOp::set_union:
+                if (lhs.full || rhs.full) {
+                    result._append_full(key, last);
+                } else if (l && r) {
+                    result._append(key, _combine(*l, *r, op));
+                } else if (l || r) {
+                    result._append(key, l ? *l : *r);
+                }
+                break;
+            case SetOp::set_intersection:
+                if (lhs.full && rhs.full) {
+                    result._append_full(key, last);
+                } else if (l && r) {
+                    result._append(key, _combine(*l, *r, op));
+                } else if (l && rhs.full) {
+                    result._append(key, *l);
+                } else if (r && lhs.full) {
+                    result._append(key, *r);
+                }
+                break;
+            case SetOp::set_difference:
+                if (lhs.full && r) {
+                    result._append(key, _complement(*r));
+                } else if (lhs.full && !rhs.full) {
+                    result._append_full(key, last);
+                } else if (l && r) {
+                    result._append(key, _combine(*l, *r, op));
+                } else if (l && !rhs.full) {
+                    result._append(key, *l);
+                }
+                break;
+        }
+        key = last + 1;
+    }
+    *this = std::move(result);
+}
+
+JoinidBitmap::Container JoinidBitmap::_combine(
+    const Container& lhs, const Container& rhs, SetOp op) {
+    Container result;
+
+    if (!lhs.is_bitmap() && !rhs.is_bitmap()) {
+        auto out = std::back_inserter(result.values);
+        auto l = lhs.values.begin(), le = lhs.values.end();
+        auto r = rhs.values.begin(), re = rhs.values.end();
+        switch (op) {
+            case SetOp::set_union:
+                std::set_union(l, le, r, re, out);
+                break;
+            case SetOp::set_intersection:
+                std::set_intersection(l, le, r, re, out);
+                break;
+            case SetOp::set_difference:
+                std::set_difference(l, le, r, re, out);
+                break;
+        }
+        result.cardinality = result.values.size();
+        _normalize(result);
+        return result;
+    }
+
+    // A sparse array filtered by a bitmap stays sparse
+    auto test = [](const Container& bitmap, uint16_t value) {
+        return ((bitmap.words[value / 64] >> (value % 64)) & 1) != 0;
+    };
+    if (op != SetOp::set_union && !lhs.is_bitmap()) {
+        bool keep_if_set = op == SetOp::set_intersection;
+        for (auto value : lhs.values) {
+            if (test(rhs, value) == keep_if_set) {
+                result.values.push_back(value);
+            }
+        }
+        result.cardinality = result.values.size();
+        return result;
+    }
+    if (op == SetOp::set_intersection && !rhs.is_bitmap()) {
+        for (auto value : rhs.values) {
+            if (test(lhs, value)) {
+                result.values.push_back(value);
+            }
+        }
+        result.cardinality = result.values.size();
+        return result;
+    }
+
+    // Word-at-a-time on dense containers
+    auto words = [](const Container& container) {
+        if (container.is_bitmap()) {
+            return container.words;
+        }
+        std::vector<uint64_t> words(NUM_WORDS, 0);
+        for (auto value : container.values) {
+            words[value / 64] |= uint64_t(1) << (value % 64);
+        }
+        return words;
+    };
+    result.words = words(lhs);
+    std::vector<uint64_t> rhs_words = words(rhs);
+    for (size_t w = 0; w < NUM_WORDS; ++w) {
+        switch (op) {
+            case SetOp::set_union:
+                result.words[w] |= rhs_words[w];
+                break;
+            case SetOp::set_intersection:
+                result.words[w] &= rhs_words[w];
+                break;
+            case SetOp::set_difference:
+                result.words[w] &= ~rhs_words[w];
+                break;
+        }
+        result.cardinality += popcount(result.words[w]);
+    }
+    _normalize(result);
+    return result;
+}
+
+JoinidBitmap::Container JoinidBitmap::_complement(
+    const Container& container) {
+    Container result;
+    result.words.assign(NUM_WORDS, ~uint64_t(0));
+    if (container.is_bitmap()) {
+        for (size_t w = 0; w < NUM_WORDS; ++w) {
+            result.words[w] = ~container.words[w];
+        }
+    } else {
+        for (auto value : container.values) {
+            result.words[value / 64] &= ~(uint64_t(1) << (value % 64));
+        }
+    }
+    result.cardinality = CONTAINER_SIZE - container.cardinality;
+    _normalize(result);
+    return result;
+}
+
+void JoinidBitmap::_normalize(Container& container) {
+    if (container.is_bitmap() && container.cardinality <= MAX_ARRAY_SIZE) {
+        container.values.clear();
+        container.values.reserve(container.cardinality);
+        for (size_t w = 0; w < NUM_WORDS; ++w) {
+            for (uint64_t word = container.words[w]; word != 0;
+                 word &= word - 1) {
+                container.values.push_back(
+                    static_cast<uint16_t>(w * 64 + count_trailing_zeros(word)));
+            }
+        }
+        container.words.clear();
+        container.words.shrink_to_fit();
+    } else if (
+        !container.is_bitmap() && container.cardinality > MAX_ARRAY_SIZE) {
+        container.words.assign(NUM_WORDS, 0);
+        for (auto value : container.values) {
+            container.words[value / 64] |= uint64_t(1) << (value % 64);
+        }
+        container.values.clear();
+        container.values.shrink_to_fit();
+    }
+}
+
+}  // namespace tiledbsoma
@@ -0,0 +1,259 @@
+/**
+ * @file   joinid_bitmap.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the JoinidBitmap class, a compressed set of soma_joinids
+ *   in the style of a roaring bitmap. Joinids are split on their high 48 bits
+ *   into containers of up to 2^16 values, each stored as a sorted array while
+ *   sparse and as a 65536-bit bitmap once dense. Runs of full containers are
+ *   stored as key intervals, so a range costs at most two partial containers
+ *   and one interval however long it is.
+ */
+
+#ifndef TILEDBSOMA_JOINID_BITMAP_H
+#define TILEDBSOMA_JOINID_BITMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace tiledbsoma {
+
+class JoinidBitmap {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /**
+     * @brief Build a bitmap from joinids in any order. Duplicates are
+     * ignored.
+     *
+     * @param joinids Non-negative soma_joinids
+     * @param size Number of joinids
+     */
+    static JoinidBitmap from_joinids(const int64_t* joinids, size_t size);
+
+    static JoinidBitmap from_joinids(const std::vector<int64_t>& joinids) {
+        return from_joinids(joinids.data(), joinids.size());
+    }
+
+    /**
+     * @brief Build a bitmap from inclusive [start, stop] ranges, which may
+     * overlap. The cost is independent of the length of the ranges.
+     */
+    static JoinidBitmap from_ranges(
+        const std::vector<std::pair<int64_t, int64_t>>& ranges);
+
+    /**
+     * @brief Restore a bitmap written by `serialize()`.
+     */
+    static JoinidBitmap deserialize(const uint8_t* buffer, size_t size);
+
+    static JoinidBitmap deserialize(const std::vector<uint8_t>& buffer) {
+        return deserialize(buffer.data(), buffer.size());
+    }
+
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    JoinidBitmap() = default;
+    JoinidBitmap(const JoinidBitmap&) = default;
+    JoinidBitmap(JoinidBitmap&&) = default;
+    JoinidBitmap& operator=(const JoinidBitmap&) = default;
+    JoinidBitmap& operator=(JoinidBitmap&&) = default;
+    ~JoinidBitmap() = default;
+
+    /**
+     * @brief Add one joinid.
+     */
+    void add(int64_t joinid);
+
+    /**
+     * @brief Add the joinids in the inclusive range [start, stop].
+     */
+    void add_range(int64_t start, int64_t stop);
+
+    bool contains(int64_t joinid) const;
+
+    /**
+     * @brief Return the number of joinids in the set.
+     */
+    uint64_t cardinality() const;
+
+    bool empty() const {
+        return containers_.empty() && full_.empty();
+    }
+
+    /**
+     * @brief Return the approximate memory used by the containers.
+     */
+    size_t nbytes() const;
+
+    /**
+     * @brief Set algebra. Each operation visits only the containers present
+     * in its operands and works word-at-a-time on dense containers.
+     */
+    JoinidBitmap& operator|=(const JoinidBitmap& other);
+    JoinidBitmap& operator&=(const JoinidBitmap& other);
+    JoinidBitmap& operator-=(const JoinidBitmap& other);
+
+    friend JoinidBitmap operator|(JoinidBitmap lhs, const JoinidBitmap& rhs) {
+        return lhs |= rhs;
+    }
+
+    friend JoinidBitmap operator&(JoinidBitmap lhs, const JoinidBitmap& rhs) {
+        return lhs &= rhs;
+    }
+
+    friend JoinidBitmap operator-(JoinidBitmap lhs, const JoinidBitmap& rhs) {
+        return lhs -= rhs;
+    }
+
+    bool operator==(const JoinidBitmap& other) const;
+
+    bool operator!=(const JoinidBitmap& other) const {
+        return !(*this == other);
+    }
+
+    /**
+     * @brief Return the joinids in ascending order.
+     */
+    std::vector<int64_t> to_joinids() const;
+
+    /**
+     * @brief Return the set as sorted, non-adjacent inclusive [start, stop]
+     * ranges, e.g. for use as subarray ranges.
+     */
+    std::vector<std::pair<int64_t, int64_t>> to_ranges() const;
+
+    /**
+     * @brief Serialize to a portable little-endian byte buffer.
+     */
+    std::vector<uint8_t> serialize() const;
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    // The low 16 bits of the joinids sharing one key
+    struct Container {
+        // Sorted values while sparse
+        std::vector<uint16_t> values;
+
+        // 65536-bit bitmap once dense, empty otherwise
+        std::vector<uint64_t> words;
+
+        uint32_t cardinality = 0;
+
+        bool is_bitmap() const {
+            return !words.empty();
+        }
+
+        bool operator==(const Container& other) const {
+            return cardinality == other.cardinality && values == other.values &&
+                   words == other.words;
+        }
+    };
+
+    enum class SetOp { set_union, set_intersection, set_difference };
+
+    /**
+     * @brief Return the container for `key`, creating an empty one if
+     * missing. `key` must not be in a full run.
+     */
+    Container& _container(uint64_t key);
+
+    /**
+     * @brief Return whether `key` is in a full run.
+     */
+    bool _is_full(uint64_t key) const;
+
+    /**
+     * @brief Add the values [lo, hi] to the container for `key`.
+     */
+    void _add_values(uint64_t key, uint32_t lo, uint32_t hi);
+
+    /**
+     * @brief Replace the container at `key` by a full run once it holds all
+     * 2^16 values.
+     */
+    void _settle(uint64_t key);
+
+    /**
+     * @brief Mark the keys [first, last] full, dropping their containers.
+     */
+    void _add_full(uint64_t first, uint64_t last);
+
+    /**
+     * @brief Append a container or a full run whose keys are greater than
+     * all keys of the bitmap.
+     */
+    void _append(uint64_t key, Container container);
+    void _append_full(uint64_t first, uint64_t last);
+
+    /**
+     * @brief Call `on_container(key, container)` and `on_full(first, last)`
+     * on the containers and full runs, in key order.
+     */
+    template <typename OnContainer, typename OnFull>
+    void _visit(OnContainer on_container, OnFull on_full) const;
+
+    /**
+     * @brief Apply a set operation to the containers of both bitmaps.
+     */
+    void _apply(const JoinidBitmap& other, SetOp op);
+
+    static Container _combine(
+        const Container& lhs, const Container& rhs, SetOp op);
+
+    // The values of a full container missing from `container`
+    static Container _complement(const Container& container);
+
+    // Switch a container between array and bitmap storage according to its
+    // cardinality
+    static void _normalize(Container& container);
+
+    // Container keys (joinid >> 16), sorted
+    std::vector<uint64_t> keys_;
+
+    // Containers, parallel to keys_. Each holds between 1 and 2^16 - 1
+    // values.
+    std::vector<Container> containers_;
+
+    // Keys whose 2^16 values are all present, as sorted, non-adjacent
+    // inclusive [first, last] runs. A full key has no container.
+    std::vector<std::pair<uint64_t, uint64_t>> full_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // TILEDBSOMA_JOINID_BITMAP_H
@@ -155,4 +155,159 @@ ArrowTable create_column_index_info() {
 
     return ArrowTable(std::move(col_info_array), std::move(col_info_schema));
 }
-}  // namespace helper
\ No newline at end of file
+namespace {
+ArrowSchema* new_child_schema(const char* format, const char* name) {
+    ArrowSchema* child = new ArrowSchema{};
+    child->format = strdup(format);
+    child->name = strdup(name);
+    child->n_children = 0;
+    child->flags = 0;
+    child->dictionary = nullptr;
+    child->release = &ArrowAdapter::release_schema;
+    return child;
+}
+
+ArrowTable create_index_info(
+    const std::vector<std::string>& names,
+    int64_t max_coord,
+    int64_t extent = 1) {
+    auto col_info_schema = std::make_unique<ArrowSchema>();
+    col_info_schema->format = strdup("+s");
+    col_info_schema->name = nullptr;
+    col_info_schema->metadata = nullptr;
+    col_info_schema->n_children = names.size();
+    col_info_schema->dictionary = nullptr;
+    col_info_schema->release = &ArrowAdapter::release_schema;
+    col_info_schema->children = new ArrowSchema*[names.size()];
+
+    auto col_info_array = std::make_unique<ArrowArray>();
+    col_info_array->length = 0;
+    col_info_array->null_count = 0;
+    col_info_array->offset = 0;
+    col_info_array->n_buffers = 0;
+    col_info_array->buffers = nullptr;
+    col_info_array->n_children = names.size();
+    col_info_array->release = &ArrowAdapter::release_array;
+    col_info_array->children = new ArrowArray*[names.size()];
+
+    for (size_t i = 0; i < names.size(); ++i) {
+        col_info_schema->children[i] = new_child_schema("l", names[i].c_str());
+
+        auto info = col_info_array->children[i] = new ArrowArray;
+        info->length = 3;
+        info->null_count = 0;
+        info->offset = 0;
+        info->n_buffers = 2;
+        info->release = &ArrowAdapter::release_array;
+        info->buffers = new const void*[2];
+        info->buffers[0] = nullptr;
+        info->buffers[1] = malloc(sizeof(int64_t) * 3);
+        info->n_children = 0;
+        int64_t dom[] = {0, max_coord, extent};
+        std::memcpy((void*)info->buffers[1], &dom, sizeof(int64_t) * 3);
+    }
+
+    return ArrowTable(std::move(col_info_array), std::move(col_info_schema));
+}
+}  // namespace
+
+std::pair<std::unique_ptr<ArrowSchema>, ArrowTable> create_joinid_schema(
+    int64_t max_joinid) {
+    // A dataframe indexed by soma_joinid with one int64 "label" attribute
+    auto arrow_schema = std::make_unique<ArrowSchema>();
+    arrow_schema->format = strdup("+s");
+    arrow_schema->name = nullptr;
+    arrow_schema->metadata = nullptr;
+    arrow_schema->n_children = 2;
+    arrow_schema->dictionary = nullptr;
+    arrow_schema->release = &ArrowAdapter::release_schema;
+    arrow_schema->children = new ArrowSchema*[2];
+    arrow_schema->children[0] = new_child_schema("l", "soma_joinid");
+    arrow_schema->children[1] = new_child_schema("l", "label");
+
+    return std::pair(
+        std::move(arrow_schema),
+        create_index_info({"soma_joinid"}, max_joinid));
+}
+
+ArrowTable create_ndarray_index_info(
+    size_t ndim, int64_t max_coord, int64_t extent) {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < ndim; ++i) {
+        names.push_back("soma_dim_" + std::to_string(i));
+    }
+    return create_index_info(names, max_coord, extent);
+}
+
+void create_experiment(
+    std::string_view uri,
+    std::shared_ptr<SOMAContext> ctx,
+    int64_t n_obs,
+    int64_t n_var,
+    int64_t x_extent) {
+    // Creates an experiment with obs and a measurement "RNA" whose var and
+    // X["data"] are fully populated. The label of each row is joinid % 2 and
+    // X[i, j] = i * n_var + j. Both dimensions of X have tiles of x_extent.
+    std::string exp_uri(uri);
+    std::string ms_uri = exp_uri + "/ms/RNA";
+    std::string x_uri = ms_uri + "/X/data";
+
+    auto [obs_schema, obs_index] = create_joinid_schema(n_obs - 1);
+    SOMAExperiment::create(
+        exp_uri,
+        std::move(obs_schema),
+        ArrowTable(std::move(obs_index.first), std::move(obs_index.second)),
+        ctx);
+
+    auto ms = SOMACollection::open(exp_uri + "/ms", OpenMode::write, ctx);
+    auto [var_schema, var_index] = create_joinid_schema(n_var - 1);
+    ms->add_new_measurement(
+        "RNA",
+        ms_uri,
+        URIType::absolute,
+        ctx,
+        std::move(var_schema),
+        ArrowTable(std::move(var_index.first), std::move(var_index.second)));
+    ms->close();
+
+    auto x = SOMACollection::open(ms_uri + "/X", OpenMode::write, ctx);
+    x->add_new_sparse_ndarray(
+        "data",
+        x_uri,
+        URIType::absolute,
+        ctx,
+        "l",
+        create_ndarray_index_info(2, std::max(n_obs, n_var) - 1, x_extent));
+    x->close();
+
+    auto write_axis = [&](const std::string& df_uri, int64_t n) {
+        std::vector<int64_t> joinids(n), labels(n);
+        for (int64_t i = 0; i < n; ++i) {
+            joinids[i] = i;
+            labels[i] = i % 2;
+        }
+        auto df = SOMADataFrame::open(df_uri, OpenMode::write, ctx);
+        df->set_column_data("soma_joinid", joinids.size(), joinids.data());
+        df->set_column_data("label", labels.size(), labels.data());
+        df->write();
+        df->close();
+    };
+    write_axis(exp_uri + "/obs", n_obs);
+    write_axis(ms_uri + "/var", n_var);
+
+    std::vector<int64_t> d0, d1, data;
+    for (int64_t i = 0; i < n_obs; ++i) {
+        for (int64_t j = 0; j < n_var; ++j) {
+            d0.push_back(i);
+            d1.push_back(j);
+            data.push_back(i * n_var + j);
+        }
+    }
+    auto sparse = SOMASparseNDArray::open(x_uri, OpenMode::write, ctx);
+    sparse->set_column_data("soma_dim_0", d0.size(), d0.data());
+    sparse->set_column_data("soma_dim_1", d1.size(), d1.data());
+    sparse->set_column_data("soma_data", data.size(), data.data());
+    sparse->write();
+    sparse->close();
+}
+}  // namespace helper
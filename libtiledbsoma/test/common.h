@@ -63,5 +63,15 @@ namespace helper {
 ArraySchema create_schema(Context& ctx, bool allow_duplicates = false);
 std::pair<std::unique_ptr<ArrowSchema>, ArrowTable> create_arrow_schema();
 ArrowTable create_column_index_info();
+std::pair<std::unique_ptr<ArrowSchema>, ArrowTable> create_joinid_schema(
+    int64_t max_joinid);
+ArrowTable create_ndarray_index_info(
+    size_t ndim, int64_t max_coord, int64_t extent = 1);
+void create_experiment(
+    std::string_view uri,
+    std::shared_ptr<SOMAContext> ctx,
+    int64_t n_obs,
+    int64_t n_var,
+    int64_t x_extent = 1);
 }  // namespace helper
 #endif
\ No newline at end of file
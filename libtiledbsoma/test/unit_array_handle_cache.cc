@@ -0,0 +1,156 @@
+/**
+ * @file   unit_array_handle_cache.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the ArrayHandleCache class
+ */
+
+#include "common.h"
+
+namespace {
+std::shared_ptr<SOMAContext> create_dataframe(
+    std::string_view uri, size_t capacity) {
+    std::map<std::string, std::string> config{
+        {ArrayHandleCache::CONFIG_KEY_SIZE, std::to_string(capacity)}};
+    auto ctx = std::make_shared<SOMAContext>(config);
+    auto [schema, index_columns] = helper::create_joinid_schema(9);
+    SOMADataFrame::create(
+        uri,
+        std::move(schema),
+        ArrowTable(
+            std::move(index_columns.first), std::move(index_columns.second)),
+        ctx);
+    return ctx;
+}
+
+std::vector<int64_t> read_labels(
+    std::string_view uri, std::shared_ptr<SOMAContext> ctx) {
+    auto df = SOMADataFrame::open(uri, OpenMode::read, ctx);
+    std::vector<int64_t> labels;
+    while (auto batch = df->read_next()) {
+        auto data = (*batch)->at("label")->data<int64_t>();
+        labels.insert(labels.end(), data.begin(), data.end());
+    }
+    df->close();
+    return labels;
+}
+}  // namespace
+
+TEST_CASE("ArrayHandleCache: shared read handles") {
+    std::string uri = "mem://unit-test-array-handle-cache-shared";
+    auto ctx = create_dataframe(uri, 4);
+    auto cache = ctx->array_handle_cache();
+    REQUIRE(cache != nullptr);
+
+    auto df1 = SOMADataFrame::open(uri, OpenMode::read, ctx);
+    auto df2 = SOMADataFrame::open(uri, OpenMode::read, ctx);
+    REQUIRE(cache->size() == 1);
+    REQUIRE(cache->misses() == 1);
+    REQUIRE(cache->hits() == 1);
+
+    // The Arrow schema is derived once and copied for each caller
+    auto schema1 = df1->arrow_schema();
+    auto schema2 = df2->arrow_schema();
+    REQUIRE(schema1->n_children == 2);
+    REQUIRE(schema2->n_children == 2);
+    for (int64_t i = 0; i < schema1->n_children; ++i) {
+        REQUIRE(
+            std::string(schema1->children[i]->name) ==
+            std::string(schema2->children[i]->name));
+        REQUIRE(
+            std::string(schema1->children[i]->format) ==
+            std::string(schema2->children[i]->format));
+    }
+    schema1->release(schema1.get());
+    schema2->release(schema2.get());
+
+    // Closing one user leaves the shared handle open for the other
+    df1->close();
+    REQUIRE(!df1->is_open());
+    REQUIRE(df2->is_open());
+    REQUIRE(df2->count() == 0);
+    df2->close();
+
+    // Timestamps are part of the key
+    auto df3 = SOMADataFrame::open(
+        uri,
+        OpenMode::read,
+        ctx,
+        {},
+        ResultOrder::automatic,
+        TimestampRange(0, std::numeric_limits<uint64_t>::max()));
+    REQUIRE(cache->size() == 2);
+    df3->close();
+}
+
+TEST_CASE("ArrayHandleCache: writes invalidate handles") {
+    std::string uri = "mem://unit-test-array-handle-cache-writes";
+    auto ctx = create_dataframe(uri, 4);
+    auto cache = ctx->array_handle_cache();
+
+    REQUIRE(read_labels(uri, ctx).empty());
+    REQUIRE(cache->size() == 1);
+
+    std::vector<int64_t> joinids{0, 1, 2}, labels{10, 11, 12};
+    auto df = SOMADataFrame::open(uri, OpenMode::write, ctx);
+    df->set_column_data("soma_joinid", joinids.size(), joinids.data());
+    df->set_column_data("label", labels.size(), labels.data());
+    df->write();
+    df->close();
+    REQUIRE(cache->size() == 0);
+
+    REQUIRE(read_labels(uri, ctx) == labels);
+    REQUIRE(read_labels(uri, ctx) == labels);
+    REQUIRE(cache->size() == 1);
+}
+
+TEST_CASE("ArrayHandleCache: capacity") {
+    std::string uri1 = "mem://unit-test-array-handle-cache-capacity-1";
+    std::string uri2 = "mem://unit-test-array-handle-cache-capacity-2";
+    auto ctx = create_dataframe(uri1, 1);
+    auto [schema, index_columns] = helper::create_joinid_schema(9);
+    SOMADataFrame::create(
+        uri2,
+        std::move(schema),
+        ArrowTable(
+            std::move(index_columns.first), std::move(index_columns.second)),
+        ctx);
+    auto cache = ctx->array_handle_cache();
+
+    auto df1 = SOMADataFrame::open(uri1, OpenMode::read, ctx);
+    auto df2 = SOMADataFrame::open(uri2, OpenMode::read, ctx);
+    REQUIRE(cache->size() == 1);
+
+    // A dropped handle stays usable by the arrays holding it
+    REQUIRE(df1->count() == 0);
+    auto schema1 = df1->arrow_schema();
+    REQUIRE(schema1->n_children == 2);
+    schema1->release(schema1.get());
+    df1->close();
+    df2->close();
+}
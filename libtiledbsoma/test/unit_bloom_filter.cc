@@ -0,0 +1,64 @@
+/**
+ * @file   unit_bloom_filter.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the BloomFilter class
+ */
+
+#include "common.h"
+
+TEST_CASE("BloomFilter: membership and serialization") {
+    auto filter = BloomFilter::for_capacity(10000, 0.01);
+    REQUIRE(filter.num_hashes() == 7);
+    for (int i = 0; i < 10000; ++i) {
+        filter.add("AAACCTG-" + std::to_string(i));
+    }
+
+    // No false negatives, and false positives near the configured rate
+    for (int i = 0; i < 10000; ++i) {
+        REQUIRE(filter.may_contain("AAACCTG-" + std::to_string(i)));
+    }
+    int false_positives = 0;
+    for (int i = 0; i < 100000; ++i) {
+        false_positives += filter.may_contain("TTTGGTC-" + std::to_string(i));
+    }
+    REQUIRE(false_positives < 2000);
+
+    auto buffer = filter.serialize();
+    auto restored = BloomFilter::deserialize(buffer.data(), buffer.size());
+    REQUIRE(restored.num_bits() == filter.num_bits());
+    REQUIRE(restored.serialize() == buffer);
+    REQUIRE(restored.may_contain(BloomFilter::hash("AAACCTG-42")));
+    REQUIRE_THROWS_AS(
+        BloomFilter::deserialize(buffer.data(), buffer.size() - 1),
+        TileDBSOMAError);
+
+    REQUIRE(!BloomFilter().may_contain("AAACCTG-0"));
+    REQUIRE_THROWS_AS(BloomFilter().add("AAACCTG-0"), TileDBSOMAError);
+    REQUIRE_THROWS_AS(BloomFilter::for_capacity(10, 0), TileDBSOMAError);
+}
@@ -0,0 +1,119 @@
+/**
+ * @file   unit_category_index.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the CategoryIndex class
+ */
+
+#include "common.h"
+
+namespace {
+
+// Creates a dataframe with an enumerated `cell_type` column and an
+// unenumerated `score` column
+void create_dataframe(std::string_view uri, std::shared_ptr<SOMAContext> ctx) {
+    auto tiledb_ctx = ctx->tiledb_ctx();
+    ArraySchema schema(*tiledb_ctx, TILEDB_SPARSE);
+    Domain domain(*tiledb_ctx);
+    domain.add_dimension(
+        Dimension::create<int64_t>(*tiledb_ctx, "soma_joinid", {0, 999}, 10));
+    schema.set_domain(domain);
+
+    std::vector<std::string> labels = {"B cell", "T cell", "NK cell"};
+    auto enmr = Enumeration::create(*tiledb_ctx, "cell_type", labels);
+    ArraySchemaExperimental::add_enumeration(*tiledb_ctx, schema, enmr);
+    auto cell_type = Attribute::create<int32_t>(*tiledb_ctx, "cell_type");
+    AttributeExperimental::set_enumeration_name(
+        *tiledb_ctx, cell_type, "cell_type");
+    schema.add_attribute(cell_type);
+    schema.add_attribute(Attribute::create<int32_t>(*tiledb_ctx, "score"));
+
+    SOMAArray::create(ctx, uri, schema, "SOMADataFrame")->close();
+}
+
+// Writes rows [begin, end) with cell_type code joinid % 3
+void write_rows(SOMADataFrame& df, int64_t begin, int64_t end) {
+    std::vector<int64_t> joinids;
+    std::vector<int32_t> codes;
+    for (int64_t joinid = begin; joinid < end; ++joinid) {
+        joinids.push_back(joinid);
+        codes.push_back(joinid % 3);
+    }
+    df.set_column_data("soma_joinid", joinids.size(), joinids.data());
+    df.set_column_data("cell_type", codes.size(), codes.data());
+    df.set_column_data("score", codes.size(), codes.data());
+    df.write();
+}
+
+std::vector<int64_t> expected_joinids(
+    int64_t end, const std::vector<int64_t>& codes) {
+    std::vector<int64_t> joinids;
+    for (int64_t joinid = 0; joinid < end; ++joinid) {
+        if (std::count(codes.begin(), codes.end(), joinid % 3)) {
+            joinids.push_back(joinid);
+        }
+    }
+    return joinids;
+}
+
+}  // namespace
+
+TEST_CASE("CategoryIndex: create, lookup and update") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-category-index";
+    std::string index_uri = uri + "-index";
+    create_dataframe(uri, ctx);
+
+    auto df = SOMADataFrame::open(uri, OpenMode::write, ctx);
+    write_rows(*df, 0, 100);
+    REQUIRE_THROWS(df->create_category_index(index_uri, {"score"}));
+    df->create_category_index(index_uri, {"cell_type"});
+    REQUIRE(df->category_index_uri() == index_uri);
+    REQUIRE_THROWS(df->create_category_index(index_uri, {"cell_type"}));
+    df->close();
+
+    auto reader = SOMADataFrame::open(uri, OpenMode::read, ctx);
+    auto t_cells = CategoryIndex::lookup(*reader, "cell_type", {"T cell"});
+    REQUIRE(t_cells.has_value());
+    REQUIRE(t_cells->to_joinids() == expected_joinids(100, {1}));
+    auto lymphocytes = CategoryIndex::lookup(
+        *reader, "cell_type", {"NK cell", "B cell", "unknown"});
+    REQUIRE(lymphocytes->to_joinids() == expected_joinids(100, {0, 2}));
+    REQUIRE(CategoryIndex::lookup(*reader, "cell_type", {"unknown"})->empty());
+    REQUIRE(!CategoryIndex::lookup(*reader, "score", {"1"}).has_value());
+    reader->close();
+
+    // Appended rows are added to the index
+    df->open(OpenMode::write);
+    write_rows(*df, 100, 250);
+    df->close();
+    reader->open(OpenMode::read);
+    t_cells = CategoryIndex::lookup(*reader, "cell_type", {"T cell"});
+    REQUIRE(t_cells->to_joinids() == expected_joinids(250, {1}));
+    reader->close();
+}
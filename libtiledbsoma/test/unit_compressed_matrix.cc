@@ -0,0 +1,117 @@
+/**
+ * @file   unit_compressed_matrix.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the CompressedMatrix class
+ */
+
+#include "common.h"
+
+TEMPLATE_TEST_CASE(
+    "CompressedMatrix: unsorted batches",
+    "[CompressedMatrix]",
+    int32_t,
+    float,
+    double) {
+    auto ctx = std::make_shared<SOMAContext>();
+    auto format = GENERATE(CompressedFormat::csr, CompressedFormat::csc);
+
+    // A 3 x 4 matrix with cells in no particular order, split in 2 batches
+    std::vector<int64_t> rows = {2, 0, 1, 0, 2, 1};
+    std::vector<int64_t> cols = {3, 2, 0, 0, 1, 3};
+    std::vector<TestType> data = {23, 2, 10, 0, 21, 13};
+
+    CompressedMatrix<TestType> matrix(format, 3, 4, ctx);
+    matrix.append(rows.data(), cols.data(), data.data(), 4);
+    matrix.append(rows.data() + 4, cols.data() + 4, data.data() + 4, 2);
+    matrix.compress();
+
+    REQUIRE(matrix.nnz() == 6);
+    REQUIRE(!matrix.was_presorted());
+    if (format == CompressedFormat::csr) {
+        REQUIRE(matrix.indptr() == std::vector<int64_t>({0, 2, 4, 6}));
+        REQUIRE(matrix.indices() == std::vector<int64_t>({0, 2, 0, 3, 1, 3}));
+        REQUIRE(
+            matrix.data() == std::vector<TestType>({0, 2, 10, 13, 21, 23}));
+    } else {
+        REQUIRE(matrix.indptr() == std::vector<int64_t>({0, 2, 3, 4, 6}));
+        REQUIRE(matrix.indices() == std::vector<int64_t>({0, 1, 2, 0, 1, 2}));
+        REQUIRE(
+            matrix.data() == std::vector<TestType>({0, 10, 21, 2, 13, 23}));
+    }
+}
+
+TEST_CASE("CompressedMatrix: presorted and empty") {
+    std::vector<int64_t> rows = {0, 0, 3};
+    std::vector<int64_t> cols = {1, 2, 0};
+    std::vector<double> data = {1, 2, 30};
+
+    CompressedMatrix<double> csr(CompressedFormat::csr, 5, 3);
+    csr.append(rows.data(), cols.data(), data.data(), rows.size());
+    csr.compress();
+    REQUIRE(csr.was_presorted());
+    REQUIRE(csr.indptr() == std::vector<int64_t>({0, 2, 2, 2, 3, 3}));
+    REQUIRE(csr.indices() == cols);
+    REQUIRE(csr.data() == data);
+
+    CompressedMatrix<double> empty(CompressedFormat::csc, 5, 3);
+    empty.compress();
+    REQUIRE(empty.nnz() == 0);
+    REQUIRE(empty.indptr() == std::vector<int64_t>({0, 0, 0, 0}));
+
+    CompressedMatrix<double> out_of_bounds(CompressedFormat::csr, 2, 3);
+    out_of_bounds.append(rows.data(), cols.data(), data.data(), rows.size());
+    REQUIRE_THROWS_AS(out_of_bounds.compress(), TileDBSOMAError);
+}
+
+TEST_CASE("CompressedMatrix: from X batches") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-compressed-matrix";
+    int64_t n_obs = 10, n_var = 5;
+    helper::create_experiment(uri, ctx, n_obs, n_var);
+
+    SOMAExperimentAxisQuery query(
+        SOMAExperiment::open(uri, OpenMode::read, ctx),
+        "RNA",
+        SOMAAxisQuery().set_coords({8, 2, 5}),
+        SOMAAxisQuery().set_coords({4, 0}));
+
+    auto order = GENERATE(ResultOrder::rowmajor, ResultOrder::colmajor);
+    CompressedMatrix<int64_t> matrix(
+        CompressedFormat::csr, query.n_obs(), query.n_vars(), ctx);
+    for (auto& batch : query.read_X("data", true, order)) {
+        matrix.append(batch);
+    }
+    matrix.compress();
+
+    REQUIRE(matrix.was_presorted() == (order == ResultOrder::rowmajor));
+    REQUIRE(matrix.indptr() == std::vector<int64_t>({0, 2, 4, 6}));
+    REQUIRE(matrix.indices() == std::vector<int64_t>({0, 1, 0, 1, 0, 1}));
+    REQUIRE(
+        matrix.data() == std::vector<int64_t>({10, 14, 25, 29, 40, 44}));
+}
@@ -0,0 +1,110 @@
+/**
+ * @file   unit_dense_row_reader.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the DenseRowReader class
+ */
+
+#include "common.h"
+
+TEST_CASE("DenseRowReader: dense array") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-dense-row-reader-dense";
+    int64_t n = 8;
+    SOMADenseNDArray::create(
+        uri, "g", helper::create_ndarray_index_info(2, n - 1), ctx);
+
+    std::vector<int64_t> d0{0, n - 1}, d1{0, n - 1};
+    std::vector<double> values(n * n);
+    std::iota(values.begin(), values.end(), 0);
+    auto dense = SOMADenseNDArray::open(uri, OpenMode::write, ctx);
+    dense->set_column_data("soma_dim_0", d0.size(), d0.data());
+    dense->set_column_data("soma_dim_1", d1.size(), d1.data());
+    dense->set_column_data("soma_data", values.size(), values.data());
+    dense->write();
+    dense->close();
+
+    dense = SOMADenseNDArray::open(uri, OpenMode::read, ctx);
+    std::vector<int64_t> joinids{5, 0, 3};
+    auto matrix = DenseRowReader::read<float>(*dense, joinids);
+    REQUIRE(matrix.size() == joinids.size() * n);
+    for (size_t i = 0; i < joinids.size(); ++i) {
+        for (int64_t j = 0; j < n; ++j) {
+            REQUIRE(matrix[i * n + j] == joinids[i] * n + j);
+        }
+    }
+
+    REQUIRE(DenseRowReader::read<double>(*dense, {}).empty());
+    REQUIRE_THROWS_AS(
+        DenseRowReader::read<double>(*dense, {1, 2, 1}), TileDBSOMAError);
+    dense->close();
+}
+
+TEST_CASE("DenseRowReader: sparse array") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-dense-row-reader-sparse";
+    int64_t n = 8;
+    SOMASparseNDArray::create(
+        uri, "l", helper::create_ndarray_index_info(2, n - 1), ctx);
+
+    // Row 3 is empty and only even columns are stored
+    std::vector<int64_t> d0, d1, values;
+    for (int64_t i = 0; i < n; ++i) {
+        for (int64_t j = 0; j < n; j += 2) {
+            if (i != 3) {
+                d0.push_back(i);
+                d1.push_back(j);
+                values.push_back(i * n + j);
+            }
+        }
+    }
+    auto sparse = SOMASparseNDArray::open(uri, OpenMode::write, ctx);
+    sparse->set_column_data("soma_dim_0", d0.size(), d0.data());
+    sparse->set_column_data("soma_dim_1", d1.size(), d1.data());
+    sparse->set_column_data("soma_data", values.size(), values.data());
+    sparse->write();
+    sparse->close();
+
+    sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+    std::vector<int64_t> joinids{6, 3, 1, 7};
+    auto matrix = DenseRowReader::read<double>(*sparse, joinids);
+    REQUIRE(matrix.size() == joinids.size() * n);
+    for (size_t i = 0; i < joinids.size(); ++i) {
+        for (int64_t j = 0; j < n; ++j) {
+            double expected = joinids[i] == 3 || j % 2 ? 0 :
+                                                         joinids[i] * n + j;
+            REQUIRE(matrix[i * n + j] == expected);
+        }
+    }
+
+    // Only the empty row has no cells
+    std::vector<uint8_t> present;
+    DenseRowReader::read<double>(*sparse, joinids, &present);
+    REQUIRE(present == std::vector<uint8_t>{1, 0, 1, 1});
+    sparse->close();
+}
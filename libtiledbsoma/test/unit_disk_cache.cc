@@ -0,0 +1,240 @@
+/**
+ * @file   unit_disk_cache.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the DiskCache class
+ */
+
+#include <filesystem>
+#include "common.h"
+
+namespace {
+std::shared_ptr<ArrayBuffers> make_batch(std::vector<int64_t> values) {
+    auto buffer = std::make_shared<ColumnBuffer>(
+        "a", TILEDB_INT64, values.size(), values.size() * sizeof(int64_t));
+    buffer->set_data(values.size(), values.data());
+
+    // A nullable string column, with every third value null
+    std::string chars;
+    std::vector<uint64_t> offsets{0};
+    std::vector<uint8_t> validity((values.size() + 7) / 8);
+    for (size_t i = 0; i < values.size(); ++i) {
+        chars += std::to_string(values[i]);
+        offsets.push_back(chars.size());
+        validity[i / 8] |= (i % 3 != 0) << (i % 8);
+    }
+    auto strings = std::make_shared<ColumnBuffer>(
+        "s", TILEDB_STRING_UTF8, values.size(), chars.size(), true, true);
+    strings->set_data(
+        values.size(), chars.data(), offsets.data(), validity.data());
+
+    auto batch = std::make_shared<ArrayBuffers>();
+    batch->emplace("a", buffer);
+    batch->emplace("s", strings);
+    return batch;
+}
+
+std::string scratch_directory(const std::string& name) {
+    auto path = std::filesystem::temp_directory_path() /
+                fmt::format("{}-{}", name, std::random_device{}());
+    return path.string();
+}
+}  // namespace
+
+TEST_CASE("DiskCache: serialized batches") {
+    auto batch = make_batch({7, 8, 9, 10});
+    std::vector<uint8_t> buffer;
+    batch->serialize(buffer);
+    REQUIRE(buffer.size() % 8 == 0);
+
+    size_t offset = 0;
+    auto copy = ArrayBuffers::deserialize(buffer.data(), buffer.size(), offset);
+    REQUIRE(offset == buffer.size());
+    REQUIRE(copy->names() == batch->names());
+    REQUIRE(copy->at("a")->data<int64_t>()[3] == 10);
+    REQUIRE(copy->at("s")->strings() == batch->at("s")->strings());
+    REQUIRE(copy->at("s")->validity()[0] == 0);
+    REQUIRE(copy->at("s")->validity()[1] == 1);
+
+    offset = 0;
+    REQUIRE_THROWS_AS(
+        ArrayBuffers::deserialize(buffer.data(), buffer.size() - 8, offset),
+        TileDBSOMAError);
+}
+
+TEST_CASE("DiskCache: LRU eviction and invalidation") {
+    auto directory = scratch_directory("soma-unit-test-disk-cache");
+    std::vector<int64_t> values(100);
+    std::iota(values.begin(), values.end(), 0);
+    {
+        DiskCache probe(directory, 1 << 20);
+        REQUIRE(probe.put("uri", "probe", {make_batch(values)}));
+    }
+    size_t entry_bytes = std::filesystem::file_size(
+        std::filesystem::directory_iterator(directory)->path());
+    std::filesystem::remove_all(directory);
+
+    DiskCache cache(directory, 2 * entry_bytes);
+    REQUIRE(cache.put("uri", "a", {make_batch(values)}));
+    REQUIRE(cache.put("uri", "b", {make_batch(values)}));
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.nbytes() == 2 * entry_bytes);
+
+    // Eviction follows file times, make "a" clearly the oldest
+    auto now = std::filesystem::file_time_type::clock::now();
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        std::filesystem::last_write_time(entry.path(), now);
+    }
+    auto batches = cache.get("uri", "b");
+    REQUIRE(batches.has_value());
+    REQUIRE((*batches)[0]->at("a")->data<int64_t>()[99] == 99);
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (std::filesystem::last_write_time(entry.path()) == now) {
+            std::filesystem::last_write_time(
+                entry.path(), now - std::chrono::hours(1));
+        }
+    }
+    REQUIRE(cache.put("uri", "c", {make_batch(values)}));
+    REQUIRE(!cache.get("uri", "a").has_value());
+    REQUIRE(cache.get("uri", "b").has_value());
+    REQUIRE(cache.get("uri", "c").has_value());
+    REQUIRE(cache.hits() == 3);
+    REQUIRE(cache.misses() == 1);
+
+    // Results over the budget are not cached
+    std::vector<int64_t> large(1000);
+    REQUIRE(!cache.put("uri", "d", {make_batch(large)}));
+
+    REQUIRE(cache.put("other", "e", {make_batch({1})}));
+    cache.invalidate("uri");
+    REQUIRE(cache.size() == 1);
+    REQUIRE(cache.get("other", "e").has_value());
+
+    cache.clear();
+    REQUIRE(cache.size() == 0);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("DiskCache: hits view a private mapping") {
+    auto directory = scratch_directory("soma-unit-test-disk-cache-map");
+    DiskCache cache(directory, 1 << 20);
+    REQUIRE(cache.put("uri", "a", {make_batch({7, 8, 9, 10})}));
+    auto batches = cache.get("uri", "a");
+    REQUIRE(batches.has_value());
+    auto strings = (*batches)[0]->at("s");
+
+    // Arrow conversion rewrites the mapped buffers, but not the entry
+    strings->validity_to_bitmap();
+    REQUIRE(strings->validity()[0] == 0b0110);
+    auto again = cache.get("uri", "a");
+    REQUIRE(again.has_value());
+    REQUIRE((*again)[0]->at("s")->validity()[1] == 1);
+
+    // The batches outlive the entry
+    cache.clear();
+    REQUIRE(cache.size() == 0);
+    std::vector<std::string> expected{"7", "8", "9", "10"};
+    REQUIRE((*batches)[0]->at("a")->data<int64_t>()[3] == 10);
+    REQUIRE(strings->strings() == expected);
+    REQUIRE(strings->clone()->strings() == expected);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("DiskCache: SOMAArray reads") {
+    auto directory = scratch_directory("soma-unit-test-disk-cache-reads");
+    std::map<std::string, std::string> config{
+        {DiskCache::CONFIG_KEY_DIR, directory},
+        {DiskCache::CONFIG_KEY_BYTES, std::to_string(1 << 20)}};
+    auto ctx = std::make_shared<SOMAContext>(config);
+    auto cache = ctx->disk_cache();
+    REQUIRE(cache != nullptr);
+    REQUIRE(ctx->result_cache() == nullptr);
+
+    std::string uri = "mem://unit-test-disk-cache";
+    int64_t n = 10;
+    auto [schema, index_columns] = helper::create_joinid_schema(n - 1);
+    SOMADataFrame::create(
+        uri,
+        std::move(schema),
+        ArrowTable(
+            std::move(index_columns.first), std::move(index_columns.second)),
+        ctx);
+
+    auto write = [&](std::shared_ptr<SOMAContext> ctx, int64_t offset) {
+        std::vector<int64_t> joinids(n), labels(n);
+        for (int64_t i = 0; i < n; ++i) {
+            joinids[i] = i;
+            labels[i] = offset + i;
+        }
+        auto df = SOMADataFrame::open(uri, OpenMode::write, ctx);
+        df->set_column_data("soma_joinid", n, joinids.data());
+        df->set_column_data("label", n, labels.data());
+        df->write();
+        df->close();
+    };
+
+    // Only reads at a fixed timestamp use the disk cache
+    auto read = [&](std::shared_ptr<SOMAContext> ctx, bool pinned) {
+        std::optional<TimestampRange> timestamp = std::nullopt;
+        if (pinned) {
+            timestamp = TimestampRange(0, UINT64_MAX);
+        }
+        auto df = SOMADataFrame::open(
+            uri, OpenMode::read, ctx, {}, ResultOrder::automatic, timestamp);
+        df->set_dim_points<int64_t>("soma_joinid", {2, 3});
+        std::vector<int64_t> labels;
+        while (auto batch = df->read_next()) {
+            auto data = (*batch)->at("label")->data<int64_t>();
+            labels.insert(labels.end(), data.begin(), data.end());
+        }
+        df->close();
+        return labels;
+    };
+
+    write(ctx, 0);
+    REQUIRE(read(ctx, false) == std::vector<int64_t>{2, 3});
+    REQUIRE(cache->size() == 0);
+    REQUIRE(read(ctx, true) == std::vector<int64_t>{2, 3});
+    REQUIRE(cache->size() == 1);
+    REQUIRE(read(ctx, true) == std::vector<int64_t>{2, 3});
+    REQUIRE(cache->hits() == 1);
+
+    // Another context sharing the directory, e.g. a later run, finds the
+    // entry
+    auto other = std::make_shared<SOMAContext>(config);
+    REQUIRE(read(other, true) == std::vector<int64_t>{2, 3});
+    REQUIRE(other->disk_cache()->hits() == 1);
+
+    // Writes through the context invalidate the cached reads
+    write(other, 100);
+    REQUIRE(cache->size() == 0);
+    REQUIRE(read(ctx, true) == std::vector<int64_t>{102, 103});
+
+    cache->clear();
+    std::filesystem::remove_all(directory);
+}
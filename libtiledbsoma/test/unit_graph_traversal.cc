@@ -0,0 +1,88 @@
+/**
+ * @file   unit_graph_traversal.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the GraphTraversal class
+ */
+
+#include "common.h"
+
+TEST_CASE("GraphTraversal: k-hop neighborhoods") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-graph-traversal";
+    SOMASparseNDArray::create(
+        uri, "g", helper::create_ndarray_index_info(2, 19), ctx);
+
+    // An undirected path 0 - 1 - 2 - 3 - 4, an edge 10 -> 11 and a self
+    // loop on 2
+    std::vector<int64_t> d0, d1;
+    std::vector<double> values;
+    auto add_edge = [&](int64_t from, int64_t to, double value) {
+        d0.push_back(from);
+        d1.push_back(to);
+        values.push_back(value);
+    };
+    for (int64_t i = 0; i < 4; ++i) {
+        add_edge(i, i + 1, i + 0.5);
+        add_edge(i + 1, i, i + 0.5);
+    }
+    add_edge(10, 11, 7);
+    add_edge(2, 2, 9);
+    auto graph = SOMASparseNDArray::open(uri, OpenMode::write, ctx);
+    graph->set_column_data("soma_dim_0", d0.size(), d0.data());
+    graph->set_column_data("soma_dim_1", d1.size(), d1.data());
+    graph->set_column_data("soma_data", values.size(), values.data());
+    graph->write();
+    graph->close();
+
+    graph = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+    auto one_hop = GraphTraversal::k_hop(
+        *graph, JoinidBitmap::from_joinids({2, 10}), 1);
+    REQUIRE(one_hop.joinids == std::vector<int64_t>({1, 2, 3, 10, 11}));
+    REQUIRE(one_hop.hops == std::vector<uint32_t>({1, 0, 1, 0, 1}));
+    REQUIRE(one_hop.indptr == std::vector<int64_t>({0, 1, 4, 5, 6, 6}));
+    REQUIRE(one_hop.indices == std::vector<int64_t>({1, 0, 1, 2, 1, 4}));
+    REQUIRE(one_hop.data == std::vector<double>({1.5, 1.5, 9, 2.5, 2.5, 7}));
+
+    // The expansion stops once no new node is found
+    auto all = GraphTraversal::k_hop(
+        *graph, JoinidBitmap::from_joinids({0}), 10, false);
+    REQUIRE(all.joinids == std::vector<int64_t>({0, 1, 2, 3, 4}));
+    REQUIRE(all.hops == std::vector<uint32_t>({0, 1, 2, 3, 4}));
+    REQUIRE(all.indptr.empty());
+
+    auto induced = GraphTraversal::induced_subgraph(
+        *graph, JoinidBitmap::from_joinids({0, 2, 3}));
+    REQUIRE(induced.indptr == std::vector<int64_t>({0, 0, 2, 3}));
+    REQUIRE(induced.indices == std::vector<int64_t>({1, 2, 1}));
+
+    auto empty = GraphTraversal::k_hop(*graph, JoinidBitmap(), 3);
+    REQUIRE(empty.joinids.empty());
+    REQUIRE(empty.indptr == std::vector<int64_t>({0}));
+    graph->close();
+}
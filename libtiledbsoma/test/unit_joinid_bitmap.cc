@@ -0,0 +1,255 @@
+/**
+ * @file   unit_joinid_bitmap.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the JoinidBitmap class
+ */
+
+#include "common.h"
+
+TEST_CASE("JoinidBitmap: build and convert") {
+    // Sparse (array) and dense (bitmap) containers, with runs crossing a
+    // container boundary
+    std::vector<int64_t> joinids = {70000, 5, 3, 4, 5, 1 << 20};
+    auto bitmap = JoinidBitmap::from_joinids(joinids);
+    bitmap.add_range(65530, 65545);
+    bitmap.add_range(200000, 210000);
+
+    REQUIRE(bitmap.cardinality() == 5 + 16 + 10001);
+    REQUIRE(bitmap.contains(4));
+    REQUIRE(bitmap.contains(65536));
+    REQUIRE(bitmap.contains(205000));
+    REQUIRE(!bitmap.contains(6));
+    REQUIRE(!bitmap.contains(-1));
+
+    std::vector<std::pair<int64_t, int64_t>> expected = {
+        {3, 5},
+        {65530, 65545},
+        {70000, 70000},
+        {200000, 210000},
+        {1 << 20, 1 << 20}};
+    REQUIRE(bitmap.to_ranges() == expected);
+    REQUIRE(JoinidBitmap::from_ranges(expected) == bitmap);
+
+    auto sorted = bitmap.to_joinids();
+    REQUIRE(sorted.size() == bitmap.cardinality());
+    REQUIRE(std::is_sorted(sorted.begin(), sorted.end()));
+    REQUIRE(JoinidBitmap::from_joinids(sorted) == bitmap);
+
+    REQUIRE(JoinidBitmap::deserialize(bitmap.serialize()) == bitmap);
+    REQUIRE_THROWS_AS(
+        JoinidBitmap::from_joinids(std::vector<int64_t>({-1})),
+        TileDBSOMAError);
+    REQUIRE_THROWS_AS(JoinidBitmap().add_range(5, 4), TileDBSOMAError);
+
+    // A dense selection is far smaller than the equivalent int64 array
+    auto dense = JoinidBitmap::from_ranges({{0, 9999999}});
+    REQUIRE(dense.cardinality() == 10000000);
+    REQUIRE(dense.nbytes() < 10000000 * sizeof(int64_t) / 32);
+}
+
+TEST_CASE("JoinidBitmap: reject corrupt buffers") {
+    auto put = [](std::vector<uint8_t>& buffer, uint64_t value, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    };
+    auto header = [&](uint8_t kind, uint32_t cardinality) {
+        std::vector<uint8_t> buffer;
+        put(buffer, 1, 8);  // one container
+        put(buffer, 0, 8);  // key
+        put(buffer, kind, 1);
+        put(buffer, cardinality, 4);
+        return buffer;
+    };
+
+    // A huge cardinality is rejected before anything is allocated for it
+    REQUIRE_THROWS_AS(
+        JoinidBitmap::deserialize(header(0, 0xFFFFFFFF)), TileDBSOMAError);
+    // An array container whose values are cut short
+    auto buffer = header(0, 3);
+    put(buffer, 1, 2);
+    put(buffer, 2, 2);
+    REQUIRE_THROWS_AS(JoinidBitmap::deserialize(buffer), TileDBSOMAError);
+    put(buffer, 3, 2);
+    REQUIRE(
+        JoinidBitmap::deserialize(buffer).to_joinids() ==
+        std::vector<int64_t>({1, 2, 3}));
+    // Unsorted or repeated array values
+    std::vector<std::vector<uint64_t>> unsorted = {{3, 1, 2}, {1, 1, 2}};
+    for (auto& values : unsorted) {
+        buffer = header(0, 3);
+        for (auto value : values) {
+            put(buffer, value, 2);
+        }
+        REQUIRE_THROWS_AS(JoinidBitmap::deserialize(buffer), TileDBSOMAError);
+    }
+    // A bitmap container whose cardinality does not match its set bits
+    buffer = header(1, 4097);
+    for (size_t i = 0; i < 1024; ++i) {
+        put(buffer, i < 64 ? ~uint64_t(0) : 0, 8);
+    }
+    REQUIRE_THROWS_AS(JoinidBitmap::deserialize(buffer), TileDBSOMAError);
+    buffer = header(1, 4096);
+    for (size_t i = 0; i < 1024; ++i) {
+        put(buffer, i < 64 ? ~uint64_t(0) : 0, 8);
+    }
+    REQUIRE(JoinidBitmap::deserialize(buffer).cardinality() == 4096);
+    // Empty containers, which would make empty() false for an empty set
+    REQUIRE_THROWS_AS(
+        JoinidBitmap::deserialize(header(0, 0)), TileDBSOMAError);
+    buffer = header(1, 0);
+    for (size_t i = 0; i < 1024; ++i) {
+        put(buffer, 0, 8);
+    }
+    REQUIRE_THROWS_AS(JoinidBitmap::deserialize(buffer), TileDBSOMAError);
+    // A run overlapping the container after it
+    buffer.clear();
+    put(buffer, 2, 8);
+    put(buffer, 0, 8);
+    put(buffer, 2, 1);
+    put(buffer, 1, 8);
+    put(buffer, 1, 8);
+    put(buffer, 0, 1);
+    put(buffer, 1, 4);
+    put(buffer, 7, 2);
+    REQUIRE_THROWS_AS(JoinidBitmap::deserialize(buffer), TileDBSOMAError);
+    // A full bitmap container is restored as a run
+    buffer = header(1, 65536);
+    for (size_t i = 0; i < 1024; ++i) {
+        put(buffer, ~uint64_t(0), 8);
+    }
+    REQUIRE(
+        JoinidBitmap::deserialize(buffer) ==
+        JoinidBitmap::from_ranges({{0, 65535}}));
+}
+
+TEST_CASE("JoinidBitmap: open-ended ranges") {
+    // Long ranges are stored as runs of full containers, so a range open to
+    // the largest joinid costs no more than its partial first container
+    int64_t max_joinid = std::numeric_limits<int64_t>::max();
+    auto open = JoinidBitmap::from_ranges({{5, max_joinid}});
+    REQUIRE(open.nbytes() < 2 * 8192);
+    REQUIRE(open.cardinality() == uint64_t(max_joinid) - 4);
+    REQUIRE(!open.contains(4));
+    REQUIRE(open.contains(5));
+    REQUIRE(open.contains(max_joinid));
+    REQUIRE(
+        open.to_ranges() ==
+        std::vector<std::pair<int64_t, int64_t>>({{5, max_joinid}}));
+    REQUIRE(JoinidBitmap::deserialize(open.serialize()) == open);
+    REQUIRE(open.serialize().size() < 2 * 8192);
+
+    // Adding inside a run is a no-op; adjacent ranges merge
+    auto copy = open;
+    copy.add(1 << 20);
+    copy.add_range(100, 1 << 30);
+    REQUIRE(copy == open);
+    copy.add_range(0, 4);
+    REQUIRE(copy == JoinidBitmap::from_ranges({{0, max_joinid}}));
+
+    // Set algebra against small sets splits runs without expanding them
+    auto small = JoinidBitmap::from_joinids({1, 3, 70000, int64_t(1) << 40});
+    auto both = open & small;
+    REQUIRE(
+        both.to_joinids() == std::vector<int64_t>({70000, int64_t(1) << 40}));
+    auto rest = open - small;
+    REQUIRE(rest.nbytes() < 4 * 8192);
+    REQUIRE(rest.cardinality() == open.cardinality() - 2);
+    REQUIRE(!rest.contains(70000));
+    REQUIRE(rest.contains(70001));
+    REQUIRE(
+        rest.to_ranges() ==
+        std::vector<std::pair<int64_t, int64_t>>(
+            {{5, 69999},
+             {70001, (int64_t(1) << 40) - 1},
+             {(int64_t(1) << 40) + 1, max_joinid}}));
+    REQUIRE((rest | small) == (open | small));
+    REQUIRE((open - open).empty());
+    REQUIRE(
+        (open - JoinidBitmap::from_ranges({{0, 1 << 20}})).to_ranges() ==
+        std::vector<std::pair<int64_t, int64_t>>(
+            {{(1 << 20) + 1, max_joinid}}));
+
+    // A container filled one joinid at a time becomes a run
+    JoinidBitmap filled;
+    for (int64_t joinid = 65536; joinid < 2 * 65536; ++joinid) {
+        filled.add(joinid);
+    }
+    REQUIRE(filled == JoinidBitmap::from_ranges({{65536, 2 * 65536 - 1}}));
+}
+
+TEST_CASE("JoinidBitmap: set algebra") {
+    int64_t evens = GENERATE(1000, 100000);
+    JoinidBitmap lhs, rhs;
+    for (int64_t i = 0; i < evens; ++i) {
+        lhs.add(2 * i);
+    }
+    rhs.add_range(0, evens - 1);
+
+    auto both = lhs & rhs;
+    auto either = lhs | rhs;
+    auto lhs_only = lhs - rhs;
+    auto rhs_only = rhs - lhs;
+
+    REQUIRE(both.cardinality() == static_cast<uint64_t>((evens + 1) / 2));
+    REQUIRE(
+        either.cardinality() ==
+        lhs.cardinality() + rhs.cardinality() - both.cardinality());
+    REQUIRE(lhs_only.cardinality() == lhs.cardinality() - both.cardinality());
+    REQUIRE(rhs_only.cardinality() == rhs.cardinality() - both.cardinality());
+    REQUIRE((lhs_only | both) == lhs);
+    REQUIRE((rhs_only & lhs).empty());
+    for (auto joinid : {int64_t(0), int64_t(2), evens - 2}) {
+        REQUIRE(both.contains(joinid));
+        REQUIRE(!rhs_only.contains(joinid));
+    }
+}
+
+TEST_CASE("JoinidBitmap: axis query selection") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-joinid-bitmap";
+    helper::create_experiment(uri, ctx, 20, 5);
+
+    SOMAExperimentAxisQuery query(
+        SOMAExperiment::open(uri, OpenMode::read, ctx),
+        "RNA",
+        SOMAAxisQuery().set_coords({2, 3}).set_ranges({{10, 13}, {3, 4}}));
+
+    REQUIRE(
+        query.obs_bitmap().to_ranges() ==
+        std::vector<std::pair<int64_t, int64_t>>({{2, 4}, {10, 13}}));
+    REQUIRE(query.n_obs() == 7);
+    REQUIRE(query.n_vars() == 5);
+
+    size_t num_cells = 0;
+    for (auto& batch : query.read_X("data")) {
+        num_cells += batch->num_rows();
+    }
+    REQUIRE(num_cells == 7 * 5);
+}
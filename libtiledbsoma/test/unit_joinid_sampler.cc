@@ -0,0 +1,141 @@
+/**
+ * @file   unit_joinid_sampler.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the JoinidSampler class
+ */
+
+#include "common.h"
+
+TEST_CASE("JoinidSampler: uniform") {
+    auto population = JoinidBitmap::from_ranges({{10, 19}, {100, 199}});
+
+    auto sample = JoinidSampler::uniform(population, 30, 7);
+    REQUIRE(sample.size() == 30);
+    REQUIRE(JoinidBitmap::from_joinids(sample).cardinality() == 30);
+    for (auto joinid : sample) {
+        REQUIRE(population.contains(joinid));
+    }
+    REQUIRE(JoinidSampler::uniform(population, 30, 7) == sample);
+    REQUIRE(JoinidSampler::uniform(population, 30, 8) != sample);
+
+    auto all = JoinidSampler::uniform(population, 1000, 7);
+    REQUIRE(all.size() == 110);
+    REQUIRE(JoinidBitmap::from_joinids(all) == population);
+
+    REQUIRE(JoinidSampler::uniform(JoinidBitmap(), 5, 7).empty());
+}
+
+TEST_CASE("JoinidSampler: tile ranges") {
+    auto joinids = JoinidBitmap::from_joinids({1, 3, 15, 16, 17, 40, 47, 100});
+
+    // Runs are split at tile bounds and merged across small gaps only
+    auto ranges = JoinidSampler::tile_ranges(joinids, 0, 16, 0);
+    std::vector<std::pair<int64_t, int64_t>> expected = {
+        {1, 1}, {3, 3}, {15, 15}, {16, 17}, {40, 40}, {47, 47}, {100, 100}};
+    REQUIRE(ranges == expected);
+
+    ranges = JoinidSampler::tile_ranges(joinids, 0, 16, 1);
+    expected = {{1, 3}, {15, 15}, {16, 17}, {40, 40}, {47, 47}, {100, 100}};
+    REQUIRE(ranges == expected);
+
+    // A gap as large as the tile extent merges each tile into one range
+    ranges = JoinidSampler::tile_ranges(joinids, 0, 16, 16);
+    expected = {{1, 15}, {16, 17}, {40, 47}, {100, 100}};
+    REQUIRE(ranges == expected);
+
+    ranges = JoinidSampler::tile_ranges(
+        JoinidBitmap::from_ranges({{5, 40}, {60, 63}}), 0, 16, 16);
+    expected = {{5, 15}, {16, 31}, {32, 40}, {60, 63}};
+    REQUIRE(ranges == expected);
+
+    REQUIRE_THROWS_AS(
+        JoinidSampler::tile_ranges(JoinidBitmap::from_joinids({1}), 0, 0, 0),
+        TileDBSOMAError);
+    REQUIRE_THROWS_AS(
+        JoinidSampler::tile_ranges(JoinidBitmap::from_joinids({1}), 0, 16, -1),
+        TileDBSOMAError);
+}
+
+TEST_CASE("JoinidSampler: stratified sample and read") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-joinid-sampler";
+    int64_t n_obs = 60, n_var = 4;
+    helper::create_experiment(uri, ctx, n_obs, n_var);
+
+    // The obs label is joinid % 2, so each label gets half of the sample
+    auto obs = SOMADataFrame::open(uri + "/obs", OpenMode::read, ctx);
+    auto sample = JoinidSampler::stratified(*obs, "label", 10, 3);
+    REQUIRE(sample.size() == 10);
+    REQUIRE(JoinidBitmap::from_joinids(sample).cardinality() == 10);
+    int64_t odd = std::count_if(
+        sample.begin(), sample.end(), [](int64_t j) { return j % 2; });
+    REQUIRE(odd == 5);
+
+    auto subset = JoinidSampler::stratified(
+        *obs, "label", 4, 3, JoinidBitmap::from_ranges({{0, 9}}));
+    REQUIRE(subset.size() == 4);
+    for (auto joinid : subset) {
+        REQUIRE(joinid < 10);
+    }
+    REQUIRE(JoinidSampler::stratified(*obs, "label", 100, 3).size() == 60);
+    obs->close();
+
+    // Reading X rows returns the cells of each sampled row in sample order
+    auto x = SOMASparseNDArray::open(
+        uri + "/ms/RNA/X/data", OpenMode::read, ctx);
+    auto rows = JoinidSampler::read(*x, "soma_dim_0", sample);
+    REQUIRE(rows.joinids == sample);
+    REQUIRE(rows.permutation.size() == sample.size() * n_var);
+
+    // Only the rows of sampled joinids are kept
+    size_t num_rows = 0;
+    for (auto& batch : rows.batches) {
+        num_rows += batch->num_rows();
+    }
+    REQUIRE(num_rows == rows.permutation.size());
+
+    std::vector<int64_t> dim_0, data;
+    for (auto& batch : rows.batches) {
+        auto d0 = batch->at("soma_dim_0")->data<int64_t>();
+        auto values = batch->at("soma_data")->data<int64_t>();
+        dim_0.insert(dim_0.end(), d0.begin(), d0.end());
+        data.insert(data.end(), values.begin(), values.end());
+    }
+    for (size_t k = 0; k < rows.permutation.size(); ++k) {
+        auto row = rows.permutation[k];
+        auto i = sample[k / n_var];
+        REQUIRE(dim_0[row] == i);
+        REQUIRE(data[row] / n_var == i);
+    }
+
+    REQUIRE_THROWS_AS(
+        JoinidSampler::read(*x, "soma_dim_0", {1, 1}), TileDBSOMAError);
+    REQUIRE(JoinidSampler::read(*x, "soma_dim_0", {}).permutation.empty());
+    x->close();
+}
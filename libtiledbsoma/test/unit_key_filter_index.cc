@@ -0,0 +1,193 @@
+/**
+ * @file   unit_key_filter_index.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the KeyFilterIndex class
+ */
+
+#include "common.h"
+
+namespace {
+
+// Creates a dataframe indexed by a string `obs_id` dimension
+void create_dataframe(std::string_view uri, std::shared_ptr<SOMAContext> ctx) {
+    auto tiledb_ctx = ctx->tiledb_ctx();
+    ArraySchema schema(*tiledb_ctx, TILEDB_SPARSE);
+    Domain domain(*tiledb_ctx);
+    domain.add_dimension(Dimension::create(
+        *tiledb_ctx, "obs_id", TILEDB_STRING_ASCII, nullptr, nullptr));
+    schema.set_domain(domain);
+    schema.add_attribute(Attribute::create<int64_t>(*tiledb_ctx, "n"));
+    SOMAArray::create(ctx, uri, schema, "SOMADataFrame")->close();
+}
+
+std::string barcode(int64_t n) {
+    return "cell-" + std::to_string(n);
+}
+
+// Writes the rows [begin, end) with n set to the row number
+void write_rows(SOMADataFrame& df, int64_t begin, int64_t end) {
+    std::string keys;
+    std::vector<uint64_t> offsets = {0};
+    std::vector<int64_t> values;
+    for (int64_t n = begin; n < end; ++n) {
+        keys += barcode(n);
+        offsets.push_back(keys.size());
+        values.push_back(n);
+    }
+    df.set_column_data("obs_id", values.size(), keys.data(), offsets.data());
+    df.set_column_data("n", values.size(), values.data());
+    df.write();
+}
+
+}  // namespace
+
+TEST_CASE("KeyFilterIndex: point lookups skip absent keys") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-key-filter-index";
+    std::string index_uri = uri + "-index";
+    create_dataframe(uri, ctx);
+
+    auto df = SOMADataFrame::open(uri, OpenMode::write, ctx);
+    write_rows(*df, 0, 100);
+    REQUIRE_THROWS(df->create_key_filter_index(index_uri, {"n"}));
+    df->create_key_filter_index(index_uri, {"obs_id"});
+    REQUIRE(df->key_filter_index_uri() == index_uri);
+    df->close();
+
+    // Present keys always pass, and nearly all absent keys are dropped
+    std::vector<std::string> keys;
+    for (int64_t n = 0; n < 10; ++n) {
+        keys.push_back(barcode(10 * n));
+    }
+    for (int64_t n = 0; n < 100; ++n) {
+        keys.push_back("absent-" + std::to_string(n));
+    }
+    auto reader = SOMADataFrame::open(uri, OpenMode::read, ctx);
+    auto candidates = KeyFilterIndex::filter(*reader, "obs_id", keys);
+    REQUIRE(candidates.has_value());
+    REQUIRE(candidates->keys.size() >= 10);
+    REQUIRE(candidates->keys.size() < 20);
+    REQUIRE(std::equal(
+        keys.begin(), keys.begin() + 10, candidates->keys.begin()));
+
+    reader->set_dim_points("obs_id", keys);
+    std::vector<int64_t> values;
+    while (auto batch = reader->read_next()) {
+        auto data = (*batch)->at("n")->data<int64_t>();
+        values.insert(values.end(), data.begin(), data.end());
+    }
+    std::sort(values.begin(), values.end());
+    REQUIRE(
+        values == std::vector<int64_t>{0, 10, 20, 30, 40, 50, 60, 70, 80, 90});
+    reader->close();
+
+    // Each write adds a filter of its keys
+    df->open(OpenMode::write);
+    write_rows(*df, 100, 150);
+    df->close();
+    reader->open(OpenMode::read);
+    candidates = KeyFilterIndex::filter(*reader, "obs_id", {barcode(120)});
+    REQUIRE(candidates->keys == std::vector<std::string>{barcode(120)});
+    reader->close();
+}
+
+TEST_CASE("KeyFilterIndex: lookups read the fragments of their keys") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-key-filter-index-fragments";
+    std::string index_uri = uri + "-index";
+    create_dataframe(uri, ctx);
+
+    auto open_at = [&](uint64_t timestamp) {
+        return SOMADataFrame::open(
+            uri,
+            OpenMode::write,
+            ctx,
+            {},
+            ResultOrder::automatic,
+            TimestampRange(timestamp, timestamp));
+    };
+    auto df = open_at(10);
+    write_rows(*df, 0, 100);
+    // A low false positive rate keeps keys out of the other fragments
+    df->create_key_filter_index(index_uri, {"obs_id"}, 1e-6);
+    df->close();
+    df = open_at(20);
+    write_rows(*df, 100, 200);
+    df->close();
+    df = open_at(30);
+    write_rows(*df, 200, 300);
+    df->close();
+
+    auto reader = SOMADataFrame::open(uri, OpenMode::read, ctx);
+    auto read_keys = [&reader](const std::vector<std::string>& keys) {
+        reader->reset();
+        reader->set_dim_points("obs_id", keys);
+        std::vector<int64_t> values;
+        while (auto batch = reader->read_next()) {
+            auto data = (*batch)->at("n")->data<int64_t>();
+            values.insert(values.end(), data.begin(), data.end());
+        }
+        std::sort(values.begin(), values.end());
+        return values;
+    };
+
+    auto candidates = KeyFilterIndex::filter(
+        *reader, "obs_id", {barcode(250), "absent"});
+    REQUIRE(candidates->keys == std::vector<std::string>{barcode(250)});
+    REQUIRE(candidates->fragments == TimestampRange(30, 30));
+    candidates = KeyFilterIndex::filter(
+        *reader, "obs_id", {barcode(5), barcode(250)});
+    REQUIRE(candidates->fragments == TimestampRange(10, 30));
+
+    // Narrowed reads still find every key, and reset restores the range
+    REQUIRE(read_keys({barcode(250)}) == std::vector<int64_t>{250});
+    REQUIRE(read_keys({barcode(5)}) == std::vector<int64_t>{5});
+    REQUIRE(
+        read_keys({barcode(150), barcode(5), "absent"}) ==
+        std::vector<int64_t>{5, 150});
+    reader->close();
+
+    // Consolidation replaces the filters by one of the merged fragment
+    df = SOMADataFrame::open(uri, OpenMode::write, ctx);
+    df->consolidate_and_vacuum({"fragments"});
+    df->close();
+    auto index = SOMAArray::open(OpenMode::read, index_uri, ctx);
+    size_t num_filters = 0;
+    while (auto batch = index->read_next()) {
+        num_filters += (*batch)->num_rows();
+    }
+    index->close();
+    REQUIRE(num_filters == 1);
+
+    reader->open(OpenMode::read);
+    candidates = KeyFilterIndex::filter(*reader, "obs_id", {barcode(250)});
+    REQUIRE(candidates->fragments == TimestampRange(10, 30));
+    REQUIRE(read_keys({barcode(250)}) == std::vector<int64_t>{250});
+    reader->close();
+}
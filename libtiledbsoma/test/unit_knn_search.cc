@@ -0,0 +1,169 @@
+/**
+ * @file   unit_knn_search.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the KnnSearch class
+ */
+
+#include "common.h"
+
+TEST_CASE("KnnSearch: small embedding") {
+    auto ctx = std::make_shared<SOMAContext>();
+
+    // Rows on the unit circle and the origin
+    std::vector<int64_t> joinids = {10, 11, 12, 13, 14};
+    std::vector<float> rows = {1, 0, 0, 1, -1, 0, 0, -1, 0, 0};
+    std::vector<float> queries = {2, 0, 0, 0.5};
+
+    KnnSearch l2(queries.data(), 2, 2, 2, KnnMetric::l2, ctx);
+    l2.update(joinids.data(), rows.data(), 2);
+    l2.update(joinids.data() + 2, rows.data() + 4, 3);
+    auto result = l2.result();
+    REQUIRE(result.k == 2);
+    REQUIRE(result.joinids == std::vector<int64_t>({10, 14, 11, 14}));
+    REQUIRE_THAT(result.distances[0], Catch::Matchers::WithinRel(1.0f));
+    REQUIRE_THAT(result.distances[1], Catch::Matchers::WithinRel(2.0f));
+    REQUIRE_THAT(result.distances[2], Catch::Matchers::WithinRel(0.5f));
+    REQUIRE_THAT(result.distances[3], Catch::Matchers::WithinRel(0.5f));
+
+    // The origin has no direction, so its cosine distance is 1. Ties go to
+    // the smaller joinid.
+    KnnSearch cosine(queries.data(), 2, 2, 3, KnnMetric::cosine);
+    cosine.update(joinids.data(), rows.data(), 5);
+    result = cosine.result();
+    REQUIRE(result.joinids == std::vector<int64_t>({10, 11, 13, 11, 10, 12}));
+    REQUIRE_THAT(result.distances[0], Catch::Matchers::WithinAbs(0, 1e-6));
+    REQUIRE_THAT(result.distances[1], Catch::Matchers::WithinRel(1.0f));
+
+    // Fewer candidates than neighbors
+    KnnSearch padded(queries.data(), 1, 2, 3);
+    padded.update(joinids.data(), rows.data(), 1);
+    result = padded.result();
+    REQUIRE(result.joinids == std::vector<int64_t>({10, -1, -1}));
+    REQUIRE(std::isinf(result.distances[2]));
+
+    REQUIRE_THROWS_AS(KnnSearch(queries.data(), 1, 0, 1), TileDBSOMAError);
+}
+
+TEST_CASE("KnnSearch: rows with no stored cells") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-knn-search-sparse";
+    // Rows and columns share the domain, so rows have n dimensions
+    int64_t n = 6, dim = n;
+    SOMASparseNDArray::create(
+        uri, "f", helper::create_ndarray_index_info(2, n - 1), ctx);
+
+    // Rows 1 and 4 are not stored, so they would read as the origin
+    std::vector<int64_t> d0, d1;
+    std::vector<float> values;
+    for (int64_t i = 0; i < n; ++i) {
+        if (i == 1 || i == 4) {
+            continue;
+        }
+        for (int64_t j = 0; j < dim; ++j) {
+            d0.push_back(i);
+            d1.push_back(j);
+            values.push_back(i + 1);
+        }
+    }
+    auto sparse = SOMASparseNDArray::open(uri, OpenMode::write, ctx);
+    sparse->set_column_data("soma_dim_0", d0.size(), d0.data());
+    sparse->set_column_data("soma_dim_1", d1.size(), d1.data());
+    sparse->set_column_data("soma_data", values.size(), values.data());
+    sparse->write();
+    sparse->close();
+
+    sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+    std::vector<float> query(dim, 0);
+    auto result = KnnSearch::search(
+        *sparse,
+        query.data(),
+        1,
+        dim,
+        n,
+        KnnMetric::l2,
+        JoinidBitmap::from_ranges({{0, n - 1}}),
+        3);
+    REQUIRE(result.joinids == std::vector<int64_t>({0, 2, 3, 5, -1, -1}));
+    REQUIRE(std::isinf(result.distances[4]));
+    sparse->close();
+}
+
+TEST_CASE("KnnSearch: from an axis query") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-knn-search";
+    int64_t n_obs = 20, n_var = 4;
+    helper::create_experiment(uri, ctx, n_obs, n_var);
+
+    // obsm["X_pca"][i] = (i, 0, ..., 0)
+    auto obsm = SOMACollection::open(
+        uri + "/ms/RNA/obsm", OpenMode::write, ctx);
+    obsm->add_new_dense_ndarray(
+        "X_pca",
+        uri + "/ms/RNA/obsm/X_pca",
+        URIType::absolute,
+        ctx,
+        "f",
+        helper::create_ndarray_index_info(2, n_obs - 1));
+    obsm->close();
+    std::vector<int64_t> d0{0, n_obs - 1}, d1{0, n_obs - 1};
+    std::vector<float> values(n_obs * n_obs, 0);
+    for (int64_t i = 0; i < n_obs; ++i) {
+        values[i * n_obs] = i;
+    }
+    auto dense = SOMADenseNDArray::open(
+        uri + "/ms/RNA/obsm/X_pca", OpenMode::write, ctx);
+    dense->set_column_data("soma_dim_0", d0.size(), d0.data());
+    dense->set_column_data("soma_dim_1", d1.size(), d1.data());
+    dense->set_column_data("soma_data", values.size(), values.data());
+    dense->write();
+    dense->close();
+
+    std::vector<float> queries(2 * n_obs, 0);
+    queries[0] = 7.2;
+    queries[n_obs] = 30;
+
+    SOMAExperimentAxisQuery all(
+        SOMAExperiment::open(uri, OpenMode::read, ctx), "RNA");
+    auto result = all.obsm_knn("X_pca", queries.data(), 2, n_obs, 3);
+    REQUIRE(result.joinids == std::vector<int64_t>({7, 8, 6, 19, 18, 17}));
+    REQUIRE_THAT(result.distances[3], Catch::Matchers::WithinRel(11.0f));
+
+    // Only the selected obs are candidates
+    SOMAExperimentAxisQuery selected(
+        SOMAExperiment::open(uri, OpenMode::read, ctx),
+        "RNA",
+        SOMAAxisQuery().set_ranges({{0, 6}, {9, 12}}));
+    result = selected.obsm_knn("X_pca", queries.data(), 2, n_obs, 3);
+    REQUIRE(result.joinids == std::vector<int64_t>({6, 9, 5, 12, 11, 10}));
+
+    REQUIRE_THROWS_AS(
+        all.obsm_knn("X_umap", queries.data(), 2, n_obs, 3), TileDBSOMAError);
+    REQUIRE_THROWS_AS(
+        all.obsm_knn("X_pca", queries.data(), 1, 2, 3), TileDBSOMAError);
+}
@@ -38,6 +38,7 @@
 #include <catch2/matchers/catch_matchers_string.hpp>
 #include <catch2/matchers/catch_matchers_templated.hpp>
 #include <catch2/matchers/catch_matchers_vector.hpp>
+#include <numeric>
 #include <random>
 
 #include <tiledb/tiledb>
@@ -184,3 +185,139 @@ TEST_CASE("ManagedQuery: Validity test") {
     REQUIRE_THAT(a0, Equals(mq.strings("a0")));
     REQUIRE_THAT(a0_valids, Equals(a0_valids_actual));
 }
+
+TEST_CASE("ManagedQuery: Select coalesced points") {
+    std::string uri = "mem://unit-test-array-points";
+    auto ctx = std::make_shared<Context>();
+
+    ArraySchema schema(*ctx, TILEDB_SPARSE);
+    Domain domain(*ctx);
+    domain.add_dimension(Dimension::create<int64_t>(*ctx, "d0", {0, 99}, 10));
+    schema.set_domain(domain);
+    schema.add_attribute(Attribute::create<int64_t>(*ctx, "a0"));
+    Array::create(uri, std::move(schema));
+
+    std::vector<int64_t> d0(20);
+    std::iota(d0.begin(), d0.end(), 0);
+    std::vector<int64_t> a0(d0.begin(), d0.end());
+    Array writer(*ctx, uri, TILEDB_WRITE);
+    Query query(*ctx, writer);
+    query.set_layout(TILEDB_UNORDERED)
+        .set_data_buffer("d0", d0)
+        .set_data_buffer("a0", a0);
+    query.submit();
+    writer.close();
+
+    // Unsorted, with a duplicate and two runs: [3, 5] and [9, 10]
+    std::vector<int64_t> points = {10, 4, 3, 9, 5, 4, 15};
+    auto mq = ManagedQuery(
+        std::make_shared<Array>(*ctx, uri, TILEDB_READ), ctx);
+    mq.select_points("d0", points);
+    mq.set_layout(TILEDB_ROW_MAJOR);
+    mq.setup_read();
+    mq.submit_read();
+    mq.results();
+    REQUIRE(mq.results_complete());
+    REQUIRE(mq.total_num_cells() == 6);
+
+    // The seven points are coalesced into three ranges
+    REQUIRE(mq.num_ranges("d0") == 3);
+
+    // Results follow the layout, not the order of the points
+    auto data = mq.data<int64_t>("a0");
+    std::vector<int64_t> expected = {3, 4, 5, 9, 10, 15};
+    REQUIRE(std::vector<int64_t>(data.begin(), data.end()) == expected);
+
+    // a0 equals d0, so it maps the results back to the points
+    auto mapping = ManagedQuery::point_rows(points, data.data(), data.size());
+    REQUIRE(mapping.rows == std::vector<int64_t>({4, 1, 0, 3, 2, 1, 5}));
+    REQUIRE(
+        mapping.offsets == std::vector<int64_t>({0, 1, 2, 3, 4, 5, 6, 7}));
+}
+
+TEST_CASE("ManagedQuery: Map point results") {
+    // Point 2 matches two rows and point 7 three; both are repeated. Point
+    // 40 matches no row, and row 1 matches no point.
+    std::vector<int64_t> points = {7, 2, 7, 40, 2};
+    std::vector<int64_t> values = {2, 5, 7, 2, 7, 7};
+    auto mapping = ManagedQuery::point_rows(
+        points, values.data(), values.size());
+    REQUIRE(
+        mapping.rows ==
+        std::vector<int64_t>({2, 4, 5, 0, 3, 2, 4, 5, 0, 3}));
+    REQUIRE(mapping.offsets == std::vector<int64_t>({0, 3, 5, 8, 8, 10}));
+
+    mapping = ManagedQuery::point_rows({}, values.data(), values.size());
+    REQUIRE(mapping.rows.empty());
+    REQUIRE(mapping.offsets == std::vector<int64_t>({0}));
+
+    mapping = ManagedQuery::point_rows(points, nullptr, 0);
+    REQUIRE(mapping.rows.empty());
+    REQUIRE(mapping.offsets == std::vector<int64_t>({0, 0, 0, 0, 0, 0}));
+}
+
+TEST_CASE("ManagedQuery: Select points sorted on the thread pool") {
+    std::string uri = "mem://unit-test-array-parallel-points";
+    auto soma_ctx = std::make_shared<SOMAContext>(
+        std::map<std::string, std::string>(
+            {{"sm.compute_concurrency_level", "8"}}));
+    auto ctx = soma_ctx->tiledb_ctx();
+    REQUIRE(soma_ctx->thread_pool() != nullptr);
+
+    ArraySchema schema(*ctx, TILEDB_SPARSE);
+    Domain domain(*ctx);
+    domain.add_dimension(
+        Dimension::create<int64_t>(*ctx, "d0", {0, 999999}, 1000));
+    schema.set_domain(domain);
+    schema.add_attribute(Attribute::create<int64_t>(*ctx, "a0"));
+    Array::create(uri, std::move(schema));
+
+    // Every third joinid below 300000
+    std::vector<int64_t> d0;
+    for (int64_t i = 0; i < 300000; i += 3) {
+        d0.push_back(i);
+    }
+    std::vector<int64_t> a0(d0.begin(), d0.end());
+    Array writer(*ctx, uri, TILEDB_WRITE);
+    Query query(*ctx, writer);
+    query.set_layout(TILEDB_UNORDERED)
+        .set_data_buffer("d0", d0)
+        .set_data_buffer("a0", a0);
+    query.submit();
+    writer.close();
+
+    // Enough shuffled points for several sort slices: [0, 200000) without
+    // every 1000th joinid, so 200 runs, plus duplicates of the first 1000
+    std::vector<int64_t> points;
+    for (int64_t i = 0; i < 200000; ++i) {
+        if (i % 1000 != 999) {
+            points.push_back(i);
+        }
+    }
+    points.insert(points.end(), points.begin(), points.begin() + 1000);
+    std::shuffle(points.begin(), points.end(), std::mt19937_64(7));
+    REQUIRE(points.size() >= 2 * (1 << 16));
+
+    ManagedQuery mq(std::make_shared<Array>(*ctx, uri, TILEDB_READ), ctx);
+    mq.set_thread_pool(soma_ctx->thread_pool());
+    mq.select_points("d0", points);
+    REQUIRE(mq.num_ranges("d0") == 200);
+
+    mq.set_layout(TILEDB_ROW_MAJOR);
+    std::vector<int64_t> results;
+    do {
+        mq.setup_read();
+        mq.submit_read();
+        mq.results();
+        auto data = mq.data<int64_t>("a0");
+        results.insert(results.end(), data.begin(), data.end());
+    } while (!mq.is_complete(true));
+
+    std::vector<int64_t> expected;
+    for (int64_t i = 0; i < 200000; i += 3) {
+        if (i % 1000 != 999) {
+            expected.push_back(i);
+        }
+    }
+    REQUIRE(results == expected);
+}
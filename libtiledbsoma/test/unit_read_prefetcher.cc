@@ -0,0 +1,131 @@
+/**
+ * @file   unit_read_prefetcher.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the ReadPrefetcher class
+ */
+
+#include "common.h"
+
+namespace {
+// Return the int64 values of a child of a struct batch by name
+std::vector<int64_t> child_values(
+    const ReadPrefetcher::ArrowBatch& batch, const std::string& name) {
+    auto& [array, schema] = batch;
+    for (int64_t i = 0; i < schema->n_children; ++i) {
+        if (name == schema->children[i]->name) {
+            auto child = array->children[i];
+            auto data = static_cast<const int64_t*>(child->buffers[1]);
+            return std::vector<int64_t>(data, data + child->length);
+        }
+    }
+    FAIL("Missing column " << name);
+    return {};
+}
+}  // namespace
+
+TEST_CASE("ReadPrefetcher: batches") {
+    // A small read buffer splits the read into many batches
+    std::map<std::string, std::string> cfg;
+    cfg["soma.init_buffer_bytes"] = "64";
+    auto ctx = std::make_shared<SOMAContext>(cfg);
+    std::string uri = "mem://unit-test-read-prefetcher";
+    helper::create_experiment(uri, ctx, 12, 4);
+
+    auto x = SOMASparseNDArray::open(
+        uri + "/ms/RNA/X/data",
+        OpenMode::read,
+        ctx,
+        {},
+        ResultOrder::rowmajor);
+
+    size_t num_batches = 0;
+    std::vector<int64_t> d0, d1, data;
+    {
+        ReadPrefetcher prefetcher(*x, 2);
+        while (auto batch = prefetcher.next()) {
+            REQUIRE(std::string(batch->second->format) == "+s");
+            auto v0 = child_values(*batch, "soma_dim_0");
+            auto v1 = child_values(*batch, "soma_dim_1");
+            auto vd = child_values(*batch, "soma_data");
+            d0.insert(d0.end(), v0.begin(), v0.end());
+            d1.insert(d1.end(), v1.begin(), v1.end());
+            data.insert(data.end(), vd.begin(), vd.end());
+            batch->first->release(batch->first.get());
+            batch->second->release(batch->second.get());
+            ++num_batches;
+        }
+        REQUIRE(!prefetcher.next().has_value());
+    }
+    REQUIRE(num_batches > 1);
+    REQUIRE(data.size() == 48);
+    for (size_t i = 0; i < data.size(); ++i) {
+        REQUIRE(data[i] == d0[i] * 4 + d1[i]);
+    }
+    x->close();
+}
+
+TEST_CASE("ReadPrefetcher: reindexing") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-read-prefetcher-reindex";
+    helper::create_experiment(uri, ctx, 6, 4);
+
+    auto x = SOMASparseNDArray::open(
+        uri + "/ms/RNA/X/data", OpenMode::read, ctx);
+    x->set_dim_points<int64_t>("soma_dim_1", {3, 1});
+
+    auto indexer = std::make_shared<IntIndexer>(ctx);
+    indexer->map_locations(std::vector<int64_t>{3, 1});
+    {
+        ReadPrefetcher prefetcher(*x, 1, {{"soma_dim_1", indexer}});
+        size_t num_cells = 0;
+        while (auto batch = prefetcher.next()) {
+            auto d0 = child_values(*batch, "soma_dim_0");
+            auto d1 = child_values(*batch, "soma_dim_1");
+            auto data = child_values(*batch, "soma_data");
+            for (size_t i = 0; i < data.size(); ++i) {
+                REQUIRE(d1[i] == (data[i] == d0[i] * 4 + 3 ? 0 : 1));
+            }
+            num_cells += data.size();
+            batch->first->release(batch->first.get());
+            batch->second->release(batch->second.get());
+        }
+        REQUIRE(num_cells == 12);
+    }
+    x->close();
+
+    // Errors raised on the background thread surface in next()
+    x->open(OpenMode::read);
+    {
+        ReadPrefetcher prefetcher(*x, 1, {{"soma_data_missing", indexer}});
+        REQUIRE_THROWS_AS(prefetcher.next(), TileDBSOMAError);
+    }
+    x->close();
+
+    REQUIRE_THROWS_AS(ReadPrefetcher(*x, 0), TileDBSOMAError);
+}
@@ -0,0 +1,176 @@
+/**
+ * @file   unit_result_cache.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the ResultCache class
+ */
+
+#include "common.h"
+
+namespace {
+std::vector<std::shared_ptr<ArrayBuffers>> make_batches(
+    std::vector<int64_t> values) {
+    auto buffer = std::make_shared<ColumnBuffer>(
+        "a", TILEDB_INT64, values.size(), values.size() * sizeof(int64_t));
+    buffer->set_data(values.size(), values.data());
+    auto batch = std::make_shared<ArrayBuffers>();
+    batch->emplace("a", buffer);
+    return {batch->clone()};
+}
+
+std::vector<int64_t> values_of(
+    const std::vector<std::shared_ptr<ArrayBuffers>>& batches) {
+    std::vector<int64_t> values;
+    for (const auto& batch : batches) {
+        auto data = batch->at("a")->data<int64_t>();
+        values.insert(values.end(), data.begin(), data.end());
+    }
+    return values;
+}
+}  // namespace
+
+TEST_CASE("ResultCache: LRU eviction") {
+    std::vector<int64_t> values(100);
+    std::iota(values.begin(), values.end(), 0);
+    size_t entry_bytes = make_batches(values)[0]->nbytes();
+    ResultCache cache(2 * entry_bytes);
+
+    REQUIRE(cache.put("uri", "a", make_batches(values)));
+    REQUIRE(cache.put("uri", "b", make_batches(values)));
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.nbytes() == 2 * entry_bytes);
+
+    // "a" is the least recently used entry
+    REQUIRE(cache.put("uri", "c", make_batches(values)));
+    REQUIRE(!cache.get("a").has_value());
+    REQUIRE(cache.get("b").has_value());
+
+    // "c" is now the least recently used entry
+    REQUIRE(cache.put("uri", "d", make_batches(values)));
+    REQUIRE(!cache.get("c").has_value());
+    REQUIRE(cache.get("b").has_value());
+    REQUIRE(cache.get("d").has_value());
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.hits() == 3);
+    REQUIRE(cache.misses() == 2);
+
+    // Results over the budget are not cached
+    std::vector<int64_t> large(1000);
+    REQUIRE(!cache.put("uri", "e", make_batches(large)));
+    REQUIRE(cache.size() == 2);
+
+    cache.clear();
+    REQUIRE(cache.size() == 0);
+    REQUIRE(cache.nbytes() == 0);
+}
+
+TEST_CASE("ResultCache: get returns copies") {
+    ResultCache cache(1 << 20);
+    std::vector<int64_t> values{1, 2, 3};
+    cache.put("uri", "key", make_batches(values));
+
+    auto batches = cache.get("key");
+    REQUIRE(values_of(*batches) == values);
+    (*batches)[0]->at("a")->data<int64_t>()[0] = 100;
+    REQUIRE(values_of(*cache.get("key")) == values);
+}
+
+TEST_CASE("ResultCache: invalidate") {
+    ResultCache cache(1 << 20);
+    cache.put("uri1", "a", make_batches({1}));
+    cache.put("uri1", "b", make_batches({2}));
+    cache.put("uri2", "c", make_batches({3}));
+
+    cache.invalidate("uri1");
+    REQUIRE(cache.size() == 1);
+    REQUIRE(!cache.get("a").has_value());
+    REQUIRE(!cache.get("b").has_value());
+    REQUIRE(values_of(*cache.get("c")) == std::vector<int64_t>{3});
+}
+
+TEST_CASE("ResultCache: SOMAArray reads") {
+    std::map<std::string, std::string> config{
+        {ResultCache::CONFIG_KEY_BYTES, std::to_string(1 << 20)}};
+    auto ctx = std::make_shared<SOMAContext>(config);
+    auto cache = ctx->result_cache();
+    REQUIRE(cache != nullptr);
+    REQUIRE(cache->capacity() == 1 << 20);
+
+    std::string uri = "mem://unit-test-result-cache";
+    int64_t n = 10;
+    auto [schema, index_columns] = helper::create_joinid_schema(n - 1);
+    SOMADataFrame::create(
+        uri,
+        std::move(schema),
+        ArrowTable(
+            std::move(index_columns.first), std::move(index_columns.second)),
+        ctx);
+
+    auto write = [&](int64_t offset) {
+        std::vector<int64_t> joinids(n), labels(n);
+        for (int64_t i = 0; i < n; ++i) {
+            joinids[i] = i;
+            labels[i] = offset + i;
+        }
+        auto df = SOMADataFrame::open(uri, OpenMode::write, ctx);
+        df->set_column_data("soma_joinid", n, joinids.data());
+        df->set_column_data("label", n, labels.data());
+        df->write();
+        df->close();
+    };
+
+    auto read = [&](std::vector<int64_t> points) {
+        auto df = SOMADataFrame::open(uri, OpenMode::read, ctx);
+        df->set_dim_points("soma_joinid", points);
+        std::vector<int64_t> labels;
+        while (auto batch = df->read_next()) {
+            auto data = (*batch)->at("label")->data<int64_t>();
+            labels.insert(labels.end(), data.begin(), data.end());
+        }
+        REQUIRE(df->results_complete());
+        df->close();
+        return labels;
+    };
+
+    write(0);
+    REQUIRE(read({2, 3}) == std::vector<int64_t>{2, 3});
+    REQUIRE(cache->size() == 1);
+    REQUIRE(cache->hits() == 0);
+
+    // The same selection is served from the cache, another one is not
+    REQUIRE(read({2, 3}) == std::vector<int64_t>{2, 3});
+    REQUIRE(cache->hits() == 1);
+    REQUIRE(read({4}) == std::vector<int64_t>{4});
+    REQUIRE(cache->hits() == 1);
+    REQUIRE(cache->size() == 2);
+
+    // Writes through the context invalidate the cached reads
+    write(100);
+    REQUIRE(cache->size() == 0);
+    REQUIRE(read({2, 3}) == std::vector<int64_t>{102, 103});
+}
@@ -0,0 +1,80 @@
+/**
+ * @file   unit_shared_batch.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the SharedBatch class
+ */
+
+#include "common.h"
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+
+TEST_CASE("SharedBatch: write and map a batch") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-shared-batch";
+    helper::create_experiment(uri, ctx, 30, 2);
+
+    auto obs = SOMADataFrame::open(uri + "/obs", OpenMode::read, ctx);
+    auto batch = obs->read_next();
+    REQUIRE(batch.has_value());
+    obs->close();
+
+    std::string name = "/soma-unit-test-" + std::to_string(getpid());
+    REQUIRE(SharedBatch::write(name, *batch) > 0);
+    REQUIRE_THROWS_AS(SharedBatch::write(name, *batch), TileDBSOMAError);
+
+    // Map the segment in another process, as a worker would
+    pid_t pid = fork();
+    if (pid == 0) {
+        auto [array, schema] = SharedBatch::open(name);
+        bool ok = array->length == 30 && array->n_children == 2 &&
+                  std::string(schema->format) == "+s";
+        for (int64_t c = 0; ok && c < schema->n_children; ++c) {
+            auto values = static_cast<const int64_t*>(
+                array->children[c]->buffers[1]);
+            bool label = std::string(schema->children[c]->name) == "label";
+            for (int64_t i = 0; i < 30; ++i) {
+                ok = ok && values[i] == (label ? i % 2 : i);
+            }
+        }
+        array->release(array.get());
+        schema->release(schema.get());
+        _exit(ok ? 0 : 1);
+    }
+    int status;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(WEXITSTATUS(status) == 0);
+
+    // The worker unlinked the segment after mapping it
+    REQUIRE_THROWS_AS(SharedBatch::open(name), TileDBSOMAError);
+    REQUIRE_THROWS_AS(SharedBatch::unlink(name), TileDBSOMAError);
+}
+#endif
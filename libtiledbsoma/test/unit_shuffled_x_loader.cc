@@ -0,0 +1,139 @@
+/**
+ * @file   unit_shuffled_x_loader.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the ShuffledXLoader class
+ */
+
+#include "common.h"
+
+namespace {
+// Drain one epoch, checking each row against X[i, j] = i * 5 + j, and
+// return the obs joinids in emission order
+std::vector<int64_t> drain(
+    ShuffledXLoader& loader,
+    const std::vector<int64_t>& var_joinids,
+    size_t batch_size) {
+    std::vector<int64_t> joinids;
+    while (auto batch = loader.next()) {
+        REQUIRE(batch->n_rows() <= batch_size);
+        REQUIRE(batch->n_cols == (int64_t)var_joinids.size());
+        auto dense = batch->to_dense();
+        for (size_t row = 0; row < batch->n_rows(); ++row) {
+            int64_t i = batch->obs_joinids[row];
+            for (size_t col = 0; col < var_joinids.size(); ++col) {
+                REQUIRE(
+                    dense[row * var_joinids.size() + col] ==
+                    i * 5 + var_joinids[col]);
+            }
+            joinids.push_back(i);
+        }
+    }
+    return joinids;
+}
+}  // namespace
+
+TEST_CASE("ShuffledXLoader: shuffled epochs") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-shuffled-x-loader";
+    helper::create_experiment(uri, ctx, 40, 5);
+
+    SOMAExperimentAxisQuery query(
+        SOMAExperiment::open(uri, OpenMode::read, ctx),
+        "RNA",
+        SOMAAxisQuery().set_ranges({{3, 35}}),
+        SOMAAxisQuery().set_coords({4, 1, 2}));
+    std::vector<int64_t> expected = query.obs_joinids();
+
+    ShuffledXLoaderOptions options;
+    options.seed = 7;
+    options.batch_size = 4;
+    options.chunk_size = 3;
+    options.buffer_size = 10;
+    auto loader = query.X_loader("data", options);
+    REQUIRE(loader->num_rows() == expected.size());
+
+    auto epoch0 = drain(*loader, query.var_joinids(), 4);
+    auto sorted0 = epoch0;
+    std::sort(sorted0.begin(), sorted0.end());
+    REQUIRE(sorted0 == expected);
+    REQUIRE(epoch0 != expected);
+
+    // The order only depends on the seed and epoch
+    loader->set_epoch(0);
+    REQUIRE(drain(*loader, query.var_joinids(), 4) == epoch0);
+    loader->set_epoch(1);
+    REQUIRE(loader->epoch() == 1);
+    auto epoch1 = drain(*loader, query.var_joinids(), 4);
+    REQUIRE(epoch1 != epoch0);
+
+    options.shuffle = false;
+    auto ordered = query.X_loader("data", options);
+    REQUIRE(drain(*ordered, query.var_joinids(), 4) == expected);
+}
+
+TEST_CASE("ShuffledXLoader: shards") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-shuffled-x-loader-shards";
+    helper::create_experiment(uri, ctx, 30, 5);
+
+    std::vector<int64_t> obs_joinids(30);
+    std::iota(obs_joinids.begin(), obs_joinids.end(), 0);
+    std::vector<int64_t> var_joinids = {0, 1, 2, 3, 4};
+    std::string x_uri = uri + "/ms/RNA/X/data";
+
+    ShuffledXLoaderOptions options;
+    options.batch_size = 8;
+    options.chunk_size = 4;
+    options.buffer_size = 8;
+    options.num_shards = 3;
+
+    std::vector<int64_t> all;
+    for (uint32_t shard = 0; shard < 3; ++shard) {
+        options.shard = shard;
+        ShuffledXLoader loader(ctx, x_uri, obs_joinids, var_joinids, options);
+        auto joinids = drain(loader, var_joinids, 8);
+        REQUIRE(joinids.size() == loader.num_rows());
+        all.insert(all.end(), joinids.begin(), joinids.end());
+    }
+    std::sort(all.begin(), all.end());
+    REQUIRE(all == obs_joinids);
+
+    // With drop_last every minibatch is full
+    options.shard = 0;
+    options.drop_last = true;
+    ShuffledXLoader loader(ctx, x_uri, obs_joinids, var_joinids, options);
+    while (auto batch = loader.next()) {
+        REQUIRE(batch->n_rows() == 8);
+    }
+
+    options.shard = 3;
+    REQUIRE_THROWS_AS(
+        ShuffledXLoader(ctx, x_uri, obs_joinids, var_joinids, options),
+        TileDBSOMAError);
+}
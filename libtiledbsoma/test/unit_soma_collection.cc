@@ -438,3 +438,93 @@ TEST_CASE("SOMAMeasurement: metadata") {
     REQUIRE(!soma_measurement->has_metadata("md"));
     REQUIRE(soma_measurement->metadata_num() == 2);
 }
+
+TEST_CASE("SOMAExperiment: open members") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-experiment-open-members";
+    helper::create_experiment(uri, ctx, 10, 4);
+
+    {
+        // Open the whole tree
+        auto experiment = SOMAExperiment::open(uri, OpenMode::read, ctx);
+        auto members = experiment->open_members();
+        std::vector<std::string> paths;
+        for (const auto& [path, member] : members) {
+            paths.push_back(path);
+            REQUIRE(member->is_open());
+        }
+        REQUIRE(
+            paths == std::vector<std::string>(
+                         {"ms",
+                          "ms/RNA",
+                          "ms/RNA/X",
+                          "ms/RNA/X/data",
+                          "ms/RNA/obsm",
+                          "ms/RNA/obsp",
+                          "ms/RNA/var",
+                          "ms/RNA/varm",
+                          "ms/RNA/varp",
+                          "obs"}));
+        REQUIRE(members["obs"]->type() == "SOMADataFrame");
+        REQUIRE(members["ms/RNA"]->type() == "SOMAMeasurement");
+        REQUIRE(members["ms/RNA/X/data"]->type() == "SOMASparseNDArray");
+
+        // Lazy accessors reuse the opened members
+        REQUIRE(experiment->ms() == members["ms"]);
+        REQUIRE(experiment->obs() == members["obs"]);
+        auto ms = std::dynamic_pointer_cast<SOMACollection>(members["ms"]);
+        REQUIRE(ms->member("RNA") == members["ms/RNA"]);
+
+        // Opening again returns the same handles
+        auto again = experiment->open_members({"ms/RNA/X"});
+        REQUIRE(again.size() == 4);
+        REQUIRE(again["ms/RNA/X/data"] == members["ms/RNA/X/data"]);
+
+        experiment->close();
+        REQUIRE(!members["ms/RNA/X/data"]->is_open());
+        REQUIRE(!members["obs"]->is_open());
+    }
+
+    {
+        // Open only the requested members and the collections leading to
+        // them
+        auto experiment = SOMAExperiment::open(uri, OpenMode::read, ctx);
+        auto members = experiment->open_members({"ms/RNA/X/data", "obs"});
+        std::vector<std::string> paths;
+        for (const auto& [path, member] : members) {
+            paths.push_back(path);
+        }
+        REQUIRE(
+            paths == std::vector<std::string>(
+                         {"ms", "ms/RNA", "ms/RNA/X", "ms/RNA/X/data", "obs"}));
+
+        auto ms = std::dynamic_pointer_cast<SOMACollection>(members["ms"]);
+        auto measurement = std::dynamic_pointer_cast<SOMAMeasurement>(
+            ms->member("RNA"));
+        REQUIRE(measurement != nullptr);
+        REQUIRE(measurement->X() == members["ms/RNA/X"]);
+        REQUIRE(measurement->var()->type() == "SOMADataFrame");
+        experiment->close();
+    }
+
+    {
+        // Unknown paths open nothing
+        auto experiment = SOMAExperiment::open(uri, OpenMode::read, ctx);
+        REQUIRE(experiment->open_members({"nope"}).empty());
+        experiment->close();
+    }
+
+    {
+        // Without a thread pool the members are opened one at a time
+        auto serial_ctx = std::make_shared<SOMAContext>(
+            std::map<std::string, std::string>(
+                {{"sm.compute_concurrency_level", "1"}}));
+        REQUIRE(serial_ctx->thread_pool() == nullptr);
+        std::string serial_uri = uri + "-serial";
+        helper::create_experiment(serial_uri, serial_ctx, 10, 4);
+        auto experiment = SOMAExperiment::open(
+            serial_uri, OpenMode::read, serial_ctx);
+        REQUIRE(experiment->open_members().size() == 10);
+        experiment->close();
+    }
+}
@@ -240,3 +240,105 @@ TEST_CASE("SOMADataFrame: metadata") {
     REQUIRE(!soma_dataframe->has_metadata("md"));
     REQUIRE(soma_dataframe->metadata_num() == 2);
 }
+
+TEST_CASE("SOMADataFrame: late materialization") {
+    auto late = GENERATE(false, true);
+    std::map<std::string, std::string> config{
+        {SOMAArray::CONFIG_KEY_LATE_MATERIALIZATION, late ? "true" : "false"}};
+    auto ctx = std::make_shared<SOMAContext>(config);
+    std::string uri = "mem://unit-test-dataframe-late-materialization";
+    int64_t n = 100;
+
+    auto [schema, index_columns] = helper::create_joinid_schema(n - 1);
+    SOMADataFrame::create(
+        uri,
+        std::move(schema),
+        ArrowTable(
+            std::move(index_columns.first), std::move(index_columns.second)),
+        ctx);
+
+    std::vector<int64_t> joinids(n), labels(n);
+    for (int64_t i = 0; i < n; ++i) {
+        joinids[i] = i;
+        labels[i] = 10 * i;
+    }
+    auto soma_dataframe = SOMADataFrame::open(uri, OpenMode::write, ctx);
+    soma_dataframe->set_column_data("soma_joinid", n, joinids.data());
+    soma_dataframe->set_column_data("label", n, labels.data());
+    soma_dataframe->write();
+    soma_dataframe->close();
+
+    auto read = [&](int64_t min_joinid) {
+        auto df = SOMADataFrame::open(uri, OpenMode::read, ctx);
+        auto qc = QueryCondition::create<int64_t>(
+            *ctx->tiledb_ctx(), "soma_joinid", min_joinid, TILEDB_GE);
+        df->set_condition(qc, {"soma_joinid"});
+        std::vector<int64_t> result_joinids, result_labels;
+        while (auto batch = df->read_next()) {
+            auto d = (*batch)->at("soma_joinid")->data<int64_t>();
+            auto l = (*batch)->at("label")->data<int64_t>();
+            result_joinids.insert(result_joinids.end(), d.begin(), d.end());
+            result_labels.insert(result_labels.end(), l.begin(), l.end());
+        }
+        df->close();
+        return std::pair(result_joinids, result_labels);
+    };
+
+    auto [matched_joinids, matched_labels] = read(90);
+    REQUIRE(matched_joinids.size() == 10);
+    for (size_t i = 0; i < matched_joinids.size(); ++i) {
+        REQUIRE(matched_labels[i] == 10 * matched_joinids[i]);
+    }
+    std::sort(matched_joinids.begin(), matched_joinids.end());
+    std::vector<int64_t> expected(10);
+    std::iota(expected.begin(), expected.end(), 90);
+    REQUIRE(matched_joinids == expected);
+
+    auto [empty_joinids, empty_labels] = read(n);
+    REQUIRE(empty_joinids.empty());
+    REQUIRE(empty_labels.empty());
+}
+
+TEST_CASE("SOMADataFrame: Arrow struct array") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-dataframe-arrow-struct";
+
+    auto [schema, index_columns] = helper::create_arrow_schema();
+    SOMADataFrame::create(
+        uri,
+        std::move(schema),
+        ArrowTable(
+            std::move(index_columns.first), std::move(index_columns.second)),
+        ctx);
+
+    std::vector<int64_t> d0 = {0, 1, 2, 3, 4};
+    std::vector<int> a0 = {10, 11, 12, 13, 14};
+
+    auto soma_dataframe = SOMADataFrame::open(uri, OpenMode::write, ctx);
+    soma_dataframe->set_column_data("a0", a0.size(), a0.data());
+    soma_dataframe->set_column_data("d0", d0.size(), d0.data());
+    soma_dataframe->write();
+    soma_dataframe->close();
+
+    soma_dataframe = SOMADataFrame::open(uri, OpenMode::read, ctx);
+    auto batch = soma_dataframe->read_next();
+    REQUIRE(batch.has_value());
+    auto& names = (*batch)->names();
+    auto [array, arrow_schema] = ArrowAdapter::to_arrow(*batch);
+    soma_dataframe->close();
+
+    REQUIRE(std::string(arrow_schema->format) == "+s");
+    REQUIRE(arrow_schema->n_children == static_cast<int64_t>(names.size()));
+    REQUIRE(array->n_children == static_cast<int64_t>(names.size()));
+    REQUIRE(array->length == static_cast<int64_t>(d0.size()));
+    for (size_t i = 0; i < names.size(); ++i) {
+        REQUIRE(std::string(arrow_schema->children[i]->name) == names[i]);
+        REQUIRE(array->children[i]->length == array->length);
+    }
+
+    // Releasing the struct releases every column
+    array->release(array.get());
+    arrow_schema->release(arrow_schema.get());
+    REQUIRE(array->release == nullptr);
+    REQUIRE(arrow_schema->release == nullptr);
+}
@@ -0,0 +1,199 @@
+/**
+ * @file   unit_soma_experiment_axis_query.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the SOMAExperimentAxisQuery class
+ */
+
+#include "common.h"
+
+TEST_CASE("SOMAExperimentAxisQuery: coords and ranges") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-experiment-axis-query";
+    int64_t n_obs = 10, n_var = 5;
+    helper::create_experiment(uri, ctx, n_obs, n_var);
+
+    std::shared_ptr<SOMAExperiment> experiment = SOMAExperiment::open(
+        uri, OpenMode::read, ctx);
+    SOMAExperimentAxisQuery query(
+        experiment,
+        "RNA",
+        SOMAAxisQuery().set_coords({7, 3, 1, 5, 3}),
+        SOMAAxisQuery().set_ranges({{1, 2}}));
+
+    REQUIRE(query.obs_joinids() == std::vector<int64_t>({1, 3, 5, 7}));
+    REQUIRE(query.var_joinids() == std::vector<int64_t>({1, 2}));
+    REQUIRE(query.n_obs() == 4);
+    REQUIRE(query.n_vars() == 2);
+
+    size_t num_cells = 0;
+    for (auto& batch : query.read_X("data", true)) {
+        auto d0 = batch->at("soma_dim_0")->data<int64_t>();
+        auto d1 = batch->at("soma_dim_1")->data<int64_t>();
+        auto data = batch->at("soma_data")->data<int64_t>();
+        for (size_t i = 0; i < batch->num_rows(); ++i) {
+            REQUIRE(d0[i] >= 0);
+            REQUIRE(d0[i] < 4);
+            REQUIRE(d1[i] >= 0);
+            REQUIRE(d1[i] < 2);
+            REQUIRE(
+                data[i] == query.obs_joinids()[d0[i]] * n_var +
+                               query.var_joinids()[d1[i]]);
+        }
+        num_cells += batch->num_rows();
+    }
+    REQUIRE(num_cells == 8);
+
+    auto layers = query.read_X_layers({"data"});
+    REQUIRE(layers.size() == 1);
+    num_cells = 0;
+    for (auto& batch : layers["data"]) {
+        num_cells += batch->num_rows();
+    }
+    REQUIRE(num_cells == 8);
+
+    size_t num_obs = 0;
+    for (auto& batch : query.obs({"soma_joinid", "label"})) {
+        num_obs += batch->num_rows();
+    }
+    REQUIRE(num_obs == 4);
+
+    REQUIRE_THROWS_AS(query.read_X("missing"), TileDBSOMAError);
+    experiment->close();
+}
+
+TEST_CASE("SOMAExperimentAxisQuery: value filter") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-experiment-axis-query-filter";
+    int64_t n_obs = 10, n_var = 5;
+    helper::create_experiment(uri, ctx, n_obs, n_var);
+
+    std::shared_ptr<SOMAExperiment> experiment = SOMAExperiment::open(
+        uri, OpenMode::read, ctx);
+    auto qc = QueryCondition::create<int64_t>(
+        *ctx->tiledb_ctx(), "label", 0, TILEDB_EQ);
+    SOMAExperimentAxisQuery query(
+        experiment, "RNA", SOMAAxisQuery().set_condition(qc));
+
+    REQUIRE(query.obs_joinids() == std::vector<int64_t>({0, 2, 4, 6, 8}));
+    REQUIRE(query.n_vars() == 5);
+
+    size_t num_cells = 0;
+    for (auto& batch : query.read_X("data")) {
+        auto d0 = batch->at("soma_dim_0")->data<int64_t>();
+        for (size_t i = 0; i < batch->num_rows(); ++i) {
+            REQUIRE(d0[i] % 2 == 0);
+        }
+        num_cells += batch->num_rows();
+    }
+    REQUIRE(num_cells == 25);
+
+    // An empty selection yields no cells
+    SOMAExperimentAxisQuery empty(
+        experiment, "RNA", SOMAAxisQuery().set_coords({}));
+    REQUIRE(empty.n_obs() == 0);
+    num_cells = 0;
+    for (auto& batch : empty.read_X("data", true)) {
+        num_cells += batch->num_rows();
+    }
+    REQUIRE(num_cells == 0);
+    experiment->close();
+}
+
+TEST_CASE("SOMAExperimentAxisQuery: stale column-major layout") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-experiment-axis-query-layout";
+    std::string x_uri = uri + "/ms/RNA/X/data";
+    std::string layout_uri = x_uri + "-colmajor";
+    int64_t n_obs = 10, n_var = 10;
+    helper::create_experiment(uri, ctx, n_obs, n_var, n_var);
+
+    auto x = SOMASparseNDArray::open(x_uri, OpenMode::write, ctx);
+    x->create_colmajor_layout(layout_uri);
+    x->close();
+
+    auto var_selection = JoinidBitmap::from_joinids({3});
+    auto routed_uri = [&]() {
+        auto array = SOMASparseNDArray::open_layout(
+            x_uri, ctx, std::nullopt, var_selection);
+        auto routed = array->uri();
+        array->close();
+        return routed;
+    };
+    auto read_var = [&]() {
+        std::shared_ptr<SOMAExperiment> experiment = SOMAExperiment::open(
+            uri, OpenMode::read, ctx);
+        SOMAExperimentAxisQuery query(
+            experiment,
+            "RNA",
+            SOMAAxisQuery(),
+            SOMAAxisQuery().set_coords({3}));
+        std::vector<int64_t> values;
+        for (auto& batch : query.read_X("data")) {
+            auto data = batch->at("soma_data")->data<int64_t>();
+            values.insert(values.end(), data.begin(), data.end());
+        }
+        experiment->close();
+        return values;
+    };
+
+    REQUIRE(routed_uri() == layout_uri);
+    REQUIRE(read_var().size() == 10);
+
+    // Overwrite X[4, 3] with the TileDB API, bypassing SOMAArray::write, as
+    // writers outside libtiledbsoma do
+    std::vector<int64_t> d0 = {4}, d1 = {3}, value = {-1};
+    Array array(*ctx->tiledb_ctx(), x_uri, TILEDB_WRITE);
+    Query query(*ctx->tiledb_ctx(), array);
+    query.set_layout(TILEDB_UNORDERED)
+        .set_data_buffer("soma_dim_0", d0)
+        .set_data_buffer("soma_dim_1", d1)
+        .set_data_buffer("soma_data", value);
+    query.submit();
+    array.close();
+
+    // The layout no longer matches the array, so the query reads the array
+    REQUIRE(routed_uri() == x_uri);
+    size_t overwritten = 0;
+    for (auto v : read_var()) {
+        if (v == -1) {
+            overwritten++;
+        }
+    }
+    REQUIRE(overwritten == 1);
+
+    // Later writes through SOMAArray do not bring a stale layout back
+    int64_t c0 = 5, c1 = 3, v0 = -2;
+    x->open(OpenMode::write);
+    x->set_column_data("soma_dim_0", 1, &c0);
+    x->set_column_data("soma_dim_1", 1, &c1);
+    x->set_column_data("soma_data", 1, &v0);
+    x->write();
+    x->close();
+    REQUIRE(routed_uri() == x_uri);
+}
@@ -175,4 +175,74 @@ TEST_CASE("SOMASparseNDArray: metadata") {
     soma_sparse->open(OpenMode::read, TimestampRange(0, 2));
     REQUIRE(!soma_sparse->has_metadata("md"));
     REQUIRE(soma_sparse->metadata_num() == 2);
-}
\ No newline at end of file
+}
+TEST_CASE("SOMASparseNDArray: column-major layout") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-ndarray-colmajor";
+    std::string layout_uri = uri + "-colmajor";
+
+    SOMASparseNDArray::create(
+        uri,
+        "l",
+        helper::create_ndarray_index_info(2, 99, 100),
+        ctx,
+        PlatformConfig());
+
+    std::vector<int64_t> d0, d1, a0;
+    for (int64_t i = 0; i < 10; ++i) {
+        for (int64_t j = 0; j < 10; ++j) {
+            d0.push_back(i);
+            d1.push_back(j);
+            a0.push_back(i * 10 + j);
+        }
+    }
+    auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::write, ctx);
+    soma_sparse->set_column_data("soma_dim_0", d0.size(), d0.data());
+    soma_sparse->set_column_data("soma_dim_1", d1.size(), d1.data());
+    soma_sparse->set_column_data("soma_data", a0.size(), a0.data());
+    soma_sparse->write();
+    soma_sparse->create_colmajor_layout(layout_uri);
+    REQUIRE(soma_sparse->colmajor_layout_uri() == layout_uri);
+    REQUIRE_THROWS(soma_sparse->create_colmajor_layout(layout_uri));
+    soma_sparse->close();
+
+    auto layout = SOMASparseNDArray::open(layout_uri, OpenMode::read, ctx);
+    REQUIRE(layout->tiledb_schema()->tile_order() == TILEDB_COL_MAJOR);
+    REQUIRE(layout->tiledb_schema()->cell_order() == TILEDB_COL_MAJOR);
+    REQUIRE(layout->nnz() == 100);
+    layout->close();
+
+    // Later writes are mirrored to the layout
+    int64_t c0 = 50, c1 = 50, v0 = -1;
+    soma_sparse->open(OpenMode::write);
+    soma_sparse->set_column_data("soma_dim_0", 1, &c0);
+    soma_sparse->set_column_data("soma_dim_1", 1, &c1);
+    soma_sparse->set_column_data("soma_data", 1, &v0);
+    soma_sparse->write();
+    soma_sparse->close();
+    layout->open(OpenMode::read);
+    REQUIRE(layout->nnz() == 101);
+    layout->close();
+
+    // Row selections read the array, column selections the layout
+    auto selection = JoinidBitmap::from_joinids({3});
+    auto x = SOMASparseNDArray::open_layout(uri, ctx, selection, std::nullopt);
+    REQUIRE(x->uri() == uri);
+    x->close();
+    x = SOMASparseNDArray::open_layout(uri, ctx, std::nullopt, std::nullopt);
+    REQUIRE(x->uri() == uri);
+    x->close();
+    x = SOMASparseNDArray::open_layout(uri, ctx, std::nullopt, selection);
+    REQUIRE(x->uri() == layout_uri);
+    x->set_dim_joinids("soma_dim_1", selection);
+    std::vector<int64_t> values;
+    while (auto batch = x->read_next()) {
+        auto data = (*batch)->at("soma_data")->data<int64_t>();
+        values.insert(values.end(), data.begin(), data.end());
+    }
+    x->close();
+    std::sort(values.begin(), values.end());
+    REQUIRE(
+        values ==
+        std::vector<int64_t>{3, 13, 23, 33, 43, 53, 63, 73, 83, 93});
+}
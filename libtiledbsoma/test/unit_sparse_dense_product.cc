@@ -0,0 +1,124 @@
+/**
+ * @file   unit_sparse_dense_product.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the SparseDenseProduct class
+ */
+
+#include "common.h"
+
+TEMPLATE_TEST_CASE(
+    "SparseDenseProduct: small matrix",
+    "[SparseDenseProduct]",
+    int32_t,
+    float,
+    double) {
+    auto ctx = std::make_shared<SOMAContext>();
+
+    // A = [1 0 2]    B = [1 2]
+    //     [0 0 0]        [3 4]
+    //     [0 3 0]        [5 6]
+    std::vector<int64_t> rows = {2, 0, 0};
+    std::vector<int64_t> cols = {1, 2, 0};
+    std::vector<TestType> data = {3, 2, 1};
+    std::vector<double> rhs = {1, 2, 3, 4, 5, 6};
+
+    SparseDenseProduct product(3, 3, rhs.data(), 2, ctx);
+    product.update(rows.data(), cols.data(), data.data(), 1);
+    product.update(rows.data() + 1, cols.data() + 1, data.data() + 1, 2);
+    REQUIRE(product.n_rows() == 3);
+    REQUIRE(product.k() == 2);
+    REQUIRE(product.result() == std::vector<double>({11, 14, 0, 0, 9, 12}));
+
+    SparseDenseProduct out_of_bounds(2, 3, rhs.data(), 2);
+    REQUIRE_THROWS_AS(
+        out_of_bounds.update(rows.data(), cols.data(), data.data(), 1),
+        TileDBSOMAError);
+}
+
+TEST_CASE("SparseDenseProduct: thread pool matches serial") {
+    // One batch large enough to be split across tasks
+    auto ctx = std::make_shared<SOMAContext>();
+    REQUIRE(ctx->thread_pool() != nullptr);
+    int64_t n_rows = 600, n_cols = 400, k = 4;
+    std::mt19937 gen(1);
+    std::vector<int64_t> rows, cols;
+    std::vector<float> data;
+    for (int64_t i = 0; i < n_rows; ++i) {
+        for (int64_t j = 0; j < n_cols; ++j) {
+            if (gen() % 3 != 0) {
+                rows.push_back(i);
+                cols.push_back(j);
+                data.push_back(static_cast<float>(gen() % 100) / 3);
+            }
+        }
+    }
+    std::shuffle(rows.begin(), rows.end(), std::mt19937(2));
+    std::shuffle(cols.begin(), cols.end(), std::mt19937(3));
+    std::vector<double> rhs(n_cols * k);
+    for (auto& value : rhs) {
+        value = static_cast<double>(gen() % 100) / 7;
+    }
+    REQUIRE(rows.size() * k >= 2 * (1 << 18));
+
+    SparseDenseProduct serial(n_rows, n_cols, rhs.data(), k);
+    SparseDenseProduct parallel(n_rows, n_cols, rhs.data(), k, ctx);
+    serial.update(rows.data(), cols.data(), data.data(), rows.size());
+    parallel.update(rows.data(), cols.data(), data.data(), rows.size());
+
+    // Each row sums its products on one task in batch order, so the results
+    // are identical
+    REQUIRE(parallel.result() == serial.result());
+
+    // Coordinates are checked before the cells are bucketed by task
+    SparseDenseProduct out_of_bounds(n_rows - 1, n_cols, rhs.data(), k, ctx);
+    REQUIRE_THROWS_AS(
+        out_of_bounds.update(
+            rows.data(), cols.data(), data.data(), rows.size()),
+        TileDBSOMAError);
+}
+
+TEST_CASE("SparseDenseProduct: from an axis query") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-dense-product";
+    int64_t n_obs = 10, n_var = 5;
+    helper::create_experiment(uri, ctx, n_obs, n_var);
+
+    // Selected cells are X[i, j] = i * 5 + j for obs {2, 5, 8} and var
+    // {0, 4}, so the reindexed X is [[10 14] [25 29] [40 44]]
+    SOMAExperimentAxisQuery query(
+        SOMAExperiment::open(uri, OpenMode::read, ctx),
+        "RNA",
+        SOMAAxisQuery().set_coords({8, 2, 5}),
+        SOMAAxisQuery().set_coords({4, 0}));
+    std::vector<double> rhs = {1, 2, 3, 4};
+    REQUIRE(
+        query.X_matmul("data", rhs.data(), 2) ==
+        std::vector<double>({52, 76, 112, 166, 172, 256}));
+    REQUIRE(query.X_matmul("data", rhs.data(), 0).empty());
+}
@@ -0,0 +1,239 @@
+/**
+ * @file   unit_sparse_moments.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2022 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file manages unit tests for the SparseMoments class
+ */
+
+#include "common.h"
+
+TEST_CASE("SparseMoments: small matrix") {
+    // A 3 x 4 matrix, split in 2 batches:
+    //   [1 0 0 2]
+    //   [0 0 0 0]
+    //   [3 0 5 0]
+    // The stored 0 at (1, 1) counts as a zero, not as a non-zero value.
+    std::vector<int64_t> rows = {2, 0, 1, 0, 2};
+    std::vector<int64_t> cols = {2, 3, 1, 0, 0};
+    std::vector<float> data = {5, 2, 0, 1, 3};
+
+    SparseMoments moments(3, 4);
+    moments.update(rows.data(), cols.data(), data.data(), 3);
+    moments.update(rows.data() + 3, cols.data() + 3, data.data() + 3, 2);
+    moments.finalize(0);
+
+    REQUIRE(moments.row_nnz() == std::vector<int64_t>({2, 0, 2}));
+    REQUIRE(moments.row_mean() == std::vector<double>({0.75, 0, 2}));
+    REQUIRE(
+        moments.row_variance() == std::vector<double>({0.6875, 0, 4.5}));
+    REQUIRE(moments.col_nnz() == std::vector<int64_t>({2, 0, 1, 1}));
+    REQUIRE(
+        moments.col_mean() ==
+        std::vector<double>({4.0 / 3, 0, 5.0 / 3, 2.0 / 3}));
+    REQUIRE(moments.col_variance()[1] == 0);
+    REQUIRE_THAT(moments.col_variance()[2], WithinRel(50.0 / 9, 1e-12));
+
+    REQUIRE_THROWS_AS(
+        moments.update(rows.data(), cols.data(), data.data(), 1),
+        TileDBSOMAError);
+
+    SparseMoments out_of_bounds(2, 4);
+    REQUIRE_THROWS_AS(
+        out_of_bounds.update(rows.data(), cols.data(), data.data(), 1),
+        TileDBSOMAError);
+}
+
+TEST_CASE("SparseMoments: matches dense moments") {
+    auto ctx = std::make_shared<SOMAContext>();
+    int64_t n_rows = 300, n_cols = 200;
+
+    // Large values with a small spread lose precision with naive sums of
+    // squares
+    std::mt19937 gen(0);
+    std::vector<double> dense(n_rows * n_cols, 0);
+    std::vector<int64_t> rows, cols;
+    std::vector<double> data;
+    for (int64_t i = 0; i < n_rows; ++i) {
+        for (int64_t j = 0; j < n_cols; ++j) {
+            if (gen() % 3 == 0) {
+                continue;
+            }
+            double value = 1e6 + (gen() % 1000) / 7.0;
+            dense[i * n_cols + j] = value;
+            rows.push_back(i);
+            cols.push_back(j);
+            data.push_back(value);
+        }
+    }
+
+    SparseMoments moments(n_rows, n_cols, ctx);
+    for (size_t offset = 0; offset < rows.size(); offset += 10000) {
+        size_t size = std::min<size_t>(10000, rows.size() - offset);
+        moments.update(
+            rows.data() + offset,
+            cols.data() + offset,
+            data.data() + offset,
+            size);
+    }
+    moments.finalize();
+
+    auto check = [&](int64_t i,
+                     int64_t n,
+                     auto value_at,
+                     double mean,
+                     double variance,
+                     int64_t nnz) {
+        double sum = 0;
+        int64_t expected_nnz = 0;
+        for (int64_t j = 0; j < n; ++j) {
+            sum += value_at(i, j);
+            expected_nnz += value_at(i, j) != 0;
+        }
+        double expected_mean = sum / n;
+        double m2 = 0;
+        for (int64_t j = 0; j < n; ++j) {
+            m2 += (value_at(i, j) - expected_mean) *
+                  (value_at(i, j) - expected_mean);
+        }
+        REQUIRE(nnz == expected_nnz);
+        REQUIRE_THAT(mean, WithinRel(expected_mean, 1e-12));
+        REQUIRE_THAT(variance, WithinRel(m2 / (n - 1), 1e-9));
+    };
+    auto row_value = [&](int64_t i, int64_t j) {
+        return dense[i * n_cols + j];
+    };
+    auto col_value = [&](int64_t j, int64_t i) {
+        return dense[i * n_cols + j];
+    };
+    for (int64_t i = 0; i < n_rows; ++i) {
+        check(
+            i,
+            n_cols,
+            row_value,
+            moments.row_mean()[i],
+            moments.row_variance()[i],
+            moments.row_nnz()[i]);
+    }
+    for (int64_t j = 0; j < n_cols; ++j) {
+        check(
+            j,
+            n_rows,
+            col_value,
+            moments.col_mean()[j],
+            moments.col_variance()[j],
+            moments.col_nnz()[j]);
+    }
+}
+
+TEST_CASE("SparseMoments: thread pool matches serial") {
+    // One batch large enough to be split across tasks
+    auto ctx = std::make_shared<SOMAContext>();
+    REQUIRE(ctx->thread_pool() != nullptr);
+    int64_t n_rows = 600, n_cols = 400;
+    std::mt19937 gen(1);
+    std::vector<int64_t> rows, cols;
+    std::vector<float> data;
+    for (int64_t i = 0; i < n_rows; ++i) {
+        for (int64_t j = 0; j < n_cols; ++j) {
+            if (gen() % 3 != 0) {
+                rows.push_back(i);
+                cols.push_back(j);
+                data.push_back(static_cast<float>(gen() % 100) / 3);
+            }
+        }
+    }
+    std::shuffle(rows.begin(), rows.end(), std::mt19937(2));
+    std::shuffle(cols.begin(), cols.end(), std::mt19937(3));
+    REQUIRE(rows.size() >= 2 * (1 << 16));
+
+    SparseMoments serial(n_rows, n_cols);
+    SparseMoments parallel(n_rows, n_cols, ctx);
+    for (auto* moments : {&serial, &parallel}) {
+        moments->update(rows.data(), cols.data(), data.data(), rows.size());
+        moments->finalize();
+    }
+
+    // Each row and column is accumulated by one task in batch order, so the
+    // results are identical
+    REQUIRE(parallel.row_nnz() == serial.row_nnz());
+    REQUIRE(parallel.row_mean() == serial.row_mean());
+    REQUIRE(parallel.row_variance() == serial.row_variance());
+    REQUIRE(parallel.col_nnz() == serial.col_nnz());
+    REQUIRE(parallel.col_mean() == serial.col_mean());
+    REQUIRE(parallel.col_variance() == serial.col_variance());
+
+    // Coordinates are checked before the cells are bucketed by task
+    SparseMoments out_of_bounds(n_rows - 1, n_cols, ctx);
+    REQUIRE_THROWS_AS(
+        out_of_bounds.update(
+            rows.data(), cols.data(), data.data(), rows.size()),
+        TileDBSOMAError);
+}
+
+TEST_CASE("SparseMoments: from an axis query") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-moments";
+    int64_t n_obs = 10, n_var = 5;
+    helper::create_experiment(uri, ctx, n_obs, n_var);
+
+    {
+        // Selected cells are X[i, j] = i * 5 + j for obs {2, 5, 8} and var
+        // {0, 4}
+        SOMAExperimentAxisQuery query(
+            SOMAExperiment::open(uri, OpenMode::read, ctx),
+            "RNA",
+            SOMAAxisQuery().set_coords({8, 2, 5}),
+            SOMAAxisQuery().set_coords({4, 0}));
+        auto moments = query.X_moments("data");
+        REQUIRE(moments.n_rows() == 3);
+        REQUIRE(moments.n_cols() == 2);
+        REQUIRE(moments.row_nnz() == std::vector<int64_t>({2, 2, 2}));
+        REQUIRE(moments.col_nnz() == std::vector<int64_t>({3, 3}));
+        for (size_t i = 0; i < 3; ++i) {
+            REQUIRE_THAT(
+                moments.row_mean()[i], WithinRel(12.0 + 15 * i, 1e-12));
+            REQUIRE_THAT(moments.row_variance()[i], WithinRel(8.0, 1e-12));
+        }
+        for (size_t j = 0; j < 2; ++j) {
+            REQUIRE_THAT(moments.col_mean()[j], WithinRel(25.0 + 4 * j, 1e-12));
+            REQUIRE_THAT(moments.col_variance()[j], WithinRel(225.0, 1e-12));
+        }
+    }
+
+    {
+        // X[0, 0] is a stored zero
+        SOMAExperimentAxisQuery query(
+            SOMAExperiment::open(uri, OpenMode::read, ctx), "RNA");
+        auto moments = query.X_moments("data", 0);
+        REQUIRE(moments.row_nnz()[0] == 4);
+        REQUIRE(moments.row_nnz()[1] == 5);
+        REQUIRE(moments.col_nnz()[0] == 9);
+        REQUIRE_THAT(moments.col_mean()[0], WithinRel(22.5, 1e-12));
+        REQUIRE_THAT(moments.col_variance()[0], WithinRel(206.25, 1e-12));
+    }
+}